@@ -1,8 +1,9 @@
-# Usage: python3 generate_constellation_state_pie_chart.py /path/to/num-steps.dat /path/to/logs/ device-name /path/to/dst/
+# Usage: python3 generate_constellation_state_pie_chart.py [/path/to/num-steps.dat] /path/to/logs/ device-name /path/to/dst/
 # Parameters:
-#  /path/to/num-steps.dat: config files used to specify simulation step count
-#  /path/to/logs/: path to the directory containing simulation logs
-#  device-name: e.g. adacs; replaces * in meas-sat-NNNNNNNNNN-*-state.csv
+#  /path/to/num-steps.dat: optional; accepted for compatibility with earlier
+#   versions, whose logs did not record the end of the last state interval
+#  /path/to/logs/: path to the directory containing state-intervals.csv
+#  device-name: e.g. adacs; selects the rows of state-intervals.csv to use
 #  /path/to/dst/: directory to write pie-chart-*.pdf
 # Output:
 #  pie-chart-*.pdf where * is the supplied device-name
@@ -12,111 +13,68 @@ import csv                      # read and write CSV files
 import math                     # floor, ceil, sqrt
 import matplotlib.pyplot as plt # generate a pie chart
 import statistics               # mean and population standard deviation
-import os                       # list directory
-import re                       # regular expressions
 import sys                      # script arguments
 
 # initialize script arguments
-nsd = '' # simulation step count file
-log = '' # log directory containing meas-sat-NNNNNNNNNN-*-state.csv files
-dev = '' # device name used to replace *
+log = '' # log directory containing state-intervals.csv
+dev = '' # device name
 dst = '' # destination directory for produced chart file
 
 # parse script arguments
-if len(sys.argv)==5:
-  nsd = sys.argv[1]
-  log = sys.argv[2]
+if len(sys.argv)==4 or len(sys.argv)==5:
+  # The step count is recorded in the intervals, so num-steps.dat is unused
+  log = sys.argv[-3]
   if log[-1] != '/':
     log += '/'
-  dev = sys.argv[3]
-  dst = sys.argv[4]
+  dev = sys.argv[-2]
+  dst = sys.argv[-1]
   if dst[-1] != '/':
     dst += '/'
 else:
   print(\
    'Usage: '\
    'python3 generate_constellation_state_pie_chart.py '\
-   '/path/to/num-steps.dat /path/to/logs/ device-name /path/to/dst/'\
+   '[/path/to/num-steps.dat] /path/to/logs/ device-name /path/to/dst/'\
   )
   exit()
 
-# read num-steps.dat file
-nsd_header = ''
-nsd_line_1 = ''
-with open(nsd, 'r') as infile:
-  nsd_header = infile.readline()
-  nsd_line_1 = infile.readline()
-
-# Get the max "tick" number
-cnt = int(nsd_line_1)
-
-# Collect all file names matching meas-sat-NNNNNNNNNN-[dev]-state.csv
-logs = [f for f in os.listdir(log) \
- if re.match(r'meas-sat-[0-9]{10}-'+re.escape(dev)+r'-state.csv',f) \
-]
-logs.sort()
-
 # Collect fine-grained statistics
+# Each row of state-intervals.csv holds the start step, the end step (not
+# included), the satellite, the device and the state of one interval
 dev_states = []
 sat_ids    = []
+sat_id_to_total_tick_cnt = {}
 dev_state_to_dict_of_sat_total_tick_cnts = {}
-for logfile in logs:
-  with open(log+logfile,mode='r',newline='') as csv_i:
-    # Get satellite ID string from file name
-    sat_id = logfile[9:19]
-    # Add satellite ID string to list of sat IDs
-    if sat_id not in sat_ids:
-      sat_ids.append(sat_id)
-    # Initialize CSV reader
-    csvreader = csv.reader(csv_i,delimiter=',')
-    # There should always be a header
-    head_row = next(csvreader)
-    # There should always be at least one line of data
-    prev_row = next(csvreader)
-    # Add the state to the list of states of it's not already there
-    if prev_row[1] not in dev_states:
-      dev_states.append(prev_row[1])
-    # Need to add an empty dictionary of the state isn't there yet
-    if prev_row[1] not in dev_state_to_dict_of_sat_total_tick_cnts:
-      dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]] = {}
-    # Sat ID shouldn't be in the dictionary, but safety check
-    if sat_id not in dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]]:
-      dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]][sat_id] = 0
-    # Initialize curr_row so that it's in the correct scope
-    curr_row = []
-    try:
-      curr_row = next(csvreader)
-    except StopIteration:
-      # The first and only record for this satellite, so use cnt for upper tick
-      dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]][sat_id] += \
-       cnt-int(prev_row[0])
-    else:
-      # The first of multiple records for this satellite, so use curr_row
-      dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]][sat_id] += \
-       int(curr_row[0])-int(prev_row[0])
-    while curr_row != []:
-      prev_row = curr_row
-      # Add the state to the list of states of it's not already there
-      if prev_row[1] not in dev_states:
-        dev_states.append(prev_row[1])
-      # Need to add an empty dictionary of the state isn't there yet
-      if prev_row[1] not in dev_state_to_dict_of_sat_total_tick_cnts:
-        dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]] = {}
-      # Since state prev_row[1] can change, set to zero only of Sat ID not there
-      if sat_id not in dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]]:
-        dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]][sat_id] = 0
-      # Set curr_row to [] before trying next
-      curr_row = []
-      try:
-        curr_row = next(csvreader)
-      except StopIteration:
-        # End for this satellite, so use cnt for upper tick
-        dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]][sat_id] += \
-         cnt-int(prev_row[0])
-      else:
-        # Use curr_row
-        dev_state_to_dict_of_sat_total_tick_cnts[prev_row[1]][sat_id] += \
-         int(curr_row[0])-int(prev_row[0])
+dev_rows = []
+with open(log+'state-intervals.csv',mode='r',newline='') as csv_i:
+  # Initialize CSV reader
+  csvreader = csv.reader(csv_i,delimiter=',')
+  # There should always be a header
+  head_row = next(csvreader)
+  for row in csvreader:
+    if row[3]==dev:
+      dev_rows.append(row)
+# Rows are written in step order; visit each satellite's rows in turn
+dev_rows.sort(key=lambda row: (row[2],int(row[0])))
+for row in dev_rows:
+  # Get satellite ID string from the satellite name sat-NNNNNNNNNN
+  sat_id = row[2][4:14]
+  # Add satellite ID string to list of sat IDs
+  if sat_id not in sat_ids:
+    sat_ids.append(sat_id)
+    sat_id_to_total_tick_cnt[sat_id] = 0
+  tick_cnt = int(row[1])-int(row[0])
+  sat_id_to_total_tick_cnt[sat_id] += tick_cnt
+  # Add the state to the list of states of it's not already there
+  if row[4] not in dev_states:
+    dev_states.append(row[4])
+  # Need to add an empty dictionary of the state isn't there yet
+  if row[4] not in dev_state_to_dict_of_sat_total_tick_cnts:
+    dev_state_to_dict_of_sat_total_tick_cnts[row[4]] = {}
+  # A satellite can enter a state many times
+  if sat_id not in dev_state_to_dict_of_sat_total_tick_cnts[row[4]]:
+    dev_state_to_dict_of_sat_total_tick_cnts[row[4]][sat_id] = 0
+  dev_state_to_dict_of_sat_total_tick_cnts[row[4]][sat_id] += tick_cnt
 
 # Fill in any missing zeros and convert to percentages
 for dev_state in dev_states:
@@ -126,7 +84,7 @@ for dev_state in dev_states:
     else:
       dev_state_to_dict_of_sat_total_tick_cnts[dev_state][sat_id] = 100.0* \
        float(dev_state_to_dict_of_sat_total_tick_cnts[dev_state][sat_id])/ \
-       float(cnt)
+       float(sat_id_to_total_tick_cnt[sat_id])
 
 # For each state, harvest avg, pdv, min, and max
 dev_state_to_dict_of_stats = {}
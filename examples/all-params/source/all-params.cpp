@@ -11,46 +11,63 @@
 // See the top-level LICENSE file for the license.
 
 // Standard library
-#include <algorithm>         // max, sort
-#include <cmath>             // round
-#include <cstdlib>           // exit, EXIT_SUCCESS
-#include <filesystem>        // path
-#include <fstream>           // ifstream
-#include <iomanip>           // setw, setfill
-#include <iostream>          // cout
-#include <map>               // map
-#include <ostream>           // endl
-#include <queue>             // queue
-#include <string>            // string
-#include <sstream>           // ostringstream
-#include <utility>           // make_pair
-#include <vector>            // vector
+#include <algorithm>                  // max, min, sort
+#include <array>                      // array
+#include <cmath>                      // ceil, round
+#include <cstdint>                    // int64_t
+#include <cstdlib>                    // exit, EXIT_SUCCESS
+#include <filesystem>                 // path
+#include <fstream>                    // ifstream, ofstream
+#include <iomanip>                    // setw, setfill
+#include <iostream>                   // cerr, cout
+#include <limits>                     // numeric_limits
+#include <map>                        // map
+#include <ostream>                    // endl, ostream
+#include <queue>                      // queue
+#include <set>                        // set
+#include <string>                     // string
+#include <sstream>                    // ostringstream
+#include <utility>                    // make_pair
+#include <vector>                     // vector
 
 // json
-#include <Array.hpp>         // Array
-#include <Bool.hpp>          // Bool
-#include <Nul.hpp>           // Nul
-#include <Number.hpp>        // Number
-#include <Object.hpp>        // Object
-#include <String.hpp>        // String
-#include <json-util.hpp>     // readFile, writeFile
-#include <Value.hpp>         // Value
+#include <Array.hpp>                  // Array
+#include <Bool.hpp>                   // Bool
+#include <Nul.hpp>                    // Nul
+#include <Number.hpp>                 // Number
+#include <Object.hpp>                 // Object
+#include <String.hpp>                 // String
+#include <json-util.hpp>              // readFile, writeFile
+#include <Value.hpp>                  // Value
 
 // cote
-#include <Capacitor.hpp>     // Capacitor
-#include <Channel.hpp>       // Channel
-#include <constants.hpp>     // constants
-#include <DateTime.hpp>      // DateTime
-#include <GroundStation.hpp> // GroundStation
-#include <Log.hpp>           // Log
-#include <LogLevel.hpp>      // LogLevel
-#include <Receiver.hpp>      // Receiver
-#include <Satellite.hpp>     // Satellite
-#include <Sensor.hpp>        // Sensor
-#include <SolarArray.hpp>    // SolarArray
-#include <StateMachine.hpp>  // StateMachine
-#include <Transmitter.hpp>   // Transmitter
-#include <utilities.hpp>     // calcJulianDayFromYMD, calcSecSinceMidnight
+#include <Capacitor.hpp>              // Capacitor
+#include <Channel.hpp>                // Channel
+#include <constants.hpp>              // constants
+#include <DateTime.hpp>               // DateTime
+#include <EntityStore.hpp>            // EntityStore
+#include <GroundStation.hpp>          // GroundStation
+#include <IPhase.hpp>                 // IPhase
+#include <IQuiescentPhase.hpp>        // IQuiescentPhase
+#include <LoadAggregator.hpp>         // LoadAggregator
+#include <Log.hpp>                    // Log
+#include <LogBuffer.hpp>              // LogBuffer
+#include <LogLevel.hpp>               // LogLevel
+#include <Metrics.hpp>                // Metrics
+#include <PowerBus.hpp>               // PowerBus
+#include <PropagatePhase.hpp>         // PropagatePhase
+#include <Receiver.hpp>               // Receiver
+#include <Satellite.hpp>              // Satellite
+#include <Sensor.hpp>                 // Sensor
+#include <Simulation.hpp>             // Simulation
+#include <SolarArray.hpp>             // SolarArray
+#include <StateMachine.hpp>           // StateMachine
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+#include <Transmitter.hpp>            // Transmitter
+#include <utilities.hpp>              // calcJulianDayFromYMD,
+                                      // calcSecSinceMidnight, calcStepsBelow,
+                                      // calcStepsOutsidePenumbra,
+                                      // calcStepsToElevation
 
 /*
 // Neural network struct
@@ -82,842 +99,355 @@ namespace cote {
   } NeuralNetwork;
 }
 
-int main(int argc, char** argv) {
-  // Set up configuration variables
-  std::filesystem::path dateTimeFile;                    // start date and time
-  std::filesystem::path timeStepFile;                    // time between steps
-  std::filesystem::path numStepsFile;                    // time step count
-  std::vector<std::filesystem::path> satelliteFiles;     // satellite TLEs
-  std::vector<std::filesystem::path> solarArrayFiles;    // solar array configs
-  std::vector<std::filesystem::path> capacitorFiles;     // capacitor configs
-  std::vector<std::filesystem::path> adacsSMFiles;       // ADACS power states
-  std::vector<std::filesystem::path> cameraSMFiles;      // camera power states
-  std::vector<std::filesystem::path> computerSMFiles;    // computer power state
-  std::vector<std::filesystem::path> rxSatSMFiles;       // sat RX power states
-  std::vector<std::filesystem::path> txSatSMFiles;       // sat TX power states
-  std::vector<std::filesystem::path> rxSatFiles;         // sat RX configs
-  std::vector<std::filesystem::path> txSatFiles;         // sat TX configs
-  std::vector<std::filesystem::path> sensorSatFiles;     // bits per sense etc
-  std::vector<std::filesystem::path> programSatFiles;    // user applications
-  std::vector<std::filesystem::path> constellationFiles; // constelation configs
-  std::vector<std::filesystem::path> groundStationFiles; // gnd locations
-  std::vector<std::filesystem::path> rxGndFiles;         // gnd RX configs
-  std::vector<std::filesystem::path> txGndFiles;         // gnd TX configs
-  std::filesystem::path logDirectory;                    // logs destination
-  // Parse command line arguments
-  if(argc!=3) {
-    std::cout << "Usage: " << argv[0]
-              << " /path/to/configuration/"
-              << " /path/to/logs/"
-              << std::endl;
-    std::exit(EXIT_SUCCESS);
-  } else {
-    // Populate configuration variables
-    std::filesystem::path configurationDir(argv[1]);
-    std::filesystem::directory_iterator it(configurationDir);
-    while(it!=std::filesystem::end(it)) {
-      std::string pathStr = it->path().string();
-      if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-13),13)==
-       "date-time.dat"
-      ) {
-        dateTimeFile = it->path();
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-13),13)==
-       "time-step.dat"
-      ) {
-        timeStepFile = it->path();
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-13),13)==
-       "num-steps.dat"
-      ) {
-        numStepsFile = it->path();
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-4),4)==
-       ".sat"
-      ) {
-        satelliteFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-30),16)==
-       "solar-array-sat-"
-      ) {
-        solarArrayFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-28),14)==
-       "capacitor-sat-"
-      ) {
-        capacitorFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-27),13)==
-       "adacs-sm-sat-"
-      ) {
-        adacsSMFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-28),14)==
-       "camera-sm-sat-"
-      ) {
-        cameraSMFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-30),16)==
-       "computer-sm-sat-"
-      ) {
-        computerSMFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-24),10)==
-       "rx-sm-sat-"
-      ) {
-        rxSatSMFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-24),10)==
-       "tx-sm-sat-"
-      ) {
-        txSatSMFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-21),7)==
-       "rx-sat-"
-      ) {
-        rxSatFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-21),7)==
-       "tx-sat-"
-      ) {
-        txSatFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-25),11)==
-       "sensor-sat-"
-      ) {
-        sensorSatFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-26),12)==
-       "program-sat-"
-      ) {
-        programSatFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-29),14)==
-       "constellation-"
-      ) {
-        constellationFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-4),4)==
-       ".gnd"
-      ) {
-        groundStationFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-21),7)==
-       "rx-gnd-"
-      ) {
-        rxGndFiles.push_back(it->path());
-      } else if(
-       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-21),7)==
-       "tx-gnd-"
-      ) {
-        txGndFiles.push_back(it->path());
-      }
-      it++;
-    }
-    // Set log directory
-    logDirectory = std::filesystem::path(argv[2]);
-  }
-  // Set up log
-  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
-  cote::Log log(levels,logDirectory.string());
-  // Data for logging logic
-  std::map<uint32_t,std::pair<double,double>> satId2PrevNodeVoltages;
-  std::map<uint32_t,std::string> satId2PrevAdacsState;
-  std::map<uint32_t,std::string> satId2PrevCameraState;
-  std::map<uint32_t,std::string> satId2PrevComputerState;
-  std::map<uint32_t,std::string> satId2PrevRxState;
-  std::map<uint32_t,std::string> satId2PrevTxState;
-  std::map<uint32_t,std::pair<double,double>> satId2PrevDownlinkMbps;
-  std::map<uint32_t,std::pair<double,double>> satId2PrevUplinkMbps;
-  // Set up date and time
-  std::ifstream dateTimeHandle(dateTimeFile.string());
-  std::string line = "";
-  std::getline(dateTimeHandle,line); // Read header
-  std::getline(dateTimeHandle,line); // Read values
-  dateTimeHandle.close();
-  const int16_t year = static_cast<int16_t>(std::stoi(line.substr(0,4)));
-  const uint8_t month = static_cast<uint8_t>(std::stoi(line.substr(5,2)));
-  const uint8_t day = static_cast<uint8_t>(std::stoi(line.substr(8,2)));
-  const uint8_t hour = static_cast<uint8_t>(std::stoi(line.substr(11,2)));
-  const uint8_t minute = static_cast<uint8_t>(std::stoi(line.substr(14,2)));
-  const uint8_t second = static_cast<uint8_t>(std::stoi(line.substr(17,2)));
-  const uint32_t ns = static_cast<uint32_t>(std::stoul(line.substr(20,9)));
-  cote::DateTime dateTime(year,month,day,hour,minute,second,ns);
-  // Set up time step variables
-  std::ifstream timeStepHandle(timeStepFile.string());
-  line = "";
-  std::getline(timeStepHandle,line); // Read header
-  std::getline(timeStepHandle,line); // Read values
-  timeStepHandle.close();
-  const uint8_t hourStep = static_cast<uint8_t>(std::stoi(line.substr(0,2)));
-  const uint8_t minuteStep = static_cast<uint8_t>(std::stoi(line.substr(3,2)));
-  const uint8_t secondStep = static_cast<uint8_t>(std::stoi(line.substr(6,2)));
-  const uint32_t nsStep = static_cast<uint32_t>(std::stoul(line.substr(9,9)));
-  const double totalStepInSec =
-   (
-    static_cast<double>(hourStep)*static_cast<double>(cote::cnst::MIN_PER_HOUR)+
-    static_cast<double>(minuteStep)
-   )*static_cast<double>(cote::cnst::SEC_PER_MIN)+
-   static_cast<double>(secondStep)+
-   static_cast<double>(nsStep)/static_cast<double>(cote::cnst::NS_PER_SEC);
-  // Set up step count
-  std::ifstream numStepsHandle(numStepsFile.string());
-  line = "";
-  std::getline(numStepsHandle,line); // Read header
-  std::getline(numStepsHandle,line); // Read values
-  numStepsHandle.close();
-  const uint64_t numSteps =
-   static_cast<uint64_t>(std::stoull(line.substr(0,19)));
-  // Set up satellites
-  std::vector<cote::Satellite> satellites;
-  for(std::size_t i=0; i<satelliteFiles.size(); i++) {
-    std::string satelliteFileStr = satelliteFiles.at(i).string();
-    std::ifstream satelliteHandle(satelliteFileStr);
-    line = "";
-    std::getline(satelliteHandle,line); // Read header
-    std::getline(satelliteHandle,line); // Read values
-    satelliteHandle.close();
-    const int16_t satYear = static_cast<int16_t>(std::stoi(line.substr(0,4)));
-    const uint8_t satMonth = static_cast<uint8_t>(std::stoi(line.substr(5,2)));
-    const uint8_t satDay = static_cast<uint8_t>(std::stoi(line.substr(8,2)));
-    const uint8_t satHr = static_cast<uint8_t>(std::stoi(line.substr(11,2)));
-    const uint8_t satMin = static_cast<uint8_t>(std::stoi(line.substr(14,2)));
-    const uint8_t satSec = static_cast<uint8_t>(std::stoi(line.substr(17,2)));
-    const uint32_t satNs = static_cast<uint32_t>(std::stoul(line.substr(20,9)));
-    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(30,10)));
-    const cote::DateTime satTime(
-     satYear,satMonth,satDay,satHr,satMin,satSec,satNs
-    );
-    satellites.push_back(cote::Satellite(satelliteFileStr,&dateTime,&log));
-    satellites.back().setID(id);
-    satellites.back().setLocalTime(satTime);
-  }
-  std::sort(
-   satellites.begin(), satellites.end(),
-   [](const cote::Satellite& s1, const cote::Satellite& s2) {
-    return s1.getID() < s2.getID();
-   }
-  );
-  std::map<uint32_t,cote::Satellite*> satId2Sat;
-  for(std::size_t i=0; i<satellites.size(); i++) {
-    const uint32_t SAT_ID = satellites.at(i).getID();
-    satId2Sat[SAT_ID] = &(satellites.at(i));
-    satId2PrevDownlinkMbps[SAT_ID] = std::make_pair(0.0,0.0);
-    satId2PrevUplinkMbps[SAT_ID] = std::make_pair(0.0,0.0);
-  }
-  // Set up solar arrays
-  std::map<uint32_t,cote::SolarArray*> satId2SolarArray;
-  std::map<uint32_t,double> satId2SunOcclusionFactor;
-  for(std::size_t i=0; i<solarArrayFiles.size(); i++) {
-    std::ifstream solarArrayHandle(solarArrayFiles.at(i).string());
-    line = "";
-    std::getline(solarArrayHandle,line); // Read header
-    std::getline(solarArrayHandle,line); // Read values
-    solarArrayHandle.close();
-    const double openCircuitVoltage = std::stod(line.substr(0,10));
-    const double surfaceAreaM2 = std::stod(line.substr(11,16));
-    const double efficiency = std::stod(line.substr(28,8));
-    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(37,10)));
-    satId2SolarArray[id] = new cote::SolarArray(
-     openCircuitVoltage,surfaceAreaM2,efficiency,id,&log
-    );
-    // Set initial solar array current
-    const double JD = cote::util::calcJulianDayFromYMD(
-     dateTime.getYear(),dateTime.getMonth(),dateTime.getDay()
-    );
-    const uint32_t SEC = cote::util::calcSecSinceMidnight(
-     dateTime.getHour(), dateTime.getMinute(), dateTime.getSecond()
-    );
-    const uint32_t NS = dateTime.getNanosecond();
-    const std::array<double,3> SUN_ECI_POSN_KM =
-     cote::util::calcSunEciPosnKm(JD,SEC,NS);
-    const std::array<double,3> SAT_ECI_POSN_KM = satId2Sat[id]->getECIPosn();
-    const double sunOcclusionFactor =
-     cote::util::calcSunOcclusionFactor(SAT_ECI_POSN_KM,SUN_ECI_POSN_KM);
-    satId2SunOcclusionFactor[id] = sunOcclusionFactor;
-    //// When sunOcclusionFactor is 0.0, irradiance is SOLAR_CONSTANT
-    //// When sunOcclusionFactor is 1.0, irradiance is 1% of SOLAR_CONSTANT
-    //// -1352.44 is the slope needed to achieve the above effect
-    const double irradianceWPerM2 =
-     -1352.44*sunOcclusionFactor+cote::cnst::SOLAR_CONSTANT;
-    // setIrradianceWpM2 calculates and sets the appropriate output current
-    satId2SolarArray[id]->setIrradianceWpM2(irradianceWPerM2);
-  }
-  // Set up capacitors
-  std::map<uint32_t,cote::Capacitor*> satId2Capacitor;
-  for(std::size_t i=0; i<capacitorFiles.size(); i++) {
-    std::ifstream capacitorHandle(capacitorFiles.at(i).string());
-    line = "";
-    std::getline(capacitorHandle,line); // Read header
-    std::getline(capacitorHandle,line); // Read values
-    capacitorHandle.close();
-    const double capacitanceFarad = std::stod(line.substr(0,19));
-    const double esrOhm = std::stod(line.substr(20,10));
-    const double chargeCoulomb = std::stod(line.substr(31,32));
-    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(64,10)));
-    satId2Capacitor[id] = new cote::Capacitor(capacitanceFarad,esrOhm,id,&log);
-    satId2Capacitor[id]->setChargeCoulomb(chargeCoulomb);
-  }
-  // Set up ADACS state machines
-  std::map<uint32_t,cote::StateMachine*> satId2AdacsSm;
-  for(std::size_t i=0; i<adacsSMFiles.size(); i++) {
-    std::string adacsSMFileStr = adacsSMFiles.at(i).string();
-    const uint32_t id = static_cast<uint32_t>(
-     std::stoi(adacsSMFileStr.substr(adacsSMFileStr.size()-14,10))
-    );
-    satId2AdacsSm[id] = new cote::StateMachine(adacsSMFileStr,id,&log);
-  }
-  // Set up camera state machines
-  std::map<uint32_t,cote::StateMachine*> satId2CameraSm;
-  for(std::size_t i=0; i<cameraSMFiles.size(); i++) {
-    std::string cameraSMFileStr = cameraSMFiles.at(i).string();
-    const uint32_t id = static_cast<uint32_t>(
-     std::stoi(cameraSMFileStr.substr(cameraSMFileStr.size()-14,10))
-    );
-    satId2CameraSm[id] = new cote::StateMachine(cameraSMFileStr,id,&log);
-  }
-  // Set up computer state machines
-  std::map<uint32_t,cote::StateMachine*> satId2ComputerSm;
-  for(std::size_t i=0; i<computerSMFiles.size(); i++) {
-    std::string computerSMFileStr = computerSMFiles.at(i).string();
-    const uint32_t id = static_cast<uint32_t>(
-     std::stoi(computerSMFileStr.substr(computerSMFileStr.size()-14,10))
-    );
-    satId2ComputerSm[id] = new cote::StateMachine(computerSMFileStr,id,&log);
-  }
-  // Set up satellite RX state machines
-  std::map<uint32_t,cote::StateMachine*> satId2RxSm;
-  for(std::size_t i=0; i<rxSatSMFiles.size(); i++) {
-    std::string rxSatSMFileStr = rxSatSMFiles.at(i).string();
-    const uint32_t id = static_cast<uint32_t>(
-     std::stoi(rxSatSMFileStr.substr(rxSatSMFileStr.size()-14,10))
-    );
-    satId2RxSm[id] = new cote::StateMachine(rxSatSMFileStr,id,&log);
-  }
-  // Set up satellite TX state machines
-  std::map<uint32_t,cote::StateMachine*> satId2TxSm;
-  for(std::size_t i=0; i<txSatSMFiles.size(); i++) {
-    std::string txSatSMFileStr = txSatSMFiles.at(i).string();
-    const uint32_t id = static_cast<uint32_t>(
-     std::stoi(txSatSMFileStr.substr(txSatSMFileStr.size()-14,10))
-    );
-    satId2TxSm[id] = new cote::StateMachine(txSatSMFileStr,id,&log);
-  }
-  // Initialize the energy system for each satellite
-  // Note that the node voltage is being calculated for the first time, so a
-  // current cap cannot be applied to solarArray[SAT_ID]->getCurrentAmpere()
-  // This is OK so long as the initial conditions are sane and the time step is
-  // not too huge because it will be cut off during the next time step if the
-  // node voltage becomes too large
-  std::map<uint32_t,double> satId2NodeVoltage;
-  for(std::size_t i=0; i<satellites.size(); i++) {
-    const uint32_t SAT_ID = satellites.at(i).getID();
-    double powerW =
-     satId2AdacsSm[SAT_ID]->getVariableValue("power-w")+
-     satId2CameraSm[SAT_ID]->getVariableValue("power-w")+
-     satId2ComputerSm[SAT_ID]->getVariableValue("power-w")+
-     satId2RxSm[SAT_ID]->getVariableValue("power-w")+
-     satId2TxSm[SAT_ID]->getVariableValue("power-w");
-    double nodeVoltageDiscriminant = cote::util::calcNodeVoltageDiscriminant(
-     satId2Capacitor[SAT_ID]->getChargeCoulomb(),
-     satId2Capacitor[SAT_ID]->getCapacitanceFarad(),
-     satId2SolarArray[SAT_ID]->getCurrentAmpere(),
-     satId2Capacitor[SAT_ID]->getEsrOhm(), powerW
-    );
-    if(nodeVoltageDiscriminant<0.0) { // if power draw too high, set all to off
-      satId2AdacsSm[SAT_ID]->setCurrentState("OFF");
-      satId2CameraSm[SAT_ID]->setCurrentState("OFF");
-      satId2ComputerSm[SAT_ID]->setCurrentState("OFF");
-      satId2RxSm[SAT_ID]->setCurrentState("OFF");
-      satId2TxSm[SAT_ID]->setCurrentState("OFF");
-      powerW =
-       satId2AdacsSm[SAT_ID]->getVariableValue("power-w")+
-       satId2CameraSm[SAT_ID]->getVariableValue("power-w")+
-       satId2ComputerSm[SAT_ID]->getVariableValue("power-w")+
-       satId2RxSm[SAT_ID]->getVariableValue("power-w")+
-       satId2TxSm[SAT_ID]->getVariableValue("power-w");
-      nodeVoltageDiscriminant = cote::util::calcNodeVoltageDiscriminant(
-       satId2Capacitor[SAT_ID]->getChargeCoulomb(),
-       satId2Capacitor[SAT_ID]->getCapacitanceFarad(),
-       satId2SolarArray[SAT_ID]->getCurrentAmpere(),
-       satId2Capacitor[SAT_ID]->getEsrOhm(), powerW
-      );
-    }
-    const double nodeVoltage = cote::util::calcNodeVoltage(
-     nodeVoltageDiscriminant, satId2Capacitor[SAT_ID]->getChargeCoulomb(),
-     satId2Capacitor[SAT_ID]->getCapacitanceFarad(),
-     satId2SolarArray[SAT_ID]->getCurrentAmpere(),
-     satId2Capacitor[SAT_ID]->getEsrOhm()
-    );
-    // Set node voltage for all state machines
-    satId2AdacsSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-    satId2CameraSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-    satId2ComputerSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-    satId2RxSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-    satId2TxSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-    satId2NodeVoltage[SAT_ID] = nodeVoltage;
-    satId2PrevNodeVoltages[SAT_ID] = std::make_pair(0.0,nodeVoltage);
-    // Set the shade value for all state machines
-    if(satId2SunOcclusionFactor[SAT_ID]!=0.0) {
-      satId2AdacsSm[SAT_ID]->setVariableValue("shade",1.0);
-      satId2CameraSm[SAT_ID]->setVariableValue("shade",1.0);
-      satId2ComputerSm[SAT_ID]->setVariableValue("shade",1.0);
-      satId2RxSm[SAT_ID]->setVariableValue("shade",1.0);
-      satId2TxSm[SAT_ID]->setVariableValue("shade",1.0);
-    } else {
-      satId2AdacsSm[SAT_ID]->setVariableValue("shade",0.0);
-      satId2CameraSm[SAT_ID]->setVariableValue("shade",0.0);
-      satId2ComputerSm[SAT_ID]->setVariableValue("shade",0.0);
-      satId2RxSm[SAT_ID]->setVariableValue("shade",0.0);
-      satId2TxSm[SAT_ID]->setVariableValue("shade",0.0);
-    }
-    // Update state for each state machine
-    // After calculating the initial values for all state machine variables,
-    // updateState must be called so that they are in the correct state for the
-    // first time step
-    satId2PrevAdacsState[SAT_ID] =
-     satId2AdacsSm[SAT_ID]->getCurrentState();
-    satId2PrevCameraState[SAT_ID] =
-     satId2CameraSm[SAT_ID]->getCurrentState();
-    satId2PrevComputerState[SAT_ID] =
-     satId2ComputerSm[SAT_ID]->getCurrentState();
-    satId2PrevRxState[SAT_ID] =
-     satId2RxSm[SAT_ID]->getCurrentState();
-    satId2PrevTxState[SAT_ID] =
-     satId2TxSm[SAT_ID]->getCurrentState();
-    satId2AdacsSm[SAT_ID]->updateState();
-    satId2CameraSm[SAT_ID]->updateState();
-    satId2RxSm[SAT_ID]->updateState();
-    satId2TxSm[SAT_ID]->updateState();
-    if(satId2RxSm[SAT_ID]->getCurrentState()=="RX") {
-      satId2ComputerSm[SAT_ID]->setVariableValue("comms",1.0);
-    } else {
-      satId2ComputerSm[SAT_ID]->setVariableValue("comms",0.0);
-    }
-    satId2ComputerSm[SAT_ID]->updateState();
-    if(
-     satId2AdacsSm[SAT_ID]->getCurrentState()!=satId2PrevAdacsState[SAT_ID]
-    ) {
-      std::ostringstream oss;
-      oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-      log.meas(
-       cote::LogLevel::INFO,
-       //dateTime.toString(),
-       std::to_string(0),
-       std::string(oss.str()+"-adacs-state"),
-       std::string(satId2AdacsSm[SAT_ID]->getCurrentState())
-      );
-    }
-    if(
-     satId2CameraSm[SAT_ID]->getCurrentState()!=satId2PrevCameraState[SAT_ID]
-    ) {
-      std::ostringstream oss;
-      oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-      log.meas(
-       cote::LogLevel::INFO,
-       //dateTime.toString(),
-       std::to_string(0),
-       std::string(oss.str()+"-camera-state"),
-       std::string(satId2CameraSm[SAT_ID]->getCurrentState())
-      );
-    }
-    if(
-     satId2ComputerSm[SAT_ID]->getCurrentState()!=
-     satId2PrevComputerState[SAT_ID]
-    ) {
-      std::ostringstream oss;
-      oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-      log.meas(
-       cote::LogLevel::INFO,
-       //dateTime.toString(),
-       std::to_string(0),
-       std::string(oss.str()+"-computer-state"),
-       std::string(satId2ComputerSm[SAT_ID]->getCurrentState())
-      );
-    }
-    if(
-     satId2RxSm[SAT_ID]->getCurrentState()!=satId2PrevRxState[SAT_ID]
-    ) {
-      std::ostringstream oss;
-      oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-      log.meas(
-       cote::LogLevel::INFO,
-       //dateTime.toString(),
-       std::to_string(0),
-       std::string(oss.str()+"-rx-state"),
-       std::string(satId2RxSm[SAT_ID]->getCurrentState())
-      );
-    }
-    if(
-     satId2TxSm[SAT_ID]->getCurrentState()!=satId2PrevTxState[SAT_ID]
-    ) {
-      std::ostringstream oss;
-      oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-      log.meas(
-       cote::LogLevel::INFO,
-       //dateTime.toString(),
-       std::to_string(0),
-       std::string(oss.str()+"-tx-state"),
-       std::string(satId2TxSm[SAT_ID]->getCurrentState())
-      );
-    }
-  }
-  // Set up satellite RX
-  std::map<uint32_t,cote::Receiver*> satId2Rx;
-  std::map<uint32_t,const double> satId2RxCenterFrequencyHz;
-  std::map<uint32_t,const double> satId2RxBandwidthHz;
-  for(std::size_t i=0; i<rxSatFiles.size(); i++) {
-    std::ifstream rxSatHandle(rxSatFiles.at(i).string());
-    line = "";
-    std::getline(rxSatHandle,line); // Read header
-    std::getline(rxSatHandle,line); // Read values
-    rxSatHandle.close();
-    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
-    const std::array<double,3> posn = satId2Sat[id]->getECIPosn();
-    const double gainDB = std::stod(line.substr(11,13));
-    const double rxCenterFrequencyHz = std::stod(line.substr(25,22));
-    const double rxBandwidthHz = std::stod(line.substr(48,23));
-    satId2Rx[id] = new cote::Receiver(posn,gainDB,&dateTime,id,&log);
-    satId2RxCenterFrequencyHz.insert(std::make_pair(id,rxCenterFrequencyHz));
-    satId2RxBandwidthHz.insert(std::make_pair(id,rxBandwidthHz));
-  }
-  // Set up satellite TX
-  std::map<uint32_t,cote::Transmitter*> satId2Tx;
-  std::map<uint32_t,const double> satId2TxCenterFrequencyHz;
-  std::map<uint32_t,const double> satId2TxBandwidthHz;
-  for(std::size_t i=0; i<txSatFiles.size(); i++) {
-    std::ifstream txSatHandle(txSatFiles.at(i).string());
-    line = "";
-    std::getline(txSatHandle,line); // Read header
-    std::getline(txSatHandle,line); // Read values
-    txSatHandle.close();
-    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
-    const std::array<double,3> posn = satId2Sat[id]->getECIPosn();
-    const double powerW = std::stod(line.substr(11,16));
-    const double lineLossDB = std::stod(line.substr(28,13));
-    const double gainDB = std::stod(line.substr(42,13));
-    const double txCenterFrequencyHz = std::stod(line.substr(56,22));
-    const double txBandwidthHz = std::stod(line.substr(79,23));
-    satId2Tx[id] = new cote::Transmitter(
-     posn,powerW,lineLossDB,gainDB,&dateTime,id,&log
-    );
-    satId2TxCenterFrequencyHz.insert(std::make_pair(id,txCenterFrequencyHz));
-    satId2TxBandwidthHz.insert(std::make_pair(id,txBandwidthHz));
-  }
-  // Set up sensors
-  std::map<uint32_t,cote::Sensor*>  satId2Sensor;
-  std::map<uint32_t,const double>   satId2ThreshCoeff;
-  std::map<uint32_t,const uint32_t> satId2PixelCountW;
-  std::map<uint32_t,const double>   satId2PixelSizeM;
-  std::map<uint32_t,const double>   satId2FocalLengthM;
-  std::map<uint32_t,const uint32_t> satId2PixelCountH;
-  for(std::size_t i=0; i<sensorSatFiles.size(); i++) {
-    std::ifstream sensorHandle(sensorSatFiles.at(i).string());
-    line = "";
-    std::getline(sensorHandle,line); // Read header
-    std::getline(sensorHandle,line); // Read values
-    sensorHandle.close();
-    const uint64_t bitsPerSense =
-     static_cast<uint64_t>(std::stoull(line.substr(0,10)));
-    const uint32_t pixelCountW =
-     static_cast<uint32_t>(std::stoul(line.substr(11,5)));
-    const double pixelSizeM =
-     static_cast<double>(std::stod(line.substr(17,11)));
-    const double focalLengthM =
-     static_cast<double>(std::stod(line.substr(29,10)));
-    const uint32_t pixelCountH =
-     static_cast<uint32_t>(std::stoul(line.substr(40,5)));
-    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(46,10)));
-    const std::array<double,3> posn = satId2Sat[id]->getECIPosn();
-    satId2ThreshCoeff.insert(std::make_pair(
-     id, // geographic frame width (km) = threshCoeff*altitude(km)
-     static_cast<double>(std::max(pixelCountW,pixelCountH))*pixelSizeM/
-     focalLengthM
-    ));
-    satId2PixelCountW.insert(std::make_pair(id,pixelCountW));
-    satId2PixelSizeM.insert(std::make_pair(id,pixelSizeM));
-    satId2FocalLengthM.insert(std::make_pair(id,focalLengthM));
-    satId2PixelCountH.insert(std::make_pair(id,pixelCountH));
-    satId2Sensor[id] = new cote::Sensor(posn,&dateTime,id,&log);
-    satId2Sensor[id]->setBitsPerSense(bitsPerSense);
-  }
-  // Set up programs
-  std::map<uint32_t,cote::NeuralNetwork> satId2Program;
-  for(std::size_t i=0; i<programSatFiles.size(); i++) {
-    std::ifstream programHandle(programSatFiles.at(i).string());
-    line = "";
-    std::getline(programHandle,line); // Read header
-    std::getline(programHandle,line); // Read values
-    programHandle.close();
-    const uint32_t inputWidthPx =
-     static_cast<uint32_t>(std::stoul(line.substr(0,5)));
-    const uint32_t idealFeatureWidthPx =
-     static_cast<uint32_t>(std::stoul(line.substr(6,5)));
-    const double   actualFeatureWidthM =
-     static_cast<double>(std::stod(line.substr(12,11)));
-    const uint32_t inputHeightPx =
-     static_cast<uint32_t>(std::stoul(line.substr(24,5)));
-    const uint32_t idealFeatureHeightPx =
-     static_cast<uint32_t>(std::stoul(line.substr(30,5)));
-    const double   actualFeatureHeightM =
-     static_cast<double>(std::stod(line.substr(36,11)));
-    const uint32_t modelBits =
-     static_cast<uint32_t>(std::stoul(line.substr(48,10)));
-    const uint32_t id =
-     static_cast<uint32_t>(std::stoul(line.substr(59,10)));
-    cote::NeuralNetwork neuralNetwork = {
-     .inputWidthPx = inputWidthPx,
-     .idealFeatureWidthPx = idealFeatureWidthPx,
-     .actualFeatureWidthM = actualFeatureWidthM,
-     .inputHeightPx = inputHeightPx,
-     .idealFeatureHeightPx = idealFeatureHeightPx,
-     .actualFeatureHeightM = actualFeatureHeightM,
-     .modelBits = modelBits,
-     .id = id
-    };
-    satId2Program[id] = neuralNetwork;
+// Log measurement handles of one satellite, registered once so that the
+// simulation phases do not rebuild the "sat-XXXXXXXXXX-" names every step
+struct SatelliteLogs {
+  SatelliteLogs(cote::Log* const log, const uint32_t& satId) {
+    std::ostringstream oss;
+    oss << "sat-" << std::setw(10) << std::setfill('0') << satId << "-";
+    const std::string prefix = oss.str();
+    this->prefix = prefix;
+    this->altKm = log->registerMeas(prefix+"alt-km");
+    this->xKm = log->registerMeas(prefix+"x-km");
+    this->yKm = log->registerMeas(prefix+"y-km");
+    this->zKm = log->registerMeas(prefix+"z-km");
+    this->tileCount = log->registerMeas(prefix+"tile-count");
+    this->downlinkMbps = log->registerMeas(prefix+"downlink-Mbps");
+    this->downlinkDst = log->registerMeas(prefix+"downlink-dst");
+    this->uplinkMbps = log->registerMeas(prefix+"uplink-Mbps");
+    this->uplinkSrc = log->registerMeas(prefix+"uplink-src");
+    this->nodeVoltage = log->registerMeas(prefix+"node-voltage");
+    this->adacsState = log->registerMeas(prefix+"adacs-state");
+    this->cameraState = log->registerMeas(prefix+"camera-state");
+    this->computerState = log->registerMeas(prefix+"computer-state");
+    this->rxState = log->registerMeas(prefix+"rx-state");
+    this->txState = log->registerMeas(prefix+"tx-state");
   }
-  // Set up constellation configuration variables
-  std::map<uint32_t,std::string> constellId2DataCollection;
-  std::map<uint32_t,std::string> constellId2DataProcessing;
-  std::map< uint32_t, std::vector<cote::Satellite*> > constellId2Sats;
-  for(std::size_t i=0; i<constellationFiles.size(); i++) {
-    // Parse constellation configuration file
-    std::string constellationFileStr =
-     json::util::readFile(constellationFiles.at(i).string());
-    json::Object* constellationConfig = new json::Object(constellationFileStr);
-    std::map<std::string,json::Value*> constellConfigMap =
-     constellationConfig->getValue();
-    // Get constellation ID
-    uint32_t constellId = static_cast<uint32_t>(std::stoul(
-     dynamic_cast<json::String*>(constellConfigMap["id"])->getValue()
-    ));
-    // Record constellation data collection method
-    std::string dataCollection = dynamic_cast<json::String*>(
-     constellConfigMap["data-collection"]
-    )->getValue();
-    constellId2DataCollection[constellId] = dataCollection;
-    // Record constellation data processing method
-    std::string dataProcessing = dynamic_cast<json::String*>(
-     constellConfigMap["data-processing"]
-    )->getValue();
-    constellId2DataProcessing[constellId] = dataProcessing;
-    // Record constellation satellite members
-    constellId2Sats[constellId] = std::vector<cote::Satellite*>();
-    std::vector<json::Value*> constellSatMembers =
-     dynamic_cast<json::Array*>(constellConfigMap["satellite-ids"])->getValue();
-    std::vector<uint32_t> constellSatIds;
-    for(std::size_t j=0; j<constellSatMembers.size(); j++) {
-      uint32_t satId = static_cast<uint32_t>(std::stoul(
-       dynamic_cast<json::String*>(constellSatMembers.at(j))->getValue()
-      ));
-      constellId2Sats[constellId].push_back(satId2Sat[satId]);
-    }
-    // Clean up
-    delete constellationConfig;
-    constellationConfig = nullptr;
+  std::string prefix;
+  cote::Log::MeasHandle altKm;
+  cote::Log::MeasHandle xKm;
+  cote::Log::MeasHandle yKm;
+  cote::Log::MeasHandle zKm;
+  cote::Log::MeasHandle tileCount;
+  cote::Log::MeasHandle downlinkMbps;
+  cote::Log::MeasHandle downlinkDst;
+  cote::Log::MeasHandle uplinkMbps;
+  cote::Log::MeasHandle uplinkSrc;
+  cote::Log::MeasHandle nodeVoltage;
+  cote::Log::MeasHandle adacsState;
+  cote::Log::MeasHandle cameraState;
+  cote::Log::MeasHandle computerState;
+  cote::Log::MeasHandle rxState;
+  cote::Log::MeasHandle txState;
+};
+
+// Appends each state interval recorded by the state machine to rows as a
+// "start,end,satellite,device,state," record, then clears the recorded
+// intervals; with no rows, or if the log excludes the device's -state name,
+// the intervals are cleared without formatting them
+void recordStateIntervals(
+ cote::StateMachine& stateMachine, const std::string& prefix,
+ const std::string& device, const cote::Log::MeasHandle& meas,
+ const cote::Log* const log, std::string* const rows
+) {
+  const std::vector<cote::StateMachine::StateInterval>& intervals =
+   stateMachine.getStateIntervals();
+  const bool kept = (rows!=NULL) && !log->isExcluded(meas);
+  for(std::size_t i=0; kept && i<intervals.size(); i++) {
+    rows->append(std::to_string(intervals.at(i).start));
+    rows->append(",");
+    rows->append(std::to_string(intervals.at(i).end));
+    rows->append(",");
+    //// The prefix is "sat-XXXXXXXXXX-"; its trailing dash is dropped
+    rows->append(prefix,0,prefix.size()-1);
+    rows->append(",");
+    rows->append(device);
+    rows->append(",");
+    rows->append(stateMachine.getStateName(intervals.at(i).state));
+    rows->append(",\n");
   }
-  // Set up ground stations
+  stateMachine.clearStateIntervals();
+}
+
+// Quiescence bounds for the adaptive run; bounds on rates of change are
+// inflated by a safety factor of two, as in calcStepsOutsidePenumbra and
+// calcStepsToElevation
+const double QUIESCENCE_SAFETY_FACTOR = 2.0;
+
+// Returns the solar array irradiance of a satellite given its sun occlusion
+double calcIrradianceWPerM2(const double& sunOcclusionFactor) {
+  //// When sunOcclusionFactor is 0.0, irradiance is SOLAR_CONSTANT
+  //// When sunOcclusionFactor is 1.0, irradiance is 1% of SOLAR_CONSTANT
+  //// -1352.44 is the slope needed to achieve the above effect
+  return -1352.44*sunOcclusionFactor+cote::cnst::SOLAR_CONSTANT;
+}
+
+// Components and per-step data shared by the simulation phases; element i of
+// each satellite vector belongs to satellites.at(i) and element i of each
+// ground station vector belongs to groundStations.at(i)
+struct Scenario {
+  Scenario(cote::Log* const log) :
+   satStore(0,log), powerBus(0,log), closedFormPower(false),
+   propagatePhase(0,log) {}
+  // Satellites
+  std::vector<cote::Satellite> satellites;
+  cote::EntityStore satStore;
+  std::vector<double> sunOcclusionFactors;
+  cote::PowerBus powerBus;
+  bool closedFormPower; // true to advance the power bus in closed form
+  std::vector<cote::StateMachine> adacsSms;
+  std::vector<cote::StateMachine> cameraSms;
+  std::vector<cote::StateMachine> computerSms;
+  std::vector<cote::StateMachine> rxSms;
+  std::vector<cote::StateMachine> txSms;
+  std::vector<cote::LoadAggregator> loadAggregators;
+  std::vector<cote::StateMachine::StateId> cameraImagingIds;
+  std::vector<cote::StateMachine::StateId> cameraReadoutIds;
+  std::vector<cote::StateMachine::StateId> computerWorkIds;
+  std::vector<cote::StateMachine::StateId> rxRxIds;
+  std::vector<cote::StateMachine::StateId> txTxIds;
+  std::vector<cote::Receiver> satRxs;
+  std::vector<cote::Transmitter> satTxs;
+  std::vector<double> satTxCenterFrequencyHz;
+  std::vector<double> satTxBandwidthHz;
+  std::vector<cote::Sensor> sensors;
+  std::vector<double> threshCoeffs;
+  std::vector<uint32_t> pixelCountWs;
+  std::vector<double> pixelSizeMs;
+  std::vector<double> focalLengthMs;
+  std::vector<uint32_t> pixelCountHs;
+  std::vector<cote::NeuralNetwork> programs;
+  std::vector<double> thresholdKms;
+  std::vector<std::queue<double>> gsds;
+  std::vector<bool> rxOccupied;
+  std::vector<bool> txOccupied;
+  std::vector<uint64_t> txBufferBits;
+  // Ground stations
   std::vector<cote::GroundStation> groundStations;
-  for(std::size_t i=0; i<groundStationFiles.size(); i++) {
-    std::ifstream gndHandle(groundStationFiles.at(i).string());
-    line = "";
-    std::getline(gndHandle,line); // Read header
-    std::getline(gndHandle,line); // Read values
-    gndHandle.close();
-    uint32_t id  = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
-    double   lat = std::stod(line.substr(11,13));
-    double   lon = std::stod(line.substr(25,14));
-    double   hae = std::stod(line.substr(40,13));
-    groundStations.push_back(
-     cote::GroundStation(lat,lon,hae,&dateTime,id,&log)
-    );
-  }
-  std::sort(
-   groundStations.begin(), groundStations.end(),
-   [](const cote::GroundStation& g1, const cote::GroundStation& g2) {
-    return g1.getID() < g2.getID();
-   }
+  std::vector<cote::Receiver> gndRxs;
+  std::vector<cote::Transmitter> gndTxs;
+  std::vector<double> gndTxCenterFrequencyHz;
+  std::vector<double> gndTxBandwidthHz;
+  std::vector<std::vector<std::size_t>> gndVisSats; // visible sat indices
+  std::vector<std::size_t> gndCurrSats;             // linked sat index
+  // Communication channels
+  std::vector<cote::Channel> crosslinks;
+  std::vector<cote::Channel> downlinks;
+  std::vector<cote::Channel> uplinks;
+  // Propagates the satellites, then the ground stations, and interpolates
+  // their positions between orbit updates
+  cote::PropagatePhase propagatePhase;
+  // Data for logging logic
+  std::vector<std::pair<double,double>> prevNodeVoltages;
+  std::vector<std::pair<double,double>> prevDownlinkMbps;
+  std::vector<std::pair<double,double>> prevUplinkMbps;
+  std::vector<SatelliteLogs> satLogs;
+  // Statistics maintained during the run and written to the summary file
+  cote::Metrics metrics;
+  cote::Metrics::MetricHandle tileCountMetric;
+  cote::Metrics::MetricHandle downlinkMbpsMetric;
+  std::vector<cote::Metrics::MetricHandle> nodeVoltageMetrics;
+};
+
+// The ECI position of the satellite as of the current step, interpolated
+// between orbit updates
+std::array<double,3> getSatECIPosn(
+ const Scenario* const scenario, const std::size_t& index
+) {
+  return scenario->propagatePhase.getECIPosn(index);
+}
+
+// The ECI position of the ground station as of the current step, interpolated
+// between orbit updates
+std::array<double,3> getGndECIPosn(
+ const Scenario* const scenario, const std::size_t& index
+) {
+  return scenario->propagatePhase.getECIPosn(
+   scenario->satellites.size()+index
   );
-  std::map<uint32_t,cote::GroundStation*> gndId2Gnd;
-  for(std::size_t i=0; i<groundStations.size(); i++) {
-    gndId2Gnd[groundStations.at(i).getID()] = &(groundStations.at(i));
-  }
-  // Set up ground station RX
-  std::map<uint32_t,cote::Receiver*> gndId2Rx;
-  std::map<uint32_t,const double> gndId2RxCenterFrequencyHz;
-  std::map<uint32_t,const double> gndId2RxBandwidthHz;
-  for(std::size_t i=0; i<rxGndFiles.size(); i++) {
-    std::ifstream rxGndHandle(rxGndFiles.at(i).string());
-    line = "";
-    std::getline(rxGndHandle,line); // Read header
-    std::getline(rxGndHandle,line); // Read values
-    rxGndHandle.close();
-    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
-    const std::array<double,3> posn = gndId2Gnd[id]->getECIPosn();
-    const double gainDB = std::stod(line.substr(11,13));
-    const double rxCenterFrequencyHz = std::stod(line.substr(25,22));
-    const double rxBandwidthHz = std::stod(line.substr(48,23));
-    gndId2Rx[id] = new cote::Receiver(posn,gainDB,&dateTime,id,&log);
-    gndId2RxCenterFrequencyHz.insert(std::make_pair(id,rxCenterFrequencyHz));
-    gndId2RxBandwidthHz.insert(std::make_pair(id,rxBandwidthHz));
-  }
-  // Set up ground station TX
-  std::map<uint32_t,cote::Transmitter*> gndId2Tx;
-  std::map<uint32_t,const double> gndId2TxCenterFrequencyHz;
-  std::map<uint32_t,const double> gndId2TxBandwidthHz;
-  for(std::size_t i=0; i<txGndFiles.size(); i++) {
-    std::ifstream txGndHandle(txGndFiles.at(i).string());
-    line = "";
-    std::getline(txGndHandle,line); // Read header
-    std::getline(txGndHandle,line); // Read values
-    txGndHandle.close();
-    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
-    const std::array<double,3> posn = gndId2Gnd[id]->getECIPosn();
-    const double powerW = std::stod(line.substr(11,16));
-    const double lineLossDB = std::stod(line.substr(28,13));
-    const double gainDB = std::stod(line.substr(42,13));
-    const double txCenterFrequencyHz = std::stod(line.substr(56,22));
-    const double txBandwidthHz = std::stod(line.substr(79,23));
-    gndId2Tx[id] = new cote::Transmitter(
-     posn,powerW,lineLossDB,gainDB,&dateTime,id,&log
-    );
-    gndId2TxCenterFrequencyHz.insert(std::make_pair(id,txCenterFrequencyHz));
-    gndId2TxBandwidthHz.insert(std::make_pair(id,txBandwidthHz));
-  }
-  // Simulation data
-  std::map<uint32_t,double> satId2ThresholdKm;
-  std::map<uint32_t,std::queue<double>> satId2GSDs;
-  std::map<uint32_t,bool> satId2RxOccupied;
-  std::map<uint32_t,bool> satId2TxOccupied;
-  std::map<uint32_t,uint64_t> satId2TxBufferBits;
-  for(std::size_t i=0; i<satellites.size(); i++) {
-    const uint32_t SAT_ID = satellites.at(i).getID();
-    satId2ThresholdKm[SAT_ID] =
-     satId2ThreshCoeff[SAT_ID]*
-     cote::util::calcAltitudeKm(satellites.at(i).getECIPosn());
-    satId2GSDs[SAT_ID] = std::queue<double>();
-    satId2RxOccupied[SAT_ID] = false;
-    satId2TxOccupied[SAT_ID] = false;
-    satId2TxBufferBits[SAT_ID] = 0;
-  }
-  std::vector<cote::Channel> crosslinks = std::vector<cote::Channel>();
-  std::vector<cote::Channel> downlinks  = std::vector<cote::Channel>();
-  std::vector<cote::Channel> uplinks    = std::vector<cote::Channel>();
-  std::map<uint32_t,std::vector<cote::Satellite*>> gndId2VisSats;
-  std::map<uint32_t,cote::Satellite*> gndId2CurrSat;
-  for(std::size_t i=0; i<groundStations.size(); i++) {
-    const uint32_t GND_ID = groundStations.at(i).getID();
-    gndId2VisSats[GND_ID] = std::vector<cote::Satellite*>();
-    gndId2CurrSat[GND_ID] = nullptr;
-  }
-  // Simulation loop
-  uint64_t stepCount = 0;
-  while(stepCount<numSteps) {
-    // Date and time
-    const double JD = cote::util::calcJulianDayFromYMD(
-     dateTime.getYear(),dateTime.getMonth(),dateTime.getDay()
-    );
-    const uint32_t SEC = cote::util::calcSecSinceMidnight(
-     dateTime.getHour(), dateTime.getMinute(), dateTime.getSecond()
-    );
-    const uint32_t NS = dateTime.getNanosecond();
+}
+
+// Appends the state intervals of each of the satellite's state machines
+void recordSatelliteStateIntervals(
+ Scenario* const scenario, const std::size_t& index,
+ const cote::Log* const log, std::string* const rows
+) {
+  const SatelliteLogs& satLogs = scenario->satLogs.at(index);
+  recordStateIntervals(
+   scenario->adacsSms.at(index), satLogs.prefix, "adacs", satLogs.adacsState,
+   log, rows
+  );
+  recordStateIntervals(
+   scenario->cameraSms.at(index), satLogs.prefix, "camera",
+   satLogs.cameraState, log, rows
+  );
+  recordStateIntervals(
+   scenario->computerSms.at(index), satLogs.prefix, "computer",
+   satLogs.computerState, log, rows
+  );
+  recordStateIntervals(
+   scenario->rxSms.at(index), satLogs.prefix, "rx", satLogs.rxState, log, rows
+  );
+  recordStateIntervals(
+   scenario->txSms.at(index), satLogs.prefix, "tx", satLogs.txState, log, rows
+  );
+}
+
+// Sets the solar array irradiance of each satellite from its sun occlusion
+class EnvironmentPhase : public cote::IQuiescentPhase {
+public:
+  EnvironmentPhase(Scenario* const scenario) : scenario(scenario) {}
+  void step(cote::Simulation* const simulation) override {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<double>& sunOcclusionFactors =
+     this->scenario->sunOcclusionFactors;
+    cote::PowerBus& powerBus = this->scenario->powerBus;
     const std::array<double,3> SUN_ECI_POSN_KM =
-     cote::util::calcSunEciPosnKm(JD,SEC,NS);
-    // Simulate satellites
-    for(std::size_t i=0; i<satellites.size(); i++) {
-      const uint32_t SAT_ID = satellites.at(i).getID();
+     simulation->getSunECIPosnKm();
+    simulation->parallelFor(
+     satellites.size(),
+     [&](std::size_t i) {
       const std::array<double,3> SAT_ECI_POSN_KM =
-       satId2Sat[SAT_ID]->getECIPosn();
+       getSatECIPosn(this->scenario,i);
       // Simulate solar array current
       const double sunOcclusionFactor =
        cote::util::calcSunOcclusionFactor(SAT_ECI_POSN_KM,SUN_ECI_POSN_KM);
-      satId2SunOcclusionFactor[SAT_ID] = sunOcclusionFactor;
-      //// When sunOcclusionFactor is 0.0, irradiance is SOLAR_CONSTANT
-      //// When sunOcclusionFactor is 1.0, irradiance is 1% of SOLAR_CONSTANT
-      //// -1352.44 is the slope needed to achieve the above effect
-      const double irradianceWPerM2 =
-       -1352.44*sunOcclusionFactor+cote::cnst::SOLAR_CONSTANT;
+      sunOcclusionFactors.at(i) = sunOcclusionFactor;
       //// setIrradianceWpM2 calculates and sets the appropriate output current
-      satId2SolarArray[SAT_ID]->setIrradianceWpM2(irradianceWPerM2);
-      //// if needed, clip the output current based on most recent node voltage
-      if(
-       satId2SolarArray[SAT_ID]->getOpenCircuitVoltage()<=
-       satId2NodeVoltage[SAT_ID] &&
-       satId2SolarArray[SAT_ID]->getCurrentAmpere()!=0.0
-      ) { // Zero out solar array current if node voltage is too high
-        satId2SolarArray[SAT_ID]->setCurrentAmpere(0.0);
-      }
-      // Simulate capacitor charge
-      double capacitorChargeCoulomb =
-       satId2Capacitor[SAT_ID]->getChargeCoulomb();
-      const double totalLoadCurrentAmpere = (
-       satId2AdacsSm[SAT_ID]->getVariableValue("power-w")+
-       satId2CameraSm[SAT_ID]->getVariableValue("power-w")+
-       satId2ComputerSm[SAT_ID]->getVariableValue("power-w")+
-       satId2RxSm[SAT_ID]->getVariableValue("power-w")+
-       satId2TxSm[SAT_ID]->getVariableValue("power-w")
-      )/satId2NodeVoltage[SAT_ID];
-      capacitorChargeCoulomb += (
-       satId2SolarArray[SAT_ID]->getCurrentAmpere()-totalLoadCurrentAmpere
-      )*totalStepInSec;
-      if(capacitorChargeCoulomb<0.0) {
-        capacitorChargeCoulomb = 0.0;
+      powerBus.setIrradianceWpM2(i,calcIrradianceWPerM2(sunOcclusionFactor));
+     }
+    );
+  }
+  // The irradiance only changes in penumbra, so the phase is quiescent until a
+  // satellite could enter it
+  uint64_t getQuiescentSteps(cote::Simulation* const simulation) override {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<double>& sunOcclusionFactors =
+     this->scenario->sunOcclusionFactors;
+    const std::array<double,3> SUN_ECI_POSN_KM =
+     simulation->getSunECIPosnKm();
+    uint64_t steps = std::numeric_limits<uint64_t>::max();
+    for(std::size_t i=0; i<satellites.size() && steps>1; i++) {
+      const double sunOcclusionFactor = sunOcclusionFactors.at(i);
+      if(sunOcclusionFactor!=0.0 && sunOcclusionFactor!=1.0) {
+        return 1;
       }
-      satId2Capacitor[SAT_ID]->setChargeCoulomb(capacitorChargeCoulomb);
+      //// A positive margin also shows that the satellite has not left the
+      //// sunlight or umbra since the factor was calculated
+      steps = std::min(
+       steps,
+       cote::util::calcStepsOutsidePenumbra(
+        getSatECIPosn(this->scenario,i), SUN_ECI_POSN_KM, sunOcclusionFactor,
+        simulation->getStepSizeS()
+       )
+      );
+    }
+    return steps;
+  }
+  void skip(
+   cote::Simulation* const /*simulation*/, const uint64_t& /*steps*/
+  ) override {
+    //// The occlusion factors do not change; PowerPhase::skip sets the
+    //// irradiance on each skipped step
+  }
+private:
+  Scenario* scenario; // not owned, should not be deleted
+};
+
+// Advances the camera and computer task counts and triggers frame captures
+class PayloadPhase : public cote::IQuiescentPhase {
+public:
+  PayloadPhase(Scenario* const scenario, cote::Log* const log) :
+   scenario(scenario), log(log) {}
+  void step(cote::Simulation* const simulation) override {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<cote::StateMachine>& cameraSms = this->scenario->cameraSms;
+    std::vector<cote::StateMachine>& computerSms = this->scenario->computerSms;
+    std::vector<cote::StateMachine>& txSms = this->scenario->txSms;
+    std::vector<cote::StateMachine::StateId>& cameraImagingIds =
+     this->scenario->cameraImagingIds;
+    std::vector<cote::StateMachine::StateId>& cameraReadoutIds =
+     this->scenario->cameraReadoutIds;
+    std::vector<cote::StateMachine::StateId>& computerWorkIds =
+     this->scenario->computerWorkIds;
+    std::vector<cote::Sensor>& sensors = this->scenario->sensors;
+    std::vector<double>& threshCoeffs = this->scenario->threshCoeffs;
+    std::vector<uint32_t>& pixelCountWs = this->scenario->pixelCountWs;
+    std::vector<double>& pixelSizeMs = this->scenario->pixelSizeMs;
+    std::vector<double>& focalLengthMs = this->scenario->focalLengthMs;
+    std::vector<uint32_t>& pixelCountHs = this->scenario->pixelCountHs;
+    std::vector<cote::NeuralNetwork>& programs = this->scenario->programs;
+    std::vector<double>& thresholdKms = this->scenario->thresholdKms;
+    std::vector<std::queue<double>>& gsds = this->scenario->gsds;
+    std::vector<uint64_t>& txBufferBits = this->scenario->txBufferBits;
+    std::vector<SatelliteLogs>& satLogs = this->scenario->satLogs;
+    //// The time of this step's logs is only formatted if they are kept
+    const std::string STEP = this->log->isEnabled(cote::LogLevel::INFO) ?
+     std::to_string(simulation->getStepCount()) : std::string();
+    const double JD = simulation->getJulianDay();
+    const uint32_t SEC = simulation->getSecSinceMidnight();
+    const uint32_t NS = simulation->getNanosecond();
+    for(std::size_t i=0; i<satellites.size(); i++) {
+      const std::array<double,3> SAT_ECI_POSN_KM =
+       getSatECIPosn(this->scenario,i);
       // Simulate ADACS state machine
       //// Nothing to be done
       // Simulate camera state machine
-      if(satId2CameraSm[SAT_ID]->getCurrentState()=="IMAGING") {
+      if(
+       cameraSms.at(i).getCurrentStateId()==
+       cameraImagingIds.at(i)
+      ) {
         const double imagingDurationS =
-         satId2CameraSm[SAT_ID]->getConstantValue("imaging-duration-s");
+         cameraSms.at(i).getConstantValue("imaging-duration-s");
         double imagingTimeS = // this value is set in the sim update section
-         satId2CameraSm[SAT_ID]->getVariableValue("imaging-time-s");
+         cameraSms.at(i).getVariableValue("imaging-time-s");
         std::size_t imagingTaskCount = std::round( // hack double to size_t
-         satId2CameraSm[SAT_ID]->getVariableValue("imaging-task-count")
+         cameraSms.at(i).getVariableValue("imaging-task-count")
         );
         std::size_t readoutTaskCount = std::round( // hack double to size_t
-         satId2CameraSm[SAT_ID]->getVariableValue("readout-task-count")
+         cameraSms.at(i).getVariableValue("readout-task-count")
         );
         while(imagingTimeS>=imagingDurationS && imagingTaskCount>0) {
           readoutTaskCount += 1;
           imagingTaskCount -= 1;
           imagingTimeS -= imagingDurationS;
         }
-        satId2CameraSm[SAT_ID]->setVariableValue("imaging-time-s",imagingTimeS);
-        satId2CameraSm[SAT_ID]->setVariableValue(
+        cameraSms.at(i).setVariableValue("imaging-time-s",imagingTimeS);
+        cameraSms.at(i).setVariableValue(
          "imaging-task-count",static_cast<double>(imagingTaskCount)
         );
-        satId2CameraSm[SAT_ID]->setVariableValue(
+        cameraSms.at(i).setVariableValue(
          "readout-task-count",static_cast<double>(readoutTaskCount)
         );
-      } else if(satId2CameraSm[SAT_ID]->getCurrentState()=="READOUT") {
+      } else if(
+       cameraSms.at(i).getCurrentStateId()==
+       cameraReadoutIds.at(i)
+      ) {
         const double readoutDurationS =
-         satId2CameraSm[SAT_ID]->getConstantValue("readout-duration-s");
+         cameraSms.at(i).getConstantValue("readout-duration-s");
         double readoutTimeS = // this value is set in the sim update section
-         satId2CameraSm[SAT_ID]->getVariableValue("readout-time-s");
+         cameraSms.at(i).getVariableValue("readout-time-s");
         std::size_t readoutTaskCount = std::round( // hack double to size_t
-         satId2CameraSm[SAT_ID]->getVariableValue("readout-task-count")
+         cameraSms.at(i).getVariableValue("readout-task-count")
         );
         std::size_t claimedTaskCount = std::round( // hack double to size_t
-         satId2ComputerSm[SAT_ID]->getVariableValue("claimed-task-count")
+         computerSms.at(i).getVariableValue("claimed-task-count")
         );
         while(readoutTimeS>=readoutDurationS && readoutTaskCount>0) {
           // Calculate tile count per image
-          const double GSD = satId2GSDs[SAT_ID].front();
-          satId2GSDs[SAT_ID].pop();
+          const double GSD = gsds.at(i).front();
+          gsds.at(i).pop();
           const std::size_t tileColCount = std::round(
-           (static_cast<double>(satId2PixelCountW[SAT_ID])*
-            static_cast<double>(satId2Program[SAT_ID].idealFeatureWidthPx)/
-            (satId2Program[SAT_ID].actualFeatureWidthM/GSD)
-           )/static_cast<double>(satId2Program[SAT_ID].inputWidthPx)
+           (static_cast<double>(pixelCountWs.at(i))*
+            static_cast<double>(programs.at(i).idealFeatureWidthPx)/
+            (programs.at(i).actualFeatureWidthM/GSD)
+           )/static_cast<double>(programs.at(i).inputWidthPx)
           );
           const std::size_t tileRowCount = std::round(
-           (static_cast<double>(satId2PixelCountH[SAT_ID])*
-            static_cast<double>(satId2Program[SAT_ID].idealFeatureHeightPx)/
-            (satId2Program[SAT_ID].actualFeatureHeightM/GSD)
-           )/static_cast<double>(satId2Program[SAT_ID].inputHeightPx)
+           (static_cast<double>(pixelCountHs.at(i))*
+            static_cast<double>(programs.at(i).idealFeatureHeightPx)/
+            (programs.at(i).actualFeatureHeightM/GSD)
+           )/static_cast<double>(programs.at(i).inputHeightPx)
           );
           const std::size_t tilesPerImage = tileColCount*tileRowCount;
           // State machine logic
@@ -927,42 +457,47 @@ int main(int argc, char** argv) {
           // triggerSense() will already have been called; now, the data has
           // been read out so the satellite TX radio has data available (true)
           // for transmission to ground
-          satId2TxSm[SAT_ID]->setVariableValue("data-available",1.0);
-          satId2TxBufferBits[SAT_ID] += satId2Sensor[SAT_ID]->getBitsPerSense();
+          txSms.at(i).setVariableValue("data-available",1.0);
+          txBufferBits.at(i) += sensors.at(i).getBitsPerSense();
           // Log the tile count for the image read out
-          std::ostringstream oss;
-          oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-          log.meas(
+          COTE_MEAS(
+           *this->log,
            cote::LogLevel::INFO,
            //dateTime.toString(),
-           std::to_string(stepCount),
-           std::string(oss.str()+"-tile-count"),
-           std::to_string(tilesPerImage)
+           STEP,
+           satLogs.at(i).tileCount,
+           tilesPerImage
+          );
+          this->scenario->metrics.record(
+           this->scenario->tileCountMetric,static_cast<double>(tilesPerImage)
           );
         }
-        satId2CameraSm[SAT_ID]->setVariableValue("readout-time-s",readoutTimeS);
-        satId2CameraSm[SAT_ID]->setVariableValue(
+        cameraSms.at(i).setVariableValue("readout-time-s",readoutTimeS);
+        cameraSms.at(i).setVariableValue(
          "readout-task-count",static_cast<double>(readoutTaskCount)
         );
-        satId2ComputerSm[SAT_ID]->setVariableValue(
+        computerSms.at(i).setVariableValue(
          "claimed-task-count",static_cast<double>(claimedTaskCount)
         );
       }
       // Simulate computer state machine
-      if(satId2ComputerSm[SAT_ID]->getCurrentState()=="WORK") {
+      if(
+       computerSms.at(i).getCurrentStateId()==
+       computerWorkIds.at(i)
+      ) {
         const double taskDurationS =
-         satId2ComputerSm[SAT_ID]->getConstantValue("task-duration-s");
+         computerSms.at(i).getConstantValue("task-duration-s");
         double workTimeS = // this value is set in the sim update section
-         satId2ComputerSm[SAT_ID]->getVariableValue("work-time-s");
+         computerSms.at(i).getVariableValue("work-time-s");
         std::size_t claimedTaskCount = std::round( // hack double to size_t
-         satId2ComputerSm[SAT_ID]->getVariableValue("claimed-task-count")
+         computerSms.at(i).getVariableValue("claimed-task-count")
         );
         while(workTimeS>=taskDurationS && claimedTaskCount>0) {
           claimedTaskCount -= 1;
           workTimeS -= taskDurationS;
         }
-        satId2ComputerSm[SAT_ID]->setVariableValue("work-time-s",workTimeS);
-        satId2ComputerSm[SAT_ID]->setVariableValue(
+        computerSms.at(i).setVariableValue("work-time-s",workTimeS);
+        computerSms.at(i).setVariableValue(
          "claimed-task-count",static_cast<double>(claimedTaskCount)
         );
       }
@@ -975,176 +510,421 @@ int main(int argc, char** argv) {
       // Simulate satellite TX
       //// Nothing to be done
       // Simulate satellite sensor (data collection)
-      const std::array<double,3> PREV_SENSE_POSN =
-       satId2Sensor[SAT_ID]->getPrevSensePosn();
-      const cote::DateTime PREV_SENSE_DATE_TIME =
-       satId2Sensor[SAT_ID]->getPrevSenseDateTime();
-      const double PREV_SENSE_JD = cote::util::calcJulianDayFromYMD(
-       PREV_SENSE_DATE_TIME.getYear(), PREV_SENSE_DATE_TIME.getMonth(),
-       PREV_SENSE_DATE_TIME.getDay()
-      );
-      const uint32_t PREV_SENSE_SEC = cote::util::calcSecSinceMidnight(
-       PREV_SENSE_DATE_TIME.getHour(), PREV_SENSE_DATE_TIME.getMinute(),
-       PREV_SENSE_DATE_TIME.getSecond()
-      );
-      const uint32_t PREV_SENSE_NS = PREV_SENSE_DATE_TIME.getNanosecond();
-      const double PREV_SENSE_LAT =
-       cote::util::calcSubpointLatitude(PREV_SENSE_POSN);
-      const double PREV_SENSE_LON = cote::util::calcSubpointLongitude(
-       PREV_SENSE_JD, PREV_SENSE_SEC, PREV_SENSE_NS, PREV_SENSE_POSN
-      );
-      const double SAT_LAT =
-       cote::util::calcSubpointLatitude(SAT_ECI_POSN_KM);
-      const double SAT_LON = cote::util::calcSubpointLongitude(
-       JD, SEC, NS, SAT_ECI_POSN_KM
-      );
-      const double DIST_KM = cote::util::calcGreatCircleArc(
-       SAT_LON, SAT_LAT, PREV_SENSE_LON, PREV_SENSE_LAT
-      )*cote::cnst::WGS_84_A; // Earth "radius" in km
-      if(DIST_KM>=satId2ThresholdKm[SAT_ID]) {
+      const double DIST_KM =
+       this->calcSenseDistKm(i,SAT_ECI_POSN_KM,JD,SEC,NS);
+      if(DIST_KM>=thresholdKms.at(i)) {
         // Increment the camera state machine imaging task count
         std::size_t imagingTaskCount = std::round( // hack double to size_t
-         satId2CameraSm[SAT_ID]->getVariableValue("imaging-task-count")
+         cameraSms.at(i).getVariableValue("imaging-task-count")
         );
-        satId2CameraSm[SAT_ID]->setVariableValue(
+        cameraSms.at(i).setVariableValue(
          "imaging-task-count",static_cast<double>(imagingTaskCount+1)
         );
         // Update the threshold value for next GTFR sense event
         const double SAT_ALT_KM = cote::util::calcAltitudeKm(SAT_ECI_POSN_KM);
-        satId2ThresholdKm[SAT_ID] = satId2ThreshCoeff[SAT_ID]*SAT_ALT_KM;
+        thresholdKms.at(i) = threshCoeffs.at(i)*SAT_ALT_KM;
         // Trigger a sense event now to update prevSense values
-        satId2Sensor[SAT_ID]->triggerSense();
+        sensors.at(i).triggerSense();
         // Calculate GSD for use in tiling calculation
-        satId2GSDs[SAT_ID].push(
-         satId2PixelSizeM[SAT_ID]*SAT_ALT_KM*cote::cnst::M_PER_KM/
-         satId2FocalLengthM[SAT_ID]
+        gsds.at(i).push(
+         pixelSizeMs.at(i)*SAT_ALT_KM*cote::cnst::M_PER_KM/
+         focalLengthMs.at(i)
         );
         // Log the sense trigger event
-        std::ostringstream oss;
-        oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-        log.meas(
+        COTE_MEAS(
+         *this->log,
          cote::LogLevel::INFO,
          //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-alt-km"),
-         std::to_string(SAT_ALT_KM)
+         STEP,
+         satLogs.at(i).altKm,
+         SAT_ALT_KM
         );
-        log.meas(
+        COTE_MEAS(
+         *this->log,
          cote::LogLevel::INFO,
          //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-x-km"),
-         std::to_string(SAT_ECI_POSN_KM.at(0))
+         STEP,
+         satLogs.at(i).xKm,
+         SAT_ECI_POSN_KM.at(0)
         );
-        log.meas(
+        COTE_MEAS(
+         *this->log,
          cote::LogLevel::INFO,
          //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-y-km"),
-         std::to_string(SAT_ECI_POSN_KM.at(1))
+         STEP,
+         satLogs.at(i).yKm,
+         SAT_ECI_POSN_KM.at(1)
         );
-        log.meas(
+        COTE_MEAS(
+         *this->log,
          cote::LogLevel::INFO,
          //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-z-km"),
-         std::to_string(SAT_ECI_POSN_KM.at(2))
+         STEP,
+         satLogs.at(i).zKm,
+         SAT_ECI_POSN_KM.at(2)
         );
       }
       // Simulate satellite program
       //// Nothing to be done
       // Simulate satellite communication channels
     }
-    // Clear communication channels so that they can be re-calculated
-    crosslinks.clear();
-    downlinks.clear();
-    uplinks.clear();
+  }
+  // Quiescent until a frame could be triggered or a camera or computer task
+  // could complete; the distance from the previous frame grows at most as
+  // fast as the subpoint moves, and DevicePhase advances each task timer by
+  // one time step per step
+  uint64_t getQuiescentSteps(cote::Simulation* const simulation) override {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<cote::StateMachine>& cameraSms = this->scenario->cameraSms;
+    std::vector<cote::StateMachine>& computerSms = this->scenario->computerSms;
+    std::vector<cote::StateMachine::StateId>& cameraImagingIds =
+     this->scenario->cameraImagingIds;
+    std::vector<cote::StateMachine::StateId>& cameraReadoutIds =
+     this->scenario->cameraReadoutIds;
+    std::vector<cote::StateMachine::StateId>& computerWorkIds =
+     this->scenario->computerWorkIds;
+    std::vector<double>& thresholdKms = this->scenario->thresholdKms;
+    const double JD = simulation->getJulianDay();
+    const uint32_t SEC = simulation->getSecSinceMidnight();
+    const uint32_t NS = simulation->getNanosecond();
+    const double STEP_S = simulation->getStepSizeS();
+    uint64_t steps = std::numeric_limits<uint64_t>::max();
+    for(std::size_t i=0; i<satellites.size() && steps>1; i++) {
+      // Camera and computer tasks
+      if(
+       cameraSms.at(i).getCurrentStateId()==cameraImagingIds.at(i) &&
+       std::round(cameraSms.at(i).getVariableValue("imaging-task-count"))>0.0
+      ) {
+        steps = std::min(
+         steps,
+         cote::util::calcStepsBelow(
+          cameraSms.at(i).getConstantValue("imaging-duration-s")-
+          cameraSms.at(i).getVariableValue("imaging-time-s"),
+          STEP_S
+         )
+        );
+      } else if(
+       cameraSms.at(i).getCurrentStateId()==cameraReadoutIds.at(i) &&
+       std::round(cameraSms.at(i).getVariableValue("readout-task-count"))>0.0
+      ) {
+        steps = std::min(
+         steps,
+         cote::util::calcStepsBelow(
+          cameraSms.at(i).getConstantValue("readout-duration-s")-
+          cameraSms.at(i).getVariableValue("readout-time-s"),
+          STEP_S
+         )
+        );
+      }
+      if(
+       computerSms.at(i).getCurrentStateId()==computerWorkIds.at(i) &&
+       std::round(computerSms.at(i).getVariableValue("claimed-task-count"))>
+       0.0
+      ) {
+        steps = std::min(
+         steps,
+         cote::util::calcStepsBelow(
+          computerSms.at(i).getConstantValue("task-duration-s")-
+          computerSms.at(i).getVariableValue("work-time-s"),
+          STEP_S
+         )
+        );
+      }
+      //// The tasks are checked first since they need no geometry
+      if(steps<=1) {
+        break;
+      }
+      // Frame trigger
+      const std::array<double,3> SAT_ECI_POSN_KM =
+       getSatECIPosn(this->scenario,i);
+      const double DIST_KM =
+       this->calcSenseDistKm(i,SAT_ECI_POSN_KM,JD,SEC,NS);
+      //// The subpoint turns at most as fast as the satellite and the Earth
+      const double radiusKm = cote::util::magnitude(SAT_ECI_POSN_KM);
+      const double subpointKmPerS = cote::cnst::WGS_84_A*(
+       cote::util::calcMaxSpeedKmPerS(radiusKm)/radiusKm+
+       cote::cnst::WGS_84_WE
+      );
+      steps = std::min(
+       steps,
+       cote::util::calcStepsBelow(
+        thresholdKms.at(i)-DIST_KM,
+        QUIESCENCE_SAFETY_FACTOR*subpointKmPerS*STEP_S
+       )
+      );
+    }
+    return steps;
+  }
+  void skip(
+   cote::Simulation* const /*simulation*/, const uint64_t& /*steps*/
+  ) override {
+    //// No frame is triggered and no task completes
+  }
+private:
+  // Returns the great circle distance in km between the subpoints of the
+  // satellite and of its previous sense event
+  double calcSenseDistKm(
+   const std::size_t& i, const std::array<double,3>& satEciPosnKm,
+   const double& julianDay, const uint32_t& second, const uint32_t& nanosecond
+  ) const {
+    const cote::Sensor& sensor = this->scenario->sensors.at(i);
+    const std::array<double,3> PREV_SENSE_POSN = sensor.getPrevSensePosn();
+    const cote::DateTime PREV_SENSE_DATE_TIME = sensor.getPrevSenseDateTime();
+    const double PREV_SENSE_JD = cote::util::calcJulianDayFromYMD(
+     PREV_SENSE_DATE_TIME.getYear(), PREV_SENSE_DATE_TIME.getMonth(),
+     PREV_SENSE_DATE_TIME.getDay()
+    );
+    const uint32_t PREV_SENSE_SEC = cote::util::calcSecSinceMidnight(
+     PREV_SENSE_DATE_TIME.getHour(), PREV_SENSE_DATE_TIME.getMinute(),
+     PREV_SENSE_DATE_TIME.getSecond()
+    );
+    const uint32_t PREV_SENSE_NS = PREV_SENSE_DATE_TIME.getNanosecond();
+    const double PREV_SENSE_LAT =
+     cote::util::calcSubpointLatitude(PREV_SENSE_POSN);
+    const double PREV_SENSE_LON = cote::util::calcSubpointLongitude(
+     PREV_SENSE_JD, PREV_SENSE_SEC, PREV_SENSE_NS, PREV_SENSE_POSN
+    );
+    const double SAT_LAT = cote::util::calcSubpointLatitude(satEciPosnKm);
+    const double SAT_LON = cote::util::calcSubpointLongitude(
+     julianDay, second, nanosecond, satEciPosnKm
+    );
+    return cote::util::calcGreatCircleArc(
+     SAT_LON, SAT_LAT, PREV_SENSE_LON, PREV_SENSE_LAT
+    )*cote::cnst::WGS_84_A; // Earth "radius" in km
+  }
+  Scenario* scenario; // not owned, should not be deleted
+  cote::Log* log;     // singleton, should not be deleted
+};
+
+// Charges the capacitor of each satellite over the time step
+class ChargePhase : public cote::IQuiescentPhase {
+public:
+  ChargePhase(Scenario* const scenario) : scenario(scenario) {}
+  void step(cote::Simulation* const simulation) override {
+    cote::PowerBus& powerBus = this->scenario->powerBus;
+    // Simulate capacitor charge for all satellites
+    if(this->scenario->closedFormPower) {
+      //// The closed form clips the output current itself
+      powerBus.advance(simulation->getStepSizeS());
+    } else {
+      //// if needed, clip the output current based on most recent node voltage
+      powerBus.clipSolarCurrent();
+      powerBus.updateCharge(simulation->getStepSizeS());
+    }
+  }
+  // The charge changes every step, but only the power phase observes it, and
+  // PowerPhase::getQuiescentSteps bounds the steps over which it may change
+  uint64_t getQuiescentSteps(cote::Simulation* const /*simulation*/) override {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  void skip(
+   cote::Simulation* const /*simulation*/, const uint64_t& /*steps*/
+  ) override {
+    //// PowerPhase::skip replays the charge updates, which alternate with the
+    //// node voltage updates
+  }
+private:
+  Scenario* scenario; // not owned, should not be deleted
+};
+
+// Finds the satellites visible from each ground station and drops the links of
+// those that went out of view; may run less often than the link phase
+class VisibilityPhase : public cote::IQuiescentPhase {
+public:
+  VisibilityPhase(Scenario* const scenario) : scenario(scenario) {}
+  void step(cote::Simulation* const simulation) override {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<cote::StateMachine>& rxSms = this->scenario->rxSms;
+    std::vector<cote::StateMachine>& txSms = this->scenario->txSms;
+    std::vector<cote::GroundStation>& groundStations =
+     this->scenario->groundStations;
+    std::vector<bool>& rxOccupied = this->scenario->rxOccupied;
+    std::vector<bool>& txOccupied = this->scenario->txOccupied;
+    std::vector<std::vector<std::size_t>>& gndVisSats =
+     this->scenario->gndVisSats;
+    std::vector<std::size_t>& gndCurrSats = this->scenario->gndCurrSats;
+    const double JD = simulation->getJulianDay();
+    const uint32_t SEC = simulation->getSecSinceMidnight();
+    const uint32_t NS = simulation->getNanosecond();
     // Determine visible satellites for each ground station
     for(std::size_t i=0; i<groundStations.size(); i++) {
       const double GND_LAT  = groundStations.at(i).getLatitude();
       const double GND_LON  = groundStations.at(i).getLongitude();
       const double GND_HAE  = groundStations.at(i).getHAE();
-      const uint32_t GND_ID = groundStations.at(i).getID();
-      gndId2VisSats[GND_ID].clear();
+      gndVisSats.at(i).clear();
       bool currSatInView  = false;
       for(std::size_t j=0; j<satellites.size(); j++) {
         const std::array<double,3> SAT_ECI_POSN_KM =
-         satellites.at(j).getECIPosn();
+         getSatECIPosn(this->scenario,j);
         if(cote::util::calcElevationDeg(
          JD, SEC, NS, GND_LAT, GND_LON, GND_HAE, SAT_ECI_POSN_KM
-        )>=10.0) {
-          gndId2VisSats[GND_ID].push_back(&(satellites.at(j)));
-          if(
-           gndId2CurrSat[GND_ID]!=nullptr &&
-           gndId2CurrSat[GND_ID]==gndId2VisSats[GND_ID].back() // same pointer
-          ) {
+        )>=MIN_ELEVATION_DEG) {
+          gndVisSats.at(i).push_back(j);
+          if(gndCurrSats.at(i)==j) {
             currSatInView = true;
           }
         }
       }
       // This removes a sat/gnd channel once the satellite goes out of view
-      if(!currSatInView && gndId2CurrSat[GND_ID]!=nullptr) {
-        const uint32_t SAT_ID = gndId2CurrSat[GND_ID]->getID();
-        satId2RxSm[SAT_ID]->setVariableValue("channel-available",0.0);
-        satId2TxSm[SAT_ID]->setVariableValue("channel-available",0.0);
-        satId2RxOccupied[SAT_ID] = false;
-        satId2TxOccupied[SAT_ID] = false;
-        gndId2CurrSat[GND_ID] = nullptr;
+      if(!currSatInView && gndCurrSats.at(i)!=cote::EntityStore::NO_INDEX) {
+        const std::size_t SAT_INDEX = gndCurrSats.at(i);
+        rxSms.at(SAT_INDEX).setVariableValue("channel-available",0.0);
+        txSms.at(SAT_INDEX).setVariableValue("channel-available",0.0);
+        rxOccupied.at(SAT_INDEX) = false;
+        txOccupied.at(SAT_INDEX) = false;
+        gndCurrSats.at(i) = cote::EntityStore::NO_INDEX;
+      }
+    }
+  }
+  // Quiescent while no ground station has a link or a visible satellite and
+  // until a satellite could rise to the minimum elevation
+  uint64_t getQuiescentSteps(cote::Simulation* const simulation) override {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<cote::GroundStation>& groundStations =
+     this->scenario->groundStations;
+    std::vector<std::vector<std::size_t>>& gndVisSats =
+     this->scenario->gndVisSats;
+    std::vector<std::size_t>& gndCurrSats = this->scenario->gndCurrSats;
+    const double JD = simulation->getJulianDay();
+    const uint32_t SEC = simulation->getSecSinceMidnight();
+    const uint32_t NS = simulation->getNanosecond();
+    const double STEP_S = simulation->getStepSizeS();
+    uint64_t steps = std::numeric_limits<uint64_t>::max();
+    for(std::size_t i=0; i<groundStations.size() && steps>1; i++) {
+      //// Visibility is held between updates, so a satellite seen at the last
+      //// one stays visible until the next
+      if(
+       gndCurrSats.at(i)!=cote::EntityStore::NO_INDEX ||
+       !gndVisSats.at(i).empty()
+      ) {
+        return 1;
+      }
+      const double GND_LAT = groundStations.at(i).getLatitude();
+      const double GND_LON = groundStations.at(i).getLongitude();
+      const double GND_HAE = groundStations.at(i).getHAE();
+      for(std::size_t j=0; j<satellites.size() && steps>1; j++) {
+        const std::array<double,3> SAT_ECI_POSN_KM =
+         getSatECIPosn(this->scenario,j);
+        const double ELEVATION_DEG = cote::util::calcElevationDeg(
+         JD, SEC, NS, GND_LAT, GND_LON, GND_HAE, SAT_ECI_POSN_KM
+        );
+        steps = std::min(
+         steps,
+         (ELEVATION_DEG<MIN_ELEVATION_DEG) ?
+          cote::util::calcStepsToElevation(
+           ELEVATION_DEG, MIN_ELEVATION_DEG, GND_HAE, SAT_ECI_POSN_KM, STEP_S
+          ) : 0
+        );
       }
     }
-    // Separate loop to construct channels to make informed choice of satellite
+    return steps;
+  }
+  void skip(
+   cote::Simulation* const /*simulation*/, const uint64_t& /*steps*/
+  ) override {
+    //// No satellite is visible
+    for(std::size_t i=0; i<this->scenario->gndVisSats.size(); i++) {
+      this->scenario->gndVisSats.at(i).clear();
+    }
+  }
+private:
+  // Lowest elevation at which a ground station links with a satellite
+  static constexpr double MIN_ELEVATION_DEG = 10.0;
+  Scenario* scenario; // not owned, should not be deleted
+};
+
+// Assigns visible satellites to ground stations and simulates the links
+class CommsPhase : public cote::IQuiescentPhase {
+public:
+  CommsPhase(Scenario* const scenario, cote::Log* const log) :
+   scenario(scenario), log(log) {}
+  void step(cote::Simulation* const simulation) override {
+    std::vector<std::pair<double,double>>& prevDownlinkMbps =
+     this->scenario->prevDownlinkMbps;
+    std::vector<std::pair<double,double>>& prevUplinkMbps =
+     this->scenario->prevUplinkMbps;
+    std::vector<cote::StateMachine>& rxSms = this->scenario->rxSms;
+    std::vector<cote::StateMachine>& txSms = this->scenario->txSms;
+    std::vector<cote::StateMachine::StateId>& rxRxIds = this->scenario->rxRxIds;
+    std::vector<cote::Receiver>& satRxs = this->scenario->satRxs;
+    std::vector<cote::Transmitter>& satTxs = this->scenario->satTxs;
+    std::vector<double>& satTxCenterFrequencyHz =
+     this->scenario->satTxCenterFrequencyHz;
+    std::vector<double>& satTxBandwidthHz = this->scenario->satTxBandwidthHz;
+    std::vector<cote::Sensor>& sensors = this->scenario->sensors;
+    std::vector<cote::GroundStation>& groundStations =
+     this->scenario->groundStations;
+    std::vector<cote::Receiver>& gndRxs = this->scenario->gndRxs;
+    std::vector<cote::Transmitter>& gndTxs = this->scenario->gndTxs;
+    std::vector<double>& gndTxCenterFrequencyHz =
+     this->scenario->gndTxCenterFrequencyHz;
+    std::vector<double>& gndTxBandwidthHz = this->scenario->gndTxBandwidthHz;
+    std::vector<bool>& rxOccupied = this->scenario->rxOccupied;
+    std::vector<bool>& txOccupied = this->scenario->txOccupied;
+    std::vector<uint64_t>& txBufferBits = this->scenario->txBufferBits;
+    std::vector<cote::Channel>& crosslinks = this->scenario->crosslinks;
+    std::vector<cote::Channel>& downlinks = this->scenario->downlinks;
+    std::vector<cote::Channel>& uplinks = this->scenario->uplinks;
+    std::vector<std::vector<std::size_t>>& gndVisSats =
+     this->scenario->gndVisSats;
+    std::vector<std::size_t>& gndCurrSats = this->scenario->gndCurrSats;
+    std::vector<SatelliteLogs>& satLogs = this->scenario->satLogs;
+    //// The time of this step's logs is only formatted if they are kept
+    const std::string STEP = this->log->isEnabled(cote::LogLevel::INFO) ?
+     std::to_string(simulation->getStepCount()) : std::string();
+    // Clear communication channels so that they can be re-calculated
+    crosslinks.clear();
+    downlinks.clear();
+    uplinks.clear();
+    // Construct channels; the visibility phase found the visible satellites
     for(std::size_t i=0; i<groundStations.size(); i++) {
-      const uint32_t GND_ID = groundStations.at(i).getID();
       // If no current link, choose a visible satellite
       // Best satellite policy:
-      //   - visible (i.e. in gndId2VisSats)
+      //   - visible (i.e. in gndVisSats)
       //   - has most data to downlink (heurisic; data may not be read out yet)
-      if(gndId2CurrSat[GND_ID]==nullptr) {
-        cote::Satellite* bestSat = nullptr;
+      if(gndCurrSats.at(i)==cote::EntityStore::NO_INDEX) {
+        std::size_t bestSat = cote::EntityStore::NO_INDEX;
         uint64_t bestSatBuffer = 0;
-        for(std::size_t j=0; j<gndId2VisSats[GND_ID].size(); j++) {
-          cote::Satellite* satj = gndId2VisSats[GND_ID].at(j);
-          const uint32_t SAT_ID = satj->getID();
-          const uint64_t BUF = satId2Sensor[SAT_ID]->getBitsBuffered();
+        for(std::size_t j=0; j<gndVisSats.at(i).size(); j++) {
+          const std::size_t SAT_INDEX = gndVisSats.at(i).at(j);
+          const uint64_t BUF = sensors.at(SAT_INDEX).getBitsBuffered();
           // Don't select a satellite that is already transmitting
-          if(!satId2TxOccupied[SAT_ID] && BUF>bestSatBuffer) {
-            bestSat = satj;
+          if(!txOccupied.at(SAT_INDEX) && BUF>bestSatBuffer) {
+            bestSat = SAT_INDEX;
             bestSatBuffer = BUF;
           }
-          satj = nullptr;
         }
-        if(bestSat!=nullptr) {
-          const uint32_t SAT_ID = bestSat->getID();
-          satId2RxSm[SAT_ID]->setVariableValue("channel-available",1.0);
-          satId2TxSm[SAT_ID]->setVariableValue("channel-available",1.0);
-          satId2RxOccupied[SAT_ID] = true;
-          satId2TxOccupied[SAT_ID] = true;
-          gndId2CurrSat[GND_ID] = bestSat;
+        if(bestSat!=cote::EntityStore::NO_INDEX) {
+          rxSms.at(bestSat).setVariableValue("channel-available",1.0);
+          txSms.at(bestSat).setVariableValue("channel-available",1.0);
+          rxOccupied.at(bestSat) = true;
+          txOccupied.at(bestSat) = true;
+          gndCurrSats.at(i) = bestSat;
         }
-        bestSat = nullptr;
       }
       // Construct downlink and uplink if available
-      if(gndId2CurrSat[GND_ID]!=nullptr) {
-        const uint32_t SAT_ID = gndId2CurrSat[GND_ID]->getID();
+      if(gndCurrSats.at(i)!=cote::EntityStore::NO_INDEX) {
+        const std::size_t SAT_INDEX = gndCurrSats.at(i);
         // Construct downlink
         downlinks.push_back(
          cote::Channel(
-          satId2Tx[SAT_ID],gndId2Rx[GND_ID],
-          satId2TxCenterFrequencyHz[SAT_ID],satId2TxBandwidthHz[SAT_ID],
-          &dateTime,&log
+          &(satTxs.at(SAT_INDEX)),&(gndRxs.at(i)),
+          satTxCenterFrequencyHz.at(SAT_INDEX),satTxBandwidthHz.at(SAT_INDEX),
+          simulation->getDateTime(),this->log
          )
         );
         // Data downlink
-        if(satId2RxSm[SAT_ID]->getCurrentState()=="RX") {
+        if(rxSms.at(SAT_INDEX).getCurrentStateId()==rxRxIds.at(SAT_INDEX)) {
           const uint64_t TX_BITS = static_cast<uint64_t>(std::round(
-           static_cast<double>(downlinks.back().getBitsPerSec())*totalStepInSec
+           static_cast<double>(downlinks.back().getBitsPerSec())*
+           simulation->getStepSizeS()
           ));
-          satId2Sensor[SAT_ID]->drainBuffer(TX_BITS);
-          if(TX_BITS<=satId2TxBufferBits[SAT_ID]) {
-            satId2TxBufferBits[SAT_ID] -= TX_BITS;
+          sensors.at(SAT_INDEX).drainBuffer(TX_BITS);
+          if(TX_BITS<=txBufferBits.at(SAT_INDEX)) {
+            txBufferBits.at(SAT_INDEX) -= TX_BITS;
           } else {
-            satId2TxBufferBits[SAT_ID] = 0;
-            satId2TxSm[SAT_ID]->setVariableValue("data-available",0.0);
+            txBufferBits.at(SAT_INDEX) = 0;
+            txSms.at(SAT_INDEX).setVariableValue("data-available",0.0);
           }
           // Log downlink Mbps when the sign of slope surrogate changes
           // NOTE: oldest first second current
@@ -1154,45 +934,48 @@ int main(int argc, char** argv) {
           //double downlinkMbps =
           // static_cast<double>(downlinks.back().getBitsPerSec())/1.0e6;
           double downlinkMbps = smoothedBitsPerSec/1.0e6;
+          this->scenario->metrics.record(
+           this->scenario->downlinkMbpsMetric,downlinkMbps
+          );
           double prevDiff =
-           satId2PrevDownlinkMbps[SAT_ID].second-
-           satId2PrevDownlinkMbps[SAT_ID].first;
+           prevDownlinkMbps.at(SAT_INDEX).second-
+           prevDownlinkMbps.at(SAT_INDEX).first;
           int prevSign = (prevDiff>0.0) ? 1 : ((prevDiff<0.0) ? -1 : 0);
-          double currDiff = downlinkMbps-satId2PrevDownlinkMbps[SAT_ID].second;
+          double currDiff = downlinkMbps-prevDownlinkMbps.at(SAT_INDEX).second;
           int currSign = (currDiff>0.0) ? 1 : ((currDiff<0.0) ? -1 : 0);
           if(prevSign!=currSign) {
-            std::ostringstream oss;
-            oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-            log.meas(
+            COTE_MEAS(
+             *this->log,
              cote::LogLevel::INFO,
              //dateTime.toString(),
-             std::to_string(stepCount),
-             std::string(oss.str()+"-downlink-Mbps"),
-             std::to_string(downlinkMbps)
+             STEP,
+             satLogs.at(SAT_INDEX).downlinkMbps,
+             downlinkMbps
             );
-            log.meas(
+            COTE_MEAS(
+             *this->log,
              cote::LogLevel::INFO,
              //dateTime.toString(),
-             std::to_string(stepCount),
-             std::string(oss.str()+"-downlink-dst"),
-             std::to_string(downlinks.back().getReceiver()->getID())
+             STEP,
+             satLogs.at(SAT_INDEX).downlinkDst,
+             downlinks.back().getReceiver()->getID()
             );
           }
           // Update downlink Mbps history
-          satId2PrevDownlinkMbps[SAT_ID].first =
-           satId2PrevDownlinkMbps[SAT_ID].second;
-          satId2PrevDownlinkMbps[SAT_ID].second = downlinkMbps;
+          prevDownlinkMbps.at(SAT_INDEX).first =
+           prevDownlinkMbps.at(SAT_INDEX).second;
+          prevDownlinkMbps.at(SAT_INDEX).second = downlinkMbps;
         }
         // Construct uplink
         uplinks.push_back(
          cote::Channel(
-          gndId2Tx[GND_ID],satId2Rx[SAT_ID],
-          gndId2TxCenterFrequencyHz[GND_ID],gndId2TxBandwidthHz[GND_ID],
-          &dateTime,&log
+          &(gndTxs.at(i)),&(satRxs.at(SAT_INDEX)),
+          gndTxCenterFrequencyHz.at(i),gndTxBandwidthHz.at(i),
+          simulation->getDateTime(),this->log
          )
         );
         // Data uplink
-        if(satId2RxSm[SAT_ID]->getCurrentState()=="RX") {
+        if(rxSms.at(SAT_INDEX).getCurrentStateId()==rxRxIds.at(SAT_INDEX)) {
           // Log uplink Mbps when the sign of slope surrogate changes
           // NOTE: oldest first second current
           double smoothedBitsPerSec = static_cast<double>(std::round(
@@ -1202,369 +985,1405 @@ int main(int argc, char** argv) {
           // static_cast<double>(uplinks.back().getBitsPerSec())/1.0e6;
           double uplinkMbps = smoothedBitsPerSec/1.0e6;
           double prevDiff =
-           satId2PrevUplinkMbps[SAT_ID].second-
-           satId2PrevUplinkMbps[SAT_ID].first;
+           prevUplinkMbps.at(SAT_INDEX).second-
+           prevUplinkMbps.at(SAT_INDEX).first;
           int prevSign = (prevDiff>0.0) ? 1 : ((prevDiff<0.0) ? -1 : 0);
-          double currDiff = uplinkMbps-satId2PrevUplinkMbps[SAT_ID].second;
+          double currDiff = uplinkMbps-prevUplinkMbps.at(SAT_INDEX).second;
           int currSign = (currDiff>0.0) ? 1 : ((currDiff<0.0) ? -1 : 0);
           if(prevSign!=currSign) {
-            std::ostringstream oss;
-            oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-            log.meas(
+            COTE_MEAS(
+             *this->log,
              cote::LogLevel::INFO,
              //dateTime.toString(),
-             std::to_string(stepCount),
-             std::string(oss.str()+"-uplink-Mbps"),
-             std::to_string(uplinkMbps)
+             STEP,
+             satLogs.at(SAT_INDEX).uplinkMbps,
+             uplinkMbps
             );
-            log.meas(
+            COTE_MEAS(
+             *this->log,
              cote::LogLevel::INFO,
              //dateTime.toString(),
-             std::to_string(stepCount),
-             std::string(oss.str()+"-uplink-src"),
-             std::to_string(uplinks.back().getTransmitter()->getID())
+             STEP,
+             satLogs.at(SAT_INDEX).uplinkSrc,
+             uplinks.back().getTransmitter()->getID()
             );
           }
           // Update uplink Mbps history
-          satId2PrevUplinkMbps[SAT_ID].first =
-           satId2PrevUplinkMbps[SAT_ID].second;
-          satId2PrevUplinkMbps[SAT_ID].second = uplinkMbps;
+          prevUplinkMbps.at(SAT_INDEX).first =
+           prevUplinkMbps.at(SAT_INDEX).second;
+          prevUplinkMbps.at(SAT_INDEX).second = uplinkMbps;
         }
       }
     }
-    // Update simulation to the next time step
-    dateTime.update(hourStep,minuteStep,secondStep,nsStep);
+  }
+  // Quiescent while no ground station has a link
+  uint64_t getQuiescentSteps(cote::Simulation* const /*simulation*/) override {
+    std::vector<std::size_t>& gndCurrSats = this->scenario->gndCurrSats;
+    for(std::size_t i=0; i<gndCurrSats.size(); i++) {
+      if(gndCurrSats.at(i)!=cote::EntityStore::NO_INDEX) {
+        return 1;
+      }
+    }
+    return std::numeric_limits<uint64_t>::max();
+  }
+  void skip(
+   cote::Simulation* const /*simulation*/, const uint64_t& /*steps*/
+  ) override {
+    //// Without links there are no channels
+    this->scenario->crosslinks.clear();
+    this->scenario->downlinks.clear();
+    this->scenario->uplinks.clear();
+  }
+private:
+  Scenario* scenario; // not owned, should not be deleted
+  cote::Log* log;     // singleton, should not be deleted
+};
+
+// Runs after propagation: advances the camera and computer timers and moves
+// each radio and sensor with its satellite or ground station
+class DevicePhase : public cote::IQuiescentPhase {
+public:
+  DevicePhase(Scenario* const scenario) : scenario(scenario) {}
+  void step(cote::Simulation* const simulation) override {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<cote::StateMachine>& cameraSms = this->scenario->cameraSms;
+    std::vector<cote::StateMachine>& computerSms = this->scenario->computerSms;
+    std::vector<cote::StateMachine::StateId>& cameraImagingIds =
+     this->scenario->cameraImagingIds;
+    std::vector<cote::StateMachine::StateId>& cameraReadoutIds =
+     this->scenario->cameraReadoutIds;
+    std::vector<cote::StateMachine::StateId>& computerWorkIds =
+     this->scenario->computerWorkIds;
+    std::vector<cote::Receiver>& satRxs = this->scenario->satRxs;
+    std::vector<cote::Transmitter>& satTxs = this->scenario->satTxs;
+    std::vector<cote::Sensor>& sensors = this->scenario->sensors;
+    std::vector<cote::GroundStation>& groundStations =
+     this->scenario->groundStations;
+    std::vector<cote::Receiver>& gndRxs = this->scenario->gndRxs;
+    std::vector<cote::Transmitter>& gndTxs = this->scenario->gndTxs;
+    const uint8_t hourStep = simulation->getHourStep();
+    const uint8_t minuteStep = simulation->getMinuteStep();
+    const uint8_t secondStep = simulation->getSecondStep();
+    const uint32_t nanosecondStep = simulation->getNanosecondStep();
+    simulation->parallelFor(
+     satellites.size(),
+     [&](std::size_t i) {
+      const std::array<double,3> SAT_ECI_POSN_KM =
+       getSatECIPosn(this->scenario,i);
+      if(
+       cameraSms.at(i).getCurrentStateId()==
+       cameraImagingIds.at(i)
+      ) {
+        double imagingTimeS =
+         cameraSms.at(i).getVariableValue("imaging-time-s");
+        cameraSms.at(i).setVariableValue(
+         "imaging-time-s",imagingTimeS+simulation->getStepSizeS()
+        );
+      } else if(
+       cameraSms.at(i).getCurrentStateId()==
+       cameraReadoutIds.at(i)
+      ) {
+        double readoutTimeS =
+         cameraSms.at(i).getVariableValue("readout-time-s");
+        cameraSms.at(i).setVariableValue(
+         "readout-time-s",readoutTimeS+simulation->getStepSizeS()
+        );
+      }
+      if(
+       computerSms.at(i).getCurrentStateId()==
+       computerWorkIds.at(i)
+      ) {
+        double workTimeS =
+         computerSms.at(i).getVariableValue("work-time-s");
+        computerSms.at(i).setVariableValue(
+         "work-time-s",workTimeS+simulation->getStepSizeS()
+        );
+      }
+      satRxs.at(i).setPosn(SAT_ECI_POSN_KM);
+      satRxs.at(i).update(hourStep,minuteStep,secondStep,nanosecondStep);
+      satTxs.at(i).setPosn(SAT_ECI_POSN_KM);
+      satTxs.at(i).update(hourStep,minuteStep,secondStep,nanosecondStep);
+      sensors.at(i).setECIPosn(SAT_ECI_POSN_KM);
+      sensors.at(i).update(hourStep,minuteStep,secondStep,nanosecondStep);
+     }
+    );
+    for(std::size_t i=0; i<groundStations.size(); i++) {
+      const std::array<double,3> GND_ECI_POSN_KM =
+       getGndECIPosn(this->scenario,i);
+      gndRxs.at(i).setPosn(GND_ECI_POSN_KM);
+      gndRxs.at(i).update(hourStep,minuteStep,secondStep,nanosecondStep);
+      gndTxs.at(i).setPosn(GND_ECI_POSN_KM);
+      gndTxs.at(i).update(hourStep,minuteStep,secondStep,nanosecondStep);
+    }
+  }
+  // Quiescent until a running timer could reach a value that a guard of its
+  // state machine compares it against; PayloadPhase bounds the steps until a
+  // timer completes a task
+  uint64_t getQuiescentSteps(cote::Simulation* const simulation) override {
+    std::vector<cote::StateMachine>& cameraSms = this->scenario->cameraSms;
+    std::vector<cote::StateMachine>& computerSms = this->scenario->computerSms;
+    std::vector<cote::StateMachine::StateId>& cameraImagingIds =
+     this->scenario->cameraImagingIds;
+    std::vector<cote::StateMachine::StateId>& cameraReadoutIds =
+     this->scenario->cameraReadoutIds;
+    std::vector<cote::StateMachine::StateId>& computerWorkIds =
+     this->scenario->computerWorkIds;
+    const double STEP_S = simulation->getStepSizeS();
+    uint64_t steps = std::numeric_limits<uint64_t>::max();
+    for(std::size_t i=0; i<cameraSms.size() && steps>1; i++) {
+      if(cameraSms.at(i).getCurrentStateId()==cameraImagingIds.at(i)) {
+        steps = std::min(
+         steps,calcTimerSteps(cameraSms.at(i),"imaging-time-s",STEP_S)
+        );
+      } else if(cameraSms.at(i).getCurrentStateId()==cameraReadoutIds.at(i)) {
+        steps = std::min(
+         steps,calcTimerSteps(cameraSms.at(i),"readout-time-s",STEP_S)
+        );
+      }
+      if(computerSms.at(i).getCurrentStateId()==computerWorkIds.at(i)) {
+        steps = std::min(
+         steps,calcTimerSteps(computerSms.at(i),"work-time-s",STEP_S)
+        );
+      }
+    }
+    return steps;
+  }
+  void skip(
+   cote::Simulation* const simulation, const uint64_t& steps
+  ) override {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<cote::StateMachine>& cameraSms = this->scenario->cameraSms;
+    std::vector<cote::StateMachine>& computerSms = this->scenario->computerSms;
+    std::vector<cote::StateMachine::StateId>& cameraImagingIds =
+     this->scenario->cameraImagingIds;
+    std::vector<cote::StateMachine::StateId>& cameraReadoutIds =
+     this->scenario->cameraReadoutIds;
+    std::vector<cote::StateMachine::StateId>& computerWorkIds =
+     this->scenario->computerWorkIds;
+    std::vector<cote::Receiver>& satRxs = this->scenario->satRxs;
+    std::vector<cote::Transmitter>& satTxs = this->scenario->satTxs;
+    std::vector<cote::Sensor>& sensors = this->scenario->sensors;
+    std::vector<cote::GroundStation>& groundStations =
+     this->scenario->groundStations;
+    std::vector<cote::Receiver>& gndRxs = this->scenario->gndRxs;
+    std::vector<cote::Transmitter>& gndTxs = this->scenario->gndTxs;
+    const double STEP_S = simulation->getStepSizeS();
+    //// The entities have already been propagated over the skipped steps, and
+    //// radio and sensor updates only act on a sense trigger, which a
+    //// quiescent payload does not set
+    for(std::size_t i=0; i<satellites.size(); i++) {
+      if(cameraSms.at(i).getCurrentStateId()==cameraImagingIds.at(i)) {
+        advanceTimer(cameraSms.at(i),"imaging-time-s",STEP_S,steps);
+      } else if(cameraSms.at(i).getCurrentStateId()==cameraReadoutIds.at(i)) {
+        advanceTimer(cameraSms.at(i),"readout-time-s",STEP_S,steps);
+      }
+      if(computerSms.at(i).getCurrentStateId()==computerWorkIds.at(i)) {
+        advanceTimer(computerSms.at(i),"work-time-s",STEP_S,steps);
+      }
+      const std::array<double,3> SAT_ECI_POSN_KM =
+       getSatECIPosn(this->scenario,i);
+      satRxs.at(i).setPosn(SAT_ECI_POSN_KM);
+      satTxs.at(i).setPosn(SAT_ECI_POSN_KM);
+      sensors.at(i).setECIPosn(SAT_ECI_POSN_KM);
+    }
+    for(std::size_t i=0; i<groundStations.size(); i++) {
+      const std::array<double,3> GND_ECI_POSN_KM =
+       getGndECIPosn(this->scenario,i);
+      gndRxs.at(i).setPosn(GND_ECI_POSN_KM);
+      gndTxs.at(i).setPosn(GND_ECI_POSN_KM);
+    }
+  }
+private:
+  // Returns the number of steps over which advancing the timer does not change
+  // how it compares with the guards out of the current state
+  static uint64_t calcTimerSteps(
+   const cote::StateMachine& stateMachine, const std::string& timer,
+   const double& stepS
+  ) {
+    const double timeS = stateMachine.getVariableValue(timer);
+    const std::vector<double> values = stateMachine.getConditionValues(timer);
+    uint64_t steps = std::numeric_limits<uint64_t>::max();
+    for(std::size_t i=0; i<values.size(); i++) {
+      if(values.at(i)>=timeS) {
+        steps = std::min(
+         steps,cote::util::calcStepsBelow(values.at(i)-timeS,stepS)
+        );
+      }
+    }
+    return steps;
+  }
+  // Adds the time step to the timer once per step, as step does, so that the
+  // sum is rounded the same way
+  static void advanceTimer(
+   cote::StateMachine& stateMachine, const std::string& timer,
+   const double& stepS, const uint64_t& steps
+  ) {
+    double timeS = stateMachine.getVariableValue(timer);
+    for(uint64_t i=0; i<steps; i++) {
+      timeS = timeS+stepS;
+    }
+    stateMachine.setVariableValue(timer,timeS);
+  }
+  Scenario* scenario; // not owned, should not be deleted
+};
+
+// Updates the node voltages and steps the state machines of each satellite
+class PowerPhase : public cote::IQuiescentPhase {
+public:
+  // State intervals are appended to stateIntervalFile, if not NULL
+  PowerPhase(
+   Scenario* const scenario, cote::Log* const log,
+   std::ostream* const stateIntervalFile
+  ) : scenario(scenario), log(log), stateIntervalFile(stateIntervalFile) {}
+  void step(cote::Simulation* const simulation) override {
+    this->stepPower(simulation,simulation->getStepCount());
+  }
+  // The node voltages change every step, so the phase is quiescent while no
+  // state machine changes state: after a step in which none did, until a node
+  // would brown out or its voltage would cross a guard threshold. The voltages
+  // are found by charging a copy of the power bus as the skipped steps would,
+  // or in closed form from the time to each node's next event
+  uint64_t getQuiescentSteps(cote::Simulation* const simulation) override {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<double>& sunOcclusionFactors =
+     this->scenario->sunOcclusionFactors;
+    cote::PowerBus& powerBus = this->scenario->powerBus;
+    if(this->settled.size()!=satellites.size()) {
+      return 1;
+    }
+    for(std::size_t i=0; i<this->settled.size(); i++) {
+      if(this->settled.at(i)==0) {
+        return 1;
+      }
+    }
+    // The node voltage each guard last saw and the values it is compared with
+    std::vector<std::vector<std::pair<double,std::vector<double>>>> guards(
+     satellites.size()
+    );
     for(std::size_t i=0; i<satellites.size(); i++) {
-      const uint32_t SAT_ID = satellites.at(i).getID();
-      satellites.at(i).update(hourStep,minuteStep,secondStep,nsStep);
-      const std::array<double,3> SAT_ECI_POSN_KM =
-       satellites.at(i).getECIPosn();
-      if(satId2CameraSm[SAT_ID]->getCurrentState()=="IMAGING") {
-        double imagingTimeS =
-         satId2CameraSm[SAT_ID]->getVariableValue("imaging-time-s");
-        satId2CameraSm[SAT_ID]->setVariableValue(
-         "imaging-time-s",imagingTimeS+totalStepInSec
+      const std::vector<cote::StateMachine*> satSms = {
+       &(this->scenario->adacsSms.at(i)), &(this->scenario->cameraSms.at(i)),
+       &(this->scenario->computerSms.at(i)), &(this->scenario->rxSms.at(i)),
+       &(this->scenario->txSms.at(i))
+      };
+      for(std::size_t j=0; j<satSms.size(); j++) {
+        guards.at(i).push_back(std::make_pair(
+         satSms.at(j)->getVariableValue("node-voltage"),
+         satSms.at(j)->getConditionValues("node-voltage")
+        ));
+      }
+    }
+    const uint64_t limit = simulation->getQuiescentStepLimit();
+    if(this->scenario->closedFormPower) {
+      //// Skipped steps end before the earliest event; an event that falls
+      //// exactly on a step ends the skip before that step
+      uint64_t steps = limit;
+      for(std::size_t i=0; i<guards.size() && steps>0; i++) {
+        std::vector<double> thresholds;
+        for(std::size_t j=0; j<guards.at(i).size(); j++) {
+          thresholds.insert(
+           thresholds.end(), guards.at(i).at(j).second.begin(),
+           guards.at(i).at(j).second.end()
+          );
+        }
+        const double eventSteps = powerBus.calcTimeToNextEvent(i,thresholds)/
+         simulation->getStepSizeS();
+        if(eventSteps<static_cast<double>(steps)) {
+          steps = static_cast<uint64_t>(
+           std::max(0.0,std::ceil(eventSteps)-1.0)
+          );
+        }
+      }
+      return steps;
+    }
+    cote::PowerBus lookahead(powerBus);
+    uint64_t steps = 0;
+    while(steps<limit) {
+      for(std::size_t i=0; i<satellites.size(); i++) {
+        lookahead.setIrradianceWpM2(
+         i,calcIrradianceWPerM2(sunOcclusionFactors.at(i))
         );
-      } else if(satId2CameraSm[SAT_ID]->getCurrentState()=="READOUT") {
-        double readoutTimeS =
-         satId2CameraSm[SAT_ID]->getVariableValue("readout-time-s");
-        satId2CameraSm[SAT_ID]->setVariableValue(
-         "readout-time-s",readoutTimeS+totalStepInSec
+      }
+      lookahead.clipSolarCurrent();
+      lookahead.updateCharge(simulation->getStepSizeS());
+      if(lookahead.updateNodeVoltage()>0) {
+        return steps;
+      }
+      for(std::size_t i=0; i<guards.size(); i++) {
+        const double nodeVoltage = lookahead.getNodeVoltage(i);
+        for(std::size_t j=0; j<guards.at(i).size(); j++) {
+          const double guardVoltage = guards.at(i).at(j).first;
+          const std::vector<double>& values = guards.at(i).at(j).second;
+          for(std::size_t k=0; k<values.size(); k++) {
+            if(
+             (nodeVoltage<values.at(k))!=(guardVoltage<values.at(k)) ||
+             (nodeVoltage>values.at(k))!=(guardVoltage>values.at(k))
+            ) {
+              return steps;
+            }
+          }
+        }
+      }
+      steps += 1;
+    }
+    return steps;
+  }
+  // Replays the solar array, charge and node voltage updates of each skipped
+  // step, including those of the environment and charge phases; in closed
+  // form, the charge is advanced over all skipped steps at once and the phase
+  // is run only as of the last of them
+  void skip(
+   cote::Simulation* const simulation, const uint64_t& steps
+  ) override {
+    std::vector<double>& sunOcclusionFactors =
+     this->scenario->sunOcclusionFactors;
+    cote::PowerBus& powerBus = this->scenario->powerBus;
+    if(this->scenario->closedFormPower && steps>0) {
+      for(std::size_t i=0; i<sunOcclusionFactors.size(); i++) {
+        powerBus.setIrradianceWpM2(
+         i,calcIrradianceWPerM2(sunOcclusionFactors.at(i))
         );
       }
-      if(satId2ComputerSm[SAT_ID]->getCurrentState()=="WORK") {
-        double workTimeS =
-         satId2ComputerSm[SAT_ID]->getVariableValue("work-time-s");
-        satId2ComputerSm[SAT_ID]->setVariableValue(
-         "work-time-s",workTimeS+totalStepInSec
+      powerBus.advance(static_cast<double>(steps)*simulation->getStepSizeS());
+      this->stepPower(simulation,simulation->getStepCount()+steps-1);
+      return;
+    }
+    for(uint64_t k=0; k<steps; k++) {
+      for(std::size_t i=0; i<sunOcclusionFactors.size(); i++) {
+        powerBus.setIrradianceWpM2(
+         i,calcIrradianceWPerM2(sunOcclusionFactors.at(i))
         );
       }
-      satId2Rx[SAT_ID]->setPosn(SAT_ECI_POSN_KM);
-      satId2Rx[SAT_ID]->update(hourStep,minuteStep,secondStep,nsStep);
-      satId2Tx[SAT_ID]->setPosn(SAT_ECI_POSN_KM);
-      satId2Tx[SAT_ID]->update(hourStep,minuteStep,secondStep,nsStep);
-      satId2Sensor[SAT_ID]->setECIPosn(SAT_ECI_POSN_KM);
-      satId2Sensor[SAT_ID]->update(hourStep,minuteStep,secondStep,nsStep);
-      double powerW =
-       satId2AdacsSm[SAT_ID]->getVariableValue("power-w")+
-       satId2CameraSm[SAT_ID]->getVariableValue("power-w")+
-       satId2ComputerSm[SAT_ID]->getVariableValue("power-w")+
-       satId2RxSm[SAT_ID]->getVariableValue("power-w")+
-       satId2TxSm[SAT_ID]->getVariableValue("power-w");
-      double nodeVoltageDiscriminant = cote::util::calcNodeVoltageDiscriminant(
-       satId2Capacitor[SAT_ID]->getChargeCoulomb(),
-       satId2Capacitor[SAT_ID]->getCapacitanceFarad(),
-       satId2SolarArray[SAT_ID]->getCurrentAmpere(),
-       satId2Capacitor[SAT_ID]->getEsrOhm(), powerW
-      );
-      if(nodeVoltageDiscriminant<0.0) { // if power draw too high, turn all off
-        satId2AdacsSm[SAT_ID]->setCurrentState("OFF");
-        satId2CameraSm[SAT_ID]->setCurrentState("OFF");
-        satId2ComputerSm[SAT_ID]->setCurrentState("OFF");
-        satId2RxSm[SAT_ID]->setCurrentState("OFF");
-        satId2TxSm[SAT_ID]->setCurrentState("OFF");
-        powerW =
-         satId2AdacsSm[SAT_ID]->getVariableValue("power-w")+
-         satId2CameraSm[SAT_ID]->getVariableValue("power-w")+
-         satId2ComputerSm[SAT_ID]->getVariableValue("power-w")+
-         satId2RxSm[SAT_ID]->getVariableValue("power-w")+
-         satId2TxSm[SAT_ID]->getVariableValue("power-w");
-        nodeVoltageDiscriminant = cote::util::calcNodeVoltageDiscriminant(
-         satId2Capacitor[SAT_ID]->getChargeCoulomb(),
-         satId2Capacitor[SAT_ID]->getCapacitanceFarad(),
-         satId2SolarArray[SAT_ID]->getCurrentAmpere(),
-         satId2Capacitor[SAT_ID]->getEsrOhm(), powerW
+      powerBus.clipSolarCurrent();
+      powerBus.updateCharge(simulation->getStepSizeS());
+      this->stepPower(simulation,simulation->getStepCount()+k);
+    }
+  }
+private:
+  // Runs the phase as of the given step count
+  void stepPower(
+   cote::Simulation* const simulation, const uint64_t& stepCount
+  ) {
+    std::vector<cote::Satellite>& satellites = this->scenario->satellites;
+    std::vector<std::pair<double,double>>& prevNodeVoltages =
+     this->scenario->prevNodeVoltages;
+    std::vector<double>& sunOcclusionFactors =
+     this->scenario->sunOcclusionFactors;
+    std::vector<cote::StateMachine>& adacsSms = this->scenario->adacsSms;
+    std::vector<cote::StateMachine>& cameraSms = this->scenario->cameraSms;
+    std::vector<cote::StateMachine>& computerSms = this->scenario->computerSms;
+    std::vector<cote::StateMachine>& rxSms = this->scenario->rxSms;
+    std::vector<cote::StateMachine>& txSms = this->scenario->txSms;
+    std::vector<cote::LoadAggregator>& loadAggregators =
+     this->scenario->loadAggregators;
+    std::vector<cote::StateMachine::StateId>& txTxIds = this->scenario->txTxIds;
+    cote::PowerBus& powerBus = this->scenario->powerBus;
+    std::vector<SatelliteLogs>& satLogs = this->scenario->satLogs;
+    //// The time of this step's logs is only formatted if they are kept
+    const std::string STEP = this->log->isEnabled(cote::LogLevel::INFO) ?
+     std::to_string(stepCount) : std::string();
+    const int64_t STEP_COUNT = static_cast<int64_t>(stepCount);
+    // Simulate node voltage for all satellites
+    powerBus.updateNodeVoltage();
+    //// Satellites are stepped in parallel, so each logs to its own buffer;
+    //// the buffers are written in satellite order to match a serial run
+    this->logBuffers.resize(satellites.size(),cote::LogBuffer(this->log));
+    this->stateIntervalRows.resize(satellites.size());
+    this->settled.resize(satellites.size(),0);
+    simulation->parallelFor(
+     satellites.size(),
+     [&](std::size_t i) {
+      cote::LogBuffer& logBuffer = this->logBuffers.at(i);
+      const std::array<cote::StateMachine::StateId,5> prevStates = {
+       adacsSms.at(i).getCurrentStateId(), cameraSms.at(i).getCurrentStateId(),
+       computerSms.at(i).getCurrentStateId(), rxSms.at(i).getCurrentStateId(),
+       txSms.at(i).getCurrentStateId()
+      };
+      // State changes below are stamped with the step count
+      adacsSms.at(i).setTime(STEP_COUNT);
+      cameraSms.at(i).setTime(STEP_COUNT);
+      computerSms.at(i).setTime(STEP_COUNT);
+      rxSms.at(i).setTime(STEP_COUNT);
+      txSms.at(i).setTime(STEP_COUNT);
+      const bool brownout = powerBus.isBrownout(i);
+      if(brownout) { // if power draw too high, turn all off
+        adacsSms.at(i).setCurrentState("OFF");
+        cameraSms.at(i).setCurrentState("OFF");
+        computerSms.at(i).setCurrentState("OFF");
+        rxSms.at(i).setCurrentState("OFF");
+        txSms.at(i).setCurrentState("OFF");
+        powerBus.setLoadPowerW(
+         i,loadAggregators.at(i).getTotalPowerW()
         );
+        powerBus.updateNodeVoltage(i);
       }
-      const double nodeVoltage = cote::util::calcNodeVoltage(
-       nodeVoltageDiscriminant, satId2Capacitor[SAT_ID]->getChargeCoulomb(),
-       satId2Capacitor[SAT_ID]->getCapacitanceFarad(),
-       satId2SolarArray[SAT_ID]->getCurrentAmpere(),
-       satId2Capacitor[SAT_ID]->getEsrOhm()
+      const double nodeVoltage = powerBus.getNodeVoltage(i);
+      //// Each satellite has its own metric, so the tasks do not contend
+      this->scenario->metrics.record(
+       this->scenario->nodeVoltageMetrics.at(i),nodeVoltage
       );
       // Set node voltage for all state machines
-      satId2AdacsSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-      satId2CameraSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-      satId2ComputerSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-      satId2RxSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-      satId2TxSm[SAT_ID]->setVariableValue("node-voltage",nodeVoltage);
-      satId2NodeVoltage[SAT_ID] = nodeVoltage;
+      adacsSms.at(i).setVariableValue("node-voltage",nodeVoltage);
+      cameraSms.at(i).setVariableValue("node-voltage",nodeVoltage);
+      computerSms.at(i).setVariableValue("node-voltage",nodeVoltage);
+      rxSms.at(i).setVariableValue("node-voltage",nodeVoltage);
+      txSms.at(i).setVariableValue("node-voltage",nodeVoltage);
       // Log node voltage when the sign of slope surrogate changes
       // NOTE: oldest first second current
       double prevDiff =
-       satId2PrevNodeVoltages[SAT_ID].second-
-       satId2PrevNodeVoltages[SAT_ID].first;
+       prevNodeVoltages.at(i).second-
+       prevNodeVoltages.at(i).first;
       int prevSign = (prevDiff>0.0) ? 1 : ((prevDiff<0.0) ? -1 : 0);
-      double currDiff = nodeVoltage-satId2PrevNodeVoltages[SAT_ID].second;
+      double currDiff = nodeVoltage-prevNodeVoltages.at(i).second;
       int currSign = (currDiff>0.0) ? 1 : ((currDiff<0.0) ? -1 : 0);
       if(prevSign!=currSign) {
-        std::ostringstream oss;
-        oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-        log.meas(
+        COTE_MEAS(
+         logBuffer,
          cote::LogLevel::INFO,
          //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-node-voltage"),
-         std::to_string(nodeVoltage)
+         STEP,
+         satLogs.at(i).nodeVoltage,
+         nodeVoltage
         );
       }
       // Update node voltage history regardless
-      satId2PrevNodeVoltages[SAT_ID].first =
-       satId2PrevNodeVoltages[SAT_ID].second;
-      satId2PrevNodeVoltages[SAT_ID].second = nodeVoltage;
+      prevNodeVoltages.at(i).first =
+       prevNodeVoltages.at(i).second;
+      prevNodeVoltages.at(i).second = nodeVoltage;
       // Set the shade value for all state machines
-      if(satId2SunOcclusionFactor[SAT_ID]!=0.0) {
-        satId2AdacsSm[SAT_ID]->setVariableValue("shade",1.0);
-        satId2CameraSm[SAT_ID]->setVariableValue("shade",1.0);
-        satId2ComputerSm[SAT_ID]->setVariableValue("shade",1.0);
-        satId2RxSm[SAT_ID]->setVariableValue("shade",1.0);
-        satId2TxSm[SAT_ID]->setVariableValue("shade",1.0);
+      if(sunOcclusionFactors.at(i)!=0.0) {
+        adacsSms.at(i).setVariableValue("shade",1.0);
+        cameraSms.at(i).setVariableValue("shade",1.0);
+        computerSms.at(i).setVariableValue("shade",1.0);
+        rxSms.at(i).setVariableValue("shade",1.0);
+        txSms.at(i).setVariableValue("shade",1.0);
       } else {
-        satId2AdacsSm[SAT_ID]->setVariableValue("shade",0.0);
-        satId2CameraSm[SAT_ID]->setVariableValue("shade",0.0);
-        satId2ComputerSm[SAT_ID]->setVariableValue("shade",0.0);
-        satId2RxSm[SAT_ID]->setVariableValue("shade",0.0);
-        satId2TxSm[SAT_ID]->setVariableValue("shade",0.0);
+        adacsSms.at(i).setVariableValue("shade",0.0);
+        cameraSms.at(i).setVariableValue("shade",0.0);
+        computerSms.at(i).setVariableValue("shade",0.0);
+        rxSms.at(i).setVariableValue("shade",0.0);
+        txSms.at(i).setVariableValue("shade",0.0);
       }
-      // Update state machine states and log state if changed
-      satId2PrevAdacsState[SAT_ID] =
-       satId2AdacsSm[SAT_ID]->getCurrentState();
-      satId2PrevCameraState[SAT_ID] =
-       satId2CameraSm[SAT_ID]->getCurrentState();
-      satId2PrevComputerState[SAT_ID] =
-       satId2ComputerSm[SAT_ID]->getCurrentState();
-      satId2PrevRxState[SAT_ID] =
-       satId2RxSm[SAT_ID]->getCurrentState();
-      satId2PrevTxState[SAT_ID] =
-       satId2TxSm[SAT_ID]->getCurrentState();
-      satId2AdacsSm[SAT_ID]->updateState();
-      satId2CameraSm[SAT_ID]->updateState();
-      satId2RxSm[SAT_ID]->updateState();
-      satId2TxSm[SAT_ID]->updateState();
-      if(satId2TxSm[SAT_ID]->getCurrentState()=="TX") {
-        satId2ComputerSm[SAT_ID]->setVariableValue("comms",1.0);
+      // Update state machine states
+      adacsSms.at(i).updateState();
+      cameraSms.at(i).updateState();
+      rxSms.at(i).updateState();
+      txSms.at(i).updateState();
+      if(txSms.at(i).getCurrentStateId()==txTxIds.at(i)) {
+        computerSms.at(i).setVariableValue("comms",1.0);
       } else {
-        satId2ComputerSm[SAT_ID]->setVariableValue("comms",0.0);
+        computerSms.at(i).setVariableValue("comms",0.0);
       }
-      satId2ComputerSm[SAT_ID]->updateState();
-      if(
-       satId2AdacsSm[SAT_ID]->getCurrentState()!=satId2PrevAdacsState[SAT_ID]
-      ) {
-        std::ostringstream oss;
-        oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-        log.meas(
-         cote::LogLevel::INFO,
-         //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-adacs-state"),
-         std::string(satId2AdacsSm[SAT_ID]->getCurrentState())
-        );
+      computerSms.at(i).updateState();
+      // Record the summed load for the next capacitor charge update
+      powerBus.setLoadPowerW(i,loadAggregators.at(i).getTotalPowerW());
+      // Record the state intervals that ended before this step
+      recordSatelliteStateIntervals(
+       this->scenario, i, this->log,
+       (this->stateIntervalFile==NULL) ?
+        NULL : &(this->stateIntervalRows.at(i))
+      );
+      // Whether the state machines were left in a stable state
+      const std::array<cote::StateMachine::StateId,5> currStates = {
+       adacsSms.at(i).getCurrentStateId(), cameraSms.at(i).getCurrentStateId(),
+       computerSms.at(i).getCurrentStateId(), rxSms.at(i).getCurrentStateId(),
+       txSms.at(i).getCurrentStateId()
+      };
+      this->settled.at(i) = (!brownout && currStates==prevStates) ? 1 : 0;
+     }
+    );
+    for(std::size_t i=0; i<this->logBuffers.size(); i++) {
+      this->logBuffers.at(i).writeTo(this->log);
+      if(this->stateIntervalFile!=NULL) {
+        *(this->stateIntervalFile) << this->stateIntervalRows.at(i);
+        this->stateIntervalRows.at(i).clear();
       }
+    }
+  }
+  Scenario* scenario;                          // not owned
+  cote::Log* log;                              // singleton, not owned
+  std::ostream* stateIntervalFile;             // not owned
+  std::vector<cote::LogBuffer> logBuffers;     // one per satellite
+  std::vector<std::string> stateIntervalRows;  // one per satellite
+  std::vector<uint8_t> settled;                // one per satellite; 1 if no
+                                               // state changed in the most
+                                               // recent step
+};
+
+int main(int argc, char** argv) {
+  // Set up configuration variables
+  std::vector<std::filesystem::path> satelliteFiles;     // satellite TLEs
+  std::vector<std::filesystem::path> solarArrayFiles;    // solar array configs
+  std::vector<std::filesystem::path> capacitorFiles;     // capacitor configs
+  std::vector<std::filesystem::path> adacsSMFiles;       // ADACS power states
+  std::vector<std::filesystem::path> cameraSMFiles;      // camera power states
+  std::vector<std::filesystem::path> computerSMFiles;    // computer power state
+  std::vector<std::filesystem::path> rxSatSMFiles;       // sat RX power states
+  std::vector<std::filesystem::path> txSatSMFiles;       // sat TX power states
+  std::vector<std::filesystem::path> rxSatFiles;         // sat RX configs
+  std::vector<std::filesystem::path> txSatFiles;         // sat TX configs
+  std::vector<std::filesystem::path> sensorSatFiles;     // bits per sense etc
+  std::vector<std::filesystem::path> programSatFiles;    // user applications
+  std::vector<std::filesystem::path> constellationFiles; // constelation configs
+  std::vector<std::filesystem::path> groundStationFiles; // gnd locations
+  std::vector<std::filesystem::path> rxGndFiles;         // gnd RX configs
+  std::vector<std::filesystem::path> txGndFiles;         // gnd TX configs
+  std::filesystem::path logFormatFile;                   // optional format
+  std::filesystem::path logBudgetFile;                   // optional budget
+  std::filesystem::path logFilterFile;                   // optional selection
+  std::filesystem::path powerIntegrationFile;            // optional method
+  std::filesystem::path orbitPeriodFile;                 // optional period
+  std::filesystem::path logDirectory;                    // logs destination
+  // Parse command line arguments
+  if(argc!=3) {
+    std::cout << "Usage: " << argv[0]
+              << " /path/to/configuration/"
+              << " /path/to/logs/"
+              << std::endl;
+    std::exit(EXIT_SUCCESS);
+  } else {
+    // Populate configuration variables
+    std::filesystem::path configurationDir(argv[1]);
+    std::filesystem::directory_iterator it(configurationDir);
+    while(it!=std::filesystem::end(it)) {
+      std::string pathStr = it->path().string();
       if(
-       satId2CameraSm[SAT_ID]->getCurrentState()!=satId2PrevCameraState[SAT_ID]
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-4),4)==
+       ".sat"
       ) {
-        std::ostringstream oss;
-        oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-        log.meas(
-         cote::LogLevel::INFO,
-         //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-camera-state"),
-         std::string(satId2CameraSm[SAT_ID]->getCurrentState())
-        );
-      }
-      if(
-       satId2ComputerSm[SAT_ID]->getCurrentState()!=
-       satId2PrevComputerState[SAT_ID]
+        satelliteFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-30),16)==
+       "solar-array-sat-"
       ) {
-        std::ostringstream oss;
-        oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-        log.meas(
-         cote::LogLevel::INFO,
-         //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-computer-state"),
-         std::string(satId2ComputerSm[SAT_ID]->getCurrentState())
-        );
-      }
-      if(
-       satId2RxSm[SAT_ID]->getCurrentState()!=satId2PrevRxState[SAT_ID]
+        solarArrayFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-28),14)==
+       "capacitor-sat-"
       ) {
-        std::ostringstream oss;
-        oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-        log.meas(
-         cote::LogLevel::INFO,
-         //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-rx-state"),
-         std::string(satId2RxSm[SAT_ID]->getCurrentState())
-        );
-      }
-      if(
-       satId2TxSm[SAT_ID]->getCurrentState()!=satId2PrevTxState[SAT_ID]
+        capacitorFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-27),13)==
+       "adacs-sm-sat-"
       ) {
-        std::ostringstream oss;
-        oss << "sat-" << std::setw(10) << std::setfill('0') << SAT_ID;
-        log.meas(
-         cote::LogLevel::INFO,
-         //dateTime.toString(),
-         std::to_string(stepCount),
-         std::string(oss.str()+"-tx-state"),
-         std::string(satId2TxSm[SAT_ID]->getCurrentState())
-        );
+        adacsSMFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-28),14)==
+       "camera-sm-sat-"
+      ) {
+        cameraSMFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-30),16)==
+       "computer-sm-sat-"
+      ) {
+        computerSMFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-24),10)==
+       "rx-sm-sat-"
+      ) {
+        rxSatSMFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-24),10)==
+       "tx-sm-sat-"
+      ) {
+        txSatSMFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-21),7)==
+       "rx-sat-"
+      ) {
+        rxSatFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-21),7)==
+       "tx-sat-"
+      ) {
+        txSatFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-25),11)==
+       "sensor-sat-"
+      ) {
+        sensorSatFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-26),12)==
+       "program-sat-"
+      ) {
+        programSatFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-29),14)==
+       "constellation-"
+      ) {
+        constellationFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-4),4)==
+       ".gnd"
+      ) {
+        groundStationFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-21),7)==
+       "rx-gnd-"
+      ) {
+        rxGndFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-21),7)==
+       "tx-gnd-"
+      ) {
+        txGndFiles.push_back(it->path());
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-14),14)==
+       "log-format.dat"
+      ) {
+        logFormatFile = it->path();
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-14),14)==
+       "log-budget.dat"
+      ) {
+        logBudgetFile = it->path();
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-14),14)==
+       "log-filter.dat"
+      ) {
+        logFilterFile = it->path();
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-21),21)==
+       "power-integration.dat"
+      ) {
+        powerIntegrationFile = it->path();
+      } else if(
+       pathStr.substr(std::max(0,static_cast<int>(pathStr.size())-16),16)==
+       "orbit-period.dat"
+      ) {
+        orbitPeriodFile = it->path();
+      }
+      it++;
+    }
+    // Set log directory
+    logDirectory = std::filesystem::path(argv[2]);
+  }
+  // Set up log
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log::Format logFormat = cote::Log::Format::CSV;
+  if(!logFormatFile.empty()) {
+    std::ifstream logFormatHandle(logFormatFile.string());
+    std::string line = "";
+    std::getline(logFormatHandle,line); // Read header
+    std::getline(logFormatHandle,line); // Read values
+    logFormatHandle.close();
+    if(line.substr(0,6)=="binary") {
+      logFormat = cote::Log::Format::BINARY;
+    } else if(line.substr(0,4)=="long") {
+      logFormat = cote::Log::Format::LONG;
+    } else if(line.substr(0,4)=="none") {
+      // Only the summary file is written, e.g. for design sweeps
+      levels = {cote::LogLevel::NONE};
+    }
+  }
+  cote::Log log(levels,logDirectory.string(),logFormat);
+  if(!logBudgetFile.empty()) {
+    std::ifstream logBudgetHandle(logBudgetFile.string());
+    std::string line = "";
+    std::getline(logBudgetHandle,line); // Read header
+    std::getline(logBudgetHandle,line); // Read values
+    logBudgetHandle.close();
+    const double megabytes = std::stod(line);
+    log.setMemoryBudget(static_cast<std::size_t>(megabytes*1000000.0));
+  }
+  if(!logFilterFile.empty() && !log.readFilter(logFilterFile.string())) {
+    std::cout << "Skipped malformed rows of " << logFilterFile.string()
+              << std::endl;
+  }
+  // Set up the simulation, which reads the date and time, the time step, and
+  // the step count and owns the clock given to every component
+  cote::Simulation simulation(std::string(argv[1]),0,&log);
+  cote::DateTime* const dateTime = simulation.getDateTime();
+  std::string line = "";
+  // Set up the components and data shared by the simulation phases
+  Scenario scenario(&log);
+  if(!powerIntegrationFile.empty()) {
+    std::ifstream powerIntegrationHandle(powerIntegrationFile.string());
+    line = "";
+    std::getline(powerIntegrationHandle,line); // Read header
+    std::getline(powerIntegrationHandle,line); // Read values
+    powerIntegrationHandle.close();
+    scenario.closedFormPower = (line.substr(0,11)=="closed-form");
+  }
+  // Set up satellites
+  std::vector<cote::Satellite>& satellites = scenario.satellites;
+  for(std::size_t i=0; i<satelliteFiles.size(); i++) {
+    std::string satelliteFileStr = satelliteFiles.at(i).string();
+    std::ifstream satelliteHandle(satelliteFileStr);
+    line = "";
+    std::getline(satelliteHandle,line); // Read header
+    std::getline(satelliteHandle,line); // Read values
+    satelliteHandle.close();
+    const int16_t satYear = static_cast<int16_t>(std::stoi(line.substr(0,4)));
+    const uint8_t satMonth = static_cast<uint8_t>(std::stoi(line.substr(5,2)));
+    const uint8_t satDay = static_cast<uint8_t>(std::stoi(line.substr(8,2)));
+    const uint8_t satHr = static_cast<uint8_t>(std::stoi(line.substr(11,2)));
+    const uint8_t satMin = static_cast<uint8_t>(std::stoi(line.substr(14,2)));
+    const uint8_t satSec = static_cast<uint8_t>(std::stoi(line.substr(17,2)));
+    const uint32_t satNs = static_cast<uint32_t>(std::stoul(line.substr(20,9)));
+    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(30,10)));
+    const cote::DateTime satTime(
+     satYear,satMonth,satDay,satHr,satMin,satSec,satNs
+    );
+    satellites.push_back(cote::Satellite(satelliteFileStr,dateTime,&log));
+    satellites.back().setID(id);
+    satellites.back().setLocalTime(satTime);
+  }
+  std::sort(
+   satellites.begin(), satellites.end(),
+   [](const cote::Satellite& s1, const cote::Satellite& s2) {
+    return s1.getID() < s2.getID();
+   }
+  );
+  // Satellite i has index i; every per-satellite component below is kept in a
+  // vector in the same order so that the simulation loop can address it by
+  // index, and satellite IDs are only used to load files and name logs
+  cote::EntityStore& satStore = scenario.satStore;
+  for(std::size_t i=0; i<satellites.size(); i++) {
+    satStore.addEntity(satellites.at(i).getID());
+  }
+  const std::size_t satCount = satStore.getEntityCount();
+  // Data for logging logic
+  std::vector<std::pair<double,double>>& prevNodeVoltages =
+   scenario.prevNodeVoltages;
+  prevNodeVoltages.resize(satCount);
+  scenario.prevDownlinkMbps.assign(satCount,std::make_pair(0.0,0.0));
+  scenario.prevUplinkMbps.assign(satCount,std::make_pair(0.0,0.0));
+  std::vector<SatelliteLogs>& satLogs = scenario.satLogs;
+  for(std::size_t i=0; i<satellites.size(); i++) {
+    satLogs.push_back(SatelliteLogs(&log,satellites.at(i).getID()));
+  }
+  // Declare the metrics recorded during the run
+  cote::Metrics& metrics = scenario.metrics;
+  scenario.tileCountMetric =
+   metrics.addHistogram("tile-count",0.0,5000.0,50);
+  scenario.downlinkMbpsMetric =
+   metrics.addQuantiles("downlink-Mbps",{0.01,0.05,0.5,0.95,0.99});
+  for(std::size_t i=0; i<satellites.size(); i++) {
+    scenario.nodeVoltageMetrics.push_back(
+     metrics.addSummary(satLogs.at(i).prefix+"node-voltage")
+    );
+  }
+  // Set up solar arrays
+  std::vector<cote::SolarArray> solarArrays;
+  std::vector<double>& sunOcclusionFactors = scenario.sunOcclusionFactors;
+  sunOcclusionFactors.assign(satCount,0.0);
+  for(std::size_t i=0; i<solarArrayFiles.size(); i++) {
+    std::ifstream solarArrayHandle(solarArrayFiles.at(i).string());
+    line = "";
+    std::getline(solarArrayHandle,line); // Read header
+    std::getline(solarArrayHandle,line); // Read values
+    solarArrayHandle.close();
+    const double openCircuitVoltage = std::stod(line.substr(0,10));
+    const double surfaceAreaM2 = std::stod(line.substr(11,16));
+    const double efficiency = std::stod(line.substr(28,8));
+    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(37,10)));
+    solarArrays.push_back(
+     cote::SolarArray(openCircuitVoltage,surfaceAreaM2,efficiency,id,&log)
+    );
+    // Set initial solar array current
+    const std::array<double,3> SUN_ECI_POSN_KM = simulation.getSunECIPosnKm();
+    const std::size_t SAT_INDEX = satStore.getIndex(id);
+    const std::array<double,3> SAT_ECI_POSN_KM =
+     satellites.at(SAT_INDEX).getECIPosn();
+    const double sunOcclusionFactor =
+     cote::util::calcSunOcclusionFactor(SAT_ECI_POSN_KM,SUN_ECI_POSN_KM);
+    sunOcclusionFactors.at(SAT_INDEX) = sunOcclusionFactor;
+    //// When sunOcclusionFactor is 0.0, irradiance is SOLAR_CONSTANT
+    //// When sunOcclusionFactor is 1.0, irradiance is 1% of SOLAR_CONSTANT
+    //// -1352.44 is the slope needed to achieve the above effect
+    const double irradianceWPerM2 =
+     -1352.44*sunOcclusionFactor+cote::cnst::SOLAR_CONSTANT;
+    // setIrradianceWpM2 calculates and sets the appropriate output current
+    solarArrays.back().setIrradianceWpM2(irradianceWPerM2);
+  }
+  std::sort(
+   solarArrays.begin(), solarArrays.end(),
+   [&satStore](const cote::SolarArray& s1, const cote::SolarArray& s2) {
+    return satStore.getIndex(s1.getID()) < satStore.getIndex(s2.getID());
+   }
+  );
+  // Set up capacitors
+  std::vector<cote::Capacitor> capacitors;
+  for(std::size_t i=0; i<capacitorFiles.size(); i++) {
+    std::ifstream capacitorHandle(capacitorFiles.at(i).string());
+    line = "";
+    std::getline(capacitorHandle,line); // Read header
+    std::getline(capacitorHandle,line); // Read values
+    capacitorHandle.close();
+    const double capacitanceFarad = std::stod(line.substr(0,19));
+    const double esrOhm = std::stod(line.substr(20,10));
+    const double chargeCoulomb = std::stod(line.substr(31,32));
+    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(64,10)));
+    capacitors.push_back(cote::Capacitor(capacitanceFarad,esrOhm,id,&log));
+    capacitors.back().setChargeCoulomb(chargeCoulomb);
+  }
+  std::sort(
+   capacitors.begin(), capacitors.end(),
+   [&satStore](const cote::Capacitor& c1, const cote::Capacitor& c2) {
+    return satStore.getIndex(c1.getID()) < satStore.getIndex(c2.getID());
+   }
+  );
+  // Set up state machines
+  std::vector<cote::StateMachine>& adacsSms = scenario.adacsSms;
+  std::vector<cote::StateMachine>& cameraSms = scenario.cameraSms;
+  std::vector<cote::StateMachine>& computerSms = scenario.computerSms;
+  std::vector<cote::StateMachine>& rxSms = scenario.rxSms;
+  std::vector<cote::StateMachine>& txSms = scenario.txSms;
+  const std::vector<std::vector<std::filesystem::path>*> smFiles = {
+   &adacsSMFiles, &cameraSMFiles, &computerSMFiles, &rxSatSMFiles,
+   &txSatSMFiles
+  };
+  const std::vector<std::vector<cote::StateMachine>*> sms = {
+   &adacsSms, &cameraSms, &computerSms, &rxSms, &txSms
+  };
+  // Malformed configuration items are skipped, so report them on stderr;
+  // identical files share a definition, which is reported once
+  std::set<const cote::StateMachineDefinition*> checkedDefinitions;
+  for(std::size_t i=0; i<smFiles.size(); i++) {
+    for(std::size_t j=0; j<smFiles.at(i)->size(); j++) {
+      std::string smFileStr = smFiles.at(i)->at(j).string();
+      const uint32_t id = static_cast<uint32_t>(
+       std::stoi(smFileStr.substr(smFileStr.size()-14,10))
+      );
+      sms.at(i)->push_back(cote::StateMachine(smFileStr,id,&log));
+      sms.at(i)->back().setRecordStateIntervals(true);
+      const cote::StateMachineDefinition* const definition =
+       sms.at(i)->back().getDefinition().get();
+      if(checkedDefinitions.insert(definition).second) {
+        const std::vector<std::string> parseErrors =
+         definition->getParseErrors();
+        for(std::size_t k=0; k<parseErrors.size(); k++) {
+          std::cerr << parseErrors.at(k) << std::endl;
+        }
       }
     }
-    for(std::size_t i=0; i<groundStations.size(); i++) {
-      const uint32_t GND_ID = groundStations.at(i).getID();
-      groundStations.at(i).update(hourStep,minuteStep,secondStep,nsStep);
-      const std::array<double,3> GND_ECI_POSN_KM =
-       groundStations.at(i).getECIPosn();
-      gndId2Rx[GND_ID]->setPosn(GND_ECI_POSN_KM);
-      gndId2Rx[GND_ID]->update(hourStep,minuteStep,secondStep,nsStep);
-      gndId2Tx[GND_ID]->setPosn(GND_ECI_POSN_KM);
-      gndId2Tx[GND_ID]->update(hourStep,minuteStep,secondStep,nsStep);
+    // The state machines must not move once the load aggregators below hold
+    // pointers to them
+    std::sort(
+     sms.at(i)->begin(), sms.at(i)->end(),
+     [&satStore](const cote::StateMachine& s1, const cote::StateMachine& s2) {
+      return satStore.getIndex(s1.getID()) < satStore.getIndex(s2.getID());
+     }
+    );
+  }
+  // Set up load aggregators, which track the summed power-w of each satellite
+  // Aggregators subscribe to the state machines, so they must not move either
+  std::vector<cote::LoadAggregator>& loadAggregators = scenario.loadAggregators;
+  loadAggregators.reserve(satCount);
+  for(std::size_t i=0; i<satCount; i++) {
+    loadAggregators.push_back(
+     cote::LoadAggregator(satStore.getExternalID(i),&log)
+    );
+    loadAggregators.at(i).addLoad(&(adacsSms.at(i)));
+    loadAggregators.at(i).addLoad(&(cameraSms.at(i)));
+    loadAggregators.at(i).addLoad(&(computerSms.at(i)));
+    loadAggregators.at(i).addLoad(&(rxSms.at(i)));
+    loadAggregators.at(i).addLoad(&(txSms.at(i)));
+  }
+  // Look up the states compared every step once, up front
+  std::vector<cote::StateMachine::StateId>& cameraImagingIds =
+   scenario.cameraImagingIds;
+  cameraImagingIds.resize(satCount);
+  std::vector<cote::StateMachine::StateId>& cameraReadoutIds =
+   scenario.cameraReadoutIds;
+  cameraReadoutIds.resize(satCount);
+  std::vector<cote::StateMachine::StateId>& computerWorkIds =
+   scenario.computerWorkIds;
+  computerWorkIds.resize(satCount);
+  std::vector<cote::StateMachine::StateId>& rxRxIds = scenario.rxRxIds;
+  rxRxIds.resize(satCount);
+  std::vector<cote::StateMachine::StateId>& txTxIds = scenario.txTxIds;
+  txTxIds.resize(satCount);
+  for(std::size_t i=0; i<satCount; i++) {
+    cameraImagingIds.at(i) = cameraSms.at(i).getStateId("IMAGING");
+    cameraReadoutIds.at(i) = cameraSms.at(i).getStateId("READOUT");
+    computerWorkIds.at(i) = computerSms.at(i).getStateId("WORK");
+    rxRxIds.at(i) = rxSms.at(i).getStateId("RX");
+    txTxIds.at(i) = txSms.at(i).getStateId("TX");
+  }
+  // Set up the power bus; node i holds the energy system of satellites.at(i)
+  // The capacitors and solar arrays above only provide the initial values
+  cote::PowerBus& powerBus = scenario.powerBus;
+  for(std::size_t i=0; i<satCount; i++) {
+    powerBus.addNode(capacitors.at(i),solarArrays.at(i));
+    powerBus.setLoadPowerW(i,loadAggregators.at(i).getTotalPowerW());
+  }
+  // Initialize the energy system for each satellite
+  // Note that the node voltage is being calculated for the first time, so a
+  // current cap cannot be applied to the solar array current
+  // This is OK so long as the initial conditions are sane and the time step is
+  // not too huge because it will be cut off during the next time step if the
+  // node voltage becomes too large
+  powerBus.updateNodeVoltage();
+  for(std::size_t i=0; i<satellites.size(); i++) {
+    if(powerBus.isBrownout(i)) { // if power draw too high, set all to off
+      adacsSms.at(i).setCurrentState("OFF");
+      cameraSms.at(i).setCurrentState("OFF");
+      computerSms.at(i).setCurrentState("OFF");
+      rxSms.at(i).setCurrentState("OFF");
+      txSms.at(i).setCurrentState("OFF");
+      powerBus.setLoadPowerW(i,loadAggregators.at(i).getTotalPowerW());
+      powerBus.updateNodeVoltage(i);
+    }
+    const double nodeVoltage = powerBus.getNodeVoltage(i);
+    // Set node voltage for all state machines
+    adacsSms.at(i).setVariableValue("node-voltage",nodeVoltage);
+    cameraSms.at(i).setVariableValue("node-voltage",nodeVoltage);
+    computerSms.at(i).setVariableValue("node-voltage",nodeVoltage);
+    rxSms.at(i).setVariableValue("node-voltage",nodeVoltage);
+    txSms.at(i).setVariableValue("node-voltage",nodeVoltage);
+    prevNodeVoltages.at(i) = std::make_pair(0.0,nodeVoltage);
+    // Set the shade value for all state machines
+    if(sunOcclusionFactors.at(i)!=0.0) {
+      adacsSms.at(i).setVariableValue("shade",1.0);
+      cameraSms.at(i).setVariableValue("shade",1.0);
+      computerSms.at(i).setVariableValue("shade",1.0);
+      rxSms.at(i).setVariableValue("shade",1.0);
+      txSms.at(i).setVariableValue("shade",1.0);
+    } else {
+      adacsSms.at(i).setVariableValue("shade",0.0);
+      cameraSms.at(i).setVariableValue("shade",0.0);
+      computerSms.at(i).setVariableValue("shade",0.0);
+      rxSms.at(i).setVariableValue("shade",0.0);
+      txSms.at(i).setVariableValue("shade",0.0);
+    }
+    // Update state for each state machine
+    // After calculating the initial values for all state machine variables,
+    // updateState must be called so that they are in the correct state for the
+    // first time step
+    adacsSms.at(i).updateState();
+    cameraSms.at(i).updateState();
+    rxSms.at(i).updateState();
+    txSms.at(i).updateState();
+    if(rxSms.at(i).getCurrentStateId()==rxRxIds.at(i)) {
+      computerSms.at(i).setVariableValue("comms",1.0);
+    } else {
+      computerSms.at(i).setVariableValue("comms",0.0);
     }
-    // Increment step count
-    stepCount+=1;
+    computerSms.at(i).updateState();
+    // Record the summed load for the next capacitor charge update
+    powerBus.setLoadPowerW(i,loadAggregators.at(i).getTotalPowerW());
   }
-  // Write out any remaining logs
-  log.writeAll();
-  // Clean up ground station TX
-  for(
-   std::map<uint32_t,cote::Transmitter*>::iterator it = gndId2Tx.begin();
-   it!=gndId2Tx.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  // Set up satellite RX
+  std::vector<cote::Receiver>& satRxs = scenario.satRxs;
+  std::vector<double> satRxCenterFrequencyHz(satCount,0.0);
+  std::vector<double> satRxBandwidthHz(satCount,0.0);
+  for(std::size_t i=0; i<rxSatFiles.size(); i++) {
+    std::ifstream rxSatHandle(rxSatFiles.at(i).string());
+    line = "";
+    std::getline(rxSatHandle,line); // Read header
+    std::getline(rxSatHandle,line); // Read values
+    rxSatHandle.close();
+    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
+    const std::size_t SAT_INDEX = satStore.getIndex(id);
+    const std::array<double,3> posn = satellites.at(SAT_INDEX).getECIPosn();
+    const double gainDB = std::stod(line.substr(11,13));
+    const double rxCenterFrequencyHz = std::stod(line.substr(25,22));
+    const double rxBandwidthHz = std::stod(line.substr(48,23));
+    satRxs.push_back(cote::Receiver(posn,gainDB,dateTime,id,&log));
+    satRxCenterFrequencyHz.at(SAT_INDEX) = rxCenterFrequencyHz;
+    satRxBandwidthHz.at(SAT_INDEX) = rxBandwidthHz;
   }
-  // Clean up ground station RX
-  for(
-   std::map<uint32_t,cote::Receiver*>::iterator it = gndId2Rx.begin();
-   it!=gndId2Rx.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  std::sort(
+   satRxs.begin(), satRxs.end(),
+   [&satStore](const cote::Receiver& r1, const cote::Receiver& r2) {
+    return satStore.getIndex(r1.getID()) < satStore.getIndex(r2.getID());
+   }
+  );
+  // Set up satellite TX
+  std::vector<cote::Transmitter>& satTxs = scenario.satTxs;
+  std::vector<double>& satTxCenterFrequencyHz = scenario.satTxCenterFrequencyHz;
+  satTxCenterFrequencyHz.assign(satCount,0.0);
+  std::vector<double>& satTxBandwidthHz = scenario.satTxBandwidthHz;
+  satTxBandwidthHz.assign(satCount,0.0);
+  for(std::size_t i=0; i<txSatFiles.size(); i++) {
+    std::ifstream txSatHandle(txSatFiles.at(i).string());
+    line = "";
+    std::getline(txSatHandle,line); // Read header
+    std::getline(txSatHandle,line); // Read values
+    txSatHandle.close();
+    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
+    const std::size_t SAT_INDEX = satStore.getIndex(id);
+    const std::array<double,3> posn = satellites.at(SAT_INDEX).getECIPosn();
+    const double powerW = std::stod(line.substr(11,16));
+    const double lineLossDB = std::stod(line.substr(28,13));
+    const double gainDB = std::stod(line.substr(42,13));
+    const double txCenterFrequencyHz = std::stod(line.substr(56,22));
+    const double txBandwidthHz = std::stod(line.substr(79,23));
+    satTxs.push_back(
+     cote::Transmitter(posn,powerW,lineLossDB,gainDB,dateTime,id,&log)
+    );
+    satTxCenterFrequencyHz.at(SAT_INDEX) = txCenterFrequencyHz;
+    satTxBandwidthHz.at(SAT_INDEX) = txBandwidthHz;
   }
-  // Clean up ground stations
-  //// Nothing to be done
-  // Clean up constellation configuration variables
-  for(
-   std::map< uint32_t, std::vector<cote::Satellite*> >::iterator it =
-   constellId2Sats.begin(); it!=constellId2Sats.end(); it++
-  ) {
-    for(std::size_t i=0; i<it->second.size(); i++) {
-      it->second.at(i) = nullptr;
+  std::sort(
+   satTxs.begin(), satTxs.end(),
+   [&satStore](const cote::Transmitter& t1, const cote::Transmitter& t2) {
+    return satStore.getIndex(t1.getID()) < satStore.getIndex(t2.getID());
+   }
+  );
+  // Set up sensors
+  std::vector<cote::Sensor>& sensors = scenario.sensors;
+  std::vector<double>& threshCoeffs = scenario.threshCoeffs;
+  threshCoeffs.assign(satCount,0.0);
+  std::vector<uint32_t>& pixelCountWs = scenario.pixelCountWs;
+  pixelCountWs.assign(satCount,0);
+  std::vector<double>& pixelSizeMs = scenario.pixelSizeMs;
+  pixelSizeMs.assign(satCount,0.0);
+  std::vector<double>& focalLengthMs = scenario.focalLengthMs;
+  focalLengthMs.assign(satCount,0.0);
+  std::vector<uint32_t>& pixelCountHs = scenario.pixelCountHs;
+  pixelCountHs.assign(satCount,0);
+  for(std::size_t i=0; i<sensorSatFiles.size(); i++) {
+    std::ifstream sensorHandle(sensorSatFiles.at(i).string());
+    line = "";
+    std::getline(sensorHandle,line); // Read header
+    std::getline(sensorHandle,line); // Read values
+    sensorHandle.close();
+    const uint64_t bitsPerSense =
+     static_cast<uint64_t>(std::stoull(line.substr(0,10)));
+    const uint32_t pixelCountW =
+     static_cast<uint32_t>(std::stoul(line.substr(11,5)));
+    const double pixelSizeM =
+     static_cast<double>(std::stod(line.substr(17,11)));
+    const double focalLengthM =
+     static_cast<double>(std::stod(line.substr(29,10)));
+    const uint32_t pixelCountH =
+     static_cast<uint32_t>(std::stoul(line.substr(40,5)));
+    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(46,10)));
+    const std::size_t SAT_INDEX = satStore.getIndex(id);
+    const std::array<double,3> posn = satellites.at(SAT_INDEX).getECIPosn();
+    // geographic frame width (km) = threshCoeff*altitude(km)
+    threshCoeffs.at(SAT_INDEX) =
+     static_cast<double>(std::max(pixelCountW,pixelCountH))*pixelSizeM/
+     focalLengthM;
+    pixelCountWs.at(SAT_INDEX) = pixelCountW;
+    pixelSizeMs.at(SAT_INDEX) = pixelSizeM;
+    focalLengthMs.at(SAT_INDEX) = focalLengthM;
+    pixelCountHs.at(SAT_INDEX) = pixelCountH;
+    sensors.push_back(cote::Sensor(posn,dateTime,id,&log));
+    sensors.back().setBitsPerSense(bitsPerSense);
+  }
+  std::sort(
+   sensors.begin(), sensors.end(),
+   [&satStore](const cote::Sensor& s1, const cote::Sensor& s2) {
+    return satStore.getIndex(s1.getID()) < satStore.getIndex(s2.getID());
+   }
+  );
+  // Set up programs
+  std::vector<cote::NeuralNetwork>& programs = scenario.programs;
+  programs.resize(satCount);
+  for(std::size_t i=0; i<programSatFiles.size(); i++) {
+    std::ifstream programHandle(programSatFiles.at(i).string());
+    line = "";
+    std::getline(programHandle,line); // Read header
+    std::getline(programHandle,line); // Read values
+    programHandle.close();
+    const uint32_t inputWidthPx =
+     static_cast<uint32_t>(std::stoul(line.substr(0,5)));
+    const uint32_t idealFeatureWidthPx =
+     static_cast<uint32_t>(std::stoul(line.substr(6,5)));
+    const double   actualFeatureWidthM =
+     static_cast<double>(std::stod(line.substr(12,11)));
+    const uint32_t inputHeightPx =
+     static_cast<uint32_t>(std::stoul(line.substr(24,5)));
+    const uint32_t idealFeatureHeightPx =
+     static_cast<uint32_t>(std::stoul(line.substr(30,5)));
+    const double   actualFeatureHeightM =
+     static_cast<double>(std::stod(line.substr(36,11)));
+    const uint32_t modelBits =
+     static_cast<uint32_t>(std::stoul(line.substr(48,10)));
+    const uint32_t id =
+     static_cast<uint32_t>(std::stoul(line.substr(59,10)));
+    cote::NeuralNetwork neuralNetwork = {
+     .inputWidthPx = inputWidthPx,
+     .idealFeatureWidthPx = idealFeatureWidthPx,
+     .actualFeatureWidthM = actualFeatureWidthM,
+     .inputHeightPx = inputHeightPx,
+     .idealFeatureHeightPx = idealFeatureHeightPx,
+     .actualFeatureHeightM = actualFeatureHeightM,
+     .modelBits = modelBits,
+     .id = id
+    };
+    programs.at(satStore.getIndex(id)) = neuralNetwork;
+  }
+  // Set up constellation configuration variables
+  std::map<uint32_t,std::string> constellId2DataCollection;
+  std::map<uint32_t,std::string> constellId2DataProcessing;
+  std::map< uint32_t, std::vector<std::size_t> > constellId2Sats;
+  for(std::size_t i=0; i<constellationFiles.size(); i++) {
+    // Parse constellation configuration file
+    std::string constellationFileStr =
+     json::util::readFile(constellationFiles.at(i).string());
+    json::Object* constellationConfig = new json::Object(constellationFileStr);
+    std::map<std::string,json::Value*> constellConfigMap =
+     constellationConfig->getValue();
+    // Get constellation ID
+    uint32_t constellId = static_cast<uint32_t>(std::stoul(
+     dynamic_cast<json::String*>(constellConfigMap["id"])->getValue()
+    ));
+    // Record constellation data collection method
+    std::string dataCollection = dynamic_cast<json::String*>(
+     constellConfigMap["data-collection"]
+    )->getValue();
+    constellId2DataCollection[constellId] = dataCollection;
+    // Record constellation data processing method
+    std::string dataProcessing = dynamic_cast<json::String*>(
+     constellConfigMap["data-processing"]
+    )->getValue();
+    constellId2DataProcessing[constellId] = dataProcessing;
+    // Record constellation satellite members
+    constellId2Sats[constellId] = std::vector<std::size_t>();
+    std::vector<json::Value*> constellSatMembers =
+     dynamic_cast<json::Array*>(constellConfigMap["satellite-ids"])->getValue();
+    std::vector<uint32_t> constellSatIds;
+    for(std::size_t j=0; j<constellSatMembers.size(); j++) {
+      uint32_t satId = static_cast<uint32_t>(std::stoul(
+       dynamic_cast<json::String*>(constellSatMembers.at(j))->getValue()
+      ));
+      constellId2Sats[constellId].push_back(satStore.getIndex(satId));
     }
+    // Clean up
+    delete constellationConfig;
+    constellationConfig = nullptr;
   }
-  // Clean up programs
-  //// Nothing to be done
-  // Clean up sensors
-  for(
-   std::map<uint32_t,cote::Sensor*>::iterator it = satId2Sensor.begin();
-   it!=satId2Sensor.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  // Set up ground stations
+  std::vector<cote::GroundStation>& groundStations = scenario.groundStations;
+  for(std::size_t i=0; i<groundStationFiles.size(); i++) {
+    std::ifstream gndHandle(groundStationFiles.at(i).string());
+    line = "";
+    std::getline(gndHandle,line); // Read header
+    std::getline(gndHandle,line); // Read values
+    gndHandle.close();
+    uint32_t id  = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
+    double   lat = std::stod(line.substr(11,13));
+    double   lon = std::stod(line.substr(25,14));
+    double   hae = std::stod(line.substr(40,13));
+    groundStations.push_back(
+     cote::GroundStation(lat,lon,hae,dateTime,id,&log)
+    );
   }
-  // Clean up satellite TX
-  for(
-   std::map<uint32_t,cote::Transmitter*>::iterator it = satId2Tx.begin();
-   it!=satId2Tx.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  std::sort(
+   groundStations.begin(), groundStations.end(),
+   [](const cote::GroundStation& g1, const cote::GroundStation& g2) {
+    return g1.getID() < g2.getID();
+   }
+  );
+  // Ground station i has index i, as for satellites
+  cote::EntityStore gndStore(0,&log);
+  for(std::size_t i=0; i<groundStations.size(); i++) {
+    gndStore.addEntity(groundStations.at(i).getID());
   }
-  // Clean up satellite RX
-  for(
-   std::map<uint32_t,cote::Receiver*>::iterator it = satId2Rx.begin();
-   it!=satId2Rx.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  const std::size_t gndCount = gndStore.getEntityCount();
+  // Set up ground station RX
+  std::vector<cote::Receiver>& gndRxs = scenario.gndRxs;
+  std::vector<double> gndRxCenterFrequencyHz(gndCount,0.0);
+  std::vector<double> gndRxBandwidthHz(gndCount,0.0);
+  for(std::size_t i=0; i<rxGndFiles.size(); i++) {
+    std::ifstream rxGndHandle(rxGndFiles.at(i).string());
+    line = "";
+    std::getline(rxGndHandle,line); // Read header
+    std::getline(rxGndHandle,line); // Read values
+    rxGndHandle.close();
+    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
+    const std::size_t GND_INDEX = gndStore.getIndex(id);
+    const std::array<double,3> posn = groundStations.at(GND_INDEX).getECIPosn();
+    const double gainDB = std::stod(line.substr(11,13));
+    const double rxCenterFrequencyHz = std::stod(line.substr(25,22));
+    const double rxBandwidthHz = std::stod(line.substr(48,23));
+    gndRxs.push_back(cote::Receiver(posn,gainDB,dateTime,id,&log));
+    gndRxCenterFrequencyHz.at(GND_INDEX) = rxCenterFrequencyHz;
+    gndRxBandwidthHz.at(GND_INDEX) = rxBandwidthHz;
   }
-  // Clean up satellite TX state machines
-  for(
-   std::map<uint32_t,cote::StateMachine*>::iterator it = satId2TxSm.begin();
-   it!=satId2TxSm.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  std::sort(
+   gndRxs.begin(), gndRxs.end(),
+   [&gndStore](const cote::Receiver& r1, const cote::Receiver& r2) {
+    return gndStore.getIndex(r1.getID()) < gndStore.getIndex(r2.getID());
+   }
+  );
+  // Set up ground station TX
+  std::vector<cote::Transmitter>& gndTxs = scenario.gndTxs;
+  std::vector<double>& gndTxCenterFrequencyHz = scenario.gndTxCenterFrequencyHz;
+  gndTxCenterFrequencyHz.assign(gndCount,0.0);
+  std::vector<double>& gndTxBandwidthHz = scenario.gndTxBandwidthHz;
+  gndTxBandwidthHz.assign(gndCount,0.0);
+  for(std::size_t i=0; i<txGndFiles.size(); i++) {
+    std::ifstream txGndHandle(txGndFiles.at(i).string());
+    line = "";
+    std::getline(txGndHandle,line); // Read header
+    std::getline(txGndHandle,line); // Read values
+    txGndHandle.close();
+    const uint32_t id = static_cast<uint32_t>(std::stoul(line.substr(0,10)));
+    const std::size_t GND_INDEX = gndStore.getIndex(id);
+    const std::array<double,3> posn = groundStations.at(GND_INDEX).getECIPosn();
+    const double powerW = std::stod(line.substr(11,16));
+    const double lineLossDB = std::stod(line.substr(28,13));
+    const double gainDB = std::stod(line.substr(42,13));
+    const double txCenterFrequencyHz = std::stod(line.substr(56,22));
+    const double txBandwidthHz = std::stod(line.substr(79,23));
+    gndTxs.push_back(
+     cote::Transmitter(posn,powerW,lineLossDB,gainDB,dateTime,id,&log)
+    );
+    gndTxCenterFrequencyHz.at(GND_INDEX) = txCenterFrequencyHz;
+    gndTxBandwidthHz.at(GND_INDEX) = txBandwidthHz;
   }
-  // Clean up satellite RX state machines
-  for(
-   std::map<uint32_t,cote::StateMachine*>::iterator it = satId2RxSm.begin();
-   it!=satId2RxSm.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  std::sort(
+   gndTxs.begin(), gndTxs.end(),
+   [&gndStore](const cote::Transmitter& t1, const cote::Transmitter& t2) {
+    return gndStore.getIndex(t1.getID()) < gndStore.getIndex(t2.getID());
+   }
+  );
+  // Simulation data
+  std::vector<double>& thresholdKms = scenario.thresholdKms;
+  thresholdKms.assign(satCount,0.0);
+  scenario.gsds.resize(satCount);
+  scenario.rxOccupied.assign(satCount,false);
+  scenario.txOccupied.assign(satCount,false);
+  scenario.txBufferBits.assign(satCount,0);
+  for(std::size_t i=0; i<satCount; i++) {
+    thresholdKms.at(i) = threshCoeffs.at(i)*
+     cote::util::calcAltitudeKm(satellites.at(i).getECIPosn());
   }
-  // Clean up computer state machines
-  for(
-   std::map<uint32_t,cote::StateMachine*>::iterator it=satId2ComputerSm.begin();
-   it!=satId2ComputerSm.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  // Indices of the satellites visible from and linked to each ground station
+  scenario.gndVisSats.resize(gndCount);
+  scenario.gndCurrSats.assign(gndCount,cote::EntityStore::NO_INDEX);
+  // Orbits, visibility and the Sun position are updated every orbit period,
+  // one second unless set by orbit-period.dat, and the positions are
+  // interpolated in between; the other phases run every step
+  double orbitPeriodS = 1.0;
+  if(!orbitPeriodFile.empty()) {
+    std::ifstream orbitPeriodHandle(orbitPeriodFile.string());
+    line = "";
+    std::getline(orbitPeriodHandle,line); // Read header
+    std::getline(orbitPeriodHandle,line); // Read values
+    orbitPeriodHandle.close();
+    orbitPeriodS = std::stod(line);
   }
-  // Clean up camera state machines
-  for(
-   std::map<uint32_t,cote::StateMachine*>::iterator it = satId2CameraSm.begin();
-   it!=satId2CameraSm.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  const uint64_t orbitPeriod = static_cast<uint64_t>(std::max(
+   1.0,std::round(orbitPeriodS/simulation.getStepSizeS())
+  ));
+  simulation.setContextPeriod(orbitPeriod);
+  // Simulation phases, run in this order once per step or period
+  EnvironmentPhase environmentPhase(&scenario);
+  PayloadPhase payloadPhase(&scenario,&log);
+  ChargePhase chargePhase(&scenario);
+  VisibilityPhase visibilityPhase(&scenario);
+  CommsPhase commsPhase(&scenario,&log);
+  cote::PropagatePhase& propagatePhase = scenario.propagatePhase;
+  //// Satellite i is entity i and ground station i is entity satCount+i
+  for(std::size_t i=0; i<satellites.size(); i++) {
+    propagatePhase.addEntity(&(satellites.at(i)),orbitPeriod);
   }
-  // Clean up ADACS state machines
-  for(
-   std::map<uint32_t,cote::StateMachine*>::iterator it = satId2AdacsSm.begin();
-   it!=satId2AdacsSm.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  for(std::size_t i=0; i<groundStations.size(); i++) {
+    propagatePhase.addEntity(&(groundStations.at(i)),orbitPeriod);
   }
-  // Clean up capacitors
-  for(
-   std::map<uint32_t,cote::Capacitor*>::iterator it = satId2Capacitor.begin();
-   it!=satId2Capacitor.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  DevicePhase devicePhase(&scenario);
+  //// The state intervals are written unless the raw logs are suppressed
+  std::ofstream stateIntervalFile;
+  if(log.isEnabled(cote::LogLevel::INFO)) {
+    stateIntervalFile.open(
+     (logDirectory/"state-intervals.csv").string(),std::ios::out
+    );
+    stateIntervalFile << "start,end,satellite,device,state,\n";
   }
-  // Clean up solar arrays
-  for(
-   std::map<uint32_t,cote::SolarArray*>::iterator it = satId2SolarArray.begin();
-   it!=satId2SolarArray.end(); it++
-  ) {
-    delete it->second;
-    it->second = nullptr;
+  PowerPhase powerPhase(
+   &scenario,&log,stateIntervalFile.is_open() ? &stateIntervalFile : NULL
+  );
+  simulation.addPhase(&environmentPhase);
+  simulation.addPhase(&payloadPhase);
+  simulation.addPhase(&chargePhase);
+  simulation.addPhase(&visibilityPhase,orbitPeriod);
+  simulation.addPhase(&commsPhase);
+  simulation.addPhase(&propagatePhase);
+  simulation.addPhase(&devicePhase);
+  simulation.addPhase(&powerPhase);
+  // Simulation loop
+  simulation.runAdaptive();
+  // Close and write the final state intervals
+  const int64_t STEP_COUNT = static_cast<int64_t>(simulation.getStepCount());
+  std::string stateIntervalRows;
+  for(std::size_t i=0; i<satCount; i++) {
+    const std::vector<cote::StateMachine*> satSms = {
+     &(adacsSms.at(i)), &(cameraSms.at(i)), &(computerSms.at(i)),
+     &(rxSms.at(i)), &(txSms.at(i))
+    };
+    for(std::size_t j=0; j<satSms.size(); j++) {
+      satSms.at(j)->setTime(STEP_COUNT);
+      satSms.at(j)->closeStateInterval();
+    }
+    recordSatelliteStateIntervals(
+     &scenario, i, &log,
+     stateIntervalFile.is_open() ? &stateIntervalRows : NULL
+    );
+  }
+  if(stateIntervalFile.is_open()) {
+    stateIntervalFile << stateIntervalRows;
+    stateIntervalFile.close();
+  }
+  // Summarize the time in each state over the constellation: the total steps
+  // and the distribution over satellites of the percentage of steps
+  const std::vector<std::string> devices = {
+   "adacs", "camera", "computer", "rx", "tx"
+  };
+  const std::vector<std::vector<cote::StateMachine>*> deviceSms = {
+   &adacsSms, &cameraSms, &computerSms, &rxSms, &txSms
+  };
+  for(std::size_t i=0; i<devices.size(); i++) {
+    std::vector<std::map<std::string,int64_t>> satTimeInStates;
+    std::map<std::string,int64_t> timeInStates; // summed over satellites
+    for(std::size_t j=0; j<deviceSms.at(i)->size(); j++) {
+      satTimeInStates.push_back(deviceSms.at(i)->at(j).getTimeInStates());
+      for(
+       std::map<std::string,int64_t>::const_iterator it =
+        satTimeInStates.back().begin();
+       it!=satTimeInStates.back().end(); it++
+      ) {
+        timeInStates[it->first] += it->second;
+      }
+    }
+    const cote::Metrics::MetricHandle totals =
+     metrics.addTotals(devices.at(i)+"-time-in-state");
+    for(
+     std::map<std::string,int64_t>::const_iterator it = timeInStates.begin();
+     it!=timeInStates.end(); it++
+    ) {
+      metrics.add(totals,it->first,static_cast<double>(it->second));
+      //// A satellite whose machine lacks the state spent no time in it
+      const cote::Metrics::MetricHandle percent =
+       metrics.addSummary(devices.at(i)+"-"+it->first+"-percent");
+      for(std::size_t j=0; j<satTimeInStates.size(); j++) {
+        const std::map<std::string,int64_t>::const_iterator satIt =
+         satTimeInStates.at(j).find(it->first);
+        const int64_t steps =
+         (satIt==satTimeInStates.at(j).end()) ? 0 : satIt->second;
+        metrics.record(
+         percent,
+         100.0*static_cast<double>(steps)/static_cast<double>(STEP_COUNT)
+        );
+      }
+    }
   }
+  // Report the most memory held by buffered logs
+  const cote::Metrics::MetricHandle peakBufferedBytes =
+   metrics.addValue("log-peak-buffered-bytes");
+  metrics.set(
+   peakBufferedBytes,static_cast<double>(log.getPeakBufferedBytes())
+  );
+  // Report the steps that the quiescent phases allowed to be skipped
+  const cote::Metrics::MetricHandle skippedSteps =
+   metrics.addValue("skipped-steps");
+  metrics.set(
+   skippedSteps,static_cast<double>(simulation.getSkippedStepCount())
+  );
+  metrics.writeSummary((logDirectory/"summary.csv").string());
+  // Write out any remaining logs
+  log.writeAll();
+  // Clean up components
+  //// Nothing to be done; components are held by value in vectors
   // Clean up satellites
   //// Nothing to be done
-  // Clean up step count
-  //// Nothing to be done
-  // Clean up time step variables
-  //// Nothing to be done
-  // Clean up date and time
+  // Clean up simulation and phases
   //// Nothing to be done
   std::exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,480 @@
+// benchmark-state-machine-parsing.cpp
+//
+// Writes many distinct copies of the state machine configuration files in a
+// directory, then times loading all of them with the previous parser, which
+// copied substrings and converted numbers with std::stod, and with
+// StateMachineDefinition. The parsed contents are compared as well.
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>                  // min
+#include <chrono>                     // duration, steady_clock
+#include <cstddef>                    // size_t
+#include <cstdlib>                    // exit, EXIT_FAILURE, EXIT_SUCCESS
+#include <filesystem>                 // directory_iterator, path, remove
+#include <fstream>                    // ifstream, ofstream
+#include <iostream>                   // cout
+#include <iterator>                   // istreambuf_iterator
+#include <map>                        // map
+#include <memory>                     // shared_ptr
+#include <ostream>                    // endl
+#include <string>                     // string, stod, stoul, to_string
+#include <tuple>                      // tuple, make_tuple
+#include <utility>                    // pair, make_pair
+#include <vector>                     // vector
+
+// cote
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+#include <StateTransition.hpp>        // StateTransition
+
+typedef std::vector<std::tuple<std::string,std::string,double>> Changes;
+
+// A transition as parsed by the previous StateTransition constructor
+struct LegacyTransition {
+  std::string srcState;
+  std::string dstState;
+  std::map<std::string,std::vector<std::pair<std::string,double>>> conditions;
+};
+
+// A configuration as parsed by the previous StateMachine constructor
+struct LegacyConfiguration {
+  std::map<std::string,double> constantValues;
+  std::map<std::string,double> variableValues;
+  std::map<std::string,Changes> enterStateValues;
+  std::map<std::string,Changes> exitStateValues;
+  std::map<std::string,std::map<std::string,Changes>> transitionValues;
+  std::map<std::string,std::vector<LegacyTransition>> stateTransitions;
+  std::string initialState;
+};
+
+// The previous StateTransition description parser
+LegacyTransition legacyParseTransition(const std::string& description) {
+  LegacyTransition transition;
+  // skip past the "transition" label
+  std::size_t delimiterIndex = description.find(":",0);
+  std::size_t i = (
+   delimiterIndex==std::string::npos ?
+   delimiterIndex : delimiterIndex+std::string(":").size()
+  );
+  // parse and set the source state name
+  delimiterIndex = description.find("->",i);
+  if(delimiterIndex==std::string::npos) {
+    transition.srcState = "";
+    i = delimiterIndex;
+  } else {
+    transition.srcState = description.substr(i,delimiterIndex-i);
+    i = delimiterIndex+std::string("->").size();
+  }
+  // parse and set the destination state name
+  delimiterIndex = description.find(":",i);
+  if(delimiterIndex==std::string::npos) {
+    transition.dstState = "";
+    i = delimiterIndex;
+  } else {
+    transition.dstState = description.substr(i,delimiterIndex-i);
+    i = delimiterIndex+std::string(":").size();
+  }
+  // parse and set the transition conditions
+  while(i<description.size()) {
+    delimiterIndex = description.find(",",i);
+    std::string transitionCondition = description.substr(i,delimiterIndex-i);
+    std::size_t j = 0;
+    std::string condition = "";
+    std::string comparisonOperator = "";
+    double value = 0.0;
+    if(transitionCondition.find("==",0)!=std::string::npos) {
+      j = transitionCondition.find("==",0);
+      comparisonOperator = "==";
+    } else if(transitionCondition.find("!=",0)!=std::string::npos) {
+      j = transitionCondition.find("!=",0);
+      comparisonOperator = "!=";
+    } else if(transitionCondition.find("<=",0)!=std::string::npos) {
+      j = transitionCondition.find("<=",0);
+      comparisonOperator = "<=";
+    } else if(transitionCondition.find(">=",0)!=std::string::npos) {
+      j = transitionCondition.find(">=",0);
+      comparisonOperator = ">=";
+    } else if(transitionCondition.find("<",0)!=std::string::npos) {
+      j = transitionCondition.find("<",0);
+      comparisonOperator = "<";
+    } else if(transitionCondition.find(">",0)!=std::string::npos) {
+      j = transitionCondition.find(">",0);
+      comparisonOperator = ">";
+    }
+    condition = transitionCondition.substr(0,j);
+    value = std::stod(transitionCondition.substr(
+     j+comparisonOperator.size(),std::string::npos
+    ));
+    if(transition.conditions.count(condition)==0) {
+      transition.conditions[condition] =
+       std::vector<std::pair<std::string,double>>();
+    }
+    transition.conditions.at(condition).push_back(
+     std::make_pair(comparisonOperator,value)
+    );
+    i = (
+     delimiterIndex==std::string::npos ?
+     delimiterIndex : delimiterIndex+std::string(",").size()
+    );
+  }
+  return transition;
+}
+
+// The previous StateMachine configuration file parser
+LegacyConfiguration legacyParseConfiguration(const std::string& configFile) {
+  LegacyConfiguration config;
+  std::ifstream configHandle(configFile);
+  std::string line = "";
+  while(std::getline(configHandle,line)) {
+    std::size_t labelEndIndex = line.find(":",0);
+    std::string label = line.substr(0,labelEndIndex);
+    line =
+     line.substr(labelEndIndex+std::string(":").size(),std::string::npos);
+    if(label=="constant") {
+      std::size_t delimiterIndex = line.find(":",0);
+      std::string constantName = line.substr(0,delimiterIndex);
+      double constantValue = std::stod(
+       line.substr(delimiterIndex+std::string(":").size(),std::string::npos)
+      );
+      config.constantValues[constantName] = constantValue;
+    } else if(label=="variable") {
+      std::size_t delimiterIndex = line.find(":",0);
+      std::string variableName = line.substr(0,delimiterIndex);
+      double variableValue = std::stod(
+       line.substr(delimiterIndex+std::string(":").size(),std::string::npos)
+      );
+      config.variableValues[variableName] = variableValue;
+    } else if(label=="enter-state") {
+      std::size_t delimiterIndex = line.find(":",0);
+      std::string stateName = line.substr(0,delimiterIndex);
+      line =
+       line.substr(delimiterIndex+std::string(":").size(),std::string::npos);
+      std::size_t lineIndex = 0;
+      while(lineIndex<line.size()) {
+        delimiterIndex = line.find(",",lineIndex);
+        std::string enterChange =
+         line.substr(lineIndex,delimiterIndex-lineIndex);
+        std::size_t operatorIndex = 0;
+        std::string variableName = "";
+        std::string assignmentOperator = "";
+        double variableValue = 0.0;
+        if(enterChange.find("+=",0)!=std::string::npos) {
+          operatorIndex = enterChange.find("+=",0);
+          assignmentOperator = "+=";
+        } else if(enterChange.find("-=",0)!=std::string::npos) {
+          operatorIndex = enterChange.find("-=",0);
+          assignmentOperator = "-=";
+        } else if(enterChange.find("*=",0)!=std::string::npos) {
+          operatorIndex = enterChange.find("*=",0);
+          assignmentOperator = "*=";
+        } else if(enterChange.find("=",0)!=std::string::npos) {
+          operatorIndex = enterChange.find("=",0);
+          assignmentOperator = "=";
+        }
+        variableName = enterChange.substr(0,operatorIndex);
+        variableValue = std::stod(enterChange.substr(
+         operatorIndex+assignmentOperator.size(),std::string::npos
+        ));
+        if(config.enterStateValues.count(stateName)==0) {
+          config.enterStateValues[stateName] =
+           std::vector<std::tuple<std::string,std::string,double>>();
+        }
+        config.enterStateValues.at(stateName).push_back(
+         std::make_tuple(variableName,assignmentOperator,variableValue)
+        );
+        lineIndex = (
+         delimiterIndex==std::string::npos ?
+         delimiterIndex : delimiterIndex+std::string(",").size()
+        );
+      }
+    } else if(label=="exit-state") {
+      std::size_t delimiterIndex = line.find(":",0);
+      std::string stateName = line.substr(0,delimiterIndex);
+      line =
+       line.substr(delimiterIndex+std::string(":").size(),std::string::npos);
+      std::size_t lineIndex = 0;
+      while(lineIndex<line.size()) {
+        delimiterIndex = line.find(",",lineIndex);
+        std::string exitChange =
+         line.substr(lineIndex,delimiterIndex-lineIndex);
+        std::size_t operatorIndex = 0;
+        std::string variableName = "";
+        std::string assignmentOperator = "";
+        double variableValue = 0.0;
+        if(exitChange.find("+=",0)!=std::string::npos) {
+          operatorIndex = exitChange.find("+=",0);
+          assignmentOperator = "+=";
+        } else if(exitChange.find("-=",0)!=std::string::npos) {
+          operatorIndex = exitChange.find("-=",0);
+          assignmentOperator = "-=";
+        } else if(exitChange.find("*=",0)!=std::string::npos) {
+          operatorIndex = exitChange.find("*=",0);
+          assignmentOperator = "*=";
+        } else if(exitChange.find("=",0)!=std::string::npos) {
+          operatorIndex = exitChange.find("=",0);
+          assignmentOperator = "=";
+        }
+        variableName = exitChange.substr(0,operatorIndex);
+        variableValue = std::stod(exitChange.substr(
+         operatorIndex+assignmentOperator.size(),std::string::npos
+        ));
+        if(config.exitStateValues.count(stateName)==0) {
+          config.exitStateValues[stateName] =
+           std::vector<std::tuple<std::string,std::string,double>>();
+        }
+        config.exitStateValues.at(stateName).push_back(
+         std::make_tuple(variableName,assignmentOperator,variableValue)
+        );
+        lineIndex = (
+         delimiterIndex==std::string::npos ?
+         delimiterIndex : delimiterIndex+std::string(",").size()
+        );
+      }
+    } else if(label=="transition") {
+      // Find the delimiter between the transition conditions and the
+      // transition changes
+      std::size_t transitionChangeIndex = line.find(":",0);
+      transitionChangeIndex = (
+       transitionChangeIndex==std::string::npos ?
+       transitionChangeIndex : transitionChangeIndex+std::string(":").size()
+      );
+      transitionChangeIndex = line.find(":",transitionChangeIndex);
+      // Record the transition conditions, source state, and destination state
+      std::string transitionConditions =
+       "transition:"+line.substr(0,transitionChangeIndex);
+      std::size_t srcStartIndex =
+       transitionConditions.find(":",0)+std::string(":").size();
+      std::size_t srcEndIndex = transitionConditions.find("->",0);
+      std::size_t dstStartIndex = srcEndIndex+std::string("->").size();
+      std::size_t dstEndIndex = transitionConditions.find(":",dstStartIndex);
+      std::string srcStateString =
+       transitionConditions.substr(srcStartIndex,srcEndIndex-srcStartIndex);
+      std::string dstStateString =
+       transitionConditions.substr(dstStartIndex,dstEndIndex-dstStartIndex);
+      if(config.stateTransitions.count(srcStateString)==0) {
+        config.stateTransitions[srcStateString] =
+         std::vector<LegacyTransition>();
+      }
+      config.stateTransitions.at(srcStateString).push_back(
+       legacyParseTransition(transitionConditions)
+      );
+      // Record the transition changes
+      transitionChangeIndex = (
+       transitionChangeIndex==std::string::npos ?
+       transitionChangeIndex : transitionChangeIndex+std::string(":").size()
+      );
+      std::string transitionChanges = line.substr(
+       std::min(transitionChangeIndex,line.size()),std::string::npos
+      );
+      if(config.transitionValues.count(srcStateString)==0) {
+        config.transitionValues[srcStateString] = std::map<
+         std::string,std::vector<std::tuple<std::string,std::string,double>>
+        >();
+      }
+      if(config.transitionValues.at(srcStateString).count(dstStateString)==0) {
+        config.transitionValues.at(srcStateString)[dstStateString] =
+         std::vector<std::tuple<std::string,std::string,double>>();
+      }
+      transitionChangeIndex = 0;
+      while(transitionChangeIndex<transitionChanges.size()) {
+        std::size_t delimterIndex =
+         transitionChanges.find(",",transitionChangeIndex);
+        std::string transitionChange = transitionChanges.substr(
+         transitionChangeIndex, delimterIndex
+        );
+        std::size_t operatorIndex = 0;
+        std::string variableName = "";
+        std::string assignmentOperator = "";
+        double variableValue = 0.0;
+        if(transitionChange.find("+=",0)!=std::string::npos) {
+          operatorIndex = transitionChange.find("+=",0);
+          assignmentOperator = "+=";
+        } else if(transitionChange.find("-=",0)!=std::string::npos) {
+          operatorIndex = transitionChange.find("-=",0);
+          assignmentOperator = "-=";
+        } else if(transitionChange.find("*=",0)!=std::string::npos) {
+          operatorIndex = transitionChange.find("*=",0);
+          assignmentOperator = "*=";
+        } else if(transitionChange.find("=",0)!=std::string::npos) {
+          operatorIndex = transitionChange.find("=",0);
+          assignmentOperator = "=";
+        }
+        variableName = transitionChange.substr(0,operatorIndex);
+        variableValue = std::stod(transitionChange.substr(
+         operatorIndex+assignmentOperator.size(),std::string::npos
+        ));
+        config.transitionValues.at(srcStateString).at(dstStateString).push_back
+        (
+         std::make_tuple(variableName,assignmentOperator,variableValue)
+        );
+        transitionChangeIndex = (
+         delimterIndex==std::string::npos ?
+         delimterIndex : delimterIndex+std::string(",").size()
+        );
+      }
+    } else if(label=="initial-state") {
+      config.initialState = line;
+    }
+  }
+  configHandle.close();
+  return config;
+}
+
+// Returns true if the definition holds what the previous parser produced
+bool matches(
+ const LegacyConfiguration& config,
+ const cote::StateMachineDefinition& definition
+) {
+  if(
+   !definition.getParseErrors().empty() ||
+   config.constantValues!=definition.getConstantValues() ||
+   config.enterStateValues!=definition.getEnterStateValues() ||
+   config.exitStateValues!=definition.getExitStateValues() ||
+   config.transitionValues!=definition.getTransitionValues() ||
+   config.initialState!=
+    definition.getStateName(definition.getInitialState()) ||
+   config.variableValues.size()!=definition.getVariableCount()
+  ) {
+    return false;
+  }
+  for(
+   cote::StateMachineDefinition::VarHandle v=0;
+   v<definition.getVariableCount(); v++
+  ) {
+    const std::string& variable = definition.getVariableName(v);
+    if(
+     config.variableValues.count(variable)==0 ||
+     config.variableValues.at(variable)!=
+      definition.getInitialVariableValues().at(v)
+    ) {
+      return false;
+    }
+  }
+  const std::map<std::string,std::vector<cote::StateTransition>>
+   stateTransitions = definition.getStateTransitions();
+  if(config.stateTransitions.size()!=stateTransitions.size()) {
+    return false;
+  }
+  for(
+   std::map<std::string,std::vector<LegacyTransition>>::const_iterator
+    it=config.stateTransitions.begin();
+   it!=config.stateTransitions.end(); it++
+  ) {
+    if(
+     stateTransitions.count(it->first)==0 ||
+     stateTransitions.at(it->first).size()!=it->second.size()
+    ) {
+      return false;
+    }
+    for(std::size_t i=0; i<it->second.size(); i++) {
+      const LegacyTransition& legacy = it->second.at(i);
+      const cote::StateTransition& transition =
+       stateTransitions.at(it->first).at(i);
+      if(
+       legacy.srcState!=transition.getSrcState() ||
+       legacy.dstState!=transition.getDstState() ||
+       legacy.conditions!=transition.getConditions()
+      ) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  // Parse command line argument(s)
+  if(argc!=3 && argc!=4) {
+    std::cout << "Usage: " << argv[0]
+              << " /path/to/configuration/ /path/to/logs/ [file-count]"
+              << std::endl;
+    std::exit(EXIT_SUCCESS);
+  }
+  const std::string configDir(argv[1]);
+  const std::string logDir(argv[2]);
+  const std::size_t fileCount = (argc==4 ? std::stoul(argv[3]) : 10000);
+  // Collect the state machine configuration files
+  std::vector<std::string> sourceFiles;
+  for(
+   const auto& entry :
+   std::filesystem::directory_iterator(configDir)
+  ) {
+    const std::string fileName = entry.path().filename().string();
+    if(
+     (
+      fileName.find("state-machine")!=std::string::npos ||
+      fileName.find("-sm-")!=std::string::npos
+     ) &&
+     entry.path().extension().string()==".dat"
+    ) {
+      sourceFiles.push_back(entry.path().string());
+    }
+  }
+  if(sourceFiles.empty()) {
+    std::cout << "No state machine configuration files found in "
+              << configDir << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  // Write distinct copies so that StateMachineDefinition::load cannot share
+  // definitions between files
+  std::vector<std::string> configFiles;
+  for(std::size_t i=0; i<fileCount; i++) {
+    std::ifstream sourceHandle(sourceFiles.at(i%sourceFiles.size()));
+    const std::string configText(
+     (std::istreambuf_iterator<char>(sourceHandle)),
+     std::istreambuf_iterator<char>()
+    );
+    sourceHandle.close();
+    const std::string configFile =
+     logDir+"state-machine-"+std::to_string(i)+".dat";
+    std::ofstream configHandle(configFile);
+    configHandle << configText;
+    if(!configText.empty() && configText.back()!='\n') {
+      configHandle << '\n';
+    }
+    configHandle << "constant:benchmark-copy:" << i << '\n';
+    configHandle.close();
+    configFiles.push_back(configFile);
+  }
+  // Time the previous parser
+  std::vector<LegacyConfiguration> configs;
+  configs.reserve(fileCount);
+  std::chrono::steady_clock::time_point start =
+   std::chrono::steady_clock::now();
+  for(std::size_t i=0; i<configFiles.size(); i++) {
+    configs.push_back(legacyParseConfiguration(configFiles.at(i)));
+  }
+  const std::chrono::duration<double> legacyS =
+   std::chrono::steady_clock::now()-start;
+  // Time StateMachineDefinition, which also compiles each configuration
+  std::vector<std::shared_ptr<const cote::StateMachineDefinition>> definitions;
+  definitions.reserve(fileCount);
+  start = std::chrono::steady_clock::now();
+  for(std::size_t i=0; i<configFiles.size(); i++) {
+    definitions.push_back(
+     cote::StateMachineDefinition::load(configFiles.at(i))
+    );
+  }
+  const std::chrono::duration<double> definitionS =
+   std::chrono::steady_clock::now()-start;
+  // Compare the parsed contents
+  std::size_t mismatchCount = 0;
+  for(std::size_t i=0; i<configFiles.size(); i++) {
+    if(!matches(configs.at(i),*definitions.at(i))) {
+      mismatchCount++;
+    }
+  }
+  for(std::size_t i=0; i<configFiles.size(); i++) {
+    std::filesystem::remove(configFiles.at(i));
+  }
+  std::cout << "Files: " << fileCount << std::endl
+            << "Mismatches: " << mismatchCount << std::endl
+            << "Previous parser: " << legacyS.count() << " s" << std::endl
+            << "StateMachineDefinition: " << definitionS.count() << " s"
+            << std::endl;
+  std::exit(mismatchCount==0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -366,7 +366,7 @@ int main(int argc, char** argv) {
      CURR_LON, CURR_LAT, PREV_LON, PREV_LAT
     )*cote::cnst::WGS_84_A; // Earth "radius" in km
     if(distanceKm>=satId2ThresholdKm[LEAD_SAT_ID]) {
-      log.evnt(cote::LogLevel::INFO,dateTime.toString(),"trigger-time");
+      COTE_EVNT(log,cote::LogLevel::INFO,dateTime.toString(),"trigger-time");
       for(size_t i=0; i<satellites.size(); i++) {
         satId2Sensor[satellites.at(i).getID()]->triggerSense();
         satId2ThresholdKm[satellites.at(i).getID()] =
@@ -376,13 +376,15 @@ int main(int argc, char** argv) {
     // Log info every 100 sim steps
     if(stepCount%100==0) {
       if(downlinks.size()==0) {
-        log.meas(
+        COTE_MEAS(
+         log,
          cote::LogLevel::INFO,
          dateTime.toString(),
          std::string("downlink-Mbps"),
          std::to_string(0.0)
         );
-        log.meas(
+        COTE_MEAS(
+         log,
          cote::LogLevel::INFO,
          dateTime.toString(),
          std::string("downlink-tx-rx"),
@@ -390,7 +392,8 @@ int main(int argc, char** argv) {
         );
       } else {
         for(size_t i=0; i<downlinks.size(); i++) {
-          log.meas(
+          COTE_MEAS(
+           log,
            cote::LogLevel::INFO,
            dateTime.toString(),
            std::string("downlink-Mbps"),
@@ -398,7 +401,8 @@ int main(int argc, char** argv) {
             static_cast<double>(downlinks.at(i).getBitsPerSec())/1.0e6
            )
           );
-          log.meas(
+          COTE_MEAS(
+           log,
            cote::LogLevel::INFO,
            dateTime.toString(),
            std::string("downlink-tx-rx"),
@@ -407,20 +411,23 @@ int main(int argc, char** argv) {
           );
         }
       }
-      for(size_t i=0; i<satellites.size(); i++) {
-        const uint32_t SAT_ID = satellites.at(i).getID();
-        std::ostringstream oss;
-        oss << "sat-"
-            << std::setw(10) << std::setfill('0') << SAT_ID;
-        log.meas(
-         cote::LogLevel::INFO,
-         dateTime.toString(),
-         std::string("MB-buffered-"+oss.str()),
-         std::to_string(
-          (static_cast<double>(satId2Sensor[SAT_ID]->getBitsBuffered())/8.0)/
-          1.0e6
-         )
-        );
+      // Names are also built only if the logs are kept
+      if(log.isEnabled(cote::LogLevel::INFO)) {
+        for(size_t i=0; i<satellites.size(); i++) {
+          const uint32_t SAT_ID = satellites.at(i).getID();
+          std::ostringstream oss;
+          oss << "sat-"
+              << std::setw(10) << std::setfill('0') << SAT_ID;
+          log.meas(
+           cote::LogLevel::INFO,
+           dateTime.toString(),
+           std::string("MB-buffered-"+oss.str()),
+           std::to_string(
+            (static_cast<double>(satId2Sensor[SAT_ID]->getBitsBuffered())/8.0)/
+            1.0e6
+           )
+          );
+        }
       }
     }
     // Update simulation to the next time step
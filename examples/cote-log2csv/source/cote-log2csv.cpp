@@ -0,0 +1,81 @@
+// cote-log2csv.cpp
+// Converts a binary log file into the equivalent CSV log files
+//
+// Usage: ./cote_log2csv /path/to/log.bin /path/to/csv/
+// /path/to/log.bin: A log file written by a Log in binary format
+// /path/to/csv/: The path to the directory for CSV log files
+// Output:
+//  - One meas-*.csv file per measurement and one evnt-*.csv file per event,
+//    identical to those written by a Log in CSV format
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>           // size_t
+#include <cstdlib>           // exit, EXIT_SUCCESS, EXIT_FAILURE
+#include <filesystem>        // path
+#include <fstream>           // ofstream
+#include <iostream>          // cout
+#include <ostream>           // endl
+#include <set>               // set
+#include <string>            // string
+
+// cote library
+#include <Log.hpp>           // Log
+#include <LogReader.hpp>     // LogReader
+
+int main(int argc, char** argv) {
+  // Set up variables
+  std::filesystem::path logFile;                 // binary log file
+  std::filesystem::path csvDirectory;            // path to CSV destination
+  // Parse command line argument(s)
+  if(argc!=3) {
+    std::cout << "Usage: " << argv[0]
+              << " /path/to/log.bin"
+              << " /path/to/csv/"
+              << std::endl;
+    std::exit(EXIT_SUCCESS);
+  } else {
+    logFile = std::filesystem::path(argv[1]);
+    csvDirectory = std::filesystem::path(argv[2]);
+  }
+  // Set up reader
+  cote::LogReader reader(logFile.string());
+  if(!reader.isValid()) {
+    std::cout << "Not a binary log file: " << logFile.string() << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  // Convert each records block, writing headers on first occurrence
+  std::set<std::string> started;
+  cote::LogReader::Records records;
+  while(reader.read(records)) {
+    const bool isMeas = (records.kind==cote::Log::KEY_MEAS);
+    const std::string fileName =
+     (csvDirectory/((isMeas ? "meas-" : "evnt-")+records.name+".csv")).string();
+    std::ofstream csvFile;
+    if(started.count(fileName)==0) {
+      csvFile.open(fileName,std::ofstream::out);
+      if(isMeas) {
+        csvFile << "time," << records.name << ",\n";
+      } else {
+        csvFile << records.name << "-time,\n";
+      }
+      started.insert(fileName);
+    } else {
+      csvFile.open(fileName,std::ofstream::app);
+    }
+    for(size_t i=0; i<records.times.size(); i++) {
+      csvFile << records.times.at(i) << ",";
+      if(isMeas) {
+        csvFile << records.values.at(i) << ",";
+      }
+      csvFile << "\n";
+    }
+    csvFile.close();
+  }
+  // Clean up
+  std::exit(EXIT_SUCCESS);
+}
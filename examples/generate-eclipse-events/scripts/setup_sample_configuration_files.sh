@@ -0,0 +1,13 @@
+#!/bin/bash
+# Usage: ./setup_sample_configuration_files.sh
+#
+# setup_sample_configuration_files.sh
+# A bash script that sets up sample configuration files
+#
+# Written by Bradley Denby
+# Other contributors: None
+#
+# See the top-level LICENSE file for the license.
+
+cp sample-configuration-files/*.dat ../configuration/
+cp sample-configuration-files/sat.tle ../configuration/
@@ -0,0 +1,92 @@
+// generate-eclipse-events.cpp
+//
+// Generates the eclipse entry and exit times of the indicated satellites over
+// the indicated dates and times. The simulation runs in discrete-event mode, so
+// each satellite is only propagated to the steps at which it is checked.
+//
+// Requires C++17 (e.g. GCC 8) for std::filesystem
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>                 // size_t
+#include <cstdlib>                 // exit, EXIT_SUCCESS
+#include <filesystem>              // path
+#include <iostream>                // cout
+#include <memory>                  // unique_ptr
+#include <ostream>                 // endl
+#include <string>                  // string, to_string
+#include <vector>                  // vector
+
+// cote
+#include <EclipseEventHandler.hpp> // EclipseEventHandler
+#include <Log.hpp>                 // Log
+#include <LogLevel.hpp>            // LogLevel
+#include <Satellite.hpp>           // Satellite
+#include <Simulation.hpp>          // Simulation
+
+int main(int argc, char** argv) {
+  // Set up variables
+  std::filesystem::path configurationDir;            // configuration files
+  std::vector<std::filesystem::path> satelliteFiles; // satellite files
+  std::filesystem::path logDirectory;                // logs destination
+  // Parse command line argument(s)
+  if(argc!=3) {
+    std::cout << "Usage: " << argv[0]
+              << " /path/to/configuration/"
+              << " /path/to/logs/"
+              << std::endl;
+    std::exit(EXIT_SUCCESS);
+  } else {
+    // Set configuration file values
+    configurationDir = std::filesystem::path(argv[1]);
+    std::filesystem::directory_iterator it(configurationDir);
+    while(it!=std::filesystem::end(it)) {
+      std::string pathStr = it->path().string();
+      if(pathStr.size()>=4 && pathStr.substr(pathStr.size()-4,4)==".tle") {
+        satelliteFiles.push_back(it->path());
+      }
+      it++;
+    }
+    // Set log directory
+    logDirectory = std::filesystem::path(argv[2]);
+  }
+  // Set up log
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,logDirectory.string());
+  // Set up simulation from date-time.dat, time-step.dat and num-steps.dat
+  cote::Simulation simulation(configurationDir.string(),0,&log);
+  // Set up satellites
+  std::vector<std::unique_ptr<cote::Satellite>> satellites;
+  for(std::size_t i=0; i<satelliteFiles.size(); i++) {
+    satellites.push_back(
+     std::unique_ptr<cote::Satellite>(
+      new cote::Satellite(
+       satelliteFiles.at(i).string(),simulation.getDateTime(),&log
+      )
+     )
+    );
+  }
+  // Set up eclipse events
+  cote::EclipseEventHandler eclipseEventHandler(0,&log);
+  for(std::size_t i=0; i<satellites.size(); i++) {
+    eclipseEventHandler.addSatellite(satellites.at(i).get());
+  }
+  eclipseEventHandler.start(&simulation);
+  // Simulation loop
+  simulation.runEvents();
+  // Log the results
+  log.meas(
+   cote::LogLevel::INFO,
+   simulation.getDateTime()->toString(),
+   std::string("handled-event-count"),
+   std::to_string(simulation.getHandledEventCount())
+  );
+  // Write out logs
+  log.writeAll();
+  // Clean up
+  std::exit(EXIT_SUCCESS);
+}
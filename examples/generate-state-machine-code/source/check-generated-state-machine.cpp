@@ -0,0 +1,100 @@
+// check-generated-state-machine.cpp
+//
+// Steps the header generated from computer-state-machine.dat alongside a
+// StateMachine built from the same file through the IStateMachine interface,
+// reports any difference in state or variable values, and reports the time
+// each takes.
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <chrono>                   // duration, steady_clock
+#include <cstddef>                  // size_t
+#include <cstdlib>                  // exit, EXIT_FAILURE, EXIT_SUCCESS
+#include <iostream>                 // cout
+#include <map>                      // map
+#include <ostream>                  // endl
+#include <string>                   // string
+
+// cote
+#include <ComputerStateMachine.hpp> // ComputerStateMachine (generated)
+#include <IStateMachine.hpp>        // IStateMachine
+#include <StateMachine.hpp>         // StateMachine
+
+// Feeds both state machines the same voltage sweep and task claims, and
+// periodically parks them in a state the configuration does not name
+void step(cote::IStateMachine& stateMachine, const std::size_t& i) {
+  if(i%1000==500) {
+    stateMachine.setCurrentState("SAFE");
+  } else if(i%1000==700) {
+    stateMachine.setCurrentState("SLEEP");
+  }
+  stateMachine.setVariableValue(
+   "node-voltage",4.5+0.05*static_cast<double>(i%60)
+  );
+  stateMachine.setVariableValue(
+   "claimed-task-count",((i/7)%3==0) ? 1.0 : 0.0
+  );
+  stateMachine.updateState();
+}
+
+int main(int argc, char** argv) {
+  // Parse command line argument(s)
+  if(argc!=2) {
+    std::cout << "Usage: " << argv[0]
+              << " /path/to/computer-state-machine.dat"
+              << std::endl;
+    std::exit(EXIT_SUCCESS);
+  }
+  const std::size_t stepCount = 1000000;
+  // Compare every step
+  cote::StateMachine interpreted(argv[1]);
+  cote::ComputerStateMachine generated;
+  std::size_t mismatchCount = 0;
+  for(std::size_t i=0; i<stepCount; i++) {
+    step(interpreted,i);
+    step(generated,i);
+    if(
+     interpreted.getCurrentState()!=generated.getCurrentState() ||
+     interpreted.getVariableValues()!=generated.getVariableValues()
+    ) {
+      mismatchCount++;
+    }
+  }
+  std::cout << "Mismatches: " << mismatchCount << std::endl;
+  // Time the two through the hot-loop interfaces
+  const cote::StateMachine::VarHandle NODE_VOLTAGE =
+   interpreted.getVariableHandle("node-voltage");
+  const cote::StateMachine::VarHandle CLAIMED_TASK_COUNT =
+   interpreted.getVariableHandle("claimed-task-count");
+  std::chrono::steady_clock::time_point start =
+   std::chrono::steady_clock::now();
+  for(std::size_t i=0; i<stepCount; i++) {
+    interpreted.setVariableValue(
+     NODE_VOLTAGE,4.5+0.05*static_cast<double>(i%60)
+    );
+    interpreted.setVariableValue(
+     CLAIMED_TASK_COUNT,((i/7)%3==0) ? 1.0 : 0.0
+    );
+    interpreted.updateState();
+  }
+  const std::chrono::duration<double> interpretedS =
+   std::chrono::steady_clock::now()-start;
+  start = std::chrono::steady_clock::now();
+  for(std::size_t i=0; i<stepCount; i++) {
+    generated.getVariables().nodeVoltage =
+     4.5+0.05*static_cast<double>(i%60);
+    generated.getVariables().claimedTaskCount = ((i/7)%3==0) ? 1.0 : 0.0;
+    generated.updateState();
+  }
+  const std::chrono::duration<double> generatedS =
+   std::chrono::steady_clock::now()-start;
+  std::cout << "Interpreted: " << interpretedS.count() << " s" << std::endl
+            << "Generated: " << generatedS.count() << " s" << std::endl
+            << "Final states: " << interpreted.getCurrentState() << " "
+            << generated.getCurrentState() << std::endl;
+  std::exit(mismatchCount==0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,512 @@
+// generate-state-machine-code.cpp
+//
+// Generates a C++ header from a state machine configuration file. The header
+// defines a class that implements IStateMachine, as StateMachine does, whose
+// states are an enum, whose variables are struct members, and whose
+// updateState is a switch with the guards and actions inlined, so the
+// compiler can optimize the control logic of a fixed configuration.
+// StateMachine remains the flexible default for configurations that change
+// between runs.
+//
+// Requires C++17 (e.g. GCC 8) for std::filesystem
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cctype>                     // isalnum, isdigit, tolower, toupper
+#include <cstddef>                    // size_t
+#include <cstdlib>                    // exit, EXIT_FAILURE, EXIT_SUCCESS
+#include <filesystem>                 // is_regular_file, path
+#include <fstream>                    // ofstream
+#include <iomanip>                    // setprecision
+#include <iostream>                   // cout
+#include <limits>                     // numeric_limits
+#include <map>                        // map
+#include <memory>                     // shared_ptr
+#include <ostream>                    // endl
+#include <set>                        // set
+#include <sstream>                    // ostringstream
+#include <string>                     // string, stod
+#include <vector>                     // vector
+
+// cote
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+
+typedef cote::StateMachineDefinition Definition;
+
+// Splits the name at characters that cannot appear in an identifier, e.g.
+// "node-voltage" yields "node" and "voltage"
+std::vector<std::string> splitName(const std::string& name) {
+  std::vector<std::string> words;
+  std::string word = "";
+  for(std::size_t i=0; i<name.size(); i++) {
+    if(std::isalnum(static_cast<unsigned char>(name.at(i)))) {
+      word += name.at(i);
+    } else if(!word.empty()) {
+      words.push_back(word);
+      word = "";
+    }
+  }
+  if(!word.empty()) {
+    words.push_back(word);
+  }
+  return words;
+}
+
+// Makes the identifier distinct from those already used and records it
+std::string makeUnique(
+ const std::string& identifier, std::set<std::string>& usedIdentifiers
+) {
+  const std::string validIdentifier =
+   (identifier.empty() || std::isdigit(identifier.at(0))) ?
+   "_"+identifier : identifier;
+  std::string uniqueIdentifier = validIdentifier;
+  for(std::size_t i=2; usedIdentifiers.count(uniqueIdentifier)!=0; i++) {
+    uniqueIdentifier = validIdentifier+"_"+std::to_string(i);
+  }
+  usedIdentifiers.insert(uniqueIdentifier);
+  return uniqueIdentifier;
+}
+
+// e.g. "computer-state-machine" yields "ComputerStateMachine"
+std::string toPascalCase(const std::string& name) {
+  std::vector<std::string> words = splitName(name);
+  std::string identifier = "";
+  for(std::size_t i=0; i<words.size(); i++) {
+    identifier += static_cast<char>(
+     std::toupper(static_cast<unsigned char>(words.at(i).at(0)))
+    );
+    identifier += words.at(i).substr(1);
+  }
+  return identifier;
+}
+
+// e.g. "node-voltage" yields "nodeVoltage"
+std::string toCamelCase(const std::string& name) {
+  std::string identifier = toPascalCase(name);
+  if(!identifier.empty()) {
+    identifier.at(0) = static_cast<char>(
+     std::tolower(static_cast<unsigned char>(identifier.at(0)))
+    );
+  }
+  return identifier;
+}
+
+// e.g. "task-duration-s" yields "TASK_DURATION_S"
+std::string toUpperSnakeCase(const std::string& name) {
+  std::vector<std::string> words = splitName(name);
+  std::string identifier = "";
+  for(std::size_t i=0; i<words.size(); i++) {
+    identifier += (i==0 ? "" : "_");
+    for(std::size_t j=0; j<words.at(i).size(); j++) {
+      identifier += static_cast<char>(
+       std::toupper(static_cast<unsigned char>(words.at(i).at(j)))
+      );
+    }
+  }
+  return identifier;
+}
+
+// Returns the shortest literal that reads back as exactly the same double
+std::string toLiteral(const double& value) {
+  if(value!=value) {
+    return "std::numeric_limits<double>::quiet_NaN()";
+  } else if(value==std::numeric_limits<double>::infinity()) {
+    return "std::numeric_limits<double>::infinity()";
+  } else if(value==-std::numeric_limits<double>::infinity()) {
+    return "-std::numeric_limits<double>::infinity()";
+  }
+  std::string literal = "";
+  for(
+   int precision=1;
+   precision<=std::numeric_limits<double>::max_digits10; precision++
+  ) {
+    std::ostringstream stream;
+    stream << std::setprecision(precision) << value;
+    literal = stream.str();
+    if(std::stod(literal)==value) {
+      break;
+    }
+  }
+  if(literal.find_first_of(".eE")==std::string::npos) {
+    literal += ".0";
+  }
+  return literal;
+}
+
+// Returns the quoted C++ string literal of the text
+std::string toStringLiteral(const std::string& text) {
+  std::string literal = "\"";
+  for(std::size_t i=0; i<text.size(); i++) {
+    if(text.at(i)=='"' || text.at(i)=='\\') {
+      literal += '\\';
+    }
+    literal += text.at(i);
+  }
+  return literal+"\"";
+}
+
+// Writes one statement per action, indented by the given prefix
+void writeActions(
+ std::ofstream& header, const std::vector<Definition::Action>& actions,
+ const std::vector<std::string>& variableMembers, const std::string& indent
+) {
+  for(std::size_t i=0; i<actions.size(); i++) {
+    const Definition::Action& action = actions.at(i);
+    std::string assignmentOperator = "=";
+    if(action.opcode==Definition::Opcode::ADD) {
+      assignmentOperator = "+=";
+    } else if(action.opcode==Definition::Opcode::SUBTRACT) {
+      assignmentOperator = "-=";
+    } else if(action.opcode==Definition::Opcode::MULTIPLY) {
+      assignmentOperator = "*=";
+    }
+    header << indent << "this->variables."
+           << variableMembers.at(action.variable) << " "
+           << assignmentOperator << " " << toLiteral(action.value) << ";"
+           << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  // Parse command line argument(s)
+  if(argc!=3) {
+    std::cout << "Usage: " << argv[0]
+              << " /path/to/state-machine.dat"
+              << " /path/to/output/"
+              << std::endl;
+    std::exit(EXIT_SUCCESS);
+  }
+  const std::filesystem::path configFile(argv[1]);
+  const std::filesystem::path outputDirectory(argv[2]);
+  if(!std::filesystem::is_regular_file(configFile)) {
+    std::cout << "Error: cannot read " << configFile.string() << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  std::shared_ptr<const Definition> definition =
+   Definition::load(configFile.string());
+  // Name the class, states, variables, and constants
+  const std::string className = toPascalCase(configFile.stem().string());
+  std::set<std::string> usedIdentifiers;
+  std::vector<std::string> stateEnumerators;
+  for(Definition::StateId i=0; i<definition->getStateCount(); i++) {
+    stateEnumerators.push_back(makeUnique(
+     toUpperSnakeCase(definition->getStateName(i)),usedIdentifiers
+    ));
+  }
+  // Stands for any state that setCurrentState names but the configuration
+  // does not, as the extra state names of StateMachine do
+  const std::string extraStateEnumerator =
+   makeUnique("EXTRA_STATE",usedIdentifiers);
+  std::vector<std::string> variableMembers;
+  for(Definition::VarHandle i=0; i<definition->getVariableCount(); i++) {
+    variableMembers.push_back(makeUnique(
+     toCamelCase(definition->getVariableName(i)),usedIdentifiers
+    ));
+  }
+  const std::map<std::string,double> constantValues =
+   definition->getConstantValues();
+  std::map<std::string,std::string> constantMembers;
+  for(
+   std::map<std::string,double>::const_iterator it=constantValues.begin();
+   it!=constantValues.end(); it++
+  ) {
+    constantMembers[it->first] =
+     makeUnique(toUpperSnakeCase(it->first),usedIdentifiers);
+  }
+  // Actions on undeclared variables fail when taken in StateMachine; reject
+  // them here instead
+  for(Definition::StateId i=0; i<definition->getStateCount(); i++) {
+    std::vector<const std::vector<Definition::Action>*> actionLists = {
+     &definition->getEnterActions(i), &definition->getExitActions(i)
+    };
+    for(std::size_t j=0; j<definition->getTransitions(i).size(); j++) {
+      actionLists.push_back(&definition->getTransitions(i).at(j).actions);
+    }
+    for(std::size_t j=0; j<actionLists.size(); j++) {
+      for(std::size_t k=0; k<actionLists.at(j)->size(); k++) {
+        if(actionLists.at(j)->at(k).variable==Definition::NO_VARIABLE) {
+          std::cout << "Error: an action of state "
+                    << definition->getStateName(i)
+                    << " assigns an undeclared variable" << std::endl;
+          std::exit(EXIT_FAILURE);
+        }
+      }
+    }
+  }
+  // Write the header
+  const std::filesystem::path headerFile =
+   outputDirectory/(className+".hpp");
+  const std::string guard =
+   "COTE_GENERATED_"+toUpperSnakeCase(configFile.stem().string())+"_HPP";
+  const std::string initialState =
+   stateEnumerators.at(definition->getInitialState());
+  std::ofstream header(headerFile.string());
+  header << "// " << className << ".hpp" << std::endl
+         << "// " << className << " class header file" << std::endl
+         << "//" << std::endl
+         << "// Generated by generate-state-machine-code from "
+         << configFile.filename().string() << std::endl
+         << "// Regenerate from the configuration file instead of editing"
+         << std::endl
+         << "//" << std::endl
+         << "// See the top-level LICENSE file for the license." << std::endl
+         << std::endl
+         << "#ifndef " << guard << std::endl
+         << "#define " << guard << std::endl
+         << std::endl
+         << "// Standard library" << std::endl
+         << "#include <cstdint>           // uint32_t" << std::endl
+         << "#include <limits>            // numeric_limits" << std::endl
+         << "#include <map>               // map" << std::endl
+         << "#include <string>            // string" << std::endl
+         << std::endl
+         << "// cote" << std::endl
+         << "#include <IStateMachine.hpp> // IStateMachine" << std::endl
+         << "#include <Log.hpp>           // Log" << std::endl
+         << std::endl
+         << "namespace cote {" << std::endl
+         << "  class " << className << " final : public IStateMachine {"
+         << std::endl
+         << "  public:" << std::endl;
+  // States, variables, and constants
+  header << "    enum class State {" << std::endl;
+  for(std::size_t i=0; i<stateEnumerators.size(); i++) {
+    header << "      " << stateEnumerators.at(i) << "," << std::endl;
+  }
+  header << "      " << extraStateEnumerator
+         << " // named by setCurrentState but not the configuration"
+         << std::endl
+         << "    };" << std::endl
+         << "    struct Variables {" << std::endl;
+  for(Definition::VarHandle i=0; i<variableMembers.size(); i++) {
+    header << "      double " << variableMembers.at(i) << " = "
+           << toLiteral(definition->getInitialVariableValues().at(i)) << ";"
+           << std::endl;
+  }
+  header << "    };" << std::endl;
+  for(
+   std::map<std::string,double>::const_iterator it=constantValues.begin();
+   it!=constantValues.end(); it++
+  ) {
+    header << "    static constexpr double " << constantMembers.at(it->first)
+           << " = " << toLiteral(it->second) << ";" << std::endl;
+  }
+  // Constructor
+  header << "    " << className
+         << "(const uint32_t& id=0, Log* const log=NULL) :" << std::endl
+         << "     currentState(State::" << initialState
+         << "), id(id), log(log) {}" << std::endl;
+  // IStateMachine interface
+  header << "    // IStateMachine interface" << std::endl
+         << "    std::map<std::string,double> getConstantValues() const"
+         << std::endl
+         << "     override {" << std::endl
+         << "      std::map<std::string,double> constantValues;" << std::endl;
+  for(
+   std::map<std::string,double>::const_iterator it=constantValues.begin();
+   it!=constantValues.end(); it++
+  ) {
+    header << "      constantValues[" << toStringLiteral(it->first) << "] = "
+           << constantMembers.at(it->first) << ";" << std::endl;
+  }
+  header << "      return constantValues;" << std::endl
+         << "    }" << std::endl
+         << "    std::map<std::string,double> getVariableValues() const"
+         << std::endl
+         << "     override {" << std::endl
+         << "      std::map<std::string,double> variableValues;" << std::endl;
+  for(Definition::VarHandle i=0; i<variableMembers.size(); i++) {
+    header << "      variableValues["
+           << toStringLiteral(definition->getVariableName(i)) << "] = "
+           << "this->variables." << variableMembers.at(i) << ";"
+           << std::endl;
+  }
+  header << "      return variableValues;" << std::endl
+         << "    }" << std::endl
+         << "    std::string getCurrentState() const override {" << std::endl
+         << "      if(this->currentState==State::" << extraStateEnumerator
+         << ") {" << std::endl
+         << "        return this->extraStateName;" << std::endl
+         << "      }" << std::endl
+         << "      return getStateName(this->currentState);" << std::endl
+         << "    }" << std::endl
+         << "    uint32_t getID() const override {" << std::endl
+         << "      return this->id;" << std::endl
+         << "    }" << std::endl
+         << "    Log* getLog() const override {" << std::endl
+         << "      return this->log;" << std::endl
+         << "    }" << std::endl
+         << "    double getConstantValue(const std::string& constant) const"
+         << std::endl
+         << "     override {" << std::endl
+         << "      return this->getConstantValues().at(constant);" << std::endl
+         << "    }" << std::endl
+         << "    double getVariableValue(const std::string& variable) const"
+         << std::endl
+         << "     override {" << std::endl
+         << "      return this->getVariableValues().at(variable);" << std::endl
+         << "    }" << std::endl
+         << "    void setVariableValue(" << std::endl
+         << "     const std::string& variable, const double& value" << std::endl
+         << "    ) override {" << std::endl;
+  for(Definition::VarHandle i=0; i<variableMembers.size(); i++) {
+    header << "      " << (i==0 ? "if" : "} else if") << "(variable=="
+           << toStringLiteral(definition->getVariableName(i)) << ") {"
+           << std::endl
+           << "        this->variables." << variableMembers.at(i)
+           << " = value;" << std::endl;
+  }
+  header << "      " << (variableMembers.empty() ? "{" : "} else {")
+         << std::endl
+         << "        // Throws std::out_of_range as StateMachine does"
+         << std::endl
+         << "        this->getVariableValues().at(variable);" << std::endl
+         << "      }" << std::endl
+         << "    }" << std::endl
+         << "    // A state the configuration does not name is entered as "
+         << extraStateEnumerator << std::endl
+         << "    void setCurrentState(const std::string& state) override {"
+         << std::endl;
+  for(Definition::StateId i=0; i<stateEnumerators.size(); i++) {
+    header << "      " << (i==0 ? "if" : "} else if") << "(state=="
+           << toStringLiteral(definition->getStateName(i)) << ") {"
+           << std::endl
+           << "        this->setCurrentState(State::"
+           << stateEnumerators.at(i) << ");" << std::endl;
+  }
+  header << "      } else {" << std::endl
+         << "        this->extraStateName = state;" << std::endl
+         << "        this->setCurrentState(State::" << extraStateEnumerator
+         << ");" << std::endl
+         << "      }" << std::endl
+         << "    }" << std::endl;
+  // updateState
+  header << "    void updateState() override {" << std::endl
+         << "      switch(this->currentState) {" << std::endl;
+  for(Definition::StateId i=0; i<stateEnumerators.size(); i++) {
+    header << "        case State::" << stateEnumerators.at(i) << ":"
+           << std::endl;
+    const std::vector<Definition::Transition>& transitions =
+     definition->getTransitions(i);
+    std::string keyword = "if";
+    for(std::size_t j=0; j<transitions.size(); j++) {
+      const Definition::Transition& transition = transitions.at(j);
+      if(!transition.satisfiable) {
+        continue; // reads an undeclared variable, so it is never taken
+      }
+      std::string guard = "";
+      for(std::size_t k=0; k<transition.conditions.size(); k++) {
+        const Definition::Condition& condition = transition.conditions.at(k);
+        std::string comparisonOperator = "==";
+        if(condition.comparison==Definition::Comparison::NE) {
+          comparisonOperator = "!=";
+        } else if(condition.comparison==Definition::Comparison::LE) {
+          comparisonOperator = "<=";
+        } else if(condition.comparison==Definition::Comparison::GE) {
+          comparisonOperator = ">=";
+        } else if(condition.comparison==Definition::Comparison::LT) {
+          comparisonOperator = "<";
+        } else if(condition.comparison==Definition::Comparison::GT) {
+          comparisonOperator = ">";
+        }
+        // One condition per line, as long conditions are written by hand
+        guard += (k==0 ? "\n           " : " &&\n           ");
+        guard += "this->variables."+variableMembers.at(condition.variable)+
+         comparisonOperator+toLiteral(condition.value);
+      }
+      header << "          " << (keyword=="if" ? "" : "} ") << keyword << "("
+             << (guard.empty() ? "true" : guard+"\n          ") << ") {"
+             << std::endl
+             << "            this->currentState = State::"
+             << stateEnumerators.at(transition.dstState) << ";" << std::endl
+             << "            this->exitState(State::"
+             << stateEnumerators.at(i) << ");" << std::endl;
+      writeActions(header,transition.actions,variableMembers,"            ");
+      header << "            this->enterState(State::"
+             << stateEnumerators.at(transition.dstState) << ");"
+             << std::endl;
+      keyword = "else if";
+    }
+    if(keyword!="if") {
+      header << "          }" << std::endl;
+    }
+    header << "          break;" << std::endl;
+  }
+  header << "        case State::" << extraStateEnumerator << ":" << std::endl
+         << "          break; // no transitions" << std::endl
+         << "      }" << std::endl
+         << "    }" << std::endl;
+  // Direct access
+  header << "    // Direct access for hot loops" << std::endl
+         << "    State getCurrentStateId() const {" << std::endl
+         << "      return this->currentState;" << std::endl
+         << "    }" << std::endl
+         << "    void setCurrentState(const State& state) {" << std::endl
+         << "      const State previousState = this->currentState;"
+         << std::endl
+         << "      this->currentState = state;" << std::endl
+         << "      this->exitState(previousState);" << std::endl
+         << "      this->enterState(state);" << std::endl
+         << "    }" << std::endl
+         << "    Variables& getVariables() {" << std::endl
+         << "      return this->variables;" << std::endl
+         << "    }" << std::endl
+         << "    const Variables& getVariables() const {" << std::endl
+         << "      return this->variables;" << std::endl
+         << "    }" << std::endl
+         << "    static std::string getStateName(const State& state) {"
+         << std::endl
+         << "      switch(state) {" << std::endl;
+  for(Definition::StateId i=0; i<stateEnumerators.size(); i++) {
+    header << "        case State::" << stateEnumerators.at(i) << ":"
+           << std::endl
+           << "          return "
+           << toStringLiteral(definition->getStateName(i)) << ";"
+           << std::endl;
+  }
+  header << "        case State::" << extraStateEnumerator << ":" << std::endl
+         << "          break; // see getCurrentState" << std::endl
+         << "      }" << std::endl
+         << "      return \"\";" << std::endl
+         << "    }" << std::endl
+         << "  private:" << std::endl;
+  // Enter and exit actions
+  for(std::size_t pass=0; pass<2; pass++) {
+    header << "    void " << (pass==0 ? "enterState" : "exitState")
+           << "(const State& state) {" << std::endl
+           << "      switch(state) {" << std::endl;
+    for(Definition::StateId i=0; i<stateEnumerators.size(); i++) {
+      const std::vector<Definition::Action>& actions =
+       (pass==0) ? definition->getEnterActions(i) :
+       definition->getExitActions(i);
+      if(!actions.empty()) {
+        header << "        case State::" << stateEnumerators.at(i) << ":"
+               << std::endl;
+        writeActions(header,actions,variableMembers,"          ");
+        header << "          break;" << std::endl;
+      }
+    }
+    header << "        default:" << std::endl
+           << "          break;" << std::endl
+           << "      }" << std::endl
+           << "    }" << std::endl;
+  }
+  header << "    Variables variables;        // variable values" << std::endl
+         << "    State currentState;         // the current state" << std::endl
+         << "    std::string extraStateName; // the name of "
+         << extraStateEnumerator << std::endl
+         << "    uint32_t id;                // identification number"
+         << std::endl
+         << "    Log* log;                   "
+         << "// singleton, should not be deleted" << std::endl
+         << "  };" << std::endl
+         << "}" << std::endl
+         << std::endl
+         << "#endif" << std::endl;
+  header.close();
+  std::exit(EXIT_SUCCESS);
+}
@@ -11,25 +11,28 @@
 // See the top-level LICENSE file for the license.
 
 // Standard library
-#include <cmath>            // round
-#include <cstdlib>          // exit, EXIT_SUCCESS
-#include <filesystem>       // path
-#include <fstream>          // ifstream
-#include <iostream>         // cout
-#include <ostream>          // endl
-#include <string>           // string
-#include <vector>           // vector
+#include <algorithm>          // max, min
+#include <cmath>              // ceil, round
+#include <cstdint>            // uint8_t, uint32_t, uint64_t
+#include <cstdlib>            // exit, EXIT_SUCCESS
+#include <filesystem>         // path
+#include <fstream>            // ifstream
+#include <iostream>           // cout
+#include <ostream>            // endl
+#include <string>             // string
+#include <vector>             // vector
 
 // cote
-#include <Capacitor.hpp>    // Capacitor
-#include <constants.hpp>    // constants
-#include <DateTime.hpp>     // DateTime
-#include <Log.hpp>          // Log
-#include <LogLevel.hpp>     // LogLevel
-#include <Satellite.hpp>    // Satellite
-#include <SolarArray.hpp>   // SolarArray
-#include <StateMachine.hpp> // StateMachine
-#include <utilities.hpp>    // calcJulianDayFromYMD, calcSecSinceMidnight
+#include <Capacitor.hpp>      // Capacitor
+#include <constants.hpp>      // constants
+#include <DateTime.hpp>       // DateTime
+#include <Log.hpp>            // Log
+#include <LogLevel.hpp>       // LogLevel
+#include <PowerSubsystem.hpp> // PowerSubsystem
+#include <Satellite.hpp>      // Satellite
+#include <SolarArray.hpp>     // SolarArray
+#include <StateMachine.hpp>   // StateMachine
+#include <utilities.hpp>      // calcJulianDayFromYMD, calcSecSinceMidnight
 
 int main(int argc, char** argv) {
   // Set up variables
@@ -121,6 +124,17 @@ int main(int argc, char** argv) {
    static_cast<double>(secondStep)+
    static_cast<double>(nanosecondStep)/
    static_cast<double>(cote::cnst::NS_PER_SEC);
+  const uint64_t NS_PER_MIN =
+   static_cast<uint64_t>(cote::cnst::SEC_PER_MIN)*
+   static_cast<uint64_t>(cote::cnst::NS_PER_SEC);
+  const uint64_t NS_PER_HOUR =
+   static_cast<uint64_t>(cote::cnst::MIN_PER_HOUR)*NS_PER_MIN;
+  const uint64_t timeStepNs =
+   static_cast<uint64_t>(hourStep)*NS_PER_HOUR+
+   static_cast<uint64_t>(minuteStep)*NS_PER_MIN+
+   static_cast<uint64_t>(secondStep)*
+   static_cast<uint64_t>(cote::cnst::NS_PER_SEC)+
+   static_cast<uint64_t>(nanosecondStep);
   // Set up step count
   std::ifstream numStepsHandle(numStepsFile.string());
   line = "";
@@ -159,9 +173,29 @@ int main(int argc, char** argv) {
   cote::StateMachine cameraStateMachine(cameraSMFile.string(),2,&log);
   // Set up ADACS state machine
   cote::StateMachine adacsStateMachine(adacsSMFile.string(),3,&log);
+  // Look up the states and variables used every step once, up front
+  const cote::StateMachine::StateId COMPUTER_WORK =
+   computerStateMachine.getStateId("WORK");
+  const cote::StateMachine::StateId CAMERA_IMAGING =
+   cameraStateMachine.getStateId("IMAGING");
+  const cote::StateMachine::StateId CAMERA_READOUT =
+   cameraStateMachine.getStateId("READOUT");
+  const cote::StateMachine::VarHandle COMPUTER_NODE_VOLTAGE =
+   computerStateMachine.getVariableHandle("node-voltage");
+  const cote::StateMachine::VarHandle CAMERA_NODE_VOLTAGE =
+   cameraStateMachine.getVariableHandle("node-voltage");
+  const cote::StateMachine::VarHandle ADACS_NODE_VOLTAGE =
+   adacsStateMachine.getVariableHandle("node-voltage");
+  // Set up power subsystem
+  cote::PowerSubsystem powerSubsystem(&capacitor,&solarArray,0,&log);
   // Simulation loop
+  //// Each iteration jumps over as many time steps as possible: nothing but
+  //// the capacitor charge and the state machine timers changes until the next
+  //// log sample, frame trigger, task completion, or node voltage threshold,
+  //// and the capacitor charge is advanced in closed form
   uint64_t gtfTrigger = 0;
   uint64_t stepCount = 0;
+  bool singleStep = true; // set when state machines must be checked next step
   while(stepCount<numSteps) {
     // Simulation logic
     const double JD = cote::util::calcJulianDayFromYMD(
@@ -180,41 +214,27 @@ int main(int argc, char** argv) {
     const double irradianceWPerM2 =
      -1352.44*sunOcclusionFactor+cote::cnst::SOLAR_CONSTANT;
     solarArray.setIrradianceWpM2(irradianceWPerM2); // sets solar array amps
-    double powerW =
+    powerSubsystem.setLoadPowerW(
      computerStateMachine.getVariableValue("power-w")+
      cameraStateMachine.getVariableValue("power-w")+
-     adacsStateMachine.getVariableValue("power-w");
-    double nodeVoltageDiscriminant = cote::util::calcNodeVoltageDiscriminant(
-     capacitor.getChargeCoulomb(), capacitor.getCapacitanceFarad(),
-     solarArray.getCurrentAmpere(), capacitor.getEsrOhm(), powerW
+     adacsStateMachine.getVariableValue("power-w")
     );
-    if(nodeVoltageDiscriminant<0.0) { // if power draw too high, set all to off
+    if(powerSubsystem.isBrownout()) { // if power draw too high, set all to off
       computerStateMachine.setCurrentState("OFF");
       cameraStateMachine.setCurrentState("OFF");
       adacsStateMachine.setCurrentState("OFF");
-      powerW =
+      powerSubsystem.setLoadPowerW(
        computerStateMachine.getVariableValue("power-w")+
        cameraStateMachine.getVariableValue("power-w")+
-       adacsStateMachine.getVariableValue("power-w");
-      nodeVoltageDiscriminant = cote::util::calcNodeVoltageDiscriminant(
-       capacitor.getChargeCoulomb(), capacitor.getCapacitanceFarad(),
-       solarArray.getCurrentAmpere(), capacitor.getEsrOhm(), powerW
+       adacsStateMachine.getVariableValue("power-w")
       );
     }
-    const double nodeVoltage = cote::util::calcNodeVoltage(
-     nodeVoltageDiscriminant, capacitor.getChargeCoulomb(),
-     capacitor.getCapacitanceFarad(), solarArray.getCurrentAmpere(),
-     capacitor.getEsrOhm()
-    );
-    if(
-     solarArray.getOpenCircuitVoltage()<=nodeVoltage &&
-     solarArray.getCurrentAmpere()!=0.0
-    ) { // Zero out solar array current if node voltage is too high
-      solarArray.setCurrentAmpere(0.0);
-    }
+    //// The power subsystem clips the solar array current at the open circuit
+    //// voltage while advancing the capacitor charge
+    const double nodeVoltage = powerSubsystem.getNodeVoltage();
     // Computer state machine custom logic
-    computerStateMachine.setVariableValue("node-voltage",nodeVoltage);
-    if(computerStateMachine.getCurrentState()=="WORK") {
+    computerStateMachine.setVariableValue(COMPUTER_NODE_VOLTAGE,nodeVoltage);
+    if(computerStateMachine.getCurrentStateId()==COMPUTER_WORK) {
       const double taskDurationS =
        computerStateMachine.getConstantValue("task-duration-s");
       double workTimeS = computerStateMachine.getVariableValue("work-time-s");
@@ -231,8 +251,8 @@ int main(int argc, char** argv) {
       );
     }
     // Camera state machine custom logic
-    cameraStateMachine.setVariableValue("node-voltage",nodeVoltage);
-    if(cameraStateMachine.getCurrentState()=="IMAGING") {
+    cameraStateMachine.setVariableValue(CAMERA_NODE_VOLTAGE,nodeVoltage);
+    if(cameraStateMachine.getCurrentStateId()==CAMERA_IMAGING) {
       const double imagingDurationS =
        cameraStateMachine.getConstantValue("imaging-duration-s");
       double imagingTimeS =
@@ -255,7 +275,7 @@ int main(int argc, char** argv) {
       cameraStateMachine.setVariableValue(
        "readout-task-count",static_cast<double>(readoutTaskCount)
       );
-    } else if(cameraStateMachine.getCurrentState()=="READOUT") {
+    } else if(cameraStateMachine.getCurrentStateId()==CAMERA_READOUT) {
       const double readoutDurationS =
        cameraStateMachine.getConstantValue("readout-duration-s");
       double readoutTimeS =
@@ -280,7 +300,7 @@ int main(int argc, char** argv) {
       );
     }
     // ADACS state machine custom logic
-    adacsStateMachine.setVariableValue("node-voltage",nodeVoltage);
+    adacsStateMachine.setVariableValue(ADACS_NODE_VOLTAGE,nodeVoltage);
     // Trigger a new ground track frame every 1.7 seconds
     if(gtfTrigger==0) {
       std::size_t imagingTaskCount = std::round(
@@ -311,46 +331,135 @@ int main(int argc, char** argv) {
        cameraStateMachine.getCurrentState()
       );
     }
-    // Update simulation to the next time step
-    dateTime.update(hourStep,minuteStep,secondStep,nanosecondStep);
-    satellite.update(hourStep,minuteStep,secondStep,nanosecondStep);
-    double capacitorChargeCoulomb = capacitor.getChargeCoulomb();
-    const double totalLoadCurrentAmpere = (
-     computerStateMachine.getVariableValue("power-w")+
-     cameraStateMachine.getVariableValue("power-w")+
-     adacsStateMachine.getVariableValue("power-w")
-    )/nodeVoltage;
-    capacitorChargeCoulomb += (
-     solarArray.getCurrentAmpere()-totalLoadCurrentAmpere
-    )*timeStepSec;
-    if(capacitorChargeCoulomb<0.0) {
-      capacitorChargeCoulomb = 0.0;
+    // Find the number of time steps until the next event
+    //// Variables changed by an event are seen by the state machines at the
+    //// end of the following step, so the step after an event is taken alone
+    uint64_t stepsToEvent = static_cast<uint64_t>(85000-gtfTrigger);
+    if(
+     computerStateMachine.getCurrentStateId()==COMPUTER_WORK &&
+     computerStateMachine.getVariableValue("claimed-task-count")>0.0
+    ) {
+      const double remainingS =
+       computerStateMachine.getConstantValue("task-duration-s")-
+       computerStateMachine.getVariableValue("work-time-s");
+      stepsToEvent = std::min(
+       stepsToEvent,
+       static_cast<uint64_t>(std::max(1.0,std::ceil(remainingS/timeStepSec)))
+      );
     }
-    capacitor.setChargeCoulomb(capacitorChargeCoulomb);
-    if(computerStateMachine.getCurrentState()=="WORK") {
+    if(
+     cameraStateMachine.getCurrentStateId()==CAMERA_IMAGING &&
+     cameraStateMachine.getVariableValue("imaging-task-count")>0.0
+    ) {
+      const double remainingS =
+       cameraStateMachine.getConstantValue("imaging-duration-s")-
+       cameraStateMachine.getVariableValue("imaging-time-s");
+      stepsToEvent = std::min(
+       stepsToEvent,
+       static_cast<uint64_t>(std::max(1.0,std::ceil(remainingS/timeStepSec)))
+      );
+    } else if(
+     cameraStateMachine.getCurrentStateId()==CAMERA_READOUT &&
+     cameraStateMachine.getVariableValue("readout-task-count")>0.0
+    ) {
+      const double remainingS =
+       cameraStateMachine.getConstantValue("readout-duration-s")-
+       cameraStateMachine.getVariableValue("readout-time-s");
+      stepsToEvent = std::min(
+       stepsToEvent,
+       static_cast<uint64_t>(std::max(1.0,std::ceil(remainingS/timeStepSec)))
+      );
+    }
+    //// State machines see a new node voltage one step after it is reached
+    std::vector<double> thresholds =
+     computerStateMachine.getConditionValues(COMPUTER_NODE_VOLTAGE);
+    std::vector<double> cameraThresholds =
+     cameraStateMachine.getConditionValues(CAMERA_NODE_VOLTAGE);
+    std::vector<double> adacsThresholds =
+     adacsStateMachine.getConditionValues(ADACS_NODE_VOLTAGE);
+    thresholds.insert(
+     thresholds.end(),cameraThresholds.begin(),cameraThresholds.end()
+    );
+    thresholds.insert(
+     thresholds.end(),adacsThresholds.begin(),adacsThresholds.end()
+    );
+    const double stepsToThreshold =
+     powerSubsystem.calcTimeToNextEvent(thresholds)/timeStepSec;
+    if(stepsToThreshold<static_cast<double>(stepsToEvent)) {
+      stepsToEvent =
+       static_cast<uint64_t>(std::max(1.0,std::ceil(stepsToThreshold)));
+    }
+    uint64_t stepsToAdvance = std::min(
+     static_cast<uint64_t>(50-(stepCount%50)), // next log sample
+     numSteps-stepCount
+    );
+    if(singleStep) {
+      stepsToAdvance = 1;
+    }
+    stepsToAdvance = std::min(stepsToAdvance,stepsToEvent);
+    singleStep = (stepsToAdvance==stepsToEvent);
+    const double elapsedS = static_cast<double>(stepsToAdvance)*timeStepSec;
+    // Update simulation to the next event
+    //// DateTime and Satellite updates accept less than one day at a time
+    uint64_t remainingNs = stepsToAdvance*timeStepNs;
+    while(remainingNs>0) {
+      const uint64_t updateNs = std::min(
+       remainingNs,
+       static_cast<uint64_t>(cote::cnst::HOUR_PER_DAY)*NS_PER_HOUR-1
+      );
+      const uint8_t updateHour = static_cast<uint8_t>(updateNs/NS_PER_HOUR);
+      const uint8_t updateMinute =
+       static_cast<uint8_t>((updateNs%NS_PER_HOUR)/NS_PER_MIN);
+      const uint8_t updateSecond = static_cast<uint8_t>(
+       (updateNs%NS_PER_MIN)/static_cast<uint64_t>(cote::cnst::NS_PER_SEC)
+      );
+      const uint32_t updateNanosecond = static_cast<uint32_t>(
+       updateNs%static_cast<uint64_t>(cote::cnst::NS_PER_SEC)
+      );
+      dateTime.update(updateHour,updateMinute,updateSecond,updateNanosecond);
+      satellite.update(
+       updateHour,updateMinute,updateSecond,updateNanosecond
+      );
+      remainingNs -= updateNs;
+    }
+    powerSubsystem.advance(elapsedS);
+    if(computerStateMachine.getCurrentStateId()==COMPUTER_WORK) {
       double workTimeS = computerStateMachine.getVariableValue("work-time-s");
       computerStateMachine.setVariableValue(
-       "work-time-s",workTimeS+timeStepSec
+       "work-time-s",workTimeS+elapsedS
       );
     }
-    if(cameraStateMachine.getCurrentState()=="IMAGING") {
+    if(cameraStateMachine.getCurrentStateId()==CAMERA_IMAGING) {
       double imagingTimeS =
        cameraStateMachine.getVariableValue("imaging-time-s");
       cameraStateMachine.setVariableValue(
-       "imaging-time-s",imagingTimeS+timeStepSec
+       "imaging-time-s",imagingTimeS+elapsedS
       );
-    } else if(cameraStateMachine.getCurrentState()=="READOUT") {
+    } else if(cameraStateMachine.getCurrentStateId()==CAMERA_READOUT) {
       double readoutTimeS =
        cameraStateMachine.getVariableValue("readout-time-s");
       cameraStateMachine.setVariableValue(
-       "readout-time-s",readoutTimeS+timeStepSec
+       "readout-time-s",readoutTimeS+elapsedS
       );
     }
+    const cote::StateMachine::StateId computerState =
+     computerStateMachine.getCurrentStateId();
+    const cote::StateMachine::StateId cameraState =
+     cameraStateMachine.getCurrentStateId();
+    const cote::StateMachine::StateId adacsState =
+     adacsStateMachine.getCurrentStateId();
     computerStateMachine.updateState();
     cameraStateMachine.updateState();
     adacsStateMachine.updateState();
-    gtfTrigger = (gtfTrigger+1)%85000;
-    stepCount+=1;
+    if(
+     computerStateMachine.getCurrentStateId()!=computerState ||
+     cameraStateMachine.getCurrentStateId()!=cameraState ||
+     adacsStateMachine.getCurrentStateId()!=adacsState
+    ) { // a state change may enable another transition on the next step
+      singleStep = true;
+    }
+    gtfTrigger = (gtfTrigger+stepsToAdvance)%85000;
+    stepCount+=stepsToAdvance;
   }
   // Write out logs
   log.writeAll();
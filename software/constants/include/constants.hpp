@@ -90,6 +90,7 @@ namespace cote { namespace cnst {
   const double WGS_84_WE = 7.292115e-5;       // Earth angular velocity rad/sec
   const double WGS_84_F  = 1.0/298.257223563; // Flattening
   const double WGS_84_C  = 2.99792458e8;      // Speed of light in vacuum m/s
+  const double WGS_84_GM = 398600.4418;       // Earth gravity param. km^3/s^2
 
   // Space Mission Analysis and Design
   // See cote/references/wertz1999space.pdf
@@ -0,0 +1,77 @@
+// EclipseEventHandler.hpp
+// EclipseEventHandler class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_ECLIPSE_EVENT_HANDLER_HPP
+#define COTE_ECLIPSE_EVENT_HANDLER_HPP
+
+// Standard library
+#include <cstddef>           // size_t
+#include <cstdint>           // uint32_t, uint64_t
+#include <string>            // string
+#include <vector>            // vector
+
+// cote library
+#include <IEventHandler.hpp> // IEventHandler
+#include <Log.hpp>           // Log
+#include <Satellite.hpp>     // Satellite
+#include <Simulation.hpp>    // Simulation
+
+namespace cote {
+  class EclipseEventHandler : public IEventHandler {
+  public:
+    // Logs each satellite entering and leaving the shadow of the Earth in a
+    // discrete-event simulation; a satellite is only propagated to the steps
+    // at which it is checked, and the next check is scheduled for the
+    // earliest step at which it could reach the penumbra
+    //// Entry is logged at the first step out of full sunlight and exit at the
+    //// first step back in it; penumbra is checked every step
+    EclipseEventHandler(const uint32_t& id=0, Log* const log=NULL);
+    EclipseEventHandler(const EclipseEventHandler& eclipseEventHandler);
+    EclipseEventHandler(EclipseEventHandler&& eclipseEventHandler);
+    virtual ~EclipseEventHandler();
+    virtual EclipseEventHandler& operator=(
+     const EclipseEventHandler& eclipseEventHandler
+    );
+    virtual EclipseEventHandler& operator=(
+     EclipseEventHandler&& eclipseEventHandler
+    );
+    virtual EclipseEventHandler* clone() const;
+    // Satellites are not owned and must outlive the handler; each must be at
+    // the simulation clock when the handler is started
+    std::size_t addSatellite(Satellite* const satellite);
+    std::size_t getSatelliteCount() const;
+    Satellite* getSatellite(const std::size_t& index) const;
+    // Checks every satellite at the current step, which schedules its next
+    // check; the entries and exits are logged as the simulation runs events
+    void start(Simulation* const simulation);
+    // The sun occlusion factor at the most recent check of the satellite
+    double getSunOcclusionFactor(const std::size_t& index) const;
+    // The number of entries into shadow logged for the satellite
+    uint64_t getEclipseCount(const std::size_t& index) const;
+    void handleEvent(
+     Simulation* const simulation, const std::size_t& entity,
+     const uint32_t& type
+    ) override;
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    // Propagates the satellite to the current step, logs any entry or exit
+    // and schedules the next check
+    void check(Simulation* const simulation, const std::size_t& index);
+    void scheduleCheck(Simulation* const simulation, const std::size_t& index);
+    std::vector<Satellite*> satellites;      // not owned, should not be deleted
+    std::vector<std::string> names;          // one log name per satellite
+    std::vector<uint64_t> stepCounts;        // step each satellite is at
+    std::vector<double> sunOcclusionFactors; // one per satellite
+    std::vector<uint64_t> eclipseCounts;     // one per satellite
+    uint32_t id;                             // identification number
+    Log* log;                                // singleton, should not be deleted
+  };
+}
+
+#endif
@@ -0,0 +1,198 @@
+// EclipseEventHandler.cpp
+// EclipseEventHandler class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>               // max, min
+#include <array>                   // array
+#include <cstddef>                 // size_t
+#include <cstdint>                 // uint32_t, uint64_t
+#include <iomanip>                 // setw, setfill
+#include <sstream>                 // ostringstream
+#include <string>                  // string
+#include <utility>                 // move
+#include <vector>                  // vector
+
+// cote
+#include <EclipseEventHandler.hpp> // EclipseEventHandler
+#include <Log.hpp>                 // Log
+#include <LogLevel.hpp>            // LogLevel
+#include <Satellite.hpp>           // Satellite
+#include <Simulation.hpp>          // Simulation
+#include <utilities.hpp>           // calcStepsOutsidePenumbra,
+                                   // calcSunOcclusionFactor
+
+namespace cote {
+  EclipseEventHandler::EclipseEventHandler(
+   const uint32_t& id, Log* const log
+  ) : id(id), log(log) {}
+
+  EclipseEventHandler::EclipseEventHandler(
+   const EclipseEventHandler& eclipseEventHandler
+  ) : satellites(eclipseEventHandler.satellites),
+   names(eclipseEventHandler.names),
+   stepCounts(eclipseEventHandler.stepCounts),
+   sunOcclusionFactors(eclipseEventHandler.sunOcclusionFactors),
+   eclipseCounts(eclipseEventHandler.eclipseCounts),
+   id(eclipseEventHandler.getID()), log(eclipseEventHandler.getLog()) {}
+
+  EclipseEventHandler::EclipseEventHandler(
+   EclipseEventHandler&& eclipseEventHandler
+  ) : satellites(std::move(eclipseEventHandler.satellites)),
+   names(std::move(eclipseEventHandler.names)),
+   stepCounts(std::move(eclipseEventHandler.stepCounts)),
+   sunOcclusionFactors(std::move(eclipseEventHandler.sunOcclusionFactors)),
+   eclipseCounts(std::move(eclipseEventHandler.eclipseCounts)),
+   id(eclipseEventHandler.id), log(eclipseEventHandler.log) {
+    eclipseEventHandler.log = NULL;
+  }
+
+  EclipseEventHandler::~EclipseEventHandler() {
+    this->log = NULL;
+  }
+
+  EclipseEventHandler& EclipseEventHandler::operator=(
+   const EclipseEventHandler& eclipseEventHandler
+  ) {
+    EclipseEventHandler temp(eclipseEventHandler);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  EclipseEventHandler& EclipseEventHandler::operator=(
+   EclipseEventHandler&& eclipseEventHandler
+  ) {
+    this->satellites          = std::move(eclipseEventHandler.satellites);
+    this->names               = std::move(eclipseEventHandler.names);
+    this->stepCounts          = std::move(eclipseEventHandler.stepCounts);
+    this->sunOcclusionFactors =
+     std::move(eclipseEventHandler.sunOcclusionFactors);
+    this->eclipseCounts       = std::move(eclipseEventHandler.eclipseCounts);
+    this->id                  = eclipseEventHandler.id;
+    this->log                 = eclipseEventHandler.log;
+    eclipseEventHandler.log   = NULL;
+    return *this;
+  }
+
+  EclipseEventHandler* EclipseEventHandler::clone() const {
+    return new EclipseEventHandler(*this);
+  }
+
+  std::size_t EclipseEventHandler::addSatellite(Satellite* const satellite) {
+    std::ostringstream name;
+    name << "sat-" << std::setw(10) << std::setfill('0') << satellite->getID()
+         << "-eclipse";
+    this->satellites.push_back(satellite);
+    this->names.push_back(name.str());
+    this->stepCounts.push_back(0);
+    this->sunOcclusionFactors.push_back(0.0);
+    this->eclipseCounts.push_back(0);
+    return this->satellites.size()-1;
+  }
+
+  std::size_t EclipseEventHandler::getSatelliteCount() const {
+    return this->satellites.size();
+  }
+
+  Satellite* EclipseEventHandler::getSatellite(const std::size_t& index) const {
+    return this->satellites.at(index);
+  }
+
+  void EclipseEventHandler::start(Simulation* const simulation) {
+    for(std::size_t i=0; i<this->satellites.size(); i++) {
+      this->stepCounts.at(i) = simulation->getStepCount();
+      this->sunOcclusionFactors.at(i) = util::calcSunOcclusionFactor(
+       this->satellites.at(i)->getECIPosn(), simulation->getSunECIPosnKm()
+      );
+      this->eclipseCounts.at(i) = 0;
+      //// A satellite that starts in shadow has not entered it during the run
+      this->scheduleCheck(simulation,i);
+    }
+  }
+
+  double EclipseEventHandler::getSunOcclusionFactor(
+   const std::size_t& index
+  ) const {
+    return this->sunOcclusionFactors.at(index);
+  }
+
+  uint64_t EclipseEventHandler::getEclipseCount(
+   const std::size_t& index
+  ) const {
+    return this->eclipseCounts.at(index);
+  }
+
+  void EclipseEventHandler::handleEvent(
+   Simulation* const simulation, const std::size_t& entity,
+   const uint32_t& /*type*/
+  ) {
+    this->check(simulation,entity);
+  }
+
+  uint32_t EclipseEventHandler::getID() const {
+    return this->id;
+  }
+
+  Log* EclipseEventHandler::getLog() const {
+    return this->log;
+  }
+
+  void EclipseEventHandler::check(
+   Simulation* const simulation, const std::size_t& index
+  ) {
+    Satellite* const satellite = this->satellites.at(index);
+    const uint64_t stepCount = simulation->getStepCount();
+    if(stepCount>this->stepCounts.at(index)) {
+      simulation->propagate(satellite,stepCount-this->stepCounts.at(index));
+      this->stepCounts.at(index) = stepCount;
+    }
+    const std::array<double,3> satEciPosnKm = satellite->getECIPosn();
+    const std::array<double,3> sunEciPosnKm = simulation->getSunECIPosnKm();
+    const double prevSunOcclusionFactor = this->sunOcclusionFactors.at(index);
+    const double sunOcclusionFactor =
+     util::calcSunOcclusionFactor(satEciPosnKm,sunEciPosnKm);
+    this->sunOcclusionFactors.at(index) = sunOcclusionFactor;
+    if(prevSunOcclusionFactor==0.0 && sunOcclusionFactor>0.0) {
+      this->eclipseCounts.at(index) += 1;
+      if(this->log!=NULL) {
+        COTE_MEAS(
+         *(this->log), LogLevel::INFO, simulation->getDateTime()->toString(),
+         this->names.at(index), std::string("entry")
+        );
+      }
+    } else if(prevSunOcclusionFactor>0.0 && sunOcclusionFactor==0.0) {
+      if(this->log!=NULL) {
+        COTE_MEAS(
+         *(this->log), LogLevel::INFO, simulation->getDateTime()->toString(),
+         this->names.at(index), std::string("exit")
+        );
+      }
+    }
+    this->scheduleCheck(simulation,index);
+  }
+
+  void EclipseEventHandler::scheduleCheck(
+   Simulation* const simulation, const std::size_t& index
+  ) {
+    //// The occlusion factor holds for the steady steps starting with the
+    //// current one, so the next step after them is the earliest at which it
+    //// could change; checks are never scheduled past the end of the run
+    const uint64_t stepCount = simulation->getStepCount();
+    const uint64_t remainingSteps = (simulation->getNumSteps()>stepCount) ?
+     simulation->getNumSteps()-stepCount : 0;
+    const uint64_t steadySteps = util::calcStepsOutsidePenumbra(
+     this->satellites.at(index)->getECIPosn(), simulation->getSunECIPosnKm(),
+     this->sunOcclusionFactors.at(index), simulation->getStepSizeS()
+    );
+    simulation->scheduleEvent(
+     stepCount+std::max(
+      std::min(steadySteps,remainingSteps),static_cast<uint64_t>(1)
+     ),
+     this,index
+    );
+  }
+}
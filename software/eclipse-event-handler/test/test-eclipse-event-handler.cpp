@@ -0,0 +1,90 @@
+// test-eclipse-event-handler.cpp
+// EclipseEventHandler class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <array>                   // array
+#include <cstdint>                 // uint32_t, uint64_t
+#include <cstdlib>                 // exit, EXIT_SUCCESS
+#include <string>                  // string, to_string
+#include <vector>                  // vector
+
+// cote library
+#include <DateTime.hpp>            // DateTime
+#include <EclipseEventHandler.hpp> // EclipseEventHandler
+#include <Log.hpp>                 // Log
+#include <LogLevel.hpp>            // LogLevel
+#include <Satellite.hpp>           // Satellite
+#include <Simulation.hpp>          // Simulation
+#include <utilities.hpp>           // calcJulianDayFromYMD,
+                                   // calcSecSinceMidnight, calcSunEciPosnKm,
+                                   // calcSunOcclusionFactor
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  // Three hours of one second steps, about two orbits
+  const cote::DateTime start(1980,10,1,23,41,24,113759999);
+  const uint64_t NUM_STEPS = 10800;
+  cote::Simulation simulation(start,0,0,1,0,NUM_STEPS,0,&log);
+  cote::Satellite satellite(
+   "../../satellite/data/test.tle",simulation.getDateTime(),&log
+  );
+  cote::EclipseEventHandler eclipseEventHandler(0,&log);
+  eclipseEventHandler.addSatellite(&satellite);
+  eclipseEventHandler.start(&simulation);
+  simulation.runEvents();
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+   "eclipse-count",
+   std::to_string(eclipseEventHandler.getEclipseCount(0))
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+   "handled-event-count",
+   std::to_string(simulation.getHandledEventCount())
+  );
+  // The same satellite stepped every step logs the same entries and exits
+  cote::DateTime dateTime(start);
+  cote::Satellite steppedSatellite("../../satellite/data/test.tle",&dateTime);
+  double prevSunOcclusionFactor = -1.0;
+  uint64_t steppedEclipseCount = 0;
+  for(uint64_t step=0; step<NUM_STEPS; step++) {
+    const std::array<double,3> sunEciPosnKm = cote::util::calcSunEciPosnKm(
+     cote::util::calcJulianDayFromYMD(
+      dateTime.getYear(), dateTime.getMonth(), dateTime.getDay()
+     ),
+     cote::util::calcSecSinceMidnight(
+      dateTime.getHour(), dateTime.getMinute(), dateTime.getSecond()
+     ),
+     dateTime.getNanosecond()
+    );
+    const double sunOcclusionFactor = cote::util::calcSunOcclusionFactor(
+     steppedSatellite.getECIPosn(),sunEciPosnKm
+    );
+    if(prevSunOcclusionFactor==0.0 && sunOcclusionFactor>0.0) {
+      steppedEclipseCount += 1;
+      log.meas(
+       cote::LogLevel::INFO, dateTime.toString(), "stepped-eclipse", "entry"
+      );
+    } else if(prevSunOcclusionFactor>0.0 && sunOcclusionFactor==0.0) {
+      log.meas(
+       cote::LogLevel::INFO, dateTime.toString(), "stepped-eclipse", "exit"
+      );
+    }
+    prevSunOcclusionFactor = sunOcclusionFactor;
+    dateTime.update(0,0,1,0);
+    steppedSatellite.update(0,0,1,0);
+  }
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(NUM_STEPS), "stepped-eclipse-count",
+   std::to_string(steppedEclipseCount)
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,59 @@
+// EntityStore.hpp
+// EntityStore class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_ENTITY_STORE_HPP
+#define COTE_ENTITY_STORE_HPP
+
+// Standard library
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
+#include <limits>  // numeric_limits
+#include <map>     // map
+#include <vector>  // vector
+
+// cote
+#include <Log.hpp> // Log
+
+namespace cote {
+  class EntityStore {
+  public:
+    // Returned by getIndex for an external ID that was never added
+    static constexpr std::size_t NO_INDEX =
+     std::numeric_limits<std::size_t>::max();
+    // Remaps external IDs, e.g. 10-digit satellite IDs, to dense indices so
+    // that the components of each entity can be kept in vectors addressed by
+    // index; external IDs are then only needed for I/O
+    EntityStore(const uint32_t& id=0, Log* const log=NULL);
+    EntityStore(const EntityStore& entityStore);
+    EntityStore(EntityStore&& entityStore);
+    virtual ~EntityStore();
+    virtual EntityStore& operator=(const EntityStore& entityStore);
+    virtual EntityStore& operator=(EntityStore&& entityStore);
+    virtual EntityStore* clone() const;
+    // Returns the index of the entity, adding it at the next index if the
+    // external ID is new
+    std::size_t addEntity(const uint32_t& externalID);
+    std::size_t getEntityCount() const;
+    bool hasEntity(const uint32_t& externalID) const;
+    // Intended for load time and I/O; the simulation loop should iterate by
+    // index instead
+    std::size_t getIndex(const uint32_t& externalID) const;
+    uint32_t getExternalID(const std::size_t& index) const;
+    // External IDs indexed by entity index
+    const std::vector<uint32_t>& getExternalIDs() const;
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    std::vector<uint32_t> externalIDs;      // indexed by entity index
+    std::map<uint32_t,std::size_t> indices; // external ID to entity index
+    uint32_t id;                            // identification number
+    Log* log;                               // singleton, should not be deleted
+  };
+}
+
+#endif
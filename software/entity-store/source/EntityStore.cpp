@@ -0,0 +1,101 @@
+// EntityStore.cpp
+// EntityStore class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>         // size_t
+#include <cstdint>         // uint32_t
+#include <map>             // map
+#include <utility>         // move
+#include <vector>          // vector
+
+// cote
+#include <EntityStore.hpp> // EntityStore
+#include <Log.hpp>         // Log
+
+namespace cote {
+  constexpr std::size_t EntityStore::NO_INDEX;
+
+  EntityStore::EntityStore(const uint32_t& id, Log* const log) :
+   id(id), log(log) {}
+
+  EntityStore::EntityStore(const EntityStore& entityStore) :
+   externalIDs(entityStore.externalIDs), indices(entityStore.indices),
+   id(entityStore.getID()), log(entityStore.getLog()) {}
+
+  EntityStore::EntityStore(EntityStore&& entityStore) :
+   externalIDs(std::move(entityStore.externalIDs)),
+   indices(std::move(entityStore.indices)), id(entityStore.id),
+   log(entityStore.log) {
+    entityStore.log = NULL;
+  }
+
+  EntityStore::~EntityStore() {
+    this->log = NULL;
+  }
+
+  EntityStore& EntityStore::operator=(const EntityStore& entityStore) {
+    EntityStore temp(entityStore);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  EntityStore& EntityStore::operator=(EntityStore&& entityStore) {
+    this->externalIDs = std::move(entityStore.externalIDs);
+    this->indices     = std::move(entityStore.indices);
+    this->id          = entityStore.id;
+    this->log         = entityStore.log;
+    entityStore.log   = NULL;
+    return *this;
+  }
+
+  EntityStore* EntityStore::clone() const {
+    return new EntityStore(*this);
+  }
+
+  std::size_t EntityStore::addEntity(const uint32_t& externalID) {
+    std::map<uint32_t,std::size_t>::const_iterator it =
+     this->indices.find(externalID);
+    if(it!=this->indices.end()) {
+      return it->second;
+    }
+    const std::size_t index = this->externalIDs.size();
+    this->externalIDs.push_back(externalID);
+    this->indices[externalID] = index;
+    return index;
+  }
+
+  std::size_t EntityStore::getEntityCount() const {
+    return this->externalIDs.size();
+  }
+
+  bool EntityStore::hasEntity(const uint32_t& externalID) const {
+    return this->indices.count(externalID)!=0;
+  }
+
+  std::size_t EntityStore::getIndex(const uint32_t& externalID) const {
+    std::map<uint32_t,std::size_t>::const_iterator it =
+     this->indices.find(externalID);
+    return (it==this->indices.end()) ? NO_INDEX : it->second;
+  }
+
+  uint32_t EntityStore::getExternalID(const std::size_t& index) const {
+    return this->externalIDs.at(index);
+  }
+
+  const std::vector<uint32_t>& EntityStore::getExternalIDs() const {
+    return this->externalIDs;
+  }
+
+  uint32_t EntityStore::getID() const {
+    return this->id;
+  }
+
+  Log* EntityStore::getLog() const {
+    return this->log;
+  }
+}
@@ -0,0 +1,61 @@
+// test-entity-store.cpp
+// EntityStore class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>         // size_t
+#include <cstdint>         // uint32_t
+#include <cstdlib>         // exit, EXIT_SUCCESS
+#include <string>          // to_string
+#include <vector>          // vector
+
+// satsim
+#include <EntityStore.hpp> // EntityStore
+#include <Log.hpp>         // Log
+#include <LogLevel.hpp>    // LogLevel
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  cote::EntityStore entityStore(0,&log);
+  // Satellite IDs become indices 0, 1, and 2; adding an ID again is a no-op
+  const std::vector<uint32_t> satIDs = {449380000, 449380001, 449380002};
+  for(std::size_t i=0; i<satIDs.size(); i++) {
+    entityStore.addEntity(satIDs.at(i));
+  }
+  log.meas(
+   cote::LogLevel::INFO, "0", "re-added-index",
+   std::to_string(entityStore.addEntity(449380001))
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "entity-count",
+   std::to_string(entityStore.getEntityCount())
+  );
+  // Components are kept in vectors addressed by index
+  std::vector<double> nodeVoltage(entityStore.getEntityCount(),0.0);
+  nodeVoltage.at(entityStore.getIndex(449380002)) = 7.2;
+  for(std::size_t i=0; i<entityStore.getEntityCount(); i++) {
+    log.meas(
+     cote::LogLevel::INFO, "0",
+     "sat-"+std::to_string(entityStore.getExternalID(i))+"-node-voltage",
+     std::to_string(nodeVoltage.at(i))
+    );
+  }
+  log.meas(
+   cote::LogLevel::INFO, "0", "has-unknown-entity",
+   std::to_string(entityStore.hasEntity(449380003))
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "unknown-is-no-index",
+   std::to_string(
+    entityStore.getIndex(449380003)==cote::EntityStore::NO_INDEX
+   )
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
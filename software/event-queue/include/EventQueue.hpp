@@ -0,0 +1,62 @@
+// EventQueue.hpp
+// EventQueue class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_EVENT_QUEUE_HPP
+#define COTE_EVENT_QUEUE_HPP
+
+// Standard library
+#include <cstddef>           // size_t
+#include <cstdint>           // uint32_t, uint64_t
+#include <vector>            // vector
+
+// cote
+#include <IEventHandler.hpp> // IEventHandler
+#include <Log.hpp>           // Log
+
+namespace cote {
+  class EventQueue {
+  public:
+    struct Event {
+      uint64_t step;          // simulation step at which the event is due
+      uint64_t sequence;      // order of scheduling; breaks ties in step
+      IEventHandler* handler; // not owned, should not be deleted
+      std::size_t entity;     // handler-defined, e.g. a satellite index
+      uint32_t type;          // handler-defined, e.g. entry or exit
+    };
+    // Orders events by step and, within a step, by the order in which they
+    // were pushed, so that runs are deterministic
+    EventQueue(const uint32_t& id=0, Log* const log=NULL);
+    EventQueue(const EventQueue& eventQueue);
+    EventQueue(EventQueue&& eventQueue);
+    virtual ~EventQueue();
+    virtual EventQueue& operator=(const EventQueue& eventQueue);
+    virtual EventQueue& operator=(EventQueue&& eventQueue);
+    virtual EventQueue* clone() const;
+    void push(
+     const uint64_t& step, IEventHandler* const handler,
+     const std::size_t& entity=0, const uint32_t& type=0
+    );
+    // The earliest event; the queue must not be empty
+    const Event& getNextEvent() const;
+    // Removes and returns the earliest event; the queue must not be empty
+    Event pop();
+    bool isEmpty() const;
+    std::size_t getSize() const;
+    void clear();
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    static bool isLater(const Event& event1, const Event& event2);
+    std::vector<Event> events; // binary min-heap ordered by step and sequence
+    uint64_t sequence;         // sequence number of the next pushed event
+    uint32_t id;               // identification number
+    Log* log;                  // singleton, should not be deleted
+  };
+}
+
+#endif
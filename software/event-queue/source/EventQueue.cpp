@@ -0,0 +1,107 @@
+// EventQueue.cpp
+// EventQueue class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>         // pop_heap, push_heap
+#include <cstddef>           // size_t
+#include <cstdint>           // uint32_t, uint64_t
+#include <utility>           // move
+#include <vector>            // vector
+
+// cote
+#include <EventQueue.hpp>    // EventQueue
+#include <IEventHandler.hpp> // IEventHandler
+#include <Log.hpp>           // Log
+
+namespace cote {
+  EventQueue::EventQueue(const uint32_t& id, Log* const log) :
+   sequence(0), id(id), log(log) {}
+
+  EventQueue::EventQueue(const EventQueue& eventQueue) :
+   events(eventQueue.events), sequence(eventQueue.sequence),
+   id(eventQueue.getID()), log(eventQueue.getLog()) {}
+
+  EventQueue::EventQueue(EventQueue&& eventQueue) :
+   events(std::move(eventQueue.events)), sequence(eventQueue.sequence),
+   id(eventQueue.id), log(eventQueue.log) {
+    eventQueue.log = NULL;
+  }
+
+  EventQueue::~EventQueue() {
+    this->log = NULL;
+  }
+
+  EventQueue& EventQueue::operator=(const EventQueue& eventQueue) {
+    EventQueue temp(eventQueue);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  EventQueue& EventQueue::operator=(EventQueue&& eventQueue) {
+    this->events   = std::move(eventQueue.events);
+    this->sequence = eventQueue.sequence;
+    this->id       = eventQueue.id;
+    this->log      = eventQueue.log;
+    eventQueue.log = NULL;
+    return *this;
+  }
+
+  EventQueue* EventQueue::clone() const {
+    return new EventQueue(*this);
+  }
+
+  void EventQueue::push(
+   const uint64_t& step, IEventHandler* const handler,
+   const std::size_t& entity, const uint32_t& type
+  ) {
+    this->events.push_back({step,this->sequence,handler,entity,type});
+    this->sequence += 1;
+    std::push_heap(
+     this->events.begin(), this->events.end(), EventQueue::isLater
+    );
+  }
+
+  const EventQueue::Event& EventQueue::getNextEvent() const {
+    return this->events.front();
+  }
+
+  EventQueue::Event EventQueue::pop() {
+    std::pop_heap(
+     this->events.begin(), this->events.end(), EventQueue::isLater
+    );
+    const Event event = this->events.back();
+    this->events.pop_back();
+    return event;
+  }
+
+  bool EventQueue::isEmpty() const {
+    return this->events.empty();
+  }
+
+  std::size_t EventQueue::getSize() const {
+    return this->events.size();
+  }
+
+  void EventQueue::clear() {
+    this->events.clear();
+  }
+
+  uint32_t EventQueue::getID() const {
+    return this->id;
+  }
+
+  Log* EventQueue::getLog() const {
+    return this->log;
+  }
+
+  bool EventQueue::isLater(const Event& event1, const Event& event2) {
+    return
+     event1.step>event2.step ||
+     (event1.step==event2.step && event1.sequence>event2.sequence);
+  }
+}
@@ -0,0 +1,70 @@
+// test-event-queue.cpp
+// EventQueue class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>           // size_t
+#include <cstdint>           // uint32_t
+#include <cstdlib>           // exit, EXIT_SUCCESS
+#include <string>            // to_string
+#include <vector>            // vector
+
+// satsim
+#include <EventQueue.hpp>    // EventQueue
+#include <IEventHandler.hpp> // IEventHandler
+#include <Log.hpp>           // Log
+#include <LogLevel.hpp>      // LogLevel
+
+// Events in this test are popped directly rather than dispatched
+class NullHandler : public cote::IEventHandler {
+public:
+  void handleEvent(
+   cote::Simulation* const simulation, const std::size_t& entity,
+   const uint32_t& type
+  ) override {}
+};
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  NullHandler handler;
+  cote::EventQueue eventQueue(0,&log);
+  // Push out of order; events at the same step keep their push order
+  eventQueue.push(30,&handler,0,1);
+  eventQueue.push(10,&handler,1,1);
+  eventQueue.push(20,&handler,2,1);
+  eventQueue.push(10,&handler,3,2);
+  eventQueue.push(10,&handler,4,3);
+  eventQueue.push(0,&handler,5,1);
+  log.meas(
+   cote::LogLevel::INFO, "0", "size", std::to_string(eventQueue.getSize())
+  );
+  // A copy pops the same events
+  cote::EventQueue copy(eventQueue);
+  while(!eventQueue.isEmpty()) {
+    const cote::EventQueue::Event event = eventQueue.pop();
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(event.step), "entity",
+     std::to_string(event.entity)
+    );
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(event.step), "type",
+     std::to_string(event.type)
+    );
+  }
+  log.meas(
+   cote::LogLevel::INFO, "0", "copy-next-entity",
+   std::to_string(copy.getNextEvent().entity)
+  );
+  copy.clear();
+  log.meas(
+   cote::LogLevel::INFO, "0", "cleared-size", std::to_string(copy.getSize())
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,34 @@
+// IEventHandler.hpp
+// IEventHandler interface file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_IEVENT_HANDLER_HPP
+#define COTE_IEVENT_HANDLER_HPP
+
+// Standard library
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t
+
+// cote library
+// None
+
+namespace cote {
+  class Simulation;
+
+  class IEventHandler {
+  public:
+    // Called by simulation when an event scheduled for this handler is due;
+    // the simulation clock and step count are at the step of the event, and
+    // entity and type are the values given when the event was scheduled
+    virtual void handleEvent(
+     Simulation* const simulation, const std::size_t& entity,
+     const uint32_t& type
+    ) = 0;
+  };
+}
+
+#endif
@@ -0,0 +1,29 @@
+// IPhase.hpp
+// IPhase interface file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_IPHASE_HPP
+#define COTE_IPHASE_HPP
+
+// Standard library
+// None
+
+// cote library
+// None
+
+namespace cote {
+  class Simulation;
+
+  class IPhase {
+  public:
+    // Called once per step by simulation, in the order in which the phases
+    // were added to it
+    virtual void step(Simulation* const simulation) = 0;
+  };
+}
+
+#endif
@@ -0,0 +1,37 @@
+// IQuiescentPhase.hpp
+// IQuiescentPhase interface file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_IQUIESCENT_PHASE_HPP
+#define COTE_IQUIESCENT_PHASE_HPP
+
+// Standard library
+#include <cstdint>    // uint64_t
+
+// cote library
+#include <IPhase.hpp> // IPhase
+
+namespace cote {
+  class Simulation;
+
+  class IQuiescentPhase : public IPhase {
+  public:
+    // Called by simulation at the start of a step; returns the number of
+    // steps, starting with the current one, over which running this phase
+    // would change nothing that other phases observe
+    //// Returning zero or one means that the current step must be run
+    virtual uint64_t getQuiescentSteps(Simulation* const simulation) = 0;
+    // Called by simulation instead of running the phase for each of a number
+    // of quiescent steps, starting with the current one; the phase updates its
+    // own state and writes any logs that running it would have, at the same
+    // step indices. The simulation clock is advanced by the simulation after
+    // every phase has been skipped
+    virtual void skip(Simulation* const simulation, const uint64_t& steps) = 0;
+  };
+}
+
+#endif
@@ -0,0 +1,47 @@
+// IStateMachine.hpp
+// IStateMachine interface file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_ISTATE_MACHINE_HPP
+#define COTE_ISTATE_MACHINE_HPP
+
+// Standard library
+#include <cstdint> // uint32_t
+#include <map>     // map
+#include <string>  // string
+
+// cote library
+// None
+
+namespace cote {
+  class Log;
+
+  class IStateMachine {
+  public:
+    virtual ~IStateMachine() {}
+    virtual std::map<std::string,double> getConstantValues() const = 0;
+    virtual std::map<std::string,double> getVariableValues() const = 0;
+    virtual std::string getCurrentState() const = 0;
+    virtual uint32_t getID() const = 0;
+    virtual Log* getLog() const = 0;
+    // Throws std::out_of_range if the configuration does not declare the
+    // constant or variable
+    virtual double getConstantValue(const std::string& constant) const = 0;
+    virtual double getVariableValue(const std::string& variable) const = 0;
+    virtual void setVariableValue(
+     const std::string& variable, const double& value
+    ) = 0;
+    // A state that the configuration does not name is entered after the exit
+    // actions of the current state; it has no actions or transitions
+    virtual void setCurrentState(const std::string& state) = 0;
+    // Takes the first transition out of the current state whose conditions
+    // hold, if any
+    virtual void updateState() = 0;
+  };
+}
+
+#endif
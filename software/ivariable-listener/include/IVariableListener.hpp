@@ -0,0 +1,32 @@
+// IVariableListener.hpp
+// IVariableListener interface file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_IVARIABLE_LISTENER_HPP
+#define COTE_IVARIABLE_LISTENER_HPP
+
+// Standard library
+#include <string> // string
+
+// cote library
+// None
+
+namespace cote {
+  class StateMachine;
+
+  class IVariableListener {
+  public:
+    // Called by stateMachine after the value of variable changes from
+    // previousValue to value
+    virtual void onVariableChange(
+     const StateMachine* const stateMachine, const std::string& variable,
+     const double& previousValue, const double& value
+    ) = 0;
+  };
+}
+
+#endif
@@ -0,0 +1,69 @@
+// LoadAggregator.hpp
+// LoadAggregator class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_LOAD_AGGREGATOR_HPP
+#define COTE_LOAD_AGGREGATOR_HPP
+
+// Standard library
+#include <cstddef>               // size_t
+#include <cstdint>               // uint32_t
+#include <string>                // string
+#include <vector>                // vector
+
+// cote library
+#include <IVariableListener.hpp> // IVariableListener
+#include <Log.hpp>               // Log
+#include <StateMachine.hpp>      // StateMachine
+
+namespace cote {
+  class LoadAggregator : public IVariableListener {
+  public:
+    // Maintains the summed power draw of a set of state machines (e.g. the
+    // devices of one satellite); the sum is updated when a machine changes
+    // its power variable rather than being recomputed by the caller each step
+    LoadAggregator(const uint32_t& id=0, Log* const log=NULL);
+    LoadAggregator(const LoadAggregator& loadAggregator);
+    LoadAggregator(LoadAggregator&& loadAggregator);
+    virtual ~LoadAggregator();
+    virtual LoadAggregator& operator=(const LoadAggregator& loadAggregator);
+    virtual LoadAggregator& operator=(LoadAggregator&& loadAggregator);
+    virtual LoadAggregator* clone() const;
+    // Subscribes to the variable of the state machine, which must outlive the
+    // aggregator or be removed from it first; returns the index of the load
+    std::size_t addLoad(
+     StateMachine* const stateMachine, const std::string& variable="power-w"
+    );
+    std::size_t getLoadCount() const;
+    StateMachine* getStateMachine(const std::size_t& index) const;
+    std::string getVariable(const std::size_t& index) const;
+    double getLoadPowerW(const std::size_t& index) const;
+    // Returns the sum of the loads in the order that they were added, which
+    // matches a left-to-right sum of the individual variable values
+    double getTotalPowerW() const;
+    void onVariableChange(
+     const StateMachine* const stateMachine, const std::string& variable,
+     const double& previousValue, const double& value
+    ) override;
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    void subscribe();
+    void unsubscribe();
+    void updateTotalPowerW();
+    // Loads; element i of each vector belongs to load i; the state machines
+    // are not owned and should not be deleted
+    std::vector<StateMachine*> stateMachines;
+    std::vector<std::string> variables; // name of the power variable
+    std::vector<double> loadPowerW;     // most recent value in Watt
+    double totalPowerW;                 // sum of loadPowerW
+    uint32_t id;                        // identification number
+    Log* log;                           // singleton, should not be deleted
+  };
+}
+
+#endif
@@ -0,0 +1,167 @@
+// LoadAggregator.cpp
+// LoadAggregator class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>               // size_t
+#include <cstdint>               // uint32_t
+#include <string>                // string
+#include <utility>               // move
+#include <vector>                // vector
+
+// cote library
+#include <IVariableListener.hpp> // IVariableListener
+#include <LoadAggregator.hpp>    // LoadAggregator
+#include <Log.hpp>               // Log
+#include <StateMachine.hpp>      // StateMachine
+
+namespace cote {
+  LoadAggregator::LoadAggregator(const uint32_t& id, Log* const log) :
+   totalPowerW(0.0), id(id), log(log) {}
+
+  LoadAggregator::LoadAggregator(const LoadAggregator& loadAggregator) :
+   stateMachines(loadAggregator.stateMachines),
+   variables(loadAggregator.variables),
+   loadPowerW(loadAggregator.loadPowerW),
+   totalPowerW(loadAggregator.getTotalPowerW()), id(loadAggregator.getID()),
+   log(loadAggregator.getLog()) {
+    this->subscribe();
+  }
+
+  LoadAggregator::LoadAggregator(LoadAggregator&& loadAggregator) :
+   stateMachines(loadAggregator.stateMachines),
+   variables(loadAggregator.variables),
+   loadPowerW(loadAggregator.loadPowerW),
+   totalPowerW(loadAggregator.totalPowerW), id(loadAggregator.id),
+   log(loadAggregator.log) {
+    loadAggregator.unsubscribe();
+    loadAggregator.stateMachines.clear();
+    loadAggregator.variables.clear();
+    loadAggregator.loadPowerW.clear();
+    loadAggregator.totalPowerW = 0.0;
+    loadAggregator.log = NULL;
+    this->subscribe();
+  }
+
+  LoadAggregator::~LoadAggregator() {
+    this->unsubscribe();
+    this->log = NULL;
+  }
+
+  LoadAggregator& LoadAggregator::operator=(
+   const LoadAggregator& loadAggregator
+  ) {
+    LoadAggregator temp(loadAggregator);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  LoadAggregator& LoadAggregator::operator=(LoadAggregator&& loadAggregator) {
+    this->unsubscribe();
+    loadAggregator.unsubscribe();
+    this->stateMachines      = std::move(loadAggregator.stateMachines);
+    this->variables          = std::move(loadAggregator.variables);
+    this->loadPowerW         = std::move(loadAggregator.loadPowerW);
+    this->totalPowerW        = loadAggregator.totalPowerW;
+    this->id                 = loadAggregator.id;
+    this->log                = loadAggregator.log;
+    loadAggregator.stateMachines.clear();
+    loadAggregator.variables.clear();
+    loadAggregator.loadPowerW.clear();
+    loadAggregator.totalPowerW = 0.0;
+    loadAggregator.log         = NULL;
+    this->subscribe();
+    return *this;
+  }
+
+  LoadAggregator* LoadAggregator::clone() const {
+    return new LoadAggregator(*this);
+  }
+
+  std::size_t LoadAggregator::addLoad(
+   StateMachine* const stateMachine, const std::string& variable
+  ) {
+    this->stateMachines.push_back(stateMachine);
+    this->variables.push_back(variable);
+    this->loadPowerW.push_back(stateMachine->getVariableValue(variable));
+    stateMachine->addVariableListener(variable,this);
+    this->updateTotalPowerW();
+    return this->stateMachines.size()-1;
+  }
+
+  std::size_t LoadAggregator::getLoadCount() const {
+    return this->stateMachines.size();
+  }
+
+  StateMachine* LoadAggregator::getStateMachine(
+   const std::size_t& index
+  ) const {
+    return this->stateMachines.at(index);
+  }
+
+  std::string LoadAggregator::getVariable(const std::size_t& index) const {
+    return this->variables.at(index);
+  }
+
+  double LoadAggregator::getLoadPowerW(const std::size_t& index) const {
+    return this->loadPowerW.at(index);
+  }
+
+  double LoadAggregator::getTotalPowerW() const {
+    return this->totalPowerW;
+  }
+
+  void LoadAggregator::onVariableChange(
+   const StateMachine* const stateMachine, const std::string& variable,
+   const double& /*previousValue*/, const double& value
+  ) {
+    //// The previous value is not needed; see updateTotalPowerW
+    for(std::size_t i=0; i<this->stateMachines.size(); i++) {
+      if(
+       this->stateMachines.at(i)==stateMachine &&
+       this->variables.at(i)==variable
+      ) {
+        this->loadPowerW.at(i) = value;
+      }
+    }
+    this->updateTotalPowerW();
+  }
+
+  uint32_t LoadAggregator::getID() const {
+    return this->id;
+  }
+
+  Log* LoadAggregator::getLog() const {
+    return this->log;
+  }
+
+  void LoadAggregator::subscribe() {
+    for(std::size_t i=0; i<this->stateMachines.size(); i++) {
+      this->stateMachines.at(i)->addVariableListener(
+       this->variables.at(i),this
+      );
+    }
+  }
+
+  void LoadAggregator::unsubscribe() {
+    for(std::size_t i=0; i<this->stateMachines.size(); i++) {
+      this->stateMachines.at(i)->removeVariableListener(
+       this->variables.at(i),this
+      );
+    }
+  }
+
+  // The total is re-summed over the (few) loads of the aggregator rather than
+  // adjusted by the difference so that no rounding error accumulates
+  void LoadAggregator::updateTotalPowerW() {
+    double totalPowerW = 0.0;
+    for(std::size_t i=0; i<this->loadPowerW.size(); i++) {
+      totalPowerW += this->loadPowerW.at(i);
+    }
+    this->totalPowerW = totalPowerW;
+  }
+}
@@ -0,0 +1,71 @@
+// test-load-aggregator.cpp
+// LoadAggregator class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>            // size_t
+#include <cstdlib>            // exit, EXIT_SUCCESS
+#include <string>             // to_string
+#include <vector>             // vector
+
+// satsim
+#include <LoadAggregator.hpp> // LoadAggregator
+#include <Log.hpp>            // Log
+#include <LogLevel.hpp>       // LogLevel
+#include <StateMachine.hpp>   // StateMachine
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  const std::string configFile =
+   "../../state-machine/configuration/computer-state-machine.dat";
+  cote::StateMachine computer0(configFile,0,&log);
+  cote::StateMachine computer1(configFile,1,&log);
+  cote::LoadAggregator loadAggregator(0,&log);
+  loadAggregator.addLoad(&computer0);
+  loadAggregator.addLoad(&computer1);
+  // The copy is subscribed to the same state machines
+  cote::LoadAggregator* copy = loadAggregator.clone();
+  double time = 0.0;
+  double nodeVoltage = 5.0;
+  computer1.setVariableValue("claimed-task-count",1.0);
+  for(std::size_t i=0; i<40; i++) {
+    time += 0.1;
+    nodeVoltage += (i<20) ? 0.1 : -0.1;
+    computer0.setVariableValue("node-voltage",nodeVoltage);
+    computer0.updateState();
+    computer1.setVariableValue("node-voltage",nodeVoltage);
+    computer1.updateState();
+    const double summedPowerW =
+     computer0.getVariableValue("power-w")+
+     computer1.getVariableValue("power-w");
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(time), "total-power-w",
+     std::to_string(loadAggregator.getTotalPowerW())
+    );
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(time), "copy-total-power-w",
+     std::to_string(copy->getTotalPowerW())
+    );
+    log.evnt(
+     cote::LogLevel::INFO, std::to_string(time),
+     (loadAggregator.getTotalPowerW()==summedPowerW) ? "sum-match" :
+     "sum-mismatch"
+    );
+  }
+  // Deleting the copy unsubscribes it before the state machines change again
+  delete copy;
+  copy = NULL;
+  computer0.setCurrentState("WORK");
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(time), "total-power-w",
+   std::to_string(loadAggregator.getTotalPowerW())
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,106 @@
+// LogBuffer.hpp
+// LogBuffer class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_LOG_BUFFER_HPP
+#define COTE_LOG_BUFFER_HPP
+
+// Standard library
+#include <cstddef>      // size_t
+#include <cstdint>      // int64_t, uint8_t, uint32_t
+#include <string>       // string
+#include <string_view>  // string_view
+#include <type_traits>  // enable_if, is_integral
+#include <vector>       // vector
+
+// cote library
+#include <Log.hpp>      // Log
+#include <LogLevel.hpp> // LogLevel
+
+namespace cote {
+  class LogBuffer {
+  public:
+    // log: the Log the buffer will be written to, whose levels and filter are
+    //      heeded when recording so that dropped logs are neither formatted
+    //      (through the COTE_MEAS and COTE_EVNT macros) nor buffered; without
+    //      one, only the compiled levels are heeded until writeTo
+    LogBuffer(Log* const log=NULL) : log(log) {}
+    // Whether logs of the given level are compiled in and heeded by the Log,
+    // for the COTE_MEAS and COTE_EVNT macros
+    bool isEnabled(const LogLevel& level) const {
+      return (this->log==NULL) ? isLogLevelCompiled(level) :
+       this->log->isEnabled(level);
+    }
+    // Whether the filter of the Log drops every log of the name; decimation
+    // is left to the Log when written to
+    bool isExcluded(const Log::MeasHandle& meas) const {
+      return this->log!=NULL && this->log->isExcluded(meas);
+    }
+    bool isExcluded(const Log::EvntHandle& evnt) const {
+      return this->log!=NULL && this->log->isExcluded(evnt);
+    }
+    // Same parameters as the corresponding Log calls
+    void evnt(
+     const LogLevel& level, const std::string& dateTime, const std::string& evnt
+    );
+    void meas(
+     const LogLevel& level, const std::string& dateTime,
+     const std::string& meas, const std::string& valu
+    );
+    void evnt(
+     const LogLevel& level, const std::string_view& dateTime,
+     const Log::EvntHandle& evnt
+    );
+    void meas(
+     const LogLevel& level, const std::string_view& dateTime,
+     const Log::MeasHandle& meas, const double& valu
+    );
+    void meas(
+     const LogLevel& level, const std::string_view& dateTime,
+     const Log::MeasHandle& meas, const int64_t& valu
+    );
+    void meas(
+     const LogLevel& level, const std::string_view& dateTime,
+     const Log::MeasHandle& meas, const std::string_view& valu
+    );
+    template<
+     typename T,
+     typename = typename std::enable_if<std::is_integral<T>::value>::type
+    >
+    void meas(
+     const LogLevel& level, const std::string_view& dateTime,
+     const Log::MeasHandle& meas, const T& valu
+    ) {
+      this->meas(level,dateTime,meas,static_cast<int64_t>(valu));
+    }
+    // Makes the recorded calls to log in the order recorded and then clears
+    // the buffer
+    void writeTo(Log* const log);
+    std::size_t getSize() const;
+    void clear();
+    Log* getLog() const;
+  private:
+    // Recorded call kinds
+    enum class Call : uint8_t {
+      EVNT_NAME, MEAS_NAME, EVNT_HANDLE, MEAS_REAL, MEAS_INT, MEAS_STRING
+    };
+    struct Entry {
+      Call call;
+      LogLevel level;
+      std::string dateTime;
+      std::string name;  // empty for handle calls
+      uint32_t handle;   // handle index for handle calls
+      double real;       // MEAS_REAL value
+      int64_t integer;   // MEAS_INT value
+      std::string valu;  // MEAS_NAME or MEAS_STRING value
+    };
+    std::vector<Entry> entries;
+    Log* log; // singleton, should not be deleted
+  };
+}
+
+#endif
@@ -0,0 +1,134 @@
+// LogBuffer.cpp
+// LogBuffer class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>       // size_t
+#include <cstdint>       // int64_t
+#include <string>        // string
+#include <string_view>   // string_view
+#include <vector>        // vector
+
+// cote library
+#include <Log.hpp>       // Log
+#include <LogBuffer.hpp> // LogBuffer
+#include <LogLevel.hpp>  // LogLevel
+
+namespace cote {
+  void LogBuffer::evnt(
+   const LogLevel& level, const std::string& dateTime, const std::string& evnt
+  ) {
+    if(!this->isEnabled(level)) {
+      return;
+    }
+    this->entries.push_back({Call::EVNT_NAME,level,dateTime,evnt,0,0.0,0,""});
+  }
+
+  void LogBuffer::meas(
+   const LogLevel& level, const std::string& dateTime,
+   const std::string& meas, const std::string& valu
+  ) {
+    if(!this->isEnabled(level)) {
+      return;
+    }
+    this->entries.push_back({Call::MEAS_NAME,level,dateTime,meas,0,0.0,0,valu});
+  }
+
+  void LogBuffer::evnt(
+   const LogLevel& level, const std::string_view& dateTime,
+   const Log::EvntHandle& evnt
+  ) {
+    if(!this->isEnabled(level) || this->isExcluded(evnt)) {
+      return;
+    }
+    this->entries.push_back(
+     {Call::EVNT_HANDLE,level,std::string(dateTime),"",evnt.index,0.0,0,""}
+    );
+  }
+
+  void LogBuffer::meas(
+   const LogLevel& level, const std::string_view& dateTime,
+   const Log::MeasHandle& meas, const double& valu
+  ) {
+    if(!this->isEnabled(level) || this->isExcluded(meas)) {
+      return;
+    }
+    this->entries.push_back(
+     {Call::MEAS_REAL,level,std::string(dateTime),"",meas.index,valu,0,""}
+    );
+  }
+
+  void LogBuffer::meas(
+   const LogLevel& level, const std::string_view& dateTime,
+   const Log::MeasHandle& meas, const int64_t& valu
+  ) {
+    if(!this->isEnabled(level) || this->isExcluded(meas)) {
+      return;
+    }
+    this->entries.push_back(
+     {Call::MEAS_INT,level,std::string(dateTime),"",meas.index,0.0,valu,""}
+    );
+  }
+
+  void LogBuffer::meas(
+   const LogLevel& level, const std::string_view& dateTime,
+   const Log::MeasHandle& meas, const std::string_view& valu
+  ) {
+    if(!this->isEnabled(level) || this->isExcluded(meas)) {
+      return;
+    }
+    this->entries.push_back(
+     {
+      Call::MEAS_STRING,level,std::string(dateTime),"",meas.index,0.0,0,
+      std::string(valu)
+     }
+    );
+  }
+
+  void LogBuffer::writeTo(Log* const log) {
+    for(std::size_t i=0; i<this->entries.size(); i++) {
+      const Entry& entry = this->entries.at(i);
+      const Log::EvntHandle evnt = {entry.handle};
+      const Log::MeasHandle meas = {entry.handle};
+      switch(entry.call) {
+        case Call::EVNT_NAME:
+          log->evnt(entry.level,entry.dateTime,entry.name);
+          break;
+        case Call::MEAS_NAME:
+          log->meas(entry.level,entry.dateTime,entry.name,entry.valu);
+          break;
+        case Call::EVNT_HANDLE:
+          log->evnt(entry.level,entry.dateTime,evnt);
+          break;
+        case Call::MEAS_REAL:
+          log->meas(entry.level,entry.dateTime,meas,entry.real);
+          break;
+        case Call::MEAS_INT:
+          log->meas(entry.level,entry.dateTime,meas,entry.integer);
+          break;
+        case Call::MEAS_STRING:
+          log->meas(
+           entry.level,entry.dateTime,meas,std::string_view(entry.valu)
+          );
+          break;
+      }
+    }
+    this->entries.clear();
+  }
+
+  std::size_t LogBuffer::getSize() const {
+    return this->entries.size();
+  }
+
+  void LogBuffer::clear() {
+    this->entries.clear();
+  }
+
+  Log* LogBuffer::getLog() const {
+    return this->log;
+  }
+}
@@ -0,0 +1,63 @@
+// test-log-buffer.cpp
+// LogBuffer class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>       // size_t
+#include <cstdlib>       // exit, EXIT_SUCCESS
+#include <string>        // to_string
+#include <vector>        // vector
+
+// satsim
+#include <Log.hpp>       // Log
+#include <LogBuffer.hpp> // LogBuffer
+#include <LogLevel.hpp>  // LogLevel
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  // Buffers filled out of order are written in buffer order
+  std::vector<cote::LogBuffer> buffers(3);
+  for(std::size_t i=buffers.size(); i>0; i--) {
+    buffers.at(i-1).meas(
+     cote::LogLevel::INFO, "0", "buffer", std::to_string(i-1)
+    );
+    buffers.at(i-1).evnt(cote::LogLevel::INFO, std::to_string(i-1), "written");
+  }
+  // Handle calls are recorded with their typed values
+  const cote::Log::MeasHandle typed = log.registerMeas("typed");
+  buffers.at(2).meas(cote::LogLevel::INFO, "2", typed, 0.5);
+  buffers.at(2).meas(cote::LogLevel::INFO, "2", typed, 7);
+  buffers.at(2).meas(cote::LogLevel::INFO, "2", typed, "seven");
+  buffers.at(2).evnt(cote::LogLevel::INFO, "2", log.registerEvnt("written"));
+  // Disabled levels are still filtered by the log
+  buffers.at(1).meas(cote::LogLevel::DEBUG, "0", "buffer", "debug");
+  log.meas(
+   cote::LogLevel::INFO, "0", "size", std::to_string(buffers.at(1).getSize())
+  );
+  for(std::size_t i=0; i<buffers.size(); i++) {
+    buffers.at(i).writeTo(&log);
+  }
+  log.meas(
+   cote::LogLevel::INFO, "1", "size", std::to_string(buffers.at(1).getSize())
+  );
+  // A buffer given its log drops disabled levels and excluded names when
+  // recording, before any value is buffered
+  log.setFilter({{false,"excluded",0}});
+  const cote::Log::MeasHandle excluded = log.registerMeas("excluded");
+  cote::LogBuffer heeding(&log);
+  heeding.meas(cote::LogLevel::INFO, "3", excluded, 1.0);
+  heeding.meas(cote::LogLevel::DEBUG, "3", typed, 1.0);
+  heeding.meas(cote::LogLevel::INFO, "3", typed, 3);
+  log.meas(
+   cote::LogLevel::INFO, "2", "size", std::to_string(heeding.getSize())
+  );
+  heeding.writeTo(&log);
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
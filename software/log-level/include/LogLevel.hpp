@@ -38,4 +38,17 @@ namespace cote {
   };
 }
 
+// Log levels compiled in, as a LogLevel bitmask; e.g. -DCOTE_LOG_LEVELS=1
+// compiles out all logs written with the COTE_MEAS and COTE_EVNT macros
+#ifndef COTE_LOG_LEVELS
+#define COTE_LOG_LEVELS 126
+#endif
+
+namespace cote {
+  // Whether logs of the given level are compiled in
+  constexpr bool isLogLevelCompiled(const LogLevel& level) {
+    return (COTE_LOG_LEVELS&static_cast<uint8_t>(level))!=0;
+  }
+}
+
 #endif
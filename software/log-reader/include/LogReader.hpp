@@ -0,0 +1,59 @@
+// LogReader.hpp
+// LogReader class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_LOG_READER_HPP
+#define COTE_LOG_READER_HPP
+
+// Standard library
+#include <cstddef> // size_t
+#include <cstdint> // int64_t, uint8_t, uint32_t, uint64_t
+#include <fstream> // ifstream
+#include <map>     // map
+#include <string>  // string
+#include <utility> // pair
+#include <vector>  // vector
+
+// cote library
+#include <Log.hpp> // Log
+
+namespace cote {
+  class LogReader {
+  public:
+    // The records of one block, formatted as in a CSV log file
+    struct Records {
+      std::string name; // measurement or event name
+      uint8_t kind;     // Log::KEY_MEAS or Log::KEY_EVNT
+      std::vector<std::string> times;
+      std::vector<std::string> values; // empty for events
+    };
+    // path: a log.bin file written by a Log in binary format
+    LogReader(const std::string& path);
+    // Whether the file could be opened and starts with the binary log magic
+    bool isValid() const;
+    // Reads up to and including the next records block; returns false at the
+    // end of the file or if the file is malformed
+    bool read(Records& records);
+  private:
+    std::string decode(const uint8_t& tag, const int64_t& bits) const;
+    // Reads the tags and 8-byte values of one column of an ENCODING_GORILLA
+    // records block, sized to the record count
+    bool readGorilla(std::vector<uint8_t>& tags, std::vector<int64_t>& bits);
+    // Reads width bits of stream at bitIndex, most significant first
+    static bool readBits(
+     const std::string& stream, const uint8_t& width, size_t& bitIndex,
+     uint64_t& value
+    );
+    template<typename T> bool readValue(T& value);
+    std::ifstream file;
+    bool valid;
+    std::map<uint32_t,std::pair<std::string,uint8_t>> keys; // (name, kind)
+    std::map<uint32_t,std::string> strings;
+  };
+}
+
+#endif
@@ -0,0 +1,245 @@
+// LogReader.cpp
+// LogReader class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>       // size_t
+#include <cstdint>       // int64_t, uint8_t, uint32_t, uint64_t
+#include <cstring>       // memcpy, strlen
+#include <fstream>       // ifstream
+#include <string>        // string, to_string
+#include <utility>       // pair
+#include <vector>        // vector
+
+// cote library
+#include <Log.hpp>       // Log
+#include <LogReader.hpp> // LogReader
+
+namespace cote {
+  LogReader::LogReader(const std::string& path) :
+   file(path,std::ios::in|std::ios::binary), valid(false) {
+    const std::string magic(Log::BINARY_MAGIC);
+    std::string header(magic.size(),'\0');
+    if(this->file.read(&header.at(0),header.size()) && header==magic) {
+      this->valid = true;
+    }
+  }
+
+  bool LogReader::isValid() const {
+    return this->valid;
+  }
+
+  bool LogReader::read(Records& records) {
+    uint8_t blockType = 0;
+    while(this->valid && this->readValue(blockType)) {
+      if(blockType==Log::BLOCK_KEY || blockType==Log::BLOCK_STRING) {
+        uint32_t id = 0;
+        uint8_t kind = 0;
+        uint32_t length = 0;
+        this->valid =
+         this->readValue(id) &&
+         (blockType==Log::BLOCK_STRING || this->readValue(kind)) &&
+         this->readValue(length);
+        std::string text(length,'\0');
+        this->valid =
+         this->valid && (length==0 || this->file.read(&text.at(0),length));
+        if(blockType==Log::BLOCK_KEY) {
+          this->keys[id] = std::pair<std::string,uint8_t>(text,kind);
+        } else {
+          this->strings[id] = text;
+        }
+      } else if(blockType==Log::BLOCK_RECORDS) {
+        uint32_t keyID = 0;
+        uint32_t count = 0;
+        uint8_t encoding = 0;
+        this->valid =
+         this->readValue(keyID) && this->readValue(count) &&
+         this->readValue(encoding) && this->keys.count(keyID)>0 &&
+         (encoding==Log::ENCODING_RAW || encoding==Log::ENCODING_GORILLA);
+        if(!this->valid) {
+          return false;
+        }
+        records.name = this->keys.at(keyID).first;
+        records.kind = this->keys.at(keyID).second;
+        records.times.clear();
+        records.values.clear();
+        std::vector<uint8_t> tags(count,0);
+        std::vector<int64_t> bits(count,0);
+        const size_t columnCount = (records.kind==Log::KEY_MEAS) ? 2 : 1;
+        for(size_t column=0; column<columnCount && this->valid; column++) {
+          if(encoding==Log::ENCODING_GORILLA) {
+            this->valid = this->readGorilla(tags,bits);
+          } else {
+            this->valid =
+             count==0 ||
+             (
+              this->file.read(reinterpret_cast<char*>(tags.data()),count) &&
+              this->file.read(
+               reinterpret_cast<char*>(bits.data()),count*sizeof(int64_t)
+              )
+             );
+          }
+          std::vector<std::string>& texts =
+           (column==0) ? records.times : records.values;
+          for(size_t i=0; i<count && this->valid; i++) {
+            texts.push_back(this->decode(tags.at(i),bits.at(i)));
+          }
+        }
+        return this->valid;
+      } else {
+        this->valid = false;
+      }
+    }
+    return false;
+  }
+
+  std::string LogReader::decode(const uint8_t& tag, const int64_t& bits) const {
+    if(tag==Log::TAG_INT) {
+      return std::to_string(bits);
+    } else if(tag==Log::TAG_REAL) {
+      double value = 0.0;
+      std::memcpy(&value,&bits,sizeof(value));
+      return std::to_string(value);
+    } else if(tag==Log::TAG_FIXED) {
+      return Log::formatFixed(bits);
+    } else {
+      return this->strings.at(static_cast<uint32_t>(bits));
+    }
+  }
+
+  bool LogReader::readGorilla(
+   std::vector<uint8_t>& tags, std::vector<int64_t>& bits
+  ) {
+    // Tag runs
+    uint32_t runCount = 0;
+    if(!this->readValue(runCount)) {
+      return false;
+    }
+    size_t tagIndex = 0;
+    for(uint32_t i=0; i<runCount; i++) {
+      uint32_t length = 0;
+      uint8_t tag = 0;
+      if(
+       !this->readValue(length) || !this->readValue(tag) ||
+       length>tags.size()-tagIndex
+      ) {
+        return false;
+      }
+      for(uint32_t j=0; j<length; j++) {
+        tags.at(tagIndex++) = tag;
+      }
+    }
+    if(tagIndex!=tags.size()) {
+      return false;
+    }
+    // Bit stream; see Log::appendGorilla for the layout
+    uint8_t mode = 0;
+    uint32_t length = 0;
+    if(!this->readValue(mode) || !this->readValue(length) || mode>1) {
+      return false;
+    }
+    const bool deltaOfDelta = (mode==1);
+    std::string stream(length,'\0');
+    if(length>0 && !this->file.read(&stream.at(0),length)) {
+      return false;
+    }
+    size_t bitIndex = 0;
+    uint64_t prevDelta = 0;
+    uint8_t prevLeading = 0;
+    uint8_t prevTrailing = 0;
+    for(size_t i=0; i<bits.size(); i++) {
+      uint64_t value = 0;
+      if(i==0) {
+        if(!LogReader::readBits(stream,64,bitIndex,value)) {
+          return false;
+        }
+        bits.at(i) = static_cast<int64_t>(value);
+        continue;
+      }
+      const uint64_t prev = static_cast<uint64_t>(bits.at(i-1));
+      uint64_t bit = 0;
+      if(!LogReader::readBits(stream,1,bitIndex,bit)) {
+        return false;
+      }
+      if(deltaOfDelta) {
+        //// Count the ones of the bucket prefix; the last bucket has no zero
+        uint8_t k = 0;
+        while(bit==1 && k<Log::GORILLA_BUCKETS-1) {
+          k++;
+          if(
+           k<Log::GORILLA_BUCKETS-1 &&
+           !LogReader::readBits(stream,1,bitIndex,bit)
+          ) {
+            return false;
+          }
+        }
+        const uint8_t width = Log::GORILLA_WIDTHS[k];
+        uint64_t dod = 0;
+        if(!LogReader::readBits(stream,width,bitIndex,dod)) {
+          return false;
+        }
+        if(width>0 && width<64 && ((dod>>(width-1))&0x1)) {
+          dod |= ~static_cast<uint64_t>(0)<<width; // sign extension
+        }
+        prevDelta += dod;
+        bits.at(i) = static_cast<int64_t>(prev+prevDelta);
+      } else {
+        uint64_t x = 0;
+        if(bit==1) {
+          if(!LogReader::readBits(stream,1,bitIndex,bit)) {
+            return false;
+          }
+          if(bit==1) {
+            uint64_t leading = 0;
+            uint64_t width = 0;
+            if(
+             !LogReader::readBits(stream,5,bitIndex,leading) ||
+             !LogReader::readBits(stream,6,bitIndex,width)
+            ) {
+              return false;
+            }
+            width = (width==0) ? 64 : width;
+            if(leading+width>64) {
+              return false;
+            }
+            prevLeading = static_cast<uint8_t>(leading);
+            prevTrailing = static_cast<uint8_t>(64-leading-width);
+          }
+          const uint8_t width = 64-prevLeading-prevTrailing;
+          if(!LogReader::readBits(stream,width,bitIndex,x)) {
+            return false;
+          }
+          x <<= prevTrailing;
+        }
+        bits.at(i) = static_cast<int64_t>(prev^x);
+      }
+    }
+    return true;
+  }
+
+  bool LogReader::readBits(
+   const std::string& stream, const uint8_t& width, size_t& bitIndex,
+   uint64_t& value
+  ) {
+    if(bitIndex+width>8*stream.size()) {
+      return false;
+    }
+    value = 0;
+    for(uint8_t i=0; i<width; i++) {
+      const uint8_t byte = static_cast<uint8_t>(stream.at(bitIndex/8));
+      value = (value<<1)|((byte>>(7-bitIndex%8))&0x1);
+      bitIndex++;
+    }
+    return true;
+  }
+
+  template<typename T> bool LogReader::readValue(T& value) {
+    return static_cast<bool>(
+     this->file.read(reinterpret_cast<char*>(&value),sizeof(T))
+    );
+  }
+}
@@ -0,0 +1,80 @@
+// test-log-reader.cpp
+// LogReader class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>       // size_t
+#include <cstdlib>       // exit, EXIT_SUCCESS
+#include <string>        // string, to_string
+#include <vector>        // vector
+
+// satsim
+#include <Log.hpp>       // Log
+#include <LogLevel.hpp>  // LogLevel
+#include <LogReader.hpp> // LogReader
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  // Write integer, real and string times and values in binary format; the
+  // step count measurement is long enough to be flushed before writeAll
+  std::vector<std::string> times;
+  std::vector<std::string> values;
+  {
+    cote::Log binaryLog(levels,"../test",cote::Log::Format::BINARY);
+    for(size_t i=0; i<70000; i++) {
+      binaryLog.meas(
+       cote::LogLevel::INFO, std::to_string(i), "step-count",
+       std::to_string(i*7)
+      );
+    }
+    times = {"0", "-12", "2022-01-01T00:00:00.000000000", "007", "1.5"};
+    values = {"3.300000", "-0.000100", "IDLE", "1e3", "IDLE"};
+    for(size_t i=0; i<times.size(); i++) {
+      binaryLog.meas(cote::LogLevel::INFO, times.at(i), "mixed", values.at(i));
+      binaryLog.evnt(cote::LogLevel::INFO, times.at(i), "tick");
+    }
+    binaryLog.writeAll();
+  }
+  // Read the blocks back and log what was found in CSV format
+  cote::Log log(levels,"../test");
+  cote::LogReader reader("../test/log.bin");
+  log.meas(
+   cote::LogLevel::INFO, "0", "valid", std::to_string(reader.isValid())
+  );
+  cote::LogReader::Records records;
+  size_t stepCount = 0;
+  bool stepValuesMatch = true;
+  while(reader.read(records)) {
+    log.meas(
+     cote::LogLevel::INFO, records.name, "block-count",
+     std::to_string(records.times.size())
+    );
+    if(records.name=="step-count") {
+      for(size_t i=0; i<records.times.size(); i++) {
+        stepValuesMatch =
+         stepValuesMatch &&
+         records.times.at(i)==std::to_string(stepCount) &&
+         records.values.at(i)==std::to_string(stepCount*7);
+        stepCount += 1;
+      }
+    } else {
+      for(size_t i=0; i<records.times.size(); i++) {
+        log.meas(
+         cote::LogLevel::INFO, records.times.at(i), records.name+"-read",
+         (records.kind==cote::Log::KEY_MEAS) ? records.values.at(i) : "event"
+        );
+      }
+    }
+  }
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(stepCount), "step-values-match",
+   std::to_string(stepValuesMatch)
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
@@ -10,59 +10,328 @@
 #define COTE_LOG_HPP
 
 // Standard library
-#include <cstdint>      // uint8_t, uint16_t
-#include <map>          // map
-#include <string>       // string
-#include <utility>      // pair
-#include <vector>       // vector
+#include <atomic>             // atomic
+#include <condition_variable> // condition_variable
+#include <cstddef>            // size_t
+#include <cstdint>            // int64_t, uint8_t, uint16_t, uint32_t, uint64_t
+#include <fstream>            // ofstream
+#include <map>                // map
+#include <mutex>              // mutex
+#include <ostream>            // ostream
+#include <string>             // string
+#include <string_view>        // string_view
+#include <thread>             // thread
+#include <type_traits>        // enable_if, is_integral
+#include <vector>             // vector
 
 // cote library
-#include <LogLevel.hpp> // LogLevel
+#include <LogLevel.hpp>       // LogLevel
 
 namespace cote {
   class Log {
   public:
+    // Output formats
+    // - CSV: one meas-<name>.csv or evnt-<name>.csv text file per log name
+    // - BINARY: a single log.bin file of typed records; see writeBinary for
+    //   the layout and the cote-log2csv example for conversion to CSV files
+    // - LONG: one long-meas-<kind>.csv or long-evnt-<kind>.csv text file per
+    //   kind of log, shared by all entities; see writeLong
+    enum class Format : uint8_t {
+      CSV    = 0,
+      BINARY = 1,
+      LONG   = 2
+    };
+    // Binary file layout constants
+    static constexpr const char* BINARY_MAGIC = "COTELOG1";
+    static constexpr uint8_t BLOCK_KEY     = 1;
+    static constexpr uint8_t BLOCK_STRING  = 2;
+    static constexpr uint8_t BLOCK_RECORDS = 3;
+    static constexpr uint8_t KEY_MEAS      = 0;
+    static constexpr uint8_t KEY_EVNT      = 1;
+    static constexpr uint8_t ENCODING_RAW     = 0;
+    static constexpr uint8_t ENCODING_GORILLA = 1;
+    // Delta-of-delta bucket bit widths of ENCODING_GORILLA; see appendGorilla
+    static constexpr uint8_t GORILLA_BUCKETS = 8;
+    static constexpr uint8_t GORILLA_WIDTHS[GORILLA_BUCKETS] =
+     {0,7,9,12,16,20,32,64};
+    static constexpr uint8_t TAG_INT       = 0; // decimal integer
+    static constexpr uint8_t TAG_REAL      = 1; // std::to_string of a double
+    static constexpr uint8_t TAG_STRING    = 2; // interned string
+    static constexpr uint8_t TAG_FIXED     = 3; // std::to_string of a double,
+                                                // stored in millionths
+    // Handles to registered names; see registerMeas and registerEvnt
+    struct MeasHandle {
+      uint32_t index;
+    };
+    struct EvntHandle {
+      uint32_t index;
+    };
+    // Selection of the logs kept for matching names; see setFilter
+    struct FilterRule {
+      bool include;        // whether matching names are kept
+      std::string pattern; // glob: '*' matches any run of characters and '?'
+                           // any one character
+      uint32_t every;      // keep every Nth log of an included name
+    };
     // levels: a vector of LogLevels to be heeded; all others will be ignored
     // dir: directory for log files
-    Log(const std::vector<LogLevel>& levels, const std::string& dir);
+    // format: output format of the log files
+    Log(
+     const std::vector<LogLevel>& levels, const std::string& dir,
+     const Format& format=Format::CSV
+    );
+    // Finishes all handed-off writes and stops the writer thread; logs still
+    // buffered are not written unless writeAll was called
+    ~Log();
+    Log(const Log&) = delete;
+    Log& operator=(const Log&) = delete;
+    // Whether logs of the given level are compiled in and heeded; see also
+    // the COTE_MEAS and COTE_EVNT macros
+    //// Defined here so that a guarded call site inlines to a bitmask test
+    bool isEnabled(const LogLevel& level) const {
+      return isLogLevelCompiled(level) &&
+       (this->levels&static_cast<uint8_t>(level))!=0;
+    }
+    // rules: ordered measurement and event selection rules; the first rule
+    //        whose pattern matches a name decides whether its logs are kept,
+    //        and names matching no rule are kept in full. Each name is
+    //        resolved once, on registration (or here for names registered
+    //        before), and the logs of an excluded name are dropped before
+    //        any buffering
+    void setFilter(const std::vector<FilterRule>& rules);
+    // Reads and sets filter rules from a file with a header line followed by
+    // "include,<pattern>,<every>," and "exclude,<pattern>," rows; returns
+    // false if the file cannot be read or has malformed rows, which are
+    // skipped
+    bool readFilter(const std::string& filePath);
+    // Returns the handle for a measurement or event name, registering the
+    // name on first use; logging by handle skips the name lookup
+    MeasHandle registerMeas(const std::string& meas);
+    EvntHandle registerEvnt(const std::string& evnt);
+    // Whether the filter drops every log of a registered name, so that a
+    // caller may skip formatting them; safe to call concurrently as long as
+    // no name is registered and the filter is not changed meanwhile
+    bool isExcluded(const MeasHandle& meas) const;
+    bool isExcluded(const EvntHandle& evnt) const;
     // level: log level of this log
     // dateTime: ISO 8601 date and time or similar
-    // evnt: event name
+    // evnt: event name or handle
     void evnt(
      const LogLevel& level, const std::string& dateTime, const std::string& evnt
     );
+    void evnt(
+     const LogLevel& level, const std::string_view& dateTime,
+     const EvntHandle& evnt
+    );
     // level: log level of this log
     // dateTime: ISO 8601 date and time or similar
-    // meas: measurement name
-    // valu: measurement value
+    // meas: measurement name or handle
+    // valu: measurement value; a double is written as by std::to_string, an
+    //       integer (within the int64_t range) in decimal, and a string as is
     void meas(
      const LogLevel& level, const std::string& dateTime,
      const std::string& meas, const std::string& valu
     );
-    // Appends all logs to their corresponding log files
-    void writeAll() const;
+    void meas(
+     const LogLevel& level, const std::string_view& dateTime,
+     const MeasHandle& meas, const double& valu
+    );
+    void meas(
+     const LogLevel& level, const std::string_view& dateTime,
+     const MeasHandle& meas, const int64_t& valu
+    );
+    void meas(
+     const LogLevel& level, const std::string_view& dateTime,
+     const MeasHandle& meas, const std::string_view& valu
+    );
+    template<
+     typename T,
+     typename = typename std::enable_if<std::is_integral<T>::value>::type
+    >
+    void meas(
+     const LogLevel& level, const std::string_view& dateTime,
+     const MeasHandle& meas, const T& valu
+    ) {
+      this->meas(level,dateTime,meas,static_cast<int64_t>(valu));
+    }
+    // Formats millionths as std::to_string formats the equivalent double
+    static std::string formatFixed(const int64_t& micros);
+    // Appends all logs to their corresponding log files; returns once every
+    // log handed off so far has been written
+    void writeAll();
+    // bytes: most bytes of logs to keep buffered over all names; beyond it,
+    //        the largest buffers are handed off early (0, the default, for no
+    //        budget, i.e. each name is handed off at BUFFER_SIZE logs)
+    void setMemoryBudget(const size_t& bytes);
+    size_t getMemoryBudget() const;
+    // Returns the bytes of logs buffered now and the most ever buffered, e.g.
+    // to report at exit; logs handed off to the writer thread are not counted
+    size_t getBufferedBytes() const;
+    size_t getPeakBufferedBytes() const;
   private:
+    // Buffered logs of one name; times and values are kept in flat arrays
+    // and only formatted when written
+    struct Column {
+      uint8_t kind;                   // KEY_MEAS or KEY_EVNT
+      uint32_t index;                 // handle index, also the binary key ID
+      std::string name;               // measurement or event name
+      bool started;                   // whether the log file or binary key
+                                      // block has been written
+      std::string timeChars;          // concatenated times
+      std::vector<uint32_t> timeEnds; // end of each time in timeChars
+      std::vector<uint8_t> tags;      // TAG_INT, TAG_REAL or TAG_STRING
+      std::vector<int64_t> bits;      // integer, double bits or end of the
+                                      // string in valueChars
+      std::string valueChars;         // concatenated string values
+      size_t bytes;                   // bytes in the five buffers above
+      uint32_t every;                 // keep every Nth log; 0 to keep none
+      uint32_t countdown;             // logs to drop before the next kept one
+    };
     // Maximum number of logs before appending to corresponding map key file
     static const uint16_t BUFFER_SIZE = 65535;
-    // Check whether the given log level is enabled
-    bool isEnabled(const LogLevel& level) const;
-    // Appends specified events to corresponding log file
-    void writeEvnt(const std::string& evnt) const;
-    // Appends specified measurements to corresponding log file
-    void writeMeas(const std::string& meas) const;
+    // Capacity of the hand-off ring of write jobs
+    static const size_t QUEUE_SIZE = 16;
+    // High-water mark of logs handed off but not yet written; a hand-off
+    // beyond it waits for the writer thread (backpressure)
+    static const size_t MAX_PENDING_LOGS = 16*static_cast<size_t>(BUFFER_SIZE);
+    // Registers a name of the given kind, returning its column index
+    uint32_t registerName(const uint8_t& kind, const std::string& name);
+    // Resolves the filter rules for a column
+    void applyFilter(Column& column) const;
+    // Whether the next log of a column is kept, counting it for decimation
+    bool keep(const uint32_t& index);
+    // Whether a glob pattern matches the whole of a name
+    static bool matchGlob(const std::string& pattern, const std::string& name);
+    // Appends a time and, for measurements, a value to a column, handing it
+    // off when full
+    void append(
+     const uint32_t& index, const std::string_view& dateTime,
+     const uint8_t& tag, const int64_t& bits
+    );
+    // Hands off the buffered logs of one column to the writer thread, leaving
+    // empty buffers in their place
+    void handOff(const uint32_t& index);
+    // Hands off the largest buffers until half of the memory budget is left
+    void enforceMemoryBudget();
+    // Writer thread loop: writes hand-off jobs in order until stopped
+    void runWriter();
+    // Appends the logs of a job to the corresponding CSV log file
+    void writeCsv(const Column& job);
+    // Appends the logs of a job to the long format file of its kind
+    //// A name "<type>-<digits>-<kind>", e.g. "sat-0449380000-node-voltage",
+    //// is split into an entity and a kind; other names have an empty entity
+    //// Rows are "time,entity,value," for measurements and "time,entity," for
+    //// events; long-meas-<kind>-index.csv (or long-evnt-) gets one
+    //// "entity,offset,count," row per job, locating the job's rows by byte
+    //// offset so that one entity can be extracted without a full scan
+    void writeLong(const Column& job);
+    // Writes the rows of a job in CSV format, with infix after each time
+    void writeRows(
+     const Column& job, const std::string& infix, std::ostream& outFile
+    ) const;
+    // Splits a log name into an entity prefix and a kind
+    static void splitName(
+     const std::string& name, std::string& entity, std::string& kind
+    );
+    // Appends the logs of a job to log.bin as a records block, preceded by
+    // key and string blocks for names and strings not yet written
+    //// Each block starts with its one-byte type; integers are little-endian
+    //// - KEY: uint32 key ID, uint8 KEY_MEAS or KEY_EVNT, uint32 length, name
+    //// - STRING: uint32 string ID, uint32 length, string
+    //// - RECORDS: uint32 key ID, uint32 count N, uint8 encoding, then the
+    ////   times and, for measurements, the values; each is a tag and 8 bytes:
+    ////   an integer, the bits of a TAG_REAL double, the millionths of a
+    ////   TAG_FIXED number or a TAG_STRING string ID
+    ////   - ENCODING_RAW: N uint8 tags followed by N int64s
+    ////   - ENCODING_GORILLA: see appendGorilla
+    //// Files are written with ENCODING_GORILLA
+    void writeBinary(const Column& job);
+    // Encodes a time or value as a tag and 8 bytes, writing a string block to
+    // out for a string not yet written
+    void encodeBinary(
+     const std::string& text, uint8_t& tag, int64_t& bits, std::string& out
+    );
+    // Appends a column of tags and 8-byte values in the ENCODING_GORILLA form
+    //// uint32 run count R, R (uint32 length, uint8 tag) runs of equal tags,
+    //// uint8 mode, uint32 byte length L and an L-byte big-endian bit stream
+    //// starting with the first value in 64 bits; each following value is
+    //// - mode 1 (no TAG_REAL), by the change d in the difference from the
+    ////   previous value: '0' if d is 0, else the first bucket k that fits,
+    ////   as k ones, a zero (except for the last bucket) and d in
+    ////   GORILLA_WIDTHS[k] bits two's complement
+    //// - mode 0, by its XOR x with the previous value: '0' if x is 0, '10'
+    ////   and the bits of x within the previous window of meaningful bits if
+    ////   they fit, else '11', 5 bits of leading zeros (at most 31), 6 bits of
+    ////   meaningful bit count (64 as 0) and the meaningful bits
+    static void appendGorilla(
+     const std::string& tags, const std::vector<int64_t>& bits, std::string& out
+    );
+    // Converts a double to millionths if formatFixed reproduces its
+    // std::to_string text
+    static bool toFixed(const double& value, int64_t& micros);
+    // Appends the low width bits of value to stream, most significant first
+    static void appendBits(
+     const uint64_t& value, const uint8_t& width, size_t& bitCount,
+     std::string& stream
+    );
     // Flag indicating enabled log levels (see LogLevel enum class)
     uint8_t levels;
     // Default directory for log files
     std::string dir;
-    // Event log map: (event, {times})
-    std::map<
-     std::string,std::vector<std::string>
-    > evntLogs;
-    // Measurement log map: (measurement, {time, value})
-    std::map<
-     std::string,std::vector<std::pair<std::string,std::string>>
-    > measLogs;
+    // Output format
+    Format format;
+    // Binary format interning: (string, string ID)
+    std::map<std::string,uint32_t> binaryStringIDs;
+    // Long format files, kept open by the writer thread: (path, file)
+    std::map<std::string,std::ofstream> longFiles;
+    // Filter rules in order
+    std::vector<FilterRule> filterRules;
+    // Registered names: (name, column index)
+    std::map<std::string,uint32_t> evntIndices;
+    std::map<std::string,uint32_t> measIndices;
+    // Buffered logs, indexed by handle
+    std::vector<Column> columns;
+    // Memory accounting of the buffered logs; the budget is also read by the
+    // writer thread, which releases written buffers when there is one
+    std::atomic<size_t> memoryBudget;
+    size_t bufferedBytes;
+    size_t peakBufferedBytes;
+    // Single-producer single-consumer ring of write jobs; the simulation
+    // thread advances queueTail and the writer thread advances queueHead
+    std::vector<Column> queue;
+    std::atomic<size_t> queueHead;
+    std::atomic<size_t> queueTail;
+    std::atomic<size_t> pendingLogs;
+    std::atomic<bool> stopping;
+    // Only used to sleep and wake: the writer when the ring is empty, the
+    // simulation thread under backpressure or in writeAll
+    std::mutex waitMutex;
+    std::condition_variable writerWake;
+    std::condition_variable producerWake;
+    std::thread writer;
   };
 }
 
+// Log a measurement or event through log, a Log or LogBuffer, only if level is
+// compiled in and enabled; the remaining arguments, e.g. a DateTime::toString
+// or std::to_string call, are only evaluated then. level must be a constant
+// expression such as cote::LogLevel::INFO, so that a level not compiled in
+// leaves no code at all
+#define COTE_MEAS(log,level,dateTime,name,valu)     \
+ do {                                               \
+   if constexpr(cote::isLogLevelCompiled(level)) {  \
+     if((log).isEnabled(level)) {                   \
+       (log).meas(level,dateTime,name,valu);        \
+     }                                              \
+   }                                                \
+ } while(false)
+#define COTE_EVNT(log,level,dateTime,name)          \
+ do {                                               \
+   if constexpr(cote::isLogLevelCompiled(level)) {  \
+     if((log).isEnabled(level)) {                   \
+       (log).evnt(level,dateTime,name);             \
+     }                                              \
+   }                                                \
+ } while(false)
+
 #endif
@@ -7,11 +7,22 @@
 // See the top-level LICENSE file for the license.
 
 // Standard library
+#include <algorithm>    // sort
+#include <atomic>       // memory_order
+#include <cmath>        // fabs, llround
 #include <cstddef>      // size_t
-#include <cstdint>      // uint8_t
-#include <fstream>      // ofstream
-#include <string>       // string
-#include <utility>      // pair
+#include <cstdint>      // int64_t, uint8_t, uint32_t, uint64_t
+#include <cstdlib>      // strtod
+#include <cstring>      // memcpy, strlen
+#include <fstream>      // ifstream, ofstream
+#include <functional>   // greater
+#include <mutex>        // lock_guard, mutex, unique_lock
+#include <ostream>      // ostream
+#include <sstream>      // istringstream
+#include <string>       // getline, stoll, stoul, string, to_string
+#include <string_view>  // string_view
+#include <thread>       // thread
+#include <utility>      // make_pair, pair
 #include <vector>       // vector
 
 // cote library
@@ -19,7 +30,12 @@
 #include <LogLevel.hpp> // LogLevel
 
 namespace cote {
-  Log::Log(const std::vector<LogLevel>& levels, const std::string& dir) {
+  Log::Log(
+   const std::vector<LogLevel>& levels, const std::string& dir,
+   const Format& format
+  ) : format(format), memoryBudget(0), bufferedBytes(0), peakBufferedBytes(0),
+      queue(QUEUE_SIZE), queueHead(0), queueTail(0), pendingLogs(0),
+      stopping(false) {
     // ingest log levels
     this->levels = static_cast<uint8_t>(0);
     for(size_t i=0; i<levels.size(); i++) {
@@ -31,79 +47,752 @@ namespace cote {
       sanitized_dir.push_back('/');
     }
     this->dir = sanitized_dir;
+    if(this->format==Format::BINARY) {
+      std::ofstream outFile(
+       this->dir+"log.bin",std::ios::out|std::ios::binary
+      );
+      outFile.write(Log::BINARY_MAGIC,std::strlen(Log::BINARY_MAGIC));
+      outFile.close();
+    }
+    this->writer = std::thread(&Log::runWriter,this);
+  }
+
+  Log::~Log() {
+    {
+      std::lock_guard<std::mutex> lock(this->waitMutex);
+      this->stopping.store(true);
+    }
+    this->writerWake.notify_one();
+    this->writer.join();
+  }
+
+  void Log::setFilter(const std::vector<FilterRule>& rules) {
+    this->filterRules = rules;
+    for(size_t i=0; i<this->columns.size(); i++) {
+      this->applyFilter(this->columns.at(i));
+    }
+  }
+
+  bool Log::readFilter(const std::string& filePath) {
+    std::ifstream filterHandle(filePath);
+    if(!filterHandle.is_open()) {
+      return false;
+    }
+    bool wellFormed = true;
+    std::vector<FilterRule> rules;
+    std::string line = "";
+    std::getline(filterHandle,line); // Read header
+    while(std::getline(filterHandle,line)) {
+      if(line.empty()) {
+        continue;
+      }
+      std::istringstream row(line);
+      std::string action = "";
+      std::string pattern = "";
+      std::string every = "";
+      std::getline(row,action,',');
+      std::getline(row,pattern,',');
+      std::getline(row,every,',');
+      FilterRule rule;
+      rule.include = (action=="include");
+      rule.pattern = pattern;
+      rule.every = 1;
+      if((action!="include" && action!="exclude") || pattern.empty()) {
+        wellFormed = false;
+        continue;
+      }
+      if(rule.include && !every.empty()) {
+        if(every.find_first_not_of("0123456789")!=std::string::npos) {
+          wellFormed = false;
+          continue;
+        }
+        rule.every = static_cast<uint32_t>(std::stoul(every));
+        if(rule.every==0) {
+          wellFormed = false;
+          continue;
+        }
+      }
+      rules.push_back(rule);
+    }
+    filterHandle.close();
+    this->setFilter(rules);
+    return wellFormed;
+  }
+
+  Log::MeasHandle Log::registerMeas(const std::string& meas) {
+    MeasHandle handle;
+    handle.index = this->registerName(Log::KEY_MEAS,meas);
+    return handle;
+  }
+
+  Log::EvntHandle Log::registerEvnt(const std::string& evnt) {
+    EvntHandle handle;
+    handle.index = this->registerName(Log::KEY_EVNT,evnt);
+    return handle;
+  }
+
+  bool Log::isExcluded(const MeasHandle& meas) const {
+    return this->columns.at(meas.index).every==0;
+  }
+
+  bool Log::isExcluded(const EvntHandle& evnt) const {
+    return this->columns.at(evnt.index).every==0;
   }
 
   void Log::evnt(
    const LogLevel& level, const std::string& dateTime, const std::string& evnt
   ) {
     if(isEnabled(level)) {
-      if(this->evntLogs.count(evnt)==0) {
-        this->evntLogs[evnt] = std::vector<std::string>();
-        std::ofstream outFile(this->dir+"evnt-"+evnt+".csv",std::ios::out);
-        outFile << evnt << "-time,"
-                << std::endl;
-        outFile.close();
-      }
-      this->evntLogs[evnt].push_back(dateTime);
-      if(this->evntLogs[evnt].size()>=BUFFER_SIZE) {
-        this->writeEvnt(evnt);
-        this->evntLogs[evnt].clear();
+      const uint32_t index = this->registerName(Log::KEY_EVNT,evnt);
+      if(this->keep(index)) {
+        this->append(index,dateTime,Log::TAG_INT,0);
       }
     }
   }
 
+  void Log::evnt(
+   const LogLevel& level, const std::string_view& dateTime,
+   const EvntHandle& evnt
+  ) {
+    if(isEnabled(level) && this->keep(evnt.index)) {
+      this->append(evnt.index,dateTime,Log::TAG_INT,0);
+    }
+  }
+
   void Log::meas(
    const LogLevel& level, const std::string& dateTime,
    const std::string& meas, const std::string& valu
   ) {
     if(isEnabled(level)) {
-      if(this->measLogs.count(meas)==0) {
-        this->measLogs[meas] =
-         std::vector< std::pair<std::string,std::string> >();
-        std::ofstream outFile(this->dir+"meas-"+meas+".csv",std::ios::out);
-        outFile << "time," << meas << ","
-                << std::endl;
-        outFile.close();
-      }
-      this->measLogs[meas].push_back(
-       std::pair<std::string,std::string>(dateTime,valu)
+      MeasHandle handle;
+      handle.index = this->registerName(Log::KEY_MEAS,meas);
+      this->meas(level,dateTime,handle,std::string_view(valu));
+    }
+  }
+
+  void Log::meas(
+   const LogLevel& level, const std::string_view& dateTime,
+   const MeasHandle& meas, const double& valu
+  ) {
+    if(isEnabled(level) && this->keep(meas.index)) {
+      int64_t bits = 0;
+      std::memcpy(&bits,&valu,sizeof(bits));
+      this->append(meas.index,dateTime,Log::TAG_REAL,bits);
+    }
+  }
+
+  void Log::meas(
+   const LogLevel& level, const std::string_view& dateTime,
+   const MeasHandle& meas, const int64_t& valu
+  ) {
+    if(isEnabled(level) && this->keep(meas.index)) {
+      this->append(meas.index,dateTime,Log::TAG_INT,valu);
+    }
+  }
+
+  void Log::meas(
+   const LogLevel& level, const std::string_view& dateTime,
+   const MeasHandle& meas, const std::string_view& valu
+  ) {
+    if(isEnabled(level) && this->keep(meas.index)) {
+      std::string& valueChars = this->columns.at(meas.index).valueChars;
+      valueChars.append(valu);
+      this->append(
+       meas.index,dateTime,Log::TAG_STRING,
+       static_cast<int64_t>(valueChars.size())
       );
-      if(this->measLogs[meas].size()>=BUFFER_SIZE) {
-        this->writeMeas(meas);
-        this->measLogs[meas].clear();
+    }
+  }
+
+  void Log::writeAll() {
+    //// A registered name without logs gets no file, as if never logged
+    for(size_t i=0; i<this->columns.size(); i++) {
+      if(!this->columns.at(i).timeEnds.empty()) {
+        this->handOff(static_cast<uint32_t>(i));
       }
     }
+    std::unique_lock<std::mutex> lock(this->waitMutex);
+    this->producerWake.wait(lock,[this]{
+      return this->queueHead.load()==this->queueTail.load();
+    });
   }
 
-  void Log::writeAll() const {
-    for(const auto& e : this->evntLogs) {
-      this->writeEvnt(e.first);
+  void Log::setMemoryBudget(const size_t& bytes) {
+    this->memoryBudget.store(bytes);
+    if(bytes>0 && this->bufferedBytes>bytes) {
+      this->enforceMemoryBudget();
     }
-    for(const auto& e : this->measLogs) {
-      this->writeMeas(e.first);
+  }
+
+  size_t Log::getMemoryBudget() const {
+    return this->memoryBudget.load();
+  }
+
+  size_t Log::getBufferedBytes() const {
+    return this->bufferedBytes;
+  }
+
+  size_t Log::getPeakBufferedBytes() const {
+    return this->peakBufferedBytes;
+  }
+
+  uint32_t Log::registerName(const uint8_t& kind, const std::string& name) {
+    std::map<std::string,uint32_t>& indices =
+     (kind==Log::KEY_EVNT) ? this->evntIndices : this->measIndices;
+    const auto it = indices.find(name);
+    if(it!=indices.end()) {
+      return it->second;
     }
+    const uint32_t index = static_cast<uint32_t>(this->columns.size());
+    indices[name] = index;
+    this->columns.push_back(Column());
+    this->columns.back().kind = kind;
+    this->columns.back().index = index;
+    this->columns.back().name = name;
+    this->columns.back().started = false;
+    this->columns.back().bytes = 0;
+    this->applyFilter(this->columns.back());
+    return index;
   }
 
-  bool Log::isEnabled(const LogLevel& level) const {
-    return this->levels&static_cast<uint8_t>(level);
+  void Log::applyFilter(Column& column) const {
+    column.every = 1;
+    column.countdown = 0;
+    for(size_t i=0; i<this->filterRules.size(); i++) {
+      const FilterRule& rule = this->filterRules.at(i);
+      if(Log::matchGlob(rule.pattern,column.name)) {
+        column.every = rule.include ? rule.every : 0;
+        return;
+      }
+    }
   }
 
-  void Log::writeEvnt(const std::string& evnt) const {
-    std::ofstream outFile(this->dir+"evnt-"+evnt+".csv",std::ios::app);
-    for(size_t i=0; i<this->evntLogs.at(evnt).size(); i++) {
-      outFile << this->evntLogs.at(evnt).at(i) << ","
-              << std::endl;
+  bool Log::keep(const uint32_t& index) {
+    Column& column = this->columns.at(index);
+    if(column.every==0) {
+      return false;
+    }
+    if(column.countdown>0) {
+      column.countdown--;
+      return false;
+    }
+    column.countdown = column.every-1;
+    return true;
+  }
+
+  bool Log::matchGlob(const std::string& pattern, const std::string& name) {
+    //// On a mismatch after a '*', retry with the '*' matching one more
+    //// character; only the latest '*' needs to be retried
+    size_t p = 0;
+    size_t n = 0;
+    size_t star = std::string::npos;
+    size_t starName = 0;
+    while(n<name.size()) {
+      const char c = (p<pattern.size()) ? pattern.at(p) : '\0';
+      if(p<pattern.size() && c=='*') {
+        star = p;
+        starName = n;
+        p++;
+      } else if(p<pattern.size() && (c=='?' || c==name.at(n))) {
+        p++;
+        n++;
+      } else if(star!=std::string::npos) {
+        p = star+1;
+        starName++;
+        n = starName;
+      } else {
+        return false;
+      }
+    }
+    while(p<pattern.size() && pattern.at(p)=='*') {
+      p++;
+    }
+    return p==pattern.size();
+  }
+
+  void Log::append(
+   const uint32_t& index, const std::string_view& dateTime,
+   const uint8_t& tag, const int64_t& bits
+  ) {
+    Column& column = this->columns.at(index);
+    column.timeChars.append(dateTime);
+    column.timeEnds.push_back(static_cast<uint32_t>(column.timeChars.size()));
+    if(column.kind==Log::KEY_MEAS) {
+      column.tags.push_back(tag);
+      column.bits.push_back(bits);
+    }
+    //// Recounting the column also covers a string value appended by meas
+    const size_t bytes =
+     column.timeChars.size()+sizeof(uint32_t)*column.timeEnds.size()+
+     column.tags.size()+sizeof(int64_t)*column.bits.size()+
+     column.valueChars.size();
+    this->bufferedBytes += bytes-column.bytes;
+    column.bytes = bytes;
+    if(this->bufferedBytes>this->peakBufferedBytes) {
+      this->peakBufferedBytes = this->bufferedBytes;
+    }
+    if(column.timeEnds.size()>=BUFFER_SIZE) {
+      this->handOff(index);
+    }
+    const size_t budget = this->memoryBudget.load(std::memory_order_relaxed);
+    if(budget>0 && this->bufferedBytes>budget) {
+      this->enforceMemoryBudget();
     }
+  }
+
+  void Log::handOff(const uint32_t& index) {
+    //// Only the simulation thread writes queueTail and only the writer thread
+    //// writes queueHead, so the ring itself needs no lock; the mutex guards
+    //// against missed wake-ups when either side goes to sleep
+    Column& column = this->columns.at(index);
+    const size_t count = column.timeEnds.size();
+    const size_t tail = this->queueTail.load(std::memory_order_relaxed);
+    if(
+     tail-this->queueHead.load()>=QUEUE_SIZE ||
+     (this->pendingLogs.load()>0 &&
+      this->pendingLogs.load()+count>MAX_PENDING_LOGS)
+    ) {
+      std::unique_lock<std::mutex> lock(this->waitMutex);
+      this->producerWake.wait(lock,[this,tail,count]{
+        return tail-this->queueHead.load()<QUEUE_SIZE &&
+         (this->pendingLogs.load()==0 ||
+          this->pendingLogs.load()+count<=MAX_PENDING_LOGS);
+      });
+    }
+    //// Swapping hands the column's buffers to the job and gives the column
+    //// the job's previous buffers, already written and cleared, to refill
+    Column& job = this->queue.at(tail%QUEUE_SIZE);
+    job.kind = column.kind;
+    job.index = column.index;
+    job.name = column.name;
+    job.started = column.started;
+    job.timeChars.swap(column.timeChars);
+    job.timeEnds.swap(column.timeEnds);
+    job.tags.swap(column.tags);
+    job.bits.swap(column.bits);
+    job.valueChars.swap(column.valueChars);
+    column.started = true;
+    this->bufferedBytes -= column.bytes;
+    column.bytes = 0;
+    this->pendingLogs.fetch_add(count);
+    {
+      std::lock_guard<std::mutex> lock(this->waitMutex);
+      this->queueTail.store(tail+1,std::memory_order_release);
+    }
+    this->writerWake.notify_one();
+  }
+
+  void Log::enforceMemoryBudget() {
+    //// Handing off down to half of the budget rather than just below it
+    //// amortizes the scan over all columns, and largest first keeps the
+    //// number of (small, per-file) write jobs low
+    std::vector<std::pair<size_t,uint32_t>> sizes;
+    for(size_t i=0; i<this->columns.size(); i++) {
+      if(this->columns.at(i).bytes>0) {
+        sizes.push_back(
+         std::make_pair(this->columns.at(i).bytes,static_cast<uint32_t>(i))
+        );
+      }
+    }
+    std::sort(sizes.begin(),sizes.end(),std::greater<>());
+    const size_t lowWater = this->memoryBudget.load()/2;
+    for(size_t i=0; i<sizes.size() && this->bufferedBytes>lowWater; i++) {
+      this->handOff(sizes.at(i).second);
+    }
+  }
+
+  void Log::runWriter() {
+    while(true) {
+      const size_t head = this->queueHead.load(std::memory_order_relaxed);
+      if(head==this->queueTail.load(std::memory_order_acquire)) {
+        std::unique_lock<std::mutex> lock(this->waitMutex);
+        this->writerWake.wait(lock,[this,head]{
+          return head!=this->queueTail.load() || this->stopping.load();
+        });
+        if(head==this->queueTail.load()) {
+          return;
+        }
+        continue;
+      }
+      Column& job = this->queue.at(head%QUEUE_SIZE);
+      if(this->format==Format::BINARY) {
+        this->writeBinary(job);
+      } else if(this->format==Format::LONG) {
+        this->writeLong(job);
+        //// Long format files stay open; flush them whenever the writer has
+        //// caught up so that they are complete when writeAll returns
+        if(head+1==this->queueTail.load()) {
+          for(auto& file : this->longFiles) {
+            file.second.flush();
+          }
+        }
+      } else {
+        this->writeCsv(job);
+      }
+      const size_t count = job.timeEnds.size();
+      if(this->memoryBudget.load()>0) {
+        //// Written buffers are swapped back into columns on the next hand-off,
+        //// so under a budget they are released rather than kept for reuse
+        std::string().swap(job.timeChars);
+        std::vector<uint32_t>().swap(job.timeEnds);
+        std::vector<uint8_t>().swap(job.tags);
+        std::vector<int64_t>().swap(job.bits);
+        std::string().swap(job.valueChars);
+      } else {
+        job.timeChars.clear();
+        job.timeEnds.clear();
+        job.tags.clear();
+        job.bits.clear();
+        job.valueChars.clear();
+      }
+      this->pendingLogs.fetch_sub(count);
+      {
+        std::lock_guard<std::mutex> lock(this->waitMutex);
+        this->queueHead.store(head+1,std::memory_order_release);
+      }
+      this->producerWake.notify_one();
+    }
+  }
+
+  void Log::writeCsv(const Column& job) {
+    const bool isMeas = (job.kind==Log::KEY_MEAS);
+    const std::string fileName =
+     this->dir+(isMeas ? "meas-" : "evnt-")+job.name+".csv";
+    std::ofstream outFile;
+    if(job.started) {
+      outFile.open(fileName,std::ios::app);
+    } else {
+      outFile.open(fileName,std::ios::out);
+      if(isMeas) {
+        outFile << "time," << job.name << ",\n";
+      } else {
+        outFile << job.name << "-time,\n";
+      }
+    }
+    this->writeRows(job,"",outFile);
     outFile.close();
   }
 
-  void Log::writeMeas(const std::string& meas) const {
-    std::ofstream outFile(this->dir+"meas-"+meas+".csv",std::ios::app);
-    for(size_t i=0; i<this->measLogs.at(meas).size(); i++) {
-      outFile << this->measLogs.at(meas).at(i).first << ","
-              << this->measLogs.at(meas).at(i).second << ","
-              << std::endl;
+  void Log::writeLong(const Column& job) {
+    const bool isMeas = (job.kind==Log::KEY_MEAS);
+    std::string entity;
+    std::string kind;
+    Log::splitName(job.name,entity,kind);
+    const std::string fileName =
+     this->dir+(isMeas ? "long-meas-" : "long-evnt-")+kind;
+    if(this->longFiles.count(fileName)==0) {
+      std::ofstream& outFile = this->longFiles[fileName];
+      outFile.open(fileName+".csv",std::ios::out);
+      if(isMeas) {
+        outFile << "time,entity," << kind << ",\n";
+      } else {
+        outFile << "time,entity,\n";
+      }
+      std::ofstream& indexFile = this->longFiles[fileName+"-index"];
+      indexFile.open(fileName+"-index.csv",std::ios::out);
+      indexFile << "entity,offset,count,\n";
     }
+    std::ofstream& outFile = this->longFiles.at(fileName);
+    this->longFiles.at(fileName+"-index")
+     << entity << "," << outFile.tellp() << "," << job.timeEnds.size()
+     << ",\n";
+    this->writeRows(job,entity+",",outFile);
+  }
+
+  void Log::writeRows(
+   const Column& job, const std::string& infix, std::ostream& outFile
+  ) const {
+    const bool isMeas = (job.kind==Log::KEY_MEAS);
+    const std::string_view times(job.timeChars);
+    const std::string_view strings(job.valueChars);
+    size_t timeStart = 0;
+    size_t stringStart = 0;
+    for(size_t i=0; i<job.timeEnds.size(); i++) {
+      outFile << times.substr(timeStart,job.timeEnds.at(i)-timeStart) << ","
+              << infix;
+      timeStart = job.timeEnds.at(i);
+      if(isMeas) {
+        if(job.tags.at(i)==Log::TAG_INT) {
+          outFile << std::to_string(job.bits.at(i));
+        } else if(job.tags.at(i)==Log::TAG_REAL) {
+          double value = 0.0;
+          std::memcpy(&value,&job.bits.at(i),sizeof(value));
+          outFile << std::to_string(value);
+        } else {
+          const size_t stringEnd = static_cast<size_t>(job.bits.at(i));
+          outFile << strings.substr(stringStart,stringEnd-stringStart);
+          stringStart = stringEnd;
+        }
+        outFile << ",";
+      }
+      outFile << "\n";
+    }
+  }
+
+  void Log::splitName(
+   const std::string& name, std::string& entity, std::string& kind
+  ) {
+    //// An entity prefix is a lowercase type, a dash, a numeric ID and a dash,
+    //// e.g. "sat-0449380000-" in "sat-0449380000-node-voltage"
+    size_t i = 0;
+    while(i<name.size() && name.at(i)>='a' && name.at(i)<='z') {
+      i++;
+    }
+    size_t j = i+1;
+    while(j<name.size() && name.at(j)>='0' && name.at(j)<='9') {
+      j++;
+    }
+    if(
+     i>0 && i<name.size() && name.at(i)=='-' && j>i+1 && j+1<name.size() &&
+     name.at(j)=='-'
+    ) {
+      entity = name.substr(0,j);
+      kind = name.substr(j+1);
+    } else {
+      entity = "";
+      kind = name;
+    }
+  }
+
+  void Log::writeBinary(const Column& job) {
+    std::string out;
+    if(!job.started) {
+      const uint32_t length = static_cast<uint32_t>(job.name.size());
+      out.push_back(static_cast<char>(Log::BLOCK_KEY));
+      out.append(reinterpret_cast<const char*>(&job.index),sizeof(job.index));
+      out.push_back(static_cast<char>(job.kind));
+      out.append(reinterpret_cast<const char*>(&length),sizeof(length));
+      out.append(job.name);
+    }
+    const size_t count = job.timeEnds.size();
+    std::string tags(count,'\0');
+    std::vector<int64_t> bits(count,0);
+    size_t timeStart = 0;
+    for(size_t i=0; i<count; i++) {
+      uint8_t tag = 0;
+      this->encodeBinary(
+       job.timeChars.substr(timeStart,job.timeEnds.at(i)-timeStart),
+       tag,bits.at(i),out
+      );
+      tags.at(i) = static_cast<char>(tag);
+      timeStart = job.timeEnds.at(i);
+    }
+    std::string valueTags(job.tags.size(),'\0');
+    std::vector<int64_t> valueBits(job.bits);
+    size_t stringStart = 0;
+    for(size_t i=0; i<job.tags.size(); i++) {
+      uint8_t tag = job.tags.at(i);
+      if(tag==Log::TAG_REAL) {
+        double value = 0.0;
+        std::memcpy(&value,&job.bits.at(i),sizeof(value));
+        if(Log::toFixed(value,valueBits.at(i))) {
+          tag = Log::TAG_FIXED;
+        }
+      } else if(tag==Log::TAG_STRING) {
+        const size_t stringEnd = static_cast<size_t>(job.bits.at(i));
+        this->encodeBinary(
+         job.valueChars.substr(stringStart,stringEnd-stringStart),
+         tag,valueBits.at(i),out
+        );
+        stringStart = stringEnd;
+      }
+      valueTags.at(i) = static_cast<char>(tag);
+    }
+    const uint32_t count32 = static_cast<uint32_t>(count);
+    out.push_back(static_cast<char>(Log::BLOCK_RECORDS));
+    out.append(reinterpret_cast<const char*>(&job.index),sizeof(job.index));
+    out.append(reinterpret_cast<const char*>(&count32),sizeof(count32));
+    out.push_back(static_cast<char>(Log::ENCODING_GORILLA));
+    Log::appendGorilla(tags,bits,out);
+    if(job.kind==Log::KEY_MEAS) {
+      Log::appendGorilla(valueTags,valueBits,out);
+    }
+    std::ofstream outFile(
+     this->dir+"log.bin",std::ios::app|std::ios::binary
+    );
+    outFile.write(out.data(),out.size());
     outFile.close();
   }
+
+  void Log::encodeBinary(
+   const std::string& text, uint8_t& tag, int64_t& bits, std::string& out
+  ) {
+    //// Only texts that format back to exactly themselves are stored as
+    //// numbers, so that conversion back to CSV reproduces the CSV format
+    const size_t digitsStart = (!text.empty() && text.at(0)=='-') ? 1 : 0;
+    const size_t pointIndex = text.find('.');
+    bool numeric = text.size()>digitsStart && text.size()<=32;
+    for(size_t i=digitsStart; numeric && i<text.size(); i++) {
+      numeric = (text.at(i)>='0' && text.at(i)<='9') || i==pointIndex;
+    }
+    if(
+     numeric && pointIndex==std::string::npos && text.size()-digitsStart<=18
+    ) {
+      const int64_t value = std::stoll(text);
+      if(std::to_string(value)==text) {
+        tag = Log::TAG_INT;
+        bits = value;
+        return;
+      }
+    } else if(numeric && pointIndex!=std::string::npos) {
+      const double value = std::strtod(text.c_str(),NULL);
+      if(std::to_string(value)==text) {
+        if(Log::toFixed(value,bits)) {
+          tag = Log::TAG_FIXED;
+        } else {
+          tag = Log::TAG_REAL;
+          std::memcpy(&bits,&value,sizeof(bits));
+        }
+        return;
+      }
+    }
+    if(this->binaryStringIDs.count(text)==0) {
+      const uint32_t stringID =
+       static_cast<uint32_t>(this->binaryStringIDs.size());
+      this->binaryStringIDs[text] = stringID;
+      const uint32_t length = static_cast<uint32_t>(text.size());
+      out.push_back(static_cast<char>(Log::BLOCK_STRING));
+      out.append(reinterpret_cast<const char*>(&stringID),sizeof(stringID));
+      out.append(reinterpret_cast<const char*>(&length),sizeof(length));
+      out.append(text);
+    }
+    tag = Log::TAG_STRING;
+    bits = static_cast<int64_t>(this->binaryStringIDs.at(text));
+  }
+
+  std::string Log::formatFixed(const int64_t& micros) {
+    const uint64_t magnitude = (micros<0) ?
+     0-static_cast<uint64_t>(micros) : static_cast<uint64_t>(micros);
+    std::string fraction = std::to_string(magnitude%1000000);
+    fraction.insert(0,6-fraction.size(),'0');
+    return
+     std::string(micros<0 ? "-" : "")+std::to_string(magnitude/1000000)+"."+
+     fraction;
+  }
+
+  bool Log::toFixed(const double& value, int64_t& micros) {
+    if(!(std::fabs(value)<9.0e12)) {
+      return false;
+    }
+    const int64_t candidate = std::llround(value*1.0e6);
+    if(Log::formatFixed(candidate)!=std::to_string(value)) {
+      return false;
+    }
+    micros = candidate;
+    return true;
+  }
+
+  void Log::appendGorilla(
+   const std::string& tags, const std::vector<int64_t>& bits, std::string& out
+  ) {
+    //// Doubles compress best by XOR; integers, fixed-point numbers and
+    //// string IDs by delta-of-delta
+    const bool deltaOfDelta =
+     tags.find(static_cast<char>(Log::TAG_REAL))==std::string::npos;
+    // Tag runs
+    std::vector<std::pair<uint32_t,uint8_t>> runs;
+    for(size_t i=0; i<tags.size(); i++) {
+      const uint8_t tag = static_cast<uint8_t>(tags.at(i));
+      if(runs.empty() || runs.back().second!=tag) {
+        runs.push_back(std::pair<uint32_t,uint8_t>(0,tag));
+      }
+      runs.back().first++;
+    }
+    const uint32_t runCount = static_cast<uint32_t>(runs.size());
+    out.append(reinterpret_cast<const char*>(&runCount),sizeof(runCount));
+    for(size_t i=0; i<runs.size(); i++) {
+      out.append(
+       reinterpret_cast<const char*>(&runs.at(i).first),sizeof(uint32_t)
+      );
+      out.push_back(static_cast<char>(runs.at(i).second));
+    }
+    out.push_back(static_cast<char>(deltaOfDelta ? 1 : 0));
+    // Bit stream; unsigned arithmetic wraps instead of overflowing
+    std::string stream;
+    size_t bitCount = 0;
+    uint64_t prevDelta = 0;
+    uint8_t prevLeading = 0;
+    uint8_t prevTrailing = 0;
+    bool prevWindow = false;
+    for(size_t i=0; i<bits.size(); i++) {
+      const uint64_t curr = static_cast<uint64_t>(bits.at(i));
+      if(i==0) {
+        Log::appendBits(curr,64,bitCount,stream);
+        continue;
+      }
+      const uint64_t prev = static_cast<uint64_t>(bits.at(i-1));
+      if(deltaOfDelta) {
+        const uint64_t delta = curr-prev;
+        const int64_t dod = static_cast<int64_t>(delta-prevDelta);
+        prevDelta = delta;
+        //// Bucket k: k ones, a zero unless k is the last bucket, then d in
+        //// GORILLA_WIDTHS[k] bits; the last bucket holds any d
+        uint8_t k = (dod==0) ? 0 : 1;
+        while(k>0 && k<Log::GORILLA_BUCKETS-1) {
+          const int64_t limit =
+           static_cast<int64_t>(1)<<(Log::GORILLA_WIDTHS[k]-1);
+          if(dod>=-limit && dod<limit) {
+            break;
+          }
+          k++;
+        }
+        Log::appendBits(~static_cast<uint64_t>(0),k,bitCount,stream);
+        if(k<Log::GORILLA_BUCKETS-1) {
+          Log::appendBits(0x0,1,bitCount,stream);
+        }
+        Log::appendBits(
+         static_cast<uint64_t>(dod),Log::GORILLA_WIDTHS[k],bitCount,stream
+        );
+      } else {
+        const uint64_t x = curr^prev;
+        if(x==0) {
+          Log::appendBits(0x0,1,bitCount,stream);
+          continue;
+        }
+        uint8_t leading = 0;
+        while(leading<31 && ((x>>(63-leading))&0x1)==0) {
+          leading++;
+        }
+        uint8_t trailing = 0;
+        while(((x>>trailing)&0x1)==0) {
+          trailing++;
+        }
+        if(prevWindow && leading>=prevLeading && trailing>=prevTrailing) {
+          Log::appendBits(0x2,2,bitCount,stream);
+          Log::appendBits(
+           x>>prevTrailing,64-prevLeading-prevTrailing,bitCount,stream
+          );
+        } else {
+          const uint8_t width = 64-leading-trailing;
+          Log::appendBits(0x3,2,bitCount,stream);
+          Log::appendBits(leading,5,bitCount,stream);
+          Log::appendBits(width&0x3f,6,bitCount,stream); // 64 is written as 0
+          Log::appendBits(x>>trailing,width,bitCount,stream);
+          prevLeading = leading;
+          prevTrailing = trailing;
+          prevWindow = true;
+        }
+      }
+    }
+    const uint32_t length = static_cast<uint32_t>(stream.size());
+    out.append(reinterpret_cast<const char*>(&length),sizeof(length));
+    out.append(stream);
+  }
+
+  void Log::appendBits(
+   const uint64_t& value, const uint8_t& width, size_t& bitCount,
+   std::string& stream
+  ) {
+    for(uint8_t i=width; i>0; i--) {
+      if(bitCount%8==0) {
+        stream.push_back('\0');
+      }
+      if((value>>(i-1))&0x1) {
+        stream.back() = static_cast<char>(
+         static_cast<uint8_t>(stream.back())|(0x80>>(bitCount%8))
+        );
+      }
+      bitCount++;
+    }
+  }
 }
@@ -8,6 +8,7 @@
 
 // Standard library
 #include <cstddef>      // size_t
+#include <fstream>      // ofstream
 #include <string>       // to_string
 
 // cote library
@@ -19,6 +20,10 @@ int main(int argc, char** argv) {
    {cote::LogLevel::INFO,cote::LogLevel::ERROR};
   cote::Log log(levels,"../test");
   std::string dateTime = "2019-06-18T11:17:";
+  const cote::Log::MeasHandle powerW = log.registerMeas("power-W");
+  const cote::Log::MeasHandle count = log.registerMeas("count");
+  const cote::Log::MeasHandle state = log.registerMeas("state");
+  const cote::Log::EvntHandle tock = log.registerEvnt("tock");
   for(size_t i=0; i<60; i++) {
     log.meas(
      cote::LogLevel::INFO, dateTime+std::to_string(i)+".0",
@@ -31,7 +36,131 @@ int main(int argc, char** argv) {
     log.evnt(
      cote::LogLevel::INFO, dateTime+std::to_string(i)+".0", "tick"
     );
+    // Handles take typed values, formatted when the logs are written
+    log.meas(
+     cote::LogLevel::INFO, dateTime+std::to_string(i)+".0",
+     powerW, 0.0048*static_cast<double>(i)
+    );
+    log.meas(cote::LogLevel::INFO, dateTime+std::to_string(i)+".0", count, i);
+    log.meas(
+     cote::LogLevel::INFO, dateTime+std::to_string(i)+".0",
+     state, (i%2==0) ? "IDLE" : "BUSY"
+    );
+    if(i%10==0) {
+      log.evnt(cote::LogLevel::INFO, dateTime+std::to_string(i)+".0", tock);
+    }
   }
+  // Macro arguments are only evaluated for logs that are kept
+  size_t evaluations = 0;
+  for(size_t i=0; i<60; i++) {
+    COTE_MEAS(
+     log, cote::LogLevel::TRACE, dateTime+std::to_string(i)+".0",
+     "lazy-current-A", std::to_string(0.0002*static_cast<double>(++evaluations))
+    );
+    COTE_MEAS(
+     log, cote::LogLevel::INFO, dateTime+std::to_string(i)+".0",
+     "lazy-voltage-V", std::to_string(0.0024*static_cast<double>(++evaluations))
+    );
+    COTE_EVNT(
+     log, cote::LogLevel::TRACE, dateTime+std::to_string(i)+".0", tock
+    );
+  }
+  log.meas(
+   cote::LogLevel::INFO, dateTime+"60.0", "lazy-evaluations",
+   std::to_string(evaluations)
+  );
   log.writeAll();
+  // The long format shares one file per kind among all entities
+  cote::Log longLog(levels,"../test",cote::Log::Format::LONG);
+  for(size_t i=0; i<60; i++) {
+    for(size_t j=0; j<3; j++) {
+      longLog.meas(
+       cote::LogLevel::INFO, dateTime+std::to_string(i)+".0",
+       "sat-000000000"+std::to_string(j)+"-voltage-V",
+       std::to_string(0.0024*static_cast<double>(i+j))
+      );
+    }
+    longLog.evnt(
+     cote::LogLevel::INFO, dateTime+std::to_string(i)+".0", "tick"
+    );
+  }
+  longLog.writeAll();
+  // Under a memory budget, the largest buffers are handed off early and the
+  // buffered bytes stay within the budget plus one log
+  cote::Log budgetLog(levels,"../test");
+  budgetLog.setMemoryBudget(4096);
+  const cote::Log::MeasHandle budgetVoltage =
+   budgetLog.registerMeas("budget-voltage-V");
+  const cote::Log::MeasHandle budgetState =
+   budgetLog.registerMeas("budget-state");
+  const cote::Log::EvntHandle budgetTick =
+   budgetLog.registerEvnt("budget-tick");
+  bool withinBudget = true;
+  for(size_t i=0; i<600; i++) {
+    const std::string time = dateTime+std::to_string(i/10)+"."+
+     std::to_string(i%10);
+    budgetLog.meas(
+     cote::LogLevel::INFO, time, budgetVoltage, 0.0024*static_cast<double>(i)
+    );
+    if(i%3==0) {
+      budgetLog.meas(
+       cote::LogLevel::INFO, time, budgetState, (i%2==0) ? "IDLE" : "BUSY"
+      );
+    }
+    if(i%5==0) {
+      budgetLog.evnt(cote::LogLevel::INFO, time, budgetTick);
+    }
+    withinBudget = withinBudget && budgetLog.getBufferedBytes()<=4096;
+  }
+  budgetLog.meas(
+   cote::LogLevel::INFO, dateTime+"60.0", "budget-peak-bytes",
+   std::to_string(budgetLog.getPeakBufferedBytes())
+  );
+  budgetLog.meas(
+   cote::LogLevel::INFO, dateTime+"60.0", "budget-respected",
+   std::to_string(withinBudget ? 1 : 0)
+  );
+  budgetLog.writeAll();
+  // Filter rules apply in order, also to names registered before them; here
+  // only every tenth filter-voltage-V log and the filter-tick and filter-tock
+  // events are kept
+  std::ofstream filterFile("../test/log-filter.dat");
+  filterFile << "action,pattern,every,\n"
+             << "include,filter-voltage-V,10,\n"
+             << "exclude,filter-current-*,\n"
+             << "include,filter-t?ck,\n"
+             << "exclude,filter-*,\n";
+  filterFile.close();
+  cote::Log filterLog(levels,"../test");
+  const cote::Log::MeasHandle filterPower =
+   filterLog.registerMeas("filter-power-W");
+  const bool filterRead = filterLog.readFilter("../test/log-filter.dat");
+  for(size_t i=0; i<60; i++) {
+    filterLog.meas(
+     cote::LogLevel::INFO, dateTime+std::to_string(i)+".0",
+     "filter-voltage-V", std::to_string(0.0024*static_cast<double>(i))
+    );
+    filterLog.meas(
+     cote::LogLevel::INFO, dateTime+std::to_string(i)+".0",
+     "filter-current-A", std::to_string(0.0002*static_cast<double>(i))
+    );
+    filterLog.meas(
+     cote::LogLevel::INFO, dateTime+std::to_string(i)+".0",
+     filterPower, 0.0048*static_cast<double>(i)
+    );
+    filterLog.evnt(
+     cote::LogLevel::INFO, dateTime+std::to_string(i)+".0", "filter-tick"
+    );
+    if(i%10==0) {
+      filterLog.evnt(
+       cote::LogLevel::INFO, dateTime+std::to_string(i)+".0", "filter-tock"
+      );
+    }
+  }
+  filterLog.meas(
+   cote::LogLevel::INFO, dateTime+"60.0", "read-filter",
+   std::to_string(filterRead ? 1 : 0)
+  );
+  filterLog.writeAll();
   return 0;
 }
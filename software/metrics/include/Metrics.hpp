@@ -0,0 +1,125 @@
+// Metrics.hpp
+// Metrics class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_METRICS_HPP
+#define COTE_METRICS_HPP
+
+// Standard library
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint32_t, uint64_t
+#include <map>     // map
+#include <string>  // string
+#include <vector>  // vector
+
+// cote library
+#include <Log.hpp> // Log
+
+namespace cote {
+  class Metrics {
+  public:
+    // Maintains statistics of streams of samples as they are produced, so
+    // that a run can report them without writing or re-reading raw logs
+    struct MetricHandle {
+      uint32_t index;
+    };
+    Metrics(const uint32_t& id=0, Log* const log=NULL);
+    Metrics(const Metrics& metrics);
+    Metrics(Metrics&& metrics);
+    virtual ~Metrics();
+    virtual Metrics& operator=(const Metrics& metrics);
+    virtual Metrics& operator=(Metrics&& metrics);
+    virtual Metrics* clone() const;
+    // Metric declarations; the name identifies the metric in the summary
+    // file. Declare every metric before recording, after which distinct
+    // metrics may be recorded from distinct threads.
+    //// Count, minimum, maximum, mean, and standard deviation of the samples
+    MetricHandle addSummary(const std::string& name);
+    //// Sample counts in binCount (at least one) equal bins over
+    //// [lower,upper), plus the counts below and at or above the range
+    MetricHandle addHistogram(
+     const std::string& name, const double& lower, const double& upper,
+     const std::size_t& binCount
+    );
+    //// Approximate quantiles (e.g. 0.5, 0.99) from a merging t-digest; a
+    //// larger compression keeps more centroids and is more accurate
+    MetricHandle addQuantiles(
+     const std::string& name, const std::vector<double>& quantiles,
+     const double& compression=100.0
+    );
+    //// Sums of amounts by label, e.g. the steps spent in each state
+    MetricHandle addTotals(const std::string& name);
+    //// A single value that each set replaces, e.g. a peak reported at the
+    //// end of a run; the summary file holds only the value
+    MetricHandle addValue(const std::string& name);
+    // Recording; the summary statistics are kept for every kind of metric
+    void record(const MetricHandle& metric, const double& value);
+    void add(
+     const MetricHandle& metric, const std::string& label, const double& amount
+    );
+    void set(const MetricHandle& metric, const double& value);
+    // Queries
+    std::size_t getMetricCount() const;
+    std::string getName(const MetricHandle& metric) const;
+    uint64_t getCount(const MetricHandle& metric) const;
+    double getMin(const MetricHandle& metric) const;
+    double getMax(const MetricHandle& metric) const;
+    double getMean(const MetricHandle& metric) const;
+    //// Population standard deviation
+    double getStdDev(const MetricHandle& metric) const;
+    //// Index 0 counts samples below the range and the last index counts
+    //// samples at or above it
+    std::vector<uint64_t> getBinCounts(const MetricHandle& metric) const;
+    double getQuantile(const MetricHandle& metric, const double& quantile)
+     const;
+    std::map<std::string,double> getTotals(const MetricHandle& metric) const;
+    double getValue(const MetricHandle& metric) const;
+    // Writes one "metric,statistic,value," row per statistic of each metric
+    // in declaration order; returns false if the file cannot be written
+    bool writeSummary(const std::string& filePath) const;
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    enum class Kind : uint8_t {SUMMARY, HISTOGRAM, QUANTILES, TOTALS, VALUE};
+    struct Centroid {
+      double mean;
+      double weight;
+    };
+    struct Metric {
+      Kind kind;
+      std::string name;
+      // Summary statistics, updated with Welford's method
+      uint64_t count;
+      double min;
+      double max;
+      double mean;
+      double m2;    // sum of squared differences from the mean
+      // Histogram bins
+      double lower;
+      double upper;
+      std::vector<uint64_t> bins;
+      // t-digest: merged centroids sorted by mean, and samples not yet merged
+      std::vector<double> quantiles;
+      double compression;
+      std::vector<Centroid> centroids;
+      std::vector<Centroid> unmerged;
+      // Totals
+      std::map<std::string,double> totals;
+      // Value
+      double value;
+    };
+    MetricHandle addMetric(const Kind& kind, const std::string& name);
+    //// Merges the unmerged samples into the centroids
+    static void compress(Metric& metric);
+    static double quantileOf(const Metric& metric, const double& quantile);
+    std::vector<Metric> metrics; // indexed by MetricHandle
+    uint32_t id;                 // identification number
+    Log* log;                    // singleton, should not be deleted
+  };
+}
+
+#endif
@@ -0,0 +1,367 @@
+// Metrics.cpp
+// Metrics class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>     // max, min, stable_sort
+#include <cmath>         // asin, floor, sqrt
+#include <cstddef>       // size_t
+#include <cstdint>       // uint32_t, uint64_t
+#include <fstream>       // ofstream
+#include <limits>        // numeric_limits
+#include <map>           // map
+#include <sstream>       // ostringstream
+#include <string>        // string, to_string
+#include <utility>       // move
+#include <vector>        // vector
+
+// cote library
+#include <constants.hpp> // PI
+#include <Log.hpp>       // Log
+#include <Metrics.hpp>   // Metrics
+
+namespace cote {
+  Metrics::Metrics(const uint32_t& id, Log* const log) : id(id), log(log) {}
+
+  Metrics::Metrics(const Metrics& metrics) :
+   metrics(metrics.metrics), id(metrics.getID()), log(metrics.getLog()) {}
+
+  Metrics::Metrics(Metrics&& metrics) :
+   metrics(std::move(metrics.metrics)), id(metrics.id), log(metrics.log) {
+    metrics.log = NULL;
+  }
+
+  Metrics::~Metrics() {
+    this->log = NULL;
+  }
+
+  Metrics& Metrics::operator=(const Metrics& metrics) {
+    Metrics temp(metrics);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  Metrics& Metrics::operator=(Metrics&& metrics) {
+    this->metrics = std::move(metrics.metrics);
+    this->id      = metrics.id;
+    this->log     = metrics.log;
+    metrics.log   = NULL;
+    return *this;
+  }
+
+  Metrics* Metrics::clone() const {
+    return new Metrics(*this);
+  }
+
+  Metrics::MetricHandle Metrics::addSummary(const std::string& name) {
+    return this->addMetric(Kind::SUMMARY,name);
+  }
+
+  Metrics::MetricHandle Metrics::addHistogram(
+   const std::string& name, const double& lower, const double& upper,
+   const std::size_t& binCount
+  ) {
+    const MetricHandle handle = this->addMetric(Kind::HISTOGRAM,name);
+    Metric& metric = this->metrics.at(handle.index);
+    metric.lower = lower;
+    metric.upper = upper;
+    metric.bins.assign(std::max(binCount,static_cast<std::size_t>(1))+2,0);
+    return handle;
+  }
+
+  Metrics::MetricHandle Metrics::addQuantiles(
+   const std::string& name, const std::vector<double>& quantiles,
+   const double& compression
+  ) {
+    const MetricHandle handle = this->addMetric(Kind::QUANTILES,name);
+    Metric& metric = this->metrics.at(handle.index);
+    metric.quantiles = quantiles;
+    metric.compression = std::max(compression,1.0);
+    return handle;
+  }
+
+  Metrics::MetricHandle Metrics::addTotals(const std::string& name) {
+    return this->addMetric(Kind::TOTALS,name);
+  }
+
+  Metrics::MetricHandle Metrics::addValue(const std::string& name) {
+    return this->addMetric(Kind::VALUE,name);
+  }
+
+  void Metrics::record(const MetricHandle& metric, const double& value) {
+    Metric& m = this->metrics.at(metric.index);
+    m.count += 1;
+    m.min = std::min(m.min,value);
+    m.max = std::max(m.max,value);
+    const double delta = value-m.mean;
+    m.mean += delta/static_cast<double>(m.count);
+    m.m2 += delta*(value-m.mean);
+    if(m.kind==Kind::HISTOGRAM) {
+      const std::size_t binCount = m.bins.size()-2;
+      if(value<m.lower) {
+        m.bins.front() += 1;
+      } else if(value>=m.upper) {
+        m.bins.back() += 1;
+      } else {
+        const std::size_t bin = static_cast<std::size_t>(std::floor(
+         (value-m.lower)/(m.upper-m.lower)*static_cast<double>(binCount)
+        ));
+        m.bins.at(1+std::min(bin,binCount-1)) += 1;
+      }
+    } else if(m.kind==Kind::QUANTILES) {
+      m.unmerged.push_back({value,1.0});
+      //// Buffering amortizes the sort in compress over many samples
+      if(
+       m.unmerged.size()>=static_cast<std::size_t>(5.0*m.compression)
+      ) {
+        compress(m);
+      }
+    }
+  }
+
+  void Metrics::add(
+   const MetricHandle& metric, const std::string& label, const double& amount
+  ) {
+    Metric& m = this->metrics.at(metric.index);
+    this->record(metric,amount);
+    m.totals[label] += amount;
+  }
+
+  void Metrics::set(const MetricHandle& metric, const double& value) {
+    Metric& m = this->metrics.at(metric.index);
+    m.count = 1;
+    m.value = value;
+  }
+
+  std::size_t Metrics::getMetricCount() const {
+    return this->metrics.size();
+  }
+
+  std::string Metrics::getName(const MetricHandle& metric) const {
+    return this->metrics.at(metric.index).name;
+  }
+
+  uint64_t Metrics::getCount(const MetricHandle& metric) const {
+    return this->metrics.at(metric.index).count;
+  }
+
+  double Metrics::getMin(const MetricHandle& metric) const {
+    const Metric& m = this->metrics.at(metric.index);
+    return (m.count==0) ? std::numeric_limits<double>::quiet_NaN() : m.min;
+  }
+
+  double Metrics::getMax(const MetricHandle& metric) const {
+    const Metric& m = this->metrics.at(metric.index);
+    return (m.count==0) ? std::numeric_limits<double>::quiet_NaN() : m.max;
+  }
+
+  double Metrics::getMean(const MetricHandle& metric) const {
+    const Metric& m = this->metrics.at(metric.index);
+    return (m.count==0) ? std::numeric_limits<double>::quiet_NaN() : m.mean;
+  }
+
+  double Metrics::getStdDev(const MetricHandle& metric) const {
+    const Metric& m = this->metrics.at(metric.index);
+    return (m.count==0) ? std::numeric_limits<double>::quiet_NaN() :
+     std::sqrt(m.m2/static_cast<double>(m.count));
+  }
+
+  std::vector<uint64_t> Metrics::getBinCounts(const MetricHandle& metric)
+   const {
+    return this->metrics.at(metric.index).bins;
+  }
+
+  double Metrics::getQuantile(
+   const MetricHandle& metric, const double& quantile
+  ) const {
+    const Metric& m = this->metrics.at(metric.index);
+    if(m.unmerged.empty()) {
+      return quantileOf(m,quantile);
+    }
+    Metric merged = m;
+    compress(merged);
+    return quantileOf(merged,quantile);
+  }
+
+  std::map<std::string,double> Metrics::getTotals(const MetricHandle& metric)
+   const {
+    return this->metrics.at(metric.index).totals;
+  }
+
+  double Metrics::getValue(const MetricHandle& metric) const {
+    const Metric& m = this->metrics.at(metric.index);
+    return (m.count==0) ? std::numeric_limits<double>::quiet_NaN() : m.value;
+  }
+
+  bool Metrics::writeSummary(const std::string& filePath) const {
+    std::ofstream outFile(filePath);
+    if(!outFile) {
+      return false;
+    }
+    outFile << "metric,statistic,value," << '\n';
+    for(MetricHandle h={0}; h.index<this->metrics.size(); h.index++) {
+      const Metric& m = this->metrics.at(h.index);
+      const std::string prefix = m.name+",";
+      if(m.kind==Kind::VALUE) {
+        if(m.count!=0) {
+          outFile << prefix << "value," << std::to_string(m.value) << ","
+                  << '\n';
+        }
+        continue;
+      }
+      outFile << prefix << "count," << m.count << "," << '\n';
+      if(m.count!=0) {
+        outFile << prefix << "min," << std::to_string(m.min) << "," << '\n';
+        outFile << prefix << "max," << std::to_string(m.max) << "," << '\n';
+        outFile << prefix << "mean," << std::to_string(m.mean) << ","
+                << '\n';
+        outFile << prefix << "stddev," << std::to_string(this->getStdDev(h))
+                << "," << '\n';
+      }
+      if(m.kind==Kind::HISTOGRAM) {
+        const std::size_t binCount = m.bins.size()-2;
+        const double width =
+         (m.upper-m.lower)/static_cast<double>(binCount);
+        outFile << prefix << "below-" << std::to_string(m.lower) << ","
+                << m.bins.front() << "," << '\n';
+        for(std::size_t i=0; i<binCount; i++) {
+          outFile << prefix << "bin-"
+                  << std::to_string(m.lower+width*static_cast<double>(i))
+                  << "," << m.bins.at(1+i) << "," << '\n';
+        }
+        outFile << prefix << "above-" << std::to_string(m.upper) << ","
+                << m.bins.back() << "," << '\n';
+      } else if(m.kind==Kind::QUANTILES && m.count!=0) {
+        for(std::size_t i=0; i<m.quantiles.size(); i++) {
+          std::ostringstream label;
+          label << "p" << 100.0*m.quantiles.at(i);
+          outFile << prefix << label.str() << ","
+                  << std::to_string(this->getQuantile(h,m.quantiles.at(i)))
+                  << "," << '\n';
+        }
+      } else if(m.kind==Kind::TOTALS) {
+        for(
+         std::map<std::string,double>::const_iterator it = m.totals.begin();
+         it!=m.totals.end(); it++
+        ) {
+          outFile << prefix << "total-" << it->first << ","
+                  << std::to_string(it->second) << "," << '\n';
+        }
+      }
+    }
+    outFile.close();
+    return !outFile.fail();
+  }
+
+  uint32_t Metrics::getID() const {
+    return this->id;
+  }
+
+  Log* Metrics::getLog() const {
+    return this->log;
+  }
+
+  Metrics::MetricHandle Metrics::addMetric(
+   const Kind& kind, const std::string& name
+  ) {
+    Metric metric;
+    metric.kind = kind;
+    metric.name = name;
+    metric.count = 0;
+    metric.min = std::numeric_limits<double>::infinity();
+    metric.max = -std::numeric_limits<double>::infinity();
+    metric.mean = 0.0;
+    metric.m2 = 0.0;
+    metric.lower = 0.0;
+    metric.upper = 0.0;
+    metric.compression = 0.0;
+    metric.value = 0.0;
+    this->metrics.push_back(metric);
+    return {static_cast<uint32_t>(this->metrics.size()-1)};
+  }
+
+  void Metrics::compress(Metric& metric) {
+    if(metric.unmerged.empty()) {
+      return;
+    }
+    std::vector<Centroid> sorted(metric.centroids);
+    sorted.insert(
+     sorted.end(),metric.unmerged.begin(),metric.unmerged.end()
+    );
+    std::stable_sort(
+     sorted.begin(), sorted.end(),
+     [](const Centroid& c1, const Centroid& c2) {
+      return c1.mean<c2.mean;
+     }
+    );
+    double totalWeight = 0.0;
+    for(std::size_t i=0; i<sorted.size(); i++) {
+      totalWeight += sorted.at(i).weight;
+    }
+    // Scale function k(q) = compression/(2 pi) asin(2q-1); a centroid may
+    // grow while it spans at most one unit of k, which keeps the centroids
+    // near the tails small and the extreme quantiles accurate
+    const double normalizer = metric.compression/(2.0*cnst::PI);
+    std::vector<Centroid> merged;
+    Centroid current = sorted.front();
+    double weightSoFar = 0.0;
+    double kLeft = normalizer*std::asin(-1.0);
+    for(std::size_t i=1; i<sorted.size(); i++) {
+      const Centroid& next = sorted.at(i);
+      const double q = std::min(
+       (weightSoFar+current.weight+next.weight)/totalWeight,1.0
+      );
+      if(normalizer*std::asin(2.0*q-1.0)-kLeft<=1.0) {
+        current.weight += next.weight;
+        current.mean += (next.mean-current.mean)*next.weight/current.weight;
+      } else {
+        weightSoFar += current.weight;
+        merged.push_back(current);
+        kLeft = normalizer*std::asin(
+         std::min(2.0*weightSoFar/totalWeight-1.0,1.0)
+        );
+        current = next;
+      }
+    }
+    merged.push_back(current);
+    metric.centroids = std::move(merged);
+    metric.unmerged.clear();
+  }
+
+  double Metrics::quantileOf(const Metric& metric, const double& quantile) {
+    const std::vector<Centroid>& centroids = metric.centroids;
+    if(centroids.empty()) {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    double totalWeight = 0.0;
+    for(std::size_t i=0; i<centroids.size(); i++) {
+      totalWeight += centroids.at(i).weight;
+    }
+    // Interpolate linearly between centroid centers, and between the extreme
+    // centroids and the exact minimum and maximum
+    const double index =
+     std::max(0.0,std::min(quantile,1.0))*totalWeight;
+    double center = centroids.front().weight/2.0;
+    if(index<=center) {
+      return metric.min+
+       (centroids.front().mean-metric.min)*((center>0.0)?index/center:0.0);
+    }
+    for(std::size_t i=0; i+1<centroids.size(); i++) {
+      const double nextCenter = center+
+       (centroids.at(i).weight+centroids.at(i+1).weight)/2.0;
+      if(index<=nextCenter) {
+        return centroids.at(i).mean+
+         (centroids.at(i+1).mean-centroids.at(i).mean)*
+         (index-center)/(nextCenter-center);
+      }
+      center = nextCenter;
+    }
+    const double tail = totalWeight-center;
+    return centroids.back().mean+(metric.max-centroids.back().mean)*
+     ((tail>0.0)?(index-center)/tail:0.0);
+  }
+}
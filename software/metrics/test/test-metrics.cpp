@@ -0,0 +1,125 @@
+// test-metrics.cpp
+// Metrics class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>    // lower_bound, sort
+#include <cmath>        // fabs, sqrt
+#include <cstddef>      // size_t
+#include <cstdint>      // uint64_t
+#include <cstdlib>      // exit, EXIT_SUCCESS
+#include <map>          // map
+#include <random>       // mt19937_64, normal_distribution
+#include <string>       // string, to_string
+#include <vector>       // vector
+
+// satsim
+#include <Log.hpp>      // Log
+#include <LogLevel.hpp> // LogLevel
+#include <Metrics.hpp>  // Metrics
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  cote::Metrics metrics(0,&log);
+  const cote::Metrics::MetricHandle VOLTAGE = metrics.addSummary("voltage");
+  const cote::Metrics::MetricHandle TILES =
+   metrics.addHistogram("tile-count",0.0,200.0,10);
+  const std::vector<double> quantiles = {0.01,0.5,0.9,0.99};
+  const cote::Metrics::MetricHandle MBPS =
+   metrics.addQuantiles("downlink-Mbps",quantiles);
+  const cote::Metrics::MetricHandle STATES = metrics.addTotals("state");
+  const cote::Metrics::MetricHandle PEAK = metrics.addValue("peak-voltage");
+  // Record a stream of samples and keep them for exact reference values
+  std::mt19937_64 generator(0);
+  std::normal_distribution<double> normal(5.0,0.5);
+  std::vector<double> samples;
+  for(std::size_t i=0; i<100000; i++) {
+    const double sample = normal(generator);
+    samples.push_back(sample);
+    metrics.record(VOLTAGE,sample);
+    metrics.record(MBPS,sample);
+    metrics.record(TILES,20.0*sample);
+    metrics.add(STATES,(sample<5.0) ? "LOW" : "HIGH",1.0);
+  }
+  double sum = 0.0;
+  for(std::size_t i=0; i<samples.size(); i++) {
+    sum += samples.at(i);
+  }
+  const double mean = sum/static_cast<double>(samples.size());
+  double sumSquares = 0.0;
+  for(std::size_t i=0; i<samples.size(); i++) {
+    sumSquares += (samples.at(i)-mean)*(samples.at(i)-mean);
+  }
+  const double stdDev =
+   std::sqrt(sumSquares/static_cast<double>(samples.size()));
+  log.meas(
+   cote::LogLevel::INFO, "0", "mean-matches",
+   std::to_string(std::fabs(metrics.getMean(VOLTAGE)-mean)<1.0e-9)
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "stddev-matches",
+   std::to_string(std::fabs(metrics.getStdDev(VOLTAGE)-stdDev)<1.0e-9)
+  );
+  // The rank of each quantile estimate should be close to the quantile
+  std::sort(samples.begin(),samples.end());
+  for(std::size_t i=0; i<quantiles.size(); i++) {
+    const double exact = samples.at(
+     static_cast<std::size_t>(quantiles.at(i)*(samples.size()-1))
+    );
+    const double estimate = metrics.getQuantile(MBPS,quantiles.at(i));
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(quantiles.at(i)), "quantile-error",
+     std::to_string(estimate-exact)
+    );
+    const double rank = static_cast<double>(
+     std::lower_bound(samples.begin(),samples.end(),estimate)-samples.begin()
+    )/static_cast<double>(samples.size());
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(quantiles.at(i)), "quantile-ok",
+     std::to_string(std::fabs(rank-quantiles.at(i))<0.001)
+    );
+  }
+  // Every sample lands in one bin
+  const std::vector<uint64_t> binCounts = metrics.getBinCounts(TILES);
+  uint64_t binSum = 0;
+  for(std::size_t i=0; i<binCounts.size(); i++) {
+    binSum += binCounts.at(i);
+  }
+  log.meas(
+   cote::LogLevel::INFO, "0", "bin-sum-matches",
+   std::to_string(binSum==samples.size())
+  );
+  const std::map<std::string,double> totals = metrics.getTotals(STATES);
+  log.meas(
+   cote::LogLevel::INFO, "0", "totals-sum-matches",
+   std::to_string(totals.at("LOW")+totals.at("HIGH")==samples.size())
+  );
+  // A value keeps only the latest set
+  metrics.set(PEAK,0.0);
+  metrics.set(PEAK,metrics.getMax(VOLTAGE));
+  log.meas(
+   cote::LogLevel::INFO, "0", "value-matches",
+   std::to_string(metrics.getValue(PEAK)==metrics.getMax(VOLTAGE))
+  );
+  // A copy continues from the same statistics
+  cote::Metrics copy(metrics);
+  copy.record(VOLTAGE,100.0);
+  log.meas(
+   cote::LogLevel::INFO, "0", "copy-independent",
+   std::to_string(
+    copy.getMax(VOLTAGE)==100.0 && metrics.getMax(VOLTAGE)<100.0
+   )
+  );
+  // Write out the summary and logs
+  log.meas(
+   cote::LogLevel::INFO, "0", "summary-written",
+   std::to_string(metrics.writeSummary("../test/summary.csv"))
+  );
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,109 @@
+// PowerBus.hpp
+// PowerBus class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_POWER_BUS_HPP
+#define COTE_POWER_BUS_HPP
+
+// Standard library
+#include <cstddef>        // size_t
+#include <cstdint>        // uint8_t, uint32_t
+#include <vector>         // vector
+
+// cote
+#include <Capacitor.hpp>  // Capacitor
+#include <Log.hpp>        // Log
+#include <SolarArray.hpp> // SolarArray
+
+namespace cote {
+  class PowerBus {
+  public:
+    // Each node is the energy-harvesting system of one satellite; nodes are
+    // addressed by the dense index returned from addNode
+    PowerBus(const uint32_t& id=0, Log* const log=NULL);
+    PowerBus(const PowerBus& powerBus);
+    PowerBus(PowerBus&& powerBus);
+    virtual ~PowerBus();
+    virtual PowerBus& operator=(const PowerBus& powerBus);
+    virtual PowerBus& operator=(PowerBus&& powerBus);
+    virtual PowerBus* clone() const;
+    // Copies the parameters and present state of the capacitor and solar array
+    // into a new node and returns the index of the node
+    std::size_t addNode(
+     const Capacitor& capacitor, const SolarArray& solarArray
+    );
+    std::size_t getNodeCount() const;
+    uint32_t getNodeID(const std::size_t& index) const;
+    double getCapacitanceFarad(const std::size_t& index) const;
+    double getEsrOhm(const std::size_t& index) const;
+    double getChargeCoulomb(const std::size_t& index) const;
+    void setChargeCoulomb(
+     const std::size_t& index, const double& chargeCoulomb
+    );
+    double getOpenCircuitVoltage(const std::size_t& index) const;
+    double getSolarCurrentAmpere(const std::size_t& index) const;
+    void setSolarCurrentAmpere(
+     const std::size_t& index, const double& currentAmpere
+    );
+    // Sets the solar array current as SolarArray::setIrradianceWpM2 does
+    void setIrradianceWpM2(
+     const std::size_t& index, const double& irradianceWpM2
+    );
+    double getLoadPowerW(const std::size_t& index) const;
+    void setLoadPowerW(const std::size_t& index, const double& loadPowerW);
+    double getNodeVoltage(const std::size_t& index) const;
+    // True if the node voltage discriminant was negative at the most recent
+    // node voltage update, i.e. the loads draw more power than the node can
+    // supply; a node in brownout is given the voltage of a zero discriminant,
+    // i.e. half the sum of its capacitor and solar array voltage terms, by
+    // both node voltage updates
+    bool isBrownout(const std::size_t& index) const;
+    // The following operate on all nodes in one pass
+    //// Zeroes out the solar array current of nodes whose most recent node
+    //// voltage is at or above the open circuit voltage
+    void clipSolarCurrent();
+    //// Integrates the capacitor charge over durationS with the most recent
+    //// node voltage and the present loads; charge does not go below zero
+    void updateCharge(const double& durationS);
+    //// Recomputes the node voltage of every node and returns the number of
+    //// nodes in brownout
+    std::size_t updateNodeVoltage();
+    // Recomputes the node voltage of a single node, e.g. after shedding load
+    bool updateNodeVoltage(const std::size_t& index);
+    // The following use the closed form of PowerSubsystem, which clips the
+    // solar array itself, so the solar array current should be set from the
+    // irradiance (i.e. not clipped) beforehand
+    //// Advances the capacitor charge of every node by durationS seconds with
+    //// constant loads and solar current; a node that browns out stops there
+    void advance(const double& durationS);
+    //// Returns the time in seconds until the node reaches one of the given
+    //// node voltages, the solar array is clipped or unclipped, or a brownout
+    //// occurs; infinity if none will occur
+    double calcTimeToNextEvent(
+     const std::size_t& index, const std::vector<double>& thresholds
+    ) const;
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    // Node parameters and state; element i of each vector belongs to node i
+    std::vector<uint32_t> nodeIDs;          // satellite identifiers
+    std::vector<double> capacitanceFarad;   // capacitance in Farad
+    std::vector<double> esrOhm;             // equivalent series resistance
+    std::vector<double> chargeCoulomb;      // capacitor charge in Coulomb
+    std::vector<double> openCircuitVoltage; // solar array Voc in Volt
+    std::vector<double> surfaceAreaM2;      // solar array surface area
+    std::vector<double> efficiency;         // solar array efficiency
+    std::vector<double> solarCurrentAmpere; // solar array current in Ampere
+    std::vector<double> loadPowerW;         // summed load power in Watt
+    std::vector<double> nodeVoltage;        // most recent node voltage
+    std::vector<uint8_t> brownout;          // 1 if discriminant was negative
+    uint32_t id;                            // identification number
+    Log* log;                               // singleton, should not be deleted
+  };
+}
+
+#endif
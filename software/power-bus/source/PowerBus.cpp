@@ -0,0 +1,275 @@
+// PowerBus.cpp
+// PowerBus class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+//
+// The node parameters and state are stored as one contiguous array per
+// quantity so that the whole-constellation passes are simple loops over
+// doubles with no branches, which compilers can vectorize. The closed-form
+// updates instead advance each node through a PowerSubsystem over scratch
+// copies of its capacitor and solar array.
+
+// Standard library
+#include <cmath>              // sqrt
+#include <cstddef>            // size_t
+#include <cstdint>            // uint8_t, uint32_t
+#include <utility>            // move
+#include <vector>             // vector
+
+// cote
+#include <Capacitor.hpp>      // Capacitor
+#include <Log.hpp>            // Log
+#include <PowerBus.hpp>       // PowerBus
+#include <PowerSubsystem.hpp> // PowerSubsystem
+#include <SolarArray.hpp>     // SolarArray
+#include <utilities.hpp>      // calcNodeVoltageDiscriminant, calcNodeVoltage
+
+namespace cote {
+  PowerBus::PowerBus(const uint32_t& id, Log* const log) : id(id), log(log) {}
+
+  PowerBus::PowerBus(const PowerBus& powerBus) :
+   nodeIDs(powerBus.nodeIDs), capacitanceFarad(powerBus.capacitanceFarad),
+   esrOhm(powerBus.esrOhm), chargeCoulomb(powerBus.chargeCoulomb),
+   openCircuitVoltage(powerBus.openCircuitVoltage),
+   surfaceAreaM2(powerBus.surfaceAreaM2), efficiency(powerBus.efficiency),
+   solarCurrentAmpere(powerBus.solarCurrentAmpere),
+   loadPowerW(powerBus.loadPowerW), nodeVoltage(powerBus.nodeVoltage),
+   brownout(powerBus.brownout), id(powerBus.getID()), log(powerBus.getLog()) {}
+
+  PowerBus::PowerBus(PowerBus&& powerBus) :
+   nodeIDs(std::move(powerBus.nodeIDs)),
+   capacitanceFarad(std::move(powerBus.capacitanceFarad)),
+   esrOhm(std::move(powerBus.esrOhm)),
+   chargeCoulomb(std::move(powerBus.chargeCoulomb)),
+   openCircuitVoltage(std::move(powerBus.openCircuitVoltage)),
+   surfaceAreaM2(std::move(powerBus.surfaceAreaM2)),
+   efficiency(std::move(powerBus.efficiency)),
+   solarCurrentAmpere(std::move(powerBus.solarCurrentAmpere)),
+   loadPowerW(std::move(powerBus.loadPowerW)),
+   nodeVoltage(std::move(powerBus.nodeVoltage)),
+   brownout(std::move(powerBus.brownout)), id(powerBus.id),
+   log(powerBus.log) {
+    powerBus.log = NULL;
+  }
+
+  PowerBus::~PowerBus() {
+    this->log = NULL;
+  }
+
+  PowerBus& PowerBus::operator=(const PowerBus& powerBus) {
+    PowerBus temp(powerBus);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  PowerBus& PowerBus::operator=(PowerBus&& powerBus) {
+    this->nodeIDs            = std::move(powerBus.nodeIDs);
+    this->capacitanceFarad   = std::move(powerBus.capacitanceFarad);
+    this->esrOhm             = std::move(powerBus.esrOhm);
+    this->chargeCoulomb      = std::move(powerBus.chargeCoulomb);
+    this->openCircuitVoltage = std::move(powerBus.openCircuitVoltage);
+    this->surfaceAreaM2      = std::move(powerBus.surfaceAreaM2);
+    this->efficiency         = std::move(powerBus.efficiency);
+    this->solarCurrentAmpere = std::move(powerBus.solarCurrentAmpere);
+    this->loadPowerW         = std::move(powerBus.loadPowerW);
+    this->nodeVoltage        = std::move(powerBus.nodeVoltage);
+    this->brownout           = std::move(powerBus.brownout);
+    this->id                 = powerBus.id;
+    this->log                = powerBus.log;
+    powerBus.log             = NULL;
+    return *this;
+  }
+
+  PowerBus* PowerBus::clone() const {
+    return new PowerBus(*this);
+  }
+
+  std::size_t PowerBus::addNode(
+   const Capacitor& capacitor, const SolarArray& solarArray
+  ) {
+    this->nodeIDs.push_back(capacitor.getID());
+    this->capacitanceFarad.push_back(capacitor.getCapacitanceFarad());
+    this->esrOhm.push_back(capacitor.getEsrOhm());
+    this->chargeCoulomb.push_back(capacitor.getChargeCoulomb());
+    this->openCircuitVoltage.push_back(solarArray.getOpenCircuitVoltage());
+    this->surfaceAreaM2.push_back(solarArray.getSurfaceAreaM2());
+    this->efficiency.push_back(solarArray.getEfficiency());
+    this->solarCurrentAmpere.push_back(solarArray.getCurrentAmpere());
+    this->loadPowerW.push_back(0.0);
+    this->nodeVoltage.push_back(0.0);
+    this->brownout.push_back(0);
+    return this->nodeIDs.size()-1;
+  }
+
+  std::size_t PowerBus::getNodeCount() const {
+    return this->nodeIDs.size();
+  }
+
+  uint32_t PowerBus::getNodeID(const std::size_t& index) const {
+    return this->nodeIDs.at(index);
+  }
+
+  double PowerBus::getCapacitanceFarad(const std::size_t& index) const {
+    return this->capacitanceFarad.at(index);
+  }
+
+  double PowerBus::getEsrOhm(const std::size_t& index) const {
+    return this->esrOhm.at(index);
+  }
+
+  double PowerBus::getChargeCoulomb(const std::size_t& index) const {
+    return this->chargeCoulomb.at(index);
+  }
+
+  void PowerBus::setChargeCoulomb(
+   const std::size_t& index, const double& chargeCoulomb
+  ) {
+    this->chargeCoulomb.at(index) = chargeCoulomb;
+  }
+
+  double PowerBus::getOpenCircuitVoltage(const std::size_t& index) const {
+    return this->openCircuitVoltage.at(index);
+  }
+
+  double PowerBus::getSolarCurrentAmpere(const std::size_t& index) const {
+    return this->solarCurrentAmpere.at(index);
+  }
+
+  void PowerBus::setSolarCurrentAmpere(
+   const std::size_t& index, const double& currentAmpere
+  ) {
+    this->solarCurrentAmpere.at(index) = currentAmpere;
+  }
+
+  void PowerBus::setIrradianceWpM2(
+   const std::size_t& index, const double& irradianceWpM2
+  ) {
+    this->solarCurrentAmpere.at(index) =
+     (irradianceWpM2*this->surfaceAreaM2.at(index)*this->efficiency.at(index))/
+     this->openCircuitVoltage.at(index);
+  }
+
+  double PowerBus::getLoadPowerW(const std::size_t& index) const {
+    return this->loadPowerW.at(index);
+  }
+
+  void PowerBus::setLoadPowerW(
+   const std::size_t& index, const double& loadPowerW
+  ) {
+    this->loadPowerW.at(index) = loadPowerW;
+  }
+
+  double PowerBus::getNodeVoltage(const std::size_t& index) const {
+    return this->nodeVoltage.at(index);
+  }
+
+  bool PowerBus::isBrownout(const std::size_t& index) const {
+    return this->brownout.at(index)!=0;
+  }
+
+  void PowerBus::clipSolarCurrent() {
+    const std::size_t count = this->nodeIDs.size();
+    const double* const voc = this->openCircuitVoltage.data();
+    const double* const v = this->nodeVoltage.data();
+    double* const i = this->solarCurrentAmpere.data();
+    for(std::size_t n=0; n<count; n++) {
+      i[n] = (voc[n]<=v[n]) ? 0.0 : i[n];
+    }
+  }
+
+  void PowerBus::updateCharge(const double& durationS) {
+    const std::size_t count = this->nodeIDs.size();
+    const double* const i = this->solarCurrentAmpere.data();
+    const double* const p = this->loadPowerW.data();
+    const double* const v = this->nodeVoltage.data();
+    double* const q = this->chargeCoulomb.data();
+    for(std::size_t n=0; n<count; n++) {
+      const double charge = q[n]+(i[n]-p[n]/v[n])*durationS;
+      q[n] = (charge<0.0) ? 0.0 : charge;
+    }
+  }
+
+  std::size_t PowerBus::updateNodeVoltage() {
+    const std::size_t count = this->nodeIDs.size();
+    const double* const c = this->capacitanceFarad.data();
+    const double* const r = this->esrOhm.data();
+    const double* const q = this->chargeCoulomb.data();
+    const double* const i = this->solarCurrentAmpere.data();
+    const double* const p = this->loadPowerW.data();
+    double* const v = this->nodeVoltage.data();
+    uint8_t* const b = this->brownout.data();
+    std::size_t brownoutCount = 0;
+    for(std::size_t n=0; n<count; n++) {
+      // Same math as calcNodeVoltageDiscriminant and calcNodeVoltage, inlined
+      // so that the loop body has no calls
+      const double sum = q[n]/c[n]+i[n]*r[n];
+      const double discriminant = sum*sum-4.0*p[n]*r[n];
+      const uint8_t negative = (discriminant<0.0) ? 1 : 0;
+      v[n] = 0.5*(sum+std::sqrt(negative ? 0.0 : discriminant));
+      b[n] = negative;
+      brownoutCount += negative;
+    }
+    return brownoutCount;
+  }
+
+  bool PowerBus::updateNodeVoltage(const std::size_t& index) {
+    const double discriminant = cote::util::calcNodeVoltageDiscriminant(
+     this->chargeCoulomb.at(index), this->capacitanceFarad.at(index),
+     this->solarCurrentAmpere.at(index), this->esrOhm.at(index),
+     this->loadPowerW.at(index)
+    );
+    //// As in the batch update, a node in brownout is given the voltage of a
+    //// zero discriminant
+    this->brownout.at(index) = (discriminant<0.0) ? 1 : 0;
+    this->nodeVoltage.at(index) = cote::util::calcNodeVoltage(
+     (discriminant<0.0) ? 0.0 : discriminant, this->chargeCoulomb.at(index),
+     this->capacitanceFarad.at(index), this->solarCurrentAmpere.at(index),
+     this->esrOhm.at(index)
+    );
+    return discriminant>=0.0;
+  }
+
+  void PowerBus::advance(const double& durationS) {
+    for(std::size_t n=0; n<this->nodeIDs.size(); n++) {
+      Capacitor capacitor(this->capacitanceFarad.at(n),this->esrOhm.at(n));
+      capacitor.setChargeCoulomb(this->chargeCoulomb.at(n));
+      SolarArray solarArray(
+       this->openCircuitVoltage.at(n), this->surfaceAreaM2.at(n),
+       this->efficiency.at(n)
+      );
+      solarArray.setCurrentAmpere(this->solarCurrentAmpere.at(n));
+      PowerSubsystem powerSubsystem(&capacitor,&solarArray);
+      powerSubsystem.setLoadPowerW(this->loadPowerW.at(n));
+      powerSubsystem.advance(durationS);
+      this->chargeCoulomb.at(n) = capacitor.getChargeCoulomb();
+    }
+  }
+
+  double PowerBus::calcTimeToNextEvent(
+   const std::size_t& index, const std::vector<double>& thresholds
+  ) const {
+    Capacitor capacitor(
+     this->capacitanceFarad.at(index),this->esrOhm.at(index)
+    );
+    capacitor.setChargeCoulomb(this->chargeCoulomb.at(index));
+    SolarArray solarArray(
+     this->openCircuitVoltage.at(index), this->surfaceAreaM2.at(index),
+     this->efficiency.at(index)
+    );
+    solarArray.setCurrentAmpere(this->solarCurrentAmpere.at(index));
+    PowerSubsystem powerSubsystem(&capacitor,&solarArray);
+    powerSubsystem.setLoadPowerW(this->loadPowerW.at(index));
+    return powerSubsystem.calcTimeToNextEvent(thresholds);
+  }
+
+  uint32_t PowerBus::getID() const {
+    return this->id;
+  }
+
+  Log* PowerBus::getLog() const {
+    return this->log;
+  }
+}
@@ -0,0 +1,112 @@
+// test-power-bus.cpp
+// PowerBus class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>        // size_t
+#include <cstdlib>        // exit, EXIT_SUCCESS
+#include <string>         // to_string
+#include <vector>         // vector
+
+// satsim
+#include <Capacitor.hpp>  // Capacitor
+#include <Log.hpp>        // Log
+#include <LogLevel.hpp>   // LogLevel
+#include <PowerBus.hpp>   // PowerBus
+#include <SolarArray.hpp> // SolarArray
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  cote::PowerBus powerBus(0,&log);
+  // Node 0 is lightly loaded and charges; nodes 1 and 2 are overloaded and
+  // brown out
+  for(std::size_t i=0; i<3; i++) {
+    cote::SolarArray solarArray(7.2,0.0064,0.292,i+1,&log);
+    solarArray.setIrradianceWpM2(1366.1);
+    cote::Capacitor capacitor(1.0,0.168,i+1,&log);
+    capacitor.setChargeCoulomb(6.0);
+    const std::size_t index = powerBus.addNode(capacitor,solarArray);
+    powerBus.setLoadPowerW(index,(i==0) ? 0.5 : 20.0);
+  }
+  powerBus.updateNodeVoltage();
+  for(std::size_t step=0; step<100; step++) {
+    powerBus.clipSolarCurrent();
+    powerBus.updateCharge(0.01);
+    const std::size_t brownoutCount = powerBus.updateNodeVoltage();
+    if(brownoutCount>0) {
+      for(std::size_t i=0; i<powerBus.getNodeCount(); i++) {
+        if(powerBus.isBrownout(i)) {
+          log.evnt(
+           cote::LogLevel::INFO, std::to_string(step),
+           "node-"+std::to_string(powerBus.getNodeID(i))+"-brownout"
+          );
+          if(i==1) {
+            powerBus.setLoadPowerW(i,0.0); // shed all load
+          } else {
+            powerBus.setLoadPowerW(i,19.9); // shed too little load
+          }
+          powerBus.updateNodeVoltage(i);
+        }
+      }
+    }
+    for(std::size_t i=0; i<powerBus.getNodeCount(); i++) {
+      log.meas(
+       cote::LogLevel::INFO, std::to_string(step),
+       "node-"+std::to_string(powerBus.getNodeID(i))+"-voltage",
+       std::to_string(powerBus.getNodeVoltage(i))
+      );
+    }
+    // A node still in brownout after a single node update holds the voltage
+    // of a zero discriminant, as after a batch update
+    if(powerBus.isBrownout(2)) {
+      log.meas(
+       cote::LogLevel::INFO, std::to_string(step), "node-3-brownout-voltage",
+       std::to_string(
+        0.5*(powerBus.getChargeCoulomb(2)/powerBus.getCapacitanceFarad(2)+
+        powerBus.getSolarCurrentAmpere(2)*powerBus.getEsrOhm(2))
+       )
+      );
+    }
+  }
+  // The closed-form update agrees with many small forward Euler steps; node 0
+  // charges and node 1 discharges without browning out
+  cote::PowerBus eulerBus(0,&log);
+  for(std::size_t i=0; i<2; i++) {
+    cote::SolarArray solarArray(7.2,0.0064,0.292,i+1,&log);
+    solarArray.setIrradianceWpM2(1366.1);
+    cote::Capacitor capacitor(1.0,0.168,i+1,&log);
+    capacitor.setChargeCoulomb(6.0);
+    const std::size_t index = eulerBus.addNode(capacitor,solarArray);
+    eulerBus.setLoadPowerW(index,(i==0) ? 0.5 : 4.0);
+  }
+  eulerBus.updateNodeVoltage();
+  cote::PowerBus closedFormBus(eulerBus);
+  for(std::size_t step=0; step<100000; step++) {
+    eulerBus.clipSolarCurrent();
+    eulerBus.updateCharge(0.00001);
+    eulerBus.updateNodeVoltage();
+  }
+  closedFormBus.advance(1.0);
+  closedFormBus.updateNodeVoltage();
+  for(std::size_t i=0; i<eulerBus.getNodeCount(); i++) {
+    log.meas(
+     cote::LogLevel::INFO, "1.0",
+     "node-"+std::to_string(eulerBus.getNodeID(i))+"-euler-voltage",
+     std::to_string(eulerBus.getNodeVoltage(i))
+    );
+    log.meas(
+     cote::LogLevel::INFO, "1.0",
+     "node-"+std::to_string(closedFormBus.getNodeID(i))+
+     "-closed-form-voltage",
+     std::to_string(closedFormBus.getNodeVoltage(i))
+    );
+  }
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,113 @@
+// PowerSubsystem.hpp
+// PowerSubsystem class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_POWER_SUBSYSTEM_HPP
+#define COTE_POWER_SUBSYSTEM_HPP
+
+// Standard library
+#include <cstdint>        // uint8_t, uint32_t
+#include <vector>         // vector
+
+// cote
+#include <Capacitor.hpp>  // Capacitor
+#include <Log.hpp>        // Log
+#include <SolarArray.hpp> // SolarArray
+
+namespace cote {
+  class PowerSubsystem {
+  public:
+    // capacitor: the energy storage element; its charge is updated in place
+    // solarArray: the energy source; its current is read but never modified
+    PowerSubsystem(
+     Capacitor* const capacitor, SolarArray* const solarArray,
+     const uint32_t& id=0, Log* const log=NULL
+    );
+    PowerSubsystem(const PowerSubsystem& powerSubsystem);
+    PowerSubsystem(PowerSubsystem&& powerSubsystem);
+    virtual ~PowerSubsystem();
+    virtual PowerSubsystem& operator=(const PowerSubsystem& powerSubsystem);
+    virtual PowerSubsystem& operator=(PowerSubsystem&& powerSubsystem);
+    virtual PowerSubsystem* clone() const;
+    Capacitor* getCapacitor() const;
+    SolarArray* getSolarArray() const;
+    double getLoadPowerW() const;
+    void setLoadPowerW(const double& loadPowerW);
+    // Returns the solar array current after clipping at the open circuit
+    // voltage, i.e. the current that actually reaches the node
+    double getSolarCurrentAmpere() const;
+    double getNodeVoltage() const;
+    // Returns true if the loads draw more power than the node can supply; the
+    // caller is expected to shed load (e.g. set state machines to OFF)
+    bool isBrownout() const;
+    // Returns the time in seconds until the node voltage reaches nodeVoltage,
+    // or infinity if it will not be reached with the present loads and solar
+    // current. Callers that step on a fixed grid should round up to the next
+    // step so that strict comparisons (e.g. node-voltage<5.0) are satisfied.
+    double calcTimeToNodeVoltage(const double& nodeVoltage) const;
+    // Returns the time in seconds until the earliest of the given node voltage
+    // thresholds is reached, the solar array is clipped or unclipped at its
+    // open circuit voltage, or a brownout occurs; infinity if none will occur
+    double calcTimeToNextEvent(const std::vector<double>& thresholds) const;
+    // Advances the capacitor charge by durationS seconds using the closed-form
+    // solution of the node equation; the loads and the solar current are
+    // assumed constant over the interval. Returns the number of seconds
+    // actually advanced, which is less than durationS if a brownout occurs.
+    double advance(const double& durationS);
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    // Operating regimes of the solar array with respect to the node voltage
+    //  SOURCE: node voltage is below Voc and the array supplies its current
+    //  CLIPPED: node voltage is above Voc and the array supplies no current
+    //  CLAMPED: node voltage is held at Voc; the array supplies the load
+    //  EMPTY: the capacitor is fully discharged and cannot discharge further
+    enum class Regime : uint8_t {SOURCE, CLIPPED, CLAMPED, EMPTY};
+    // Kinds of voltage the node approaches within a regime
+    //  NONE: the node voltage does not change
+    //  BOUNDARY: the array is clipped or unclipped at Voc
+    //  BROWNOUT: the loads can no longer be supplied
+    //  EMPTY: the capacitor charge reaches zero
+    enum class LimitKind : uint8_t {NONE, BOUNDARY, BROWNOUT, EMPTY};
+    struct Limit {
+      LimitKind kind;
+      double voltage; // regime node voltage at the limit
+      double chargeC; // capacitor charge at the limit
+    };
+    static constexpr double VOLTAGE_TOLERANCE = 1.0e-9;
+    Regime getRegime(const double& chargeC) const;
+    double getRegimeCurrentAmpere(const Regime& regime) const;
+    // Node voltage for the given charge and solar current
+    double calcNodeVoltage(const double& chargeC, const double& currentA) const;
+    // Capacitor charge for the given node voltage and solar current
+    double calcCharge(const double& nodeVoltage, const double& currentA) const;
+    // Translates a reported node voltage to the node voltage seen in a regime
+    // with the given solar current, or NaN if it cannot be reached
+    double calcRegimeVoltage(
+     const double& nodeVoltage, const double& currentA
+    ) const;
+    Limit calcRegimeLimit(const double& chargeC, const Regime& regime) const;
+    // Time to move from voltage v0 to v1 with constant current and load
+    double calcTimeBetween(
+     const double& v0, const double& v1, const double& currentA
+    ) const;
+    // Node voltage reached after durationS seconds starting from v0; the
+    // result is bracketed by v0 and vLimit
+    double calcVoltageAfter(
+     const double& v0, const double& vLimit, const double& currentA,
+     const double& durationS
+    ) const;
+    Capacitor* capacitor;   // not owned, should not be deleted
+    SolarArray* solarArray; // not owned, should not be deleted
+    double loadPowerW;      // summed power draw of all loads in Watt
+    bool brownout;          // set when advance() stops at a brownout
+    uint32_t id;            // identification number
+    Log* log;               // singleton, should not be deleted
+  };
+}
+
+#endif
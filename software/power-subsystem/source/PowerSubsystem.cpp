@@ -0,0 +1,471 @@
+// PowerSubsystem.cpp
+// PowerSubsystem class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+//
+// Between events, the loads (P) and the solar array current (I) are constant,
+// so the capacitor charge Q and the node voltage V obey
+//   Q = C*(V + P*R/V - I*R)  (the node voltage equation solved for Q)
+//   dQ/dt = I - P/V
+// Differentiating the first equation and substituting gives
+//   dt = C*(V^2 - P*R)/(V*(I*V - P)) dV
+// which integrates in closed form (see calcTimeBetween). The node voltage
+// moves monotonically away from the (unstable) equilibrium P/I, either up to
+// the open circuit voltage of the solar array or down to the brownout voltage
+// sqrt(P*R) where the discriminant of the node voltage equation reaches zero.
+// Advancing by a given duration inverts the closed-form time with a bracketed
+// Newton iteration.
+
+// Standard library
+#include <algorithm>          // max, min
+#include <cmath>              // abs, isfinite, isnan, log, sqrt, INFINITY, NAN
+#include <cstddef>            // size_t
+#include <cstdint>            // uint32_t
+#include <utility>            // move
+#include <vector>             // vector
+
+// cote
+#include <Capacitor.hpp>      // Capacitor
+#include <Log.hpp>            // Log
+#include <PowerSubsystem.hpp> // PowerSubsystem
+#include <SolarArray.hpp>     // SolarArray
+#include <utilities.hpp>      // calcNodeVoltageDiscriminant, calcNodeVoltage
+
+namespace cote {
+  PowerSubsystem::PowerSubsystem(
+   Capacitor* const capacitor, SolarArray* const solarArray,
+   const uint32_t& id, Log* const log
+  ) : capacitor(capacitor), solarArray(solarArray), loadPowerW(0.0),
+      brownout(false), id(id), log(log) {}
+
+  PowerSubsystem::PowerSubsystem(const PowerSubsystem& powerSubsystem) :
+   capacitor(powerSubsystem.getCapacitor()),
+   solarArray(powerSubsystem.getSolarArray()),
+   loadPowerW(powerSubsystem.getLoadPowerW()),
+   brownout(powerSubsystem.brownout), id(powerSubsystem.getID()),
+   log(powerSubsystem.getLog()) {}
+
+  PowerSubsystem::PowerSubsystem(PowerSubsystem&& powerSubsystem) :
+   capacitor(powerSubsystem.capacitor), solarArray(powerSubsystem.solarArray),
+   loadPowerW(powerSubsystem.loadPowerW), brownout(powerSubsystem.brownout),
+   id(powerSubsystem.id), log(powerSubsystem.log) {
+    powerSubsystem.capacitor  = NULL;
+    powerSubsystem.solarArray = NULL;
+    powerSubsystem.log        = NULL;
+  }
+
+  PowerSubsystem::~PowerSubsystem() {
+    this->capacitor  = NULL;
+    this->solarArray = NULL;
+    this->log        = NULL;
+  }
+
+  PowerSubsystem& PowerSubsystem::operator=(
+   const PowerSubsystem& powerSubsystem
+  ) {
+    PowerSubsystem temp(powerSubsystem);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  PowerSubsystem& PowerSubsystem::operator=(PowerSubsystem&& powerSubsystem) {
+    this->capacitor           = powerSubsystem.capacitor;
+    this->solarArray          = powerSubsystem.solarArray;
+    this->loadPowerW          = powerSubsystem.loadPowerW;
+    this->brownout            = powerSubsystem.brownout;
+    this->id                  = powerSubsystem.id;
+    this->log                 = powerSubsystem.log;
+    powerSubsystem.capacitor  = NULL;
+    powerSubsystem.solarArray = NULL;
+    powerSubsystem.log        = NULL;
+    return *this;
+  }
+
+  PowerSubsystem* PowerSubsystem::clone() const {
+    return new PowerSubsystem(*this);
+  }
+
+  Capacitor* PowerSubsystem::getCapacitor() const {
+    return this->capacitor;
+  }
+
+  SolarArray* PowerSubsystem::getSolarArray() const {
+    return this->solarArray;
+  }
+
+  double PowerSubsystem::getLoadPowerW() const {
+    return this->loadPowerW;
+  }
+
+  void PowerSubsystem::setLoadPowerW(const double& loadPowerW) {
+    if(loadPowerW!=this->loadPowerW) {
+      this->loadPowerW = loadPowerW;
+      this->brownout = false;
+    }
+  }
+
+  double PowerSubsystem::getSolarCurrentAmpere() const {
+    return this->getRegimeCurrentAmpere(
+     this->getRegime(this->capacitor->getChargeCoulomb())
+    );
+  }
+
+  double PowerSubsystem::getNodeVoltage() const {
+    return this->calcNodeVoltage(
+     this->capacitor->getChargeCoulomb(),
+     this->solarArray->getCurrentAmpere()
+    );
+  }
+
+  bool PowerSubsystem::isBrownout() const {
+    return this->brownout || cote::util::calcNodeVoltageDiscriminant(
+     this->capacitor->getChargeCoulomb(),
+     this->capacitor->getCapacitanceFarad(),
+     this->solarArray->getCurrentAmpere(), this->capacitor->getEsrOhm(),
+     this->loadPowerW
+    )<0.0;
+  }
+
+  double PowerSubsystem::calcTimeToNodeVoltage(const double& nodeVoltage)
+   const {
+    const double chargeC = this->capacitor->getChargeCoulomb();
+    const Regime regime = this->getRegime(chargeC);
+    const double currentA = this->getRegimeCurrentAmpere(regime);
+    if(this->isBrownout()) {
+      return INFINITY;
+    }
+    if(std::abs(this->getNodeVoltage()-nodeVoltage)<=VOLTAGE_TOLERANCE) {
+      return 0.0;
+    }
+    const Limit limit = this->calcRegimeLimit(chargeC,regime);
+    if(limit.kind==LimitKind::NONE) {
+      return INFINITY;
+    }
+    const double v0 = this->calcNodeVoltage(chargeC,currentA);
+    const double vTarget = this->calcRegimeVoltage(nodeVoltage,currentA);
+    const double direction = (limit.voltage>v0 ? 1.0 : -1.0);
+    if(
+     !std::isnan(vTarget) && (vTarget-v0)*direction>=0.0 &&
+     (
+      (limit.voltage-vTarget)*direction>0.0 ||
+      (limit.kind==LimitKind::BOUNDARY && vTarget==limit.voltage)
+     )
+    ) {
+      return this->calcTimeBetween(v0,vTarget,currentA);
+    }
+    if(limit.kind!=LimitKind::BOUNDARY) {
+      return INFINITY;
+    }
+    // The target lies beyond a regime boundary; continue from the boundary
+    // on a scratch copy of the capacitor
+    Capacitor scratchCapacitor(*(this->capacitor));
+    PowerSubsystem scratch(*this);
+    scratch.capacitor = &scratchCapacitor;
+    const double boundaryTimeS = this->calcTimeBetween(
+     v0,limit.voltage,currentA
+    );
+    scratch.advance(boundaryTimeS);
+    const double remainingTimeS = scratch.calcTimeToNodeVoltage(nodeVoltage);
+    scratch.capacitor = NULL;
+    return boundaryTimeS+remainingTimeS;
+  }
+
+  double PowerSubsystem::calcTimeToNextEvent(
+   const std::vector<double>& thresholds
+  ) const {
+    if(this->isBrownout()) {
+      return 0.0;
+    }
+    const double chargeC = this->capacitor->getChargeCoulomb();
+    const Regime regime = this->getRegime(chargeC);
+    const Limit limit = this->calcRegimeLimit(chargeC,regime);
+    if(limit.kind==LimitKind::NONE) {
+      return INFINITY;
+    }
+    const double currentA = this->getRegimeCurrentAmpere(regime);
+    const double v0 = this->calcNodeVoltage(chargeC,currentA);
+    const double direction = (limit.voltage>v0 ? 1.0 : -1.0);
+    double earliestS = this->calcTimeBetween(v0,limit.voltage,currentA);
+    const double nodeVoltage = this->getNodeVoltage();
+    for(std::size_t i=0; i<thresholds.size(); i++) {
+      // Thresholds at the present node voltage have already been reached
+      if(std::abs(thresholds.at(i)-nodeVoltage)<=VOLTAGE_TOLERANCE) {
+        continue;
+      }
+      const double vTarget =
+       this->calcRegimeVoltage(thresholds.at(i),currentA);
+      if(
+       !std::isnan(vTarget) && (vTarget-v0)*direction>0.0 &&
+       (limit.voltage-vTarget)*direction>0.0
+      ) {
+        earliestS = std::min(
+         earliestS,this->calcTimeBetween(v0,vTarget,currentA)
+        );
+      }
+    }
+    return earliestS;
+  }
+
+  double PowerSubsystem::advance(const double& durationS) {
+    double chargeC = this->capacitor->getChargeCoulomb();
+    double remainingS = durationS;
+    double elapsedS = 0.0;
+    // Each iteration either finishes the interval or crosses one regime
+    // boundary; at most three boundaries can be crossed
+    for(std::size_t i=0; i<4 && remainingS>0.0; i++) {
+      if(this->isBrownout()) {
+        this->brownout = true;
+        break;
+      }
+      const Regime regime = this->getRegime(chargeC);
+      const Limit limit = this->calcRegimeLimit(chargeC,regime);
+      if(limit.kind==LimitKind::NONE) {
+        elapsedS += remainingS;
+        remainingS = 0.0;
+        break;
+      }
+      const double currentA = this->getRegimeCurrentAmpere(regime);
+      const double v0 = this->calcNodeVoltage(chargeC,currentA);
+      const double limitS =
+       this->calcTimeBetween(v0,limit.voltage,currentA);
+      if(limitS>remainingS) {
+        const double v1 =
+         this->calcVoltageAfter(v0,limit.voltage,currentA,remainingS);
+        chargeC = std::max(0.0,this->calcCharge(v1,currentA));
+        elapsedS += remainingS;
+        remainingS = 0.0;
+      } else {
+        chargeC = limit.chargeC;
+        elapsedS += limitS;
+        remainingS -= limitS;
+        if(limit.kind==LimitKind::BROWNOUT) {
+          this->brownout = true;
+        }
+      }
+      this->capacitor->setChargeCoulomb(chargeC);
+    }
+    return elapsedS;
+  }
+
+  uint32_t PowerSubsystem::getID() const {
+    return this->id;
+  }
+
+  Log* PowerSubsystem::getLog() const {
+    return this->log;
+  }
+
+  PowerSubsystem::Regime PowerSubsystem::getRegime(const double& chargeC)
+   const {
+    const double currentA = this->solarArray->getCurrentAmpere();
+    const double openCircuitVoltage =
+     this->solarArray->getOpenCircuitVoltage();
+    const double nodeVoltage = this->calcNodeVoltage(chargeC,currentA);
+    if(currentA>0.0) {
+      if(nodeVoltage>openCircuitVoltage+VOLTAGE_TOLERANCE) {
+        return Regime::CLIPPED;
+      } else if(nodeVoltage>=openCircuitVoltage-VOLTAGE_TOLERANCE) {
+        // At the open circuit voltage the array holds the node if it can
+        // supply more than the loads draw; otherwise the node discharges
+        if(currentA*openCircuitVoltage>this->loadPowerW) {
+          return Regime::CLAMPED;
+        }
+      }
+    }
+    if(chargeC<=0.0 && currentA*nodeVoltage<=this->loadPowerW) {
+      return Regime::EMPTY;
+    }
+    return Regime::SOURCE;
+  }
+
+  double PowerSubsystem::getRegimeCurrentAmpere(const Regime& regime) const {
+    double currentA = this->solarArray->getCurrentAmpere();
+    if(regime==Regime::CLIPPED) {
+      currentA = 0.0;
+    } else if(regime==Regime::CLAMPED) {
+      currentA = std::min(
+       currentA,this->loadPowerW/this->solarArray->getOpenCircuitVoltage()
+      );
+    }
+    return currentA;
+  }
+
+  double PowerSubsystem::calcNodeVoltage(
+   const double& chargeC, const double& currentA
+  ) const {
+    const double discriminant = cote::util::calcNodeVoltageDiscriminant(
+     chargeC, this->capacitor->getCapacitanceFarad(), currentA,
+     this->capacitor->getEsrOhm(), this->loadPowerW
+    );
+    return cote::util::calcNodeVoltage(
+     std::max(0.0,discriminant), chargeC,
+     this->capacitor->getCapacitanceFarad(), currentA,
+     this->capacitor->getEsrOhm()
+    );
+  }
+
+  double PowerSubsystem::calcCharge(
+   const double& nodeVoltage, const double& currentA
+  ) const {
+    const double esrOhm = this->capacitor->getEsrOhm();
+    return this->capacitor->getCapacitanceFarad()*(
+     nodeVoltage+this->loadPowerW*esrOhm/nodeVoltage-currentA*esrOhm
+    );
+  }
+
+  double PowerSubsystem::calcRegimeVoltage(
+   const double& nodeVoltage, const double& currentA
+  ) const {
+    // Node voltages are always reported with the unclipped solar current;
+    // translate through the charge to the voltage seen in the regime
+    const double brownoutVoltage =
+     std::sqrt(this->loadPowerW*this->capacitor->getEsrOhm());
+    if(nodeVoltage<=0.0 || nodeVoltage<brownoutVoltage) {
+      return NAN;
+    }
+    const double chargeC =
+     this->calcCharge(nodeVoltage,this->solarArray->getCurrentAmpere());
+    if(chargeC<0.0) {
+      return NAN;
+    }
+    const double discriminant = cote::util::calcNodeVoltageDiscriminant(
+     chargeC, this->capacitor->getCapacitanceFarad(), currentA,
+     this->capacitor->getEsrOhm(), this->loadPowerW
+    );
+    if(discriminant<0.0) {
+      return NAN;
+    }
+    return this->calcNodeVoltage(chargeC,currentA);
+  }
+
+  PowerSubsystem::Limit PowerSubsystem::calcRegimeLimit(
+   const double& chargeC, const Regime& regime
+  ) const {
+    const double capacitanceF = this->capacitor->getCapacitanceFarad();
+    const double esrOhm = this->capacitor->getEsrOhm();
+    const double powerW = this->loadPowerW;
+    const double solarCurrentA = this->solarArray->getCurrentAmpere();
+    const double openCircuitVoltage =
+     this->solarArray->getOpenCircuitVoltage();
+    const double brownoutVoltage = std::sqrt(powerW*esrOhm);
+    Limit limit = {LimitKind::NONE, NAN, NAN};
+    if(regime==Regime::CLAMPED || regime==Regime::EMPTY) {
+      return limit;
+    }
+    const double currentA = this->getRegimeCurrentAmpere(regime);
+    const double nodeVoltage = this->calcNodeVoltage(chargeC,currentA);
+    const double netCurrentA = currentA-powerW/nodeVoltage;
+    if(netCurrentA==0.0 || (currentA==0.0 && powerW==0.0)) {
+      return limit;
+    }
+    if(regime==Regime::CLIPPED) {
+      // Discharging without solar current until the array starts sourcing
+      // again or the loads can no longer be supplied
+      const double boundaryChargeC =
+       this->calcCharge(openCircuitVoltage,solarCurrentA);
+      if(boundaryChargeC>2.0*capacitanceF*brownoutVoltage) {
+        limit.kind = LimitKind::BOUNDARY;
+        limit.chargeC = boundaryChargeC;
+        limit.voltage = this->calcNodeVoltage(boundaryChargeC,0.0);
+      } else {
+        limit.kind = LimitKind::BROWNOUT;
+        limit.chargeC = 2.0*capacitanceF*brownoutVoltage;
+        limit.voltage = brownoutVoltage;
+      }
+    } else if(netCurrentA>0.0) {
+      // Charging away from the equilibrium P/I until the array is clipped
+      limit.kind = LimitKind::BOUNDARY;
+      limit.chargeC = this->calcCharge(openCircuitVoltage,currentA);
+      limit.voltage = openCircuitVoltage;
+    } else {
+      // Discharging away from the equilibrium P/I until a brownout occurs or
+      // the capacitor is empty
+      const double brownoutChargeC =
+       capacitanceF*(2.0*brownoutVoltage-currentA*esrOhm);
+      if(brownoutChargeC>=0.0) {
+        limit.kind = LimitKind::BROWNOUT;
+        limit.chargeC = brownoutChargeC;
+        limit.voltage = brownoutVoltage;
+      } else {
+        limit.kind = LimitKind::EMPTY;
+        limit.chargeC = 0.0;
+        limit.voltage = this->calcNodeVoltage(0.0,currentA);
+      }
+    }
+    return limit;
+  }
+
+  double PowerSubsystem::calcTimeBetween(
+   const double& v0, const double& v1, const double& currentA
+  ) const {
+    const double capacitanceF = this->capacitor->getCapacitanceFarad();
+    const double esrOhm = this->capacitor->getEsrOhm();
+    const double powerW = this->loadPowerW;
+    if(v0==v1) {
+      return 0.0;
+    } else if(currentA==0.0 && powerW==0.0) {
+      return INFINITY;
+    } else if(currentA==0.0) {
+      return capacitanceF*(
+       -(v1*v1-v0*v0)/(2.0*powerW)+esrOhm*std::log(v1/v0)
+      );
+    }
+    return capacitanceF*(
+     (v1-v0)/currentA+esrOhm*std::log(v1/v0)+
+     (powerW/currentA-esrOhm*currentA)/currentA*
+     std::log((currentA*v1-powerW)/(currentA*v0-powerW))
+    );
+  }
+
+  double PowerSubsystem::calcVoltageAfter(
+   const double& v0, const double& vLimit, const double& currentA,
+   const double& durationS
+  ) const {
+    // Bracketed Newton iteration on f(v) = calcTimeBetween(v0,v)-durationS,
+    // where f(v0)<0 and f(vLimit)>=0
+    const double capacitanceF = this->capacitor->getCapacitanceFarad();
+    const double esrOhm = this->capacitor->getEsrOhm();
+    const double powerW = this->loadPowerW;
+    double lo = v0;
+    double hi = vLimit;
+    double v = v0;
+    // Start from the forward Euler estimate, which is exact for small steps
+    double slope =
+     (v0*(currentA*v0-powerW))/(capacitanceF*(v0*v0-powerW*esrOhm));
+    if(std::isfinite(slope)) {
+      v = v0+slope*durationS;
+    }
+    for(std::size_t i=0; i<100; i++) {
+      if(!((v-lo)*(hi-v)>0.0)) {
+        v = 0.5*(lo+hi);
+      }
+      const double f = this->calcTimeBetween(v0,v,currentA)-durationS;
+      if(f==0.0) {
+        break;
+      } else if(f<0.0) {
+        lo = v;
+      } else {
+        hi = v;
+      }
+      if(std::abs(hi-lo)<=VOLTAGE_TOLERANCE*1.0e-3) {
+        break;
+      }
+      const double dtdv =
+       capacitanceF*(v*v-powerW*esrOhm)/(v*(currentA*v-powerW));
+      const double vNext = v-f/dtdv;
+      if(std::isfinite(vNext) && (vNext-lo)*(hi-vNext)>0.0) {
+        if(std::abs(vNext-v)<=VOLTAGE_TOLERANCE*1.0e-3) {
+          v = vNext;
+          break;
+        }
+        v = vNext;
+      } else {
+        v = 0.5*(lo+hi);
+      }
+    }
+    return v;
+  }
+}
@@ -0,0 +1,103 @@
+// test-power-subsystem.cpp
+// PowerSubsystem class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>          // min
+#include <cstddef>            // size_t
+#include <cstdlib>            // exit, EXIT_SUCCESS
+#include <string>             // to_string
+#include <vector>             // vector
+
+// satsim
+#include <Capacitor.hpp>      // Capacitor
+#include <Log.hpp>            // Log
+#include <LogLevel.hpp>       // LogLevel
+#include <PowerSubsystem.hpp> // PowerSubsystem
+#include <SolarArray.hpp>     // SolarArray
+#include <utilities.hpp>      // calcNodeVoltageDiscriminant, calcNodeVoltage
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  cote::SolarArray solarArray(7.2,0.0064,0.292,1,&log);
+  solarArray.setIrradianceWpM2(1366.1);
+  cote::Capacitor capacitor(1.0,0.168,1,&log);
+  capacitor.setChargeCoulomb(6.0);
+  cote::PowerSubsystem powerSubsystem(&capacitor,&solarArray,1,&log);
+  const std::vector<double> thresholds = {5.0,5.5,5.75,6.75};
+  // Discharge under a load, jumping from threshold to threshold
+  powerSubsystem.setLoadPowerW(3.0);
+  double time = 0.0;
+  for(std::size_t i=0; i<3; i++) {
+    const double eventTimeS = powerSubsystem.calcTimeToNextEvent(thresholds);
+    time += powerSubsystem.advance(eventTimeS);
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(time), "node-voltage",
+     std::to_string(powerSubsystem.getNodeVoltage())
+    );
+  }
+  // Compare one second of closed-form integration with forward Euler steps
+  cote::Capacitor eulerCapacitor(capacitor);
+  const double timeStepS = 0.00002;
+  for(std::size_t i=0; i<50000; i++) {
+    const double discriminant = cote::util::calcNodeVoltageDiscriminant(
+     eulerCapacitor.getChargeCoulomb(), eulerCapacitor.getCapacitanceFarad(),
+     solarArray.getCurrentAmpere(), eulerCapacitor.getEsrOhm(), 3.0
+    );
+    const double nodeVoltage = cote::util::calcNodeVoltage(
+     discriminant, eulerCapacitor.getChargeCoulomb(),
+     eulerCapacitor.getCapacitanceFarad(), solarArray.getCurrentAmpere(),
+     eulerCapacitor.getEsrOhm()
+    );
+    eulerCapacitor.setChargeCoulomb(
+     eulerCapacitor.getChargeCoulomb()+
+     (solarArray.getCurrentAmpere()-3.0/nodeVoltage)*timeStepS
+    );
+  }
+  time += powerSubsystem.advance(1.0);
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(time), "charge-C",
+   std::to_string(capacitor.getChargeCoulomb())
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(time), "euler-charge-C",
+   std::to_string(eulerCapacitor.getChargeCoulomb())
+  );
+  // Shed the load and charge until the solar array is clamped at Voc
+  powerSubsystem.setLoadPowerW(0.5);
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(time), "time-to-voc-s",
+   std::to_string(powerSubsystem.calcTimeToNodeVoltage(7.2))
+  );
+  for(std::size_t i=0; i<5; i++) {
+    const double eventTimeS = powerSubsystem.calcTimeToNextEvent(thresholds);
+    time += powerSubsystem.advance(std::min(eventTimeS,100.0));
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(time), "node-voltage",
+     std::to_string(powerSubsystem.getNodeVoltage())
+    );
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(time), "solar-current-A",
+     std::to_string(powerSubsystem.getSolarCurrentAmpere())
+    );
+  }
+  // Draw more power than the node can supply until a brownout occurs
+  powerSubsystem.setLoadPowerW(40.0);
+  time += powerSubsystem.advance(100.0);
+  log.evnt(
+   cote::LogLevel::INFO, std::to_string(time),
+   powerSubsystem.isBrownout() ? "brownout" : "no-brownout"
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(time), "node-voltage",
+   std::to_string(powerSubsystem.getNodeVoltage())
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
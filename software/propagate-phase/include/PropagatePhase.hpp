@@ -0,0 +1,104 @@
+// PropagatePhase.hpp
+// PropagatePhase class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_PROPAGATE_PHASE_HPP
+#define COTE_PROPAGATE_PHASE_HPP
+
+// Standard library
+#include <array>               // array
+#include <cstddef>             // size_t
+#include <cstdint>             // uint8_t, uint32_t, uint64_t
+#include <vector>              // vector
+
+// cote library
+#include <GroundStation.hpp>   // GroundStation
+#include <IQuiescentPhase.hpp> // IQuiescentPhase
+#include <ISim.hpp>            // ISim
+#include <Log.hpp>             // Log
+#include <Satellite.hpp>       // Satellite
+#include <Simulation.hpp>      // Simulation
+
+namespace cote {
+  class PropagatePhase : public IQuiescentPhase {
+  public:
+    // Advances the simulation clock by one time step and then updates each
+    // entity (e.g. satellites and ground stations) by the same time step
+    //// Should be run every step; slower entities are given their own period
+    PropagatePhase(const uint32_t& id=0, Log* const log=NULL);
+    PropagatePhase(const PropagatePhase& propagatePhase);
+    PropagatePhase(PropagatePhase&& propagatePhase);
+    virtual ~PropagatePhase();
+    virtual PropagatePhase& operator=(const PropagatePhase& propagatePhase);
+    virtual PropagatePhase& operator=(PropagatePhase&& propagatePhase);
+    virtual PropagatePhase* clone() const;
+    // Entities are updated in the order added; they are not owned and must
+    // outlive the phase
+    //// An entity with a period of N steps is updated by N time steps at once,
+    //// at the end of every Nth step, so that it agrees with the clock on the
+    //// steps whose count is a multiple of N and holds its value in between;
+    //// entities should be at the clock when the phase first runs
+    std::size_t addEntity(ISim* const entity, const uint64_t& period=1);
+    // Satellites and ground stations also have an ECI position; for one with
+    // a period, the phase keeps a copy propagated to its next update so that
+    // the position can be interpolated until then
+    std::size_t addEntity(Satellite* const satellite, const uint64_t& period=1);
+    std::size_t addEntity(
+     GroundStation* const groundStation, const uint64_t& period=1
+    );
+    std::size_t getEntityCount() const;
+    ISim* getEntity(const std::size_t& index) const;
+    uint64_t getEntityPeriod(const std::size_t& index) const;
+    // The ECI position of a satellite or ground station as of the step that
+    // the clock was last advanced to, linearly interpolated between the
+    // updates of one with a period; the zero vector for other entities
+    //// Fast phases should read positions here rather than from the entity,
+    //// which holds its position between updates
+    std::array<double,3> getECIPosn(const std::size_t& index) const;
+    void step(Simulation* const simulation) override;
+    // Propagation is always quiescent; when skipping, the simulation advances
+    // the clock and each entity is advanced as if it had been stepped
+    uint64_t getQuiescentSteps(Simulation* const simulation) override;
+    void skip(Simulation* const simulation, const uint64_t& steps) override;
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    // Kinds of entity; only satellites and ground stations have a position
+    enum class Kind : uint8_t {OTHER, SATELLITE, GROUND_STATION};
+    // Copies each entity with a period and a position to its lookahead and
+    // propagates the lookahead to the next update of the entity
+    void start(Simulation* const simulation);
+    // Moves the entity to its next update, i.e. copies its lookahead to it,
+    // after first propagating the lookahead by the given number of steps, and
+    // then propagates the lookahead to the following update
+    void advanceEntity(
+     Simulation* const simulation, const std::size_t& index,
+     const uint64_t& steps
+    );
+    std::array<double,3> getEntityECIPosn(const std::size_t& index) const;
+    std::array<double,3> getLookaheadECIPosn(const std::size_t& index) const;
+    std::vector<ISim*> entities;   // not owned, should not be deleted
+    std::vector<uint64_t> periods; // one per entity
+    std::vector<Kind> kinds;       // one per entity
+    // Element i of each of the following belongs to entity i; the lookahead of
+    // an entity is at lookaheadIndices.at(i) in the vector of its kind, and
+    // its position is interpolated from prevSteps.at(i) to nextSteps.at(i)
+    std::vector<std::size_t> lookaheadIndices;
+    std::vector<uint64_t> prevSteps;
+    std::vector<uint64_t> nextSteps;
+    std::vector<std::array<double,3>> prevECIPosns;
+    std::vector<std::array<double,3>> nextECIPosns;
+    std::vector<Satellite> satelliteLookaheads;
+    std::vector<GroundStation> groundStationLookaheads;
+    uint64_t stepCount;            // step the clock was last advanced to
+    bool started;                  // true once the lookaheads are propagated
+    uint32_t id;                   // identification number
+    Log* log;                      // singleton, should not be deleted
+  };
+}
+
+#endif
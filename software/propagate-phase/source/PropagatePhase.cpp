@@ -0,0 +1,325 @@
+// PropagatePhase.cpp
+// PropagatePhase class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>          // max
+#include <array>              // array
+#include <limits>             // numeric_limits
+#include <cstddef>            // size_t
+#include <cstdint>            // uint8_t, uint32_t, uint64_t
+#include <utility>            // move
+#include <vector>             // vector
+
+// cote
+#include <GroundStation.hpp>  // GroundStation
+#include <ISim.hpp>           // ISim
+#include <Log.hpp>            // Log
+#include <PropagatePhase.hpp> // PropagatePhase
+#include <Satellite.hpp>      // Satellite
+#include <Simulation.hpp>     // Simulation
+#include <utilities.hpp>      // interpolateLinear
+
+namespace cote {
+  PropagatePhase::PropagatePhase(const uint32_t& id, Log* const log) :
+   stepCount(0), started(false), id(id), log(log) {}
+
+  PropagatePhase::PropagatePhase(const PropagatePhase& propagatePhase) :
+   entities(propagatePhase.entities), periods(propagatePhase.periods),
+   kinds(propagatePhase.kinds),
+   lookaheadIndices(propagatePhase.lookaheadIndices),
+   prevSteps(propagatePhase.prevSteps), nextSteps(propagatePhase.nextSteps),
+   prevECIPosns(propagatePhase.prevECIPosns),
+   nextECIPosns(propagatePhase.nextECIPosns),
+   satelliteLookaheads(propagatePhase.satelliteLookaheads),
+   groundStationLookaheads(propagatePhase.groundStationLookaheads),
+   stepCount(propagatePhase.stepCount), started(propagatePhase.started),
+   id(propagatePhase.getID()), log(propagatePhase.getLog()) {}
+
+  PropagatePhase::PropagatePhase(PropagatePhase&& propagatePhase) :
+   entities(std::move(propagatePhase.entities)),
+   periods(std::move(propagatePhase.periods)),
+   kinds(std::move(propagatePhase.kinds)),
+   lookaheadIndices(std::move(propagatePhase.lookaheadIndices)),
+   prevSteps(std::move(propagatePhase.prevSteps)),
+   nextSteps(std::move(propagatePhase.nextSteps)),
+   prevECIPosns(std::move(propagatePhase.prevECIPosns)),
+   nextECIPosns(std::move(propagatePhase.nextECIPosns)),
+   satelliteLookaheads(std::move(propagatePhase.satelliteLookaheads)),
+   groundStationLookaheads(std::move(propagatePhase.groundStationLookaheads)),
+   stepCount(propagatePhase.stepCount), started(propagatePhase.started),
+   id(propagatePhase.id), log(propagatePhase.log) {
+    propagatePhase.log = NULL;
+  }
+
+  PropagatePhase::~PropagatePhase() {
+    this->log = NULL;
+  }
+
+  PropagatePhase& PropagatePhase::operator=(
+   const PropagatePhase& propagatePhase
+  ) {
+    PropagatePhase temp(propagatePhase);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  PropagatePhase& PropagatePhase::operator=(PropagatePhase&& propagatePhase) {
+    this->entities         = std::move(propagatePhase.entities);
+    this->periods          = std::move(propagatePhase.periods);
+    this->kinds            = std::move(propagatePhase.kinds);
+    this->lookaheadIndices = std::move(propagatePhase.lookaheadIndices);
+    this->prevSteps        = std::move(propagatePhase.prevSteps);
+    this->nextSteps        = std::move(propagatePhase.nextSteps);
+    this->prevECIPosns     = std::move(propagatePhase.prevECIPosns);
+    this->nextECIPosns     = std::move(propagatePhase.nextECIPosns);
+    this->satelliteLookaheads =
+     std::move(propagatePhase.satelliteLookaheads);
+    this->groundStationLookaheads =
+     std::move(propagatePhase.groundStationLookaheads);
+    this->stepCount        = propagatePhase.stepCount;
+    this->started          = propagatePhase.started;
+    this->id               = propagatePhase.id;
+    this->log              = propagatePhase.log;
+    propagatePhase.log     = NULL;
+    return *this;
+  }
+
+  PropagatePhase* PropagatePhase::clone() const {
+    return new PropagatePhase(*this);
+  }
+
+  std::size_t PropagatePhase::addEntity(
+   ISim* const entity, const uint64_t& period
+  ) {
+    this->entities.push_back(entity);
+    this->periods.push_back(std::max(period,static_cast<uint64_t>(1)));
+    this->kinds.push_back(Kind::OTHER);
+    //// Only entities with a period and a position have a lookahead
+    this->lookaheadIndices.push_back(0);
+    this->prevSteps.push_back(0);
+    this->nextSteps.push_back(0);
+    this->prevECIPosns.push_back({0.0,0.0,0.0});
+    this->nextECIPosns.push_back({0.0,0.0,0.0});
+    return this->entities.size()-1;
+  }
+
+  std::size_t PropagatePhase::addEntity(
+   Satellite* const satellite, const uint64_t& period
+  ) {
+    const std::size_t index =
+     this->addEntity(static_cast<ISim*>(satellite),period);
+    this->kinds.at(index) = Kind::SATELLITE;
+    if(this->periods.at(index)>1) {
+      this->satelliteLookaheads.push_back(*satellite);
+      this->lookaheadIndices.at(index) = this->satelliteLookaheads.size()-1;
+    }
+    return index;
+  }
+
+  std::size_t PropagatePhase::addEntity(
+   GroundStation* const groundStation, const uint64_t& period
+  ) {
+    const std::size_t index =
+     this->addEntity(static_cast<ISim*>(groundStation),period);
+    this->kinds.at(index) = Kind::GROUND_STATION;
+    if(this->periods.at(index)>1) {
+      this->groundStationLookaheads.push_back(*groundStation);
+      this->lookaheadIndices.at(index) =
+       this->groundStationLookaheads.size()-1;
+    }
+    return index;
+  }
+
+  std::size_t PropagatePhase::getEntityCount() const {
+    return this->entities.size();
+  }
+
+  ISim* PropagatePhase::getEntity(const std::size_t& index) const {
+    return this->entities.at(index);
+  }
+
+  uint64_t PropagatePhase::getEntityPeriod(const std::size_t& index) const {
+    return this->periods.at(index);
+  }
+
+  std::array<double,3> PropagatePhase::getECIPosn(
+   const std::size_t& index
+  ) const {
+    if(
+     !this->started || this->periods.at(index)==1 ||
+     this->kinds.at(index)==Kind::OTHER
+    ) {
+      return this->getEntityECIPosn(index);
+    }
+    return util::interpolateLinear(
+     this->prevECIPosns.at(index), this->nextECIPosns.at(index),
+     static_cast<double>(this->stepCount-this->prevSteps.at(index))/
+     static_cast<double>(this->nextSteps.at(index)-this->prevSteps.at(index))
+    );
+  }
+
+  void PropagatePhase::step(Simulation* const simulation) {
+    if(!this->started) {
+      this->start(simulation);
+    }
+    const uint8_t hourStep = simulation->getHourStep();
+    const uint8_t minuteStep = simulation->getMinuteStep();
+    const uint8_t secondStep = simulation->getSecondStep();
+    const uint32_t nanosecondStep = simulation->getNanosecondStep();
+    simulation->getDateTime()->update(
+     hourStep,minuteStep,secondStep,nanosecondStep
+    );
+    const uint64_t nextStepCount = simulation->getStepCount()+1;
+    //// Entities are independent, so they may be updated in parallel
+    simulation->parallelFor(
+     this->entities.size(),
+     [&](std::size_t i) {
+      const uint64_t period = this->periods.at(i);
+      if(period==1) {
+        this->entities.at(i)->update(
+         hourStep,minuteStep,secondStep,nanosecondStep
+        );
+      } else if(this->kinds.at(i)!=Kind::OTHER) {
+        if(nextStepCount==this->nextSteps.at(i)) {
+          this->advanceEntity(simulation,i,0);
+        }
+      } else if(nextStepCount%period==0) {
+        simulation->propagate(this->entities.at(i),period);
+      }
+     }
+    );
+    this->stepCount = nextStepCount;
+  }
+
+  uint64_t PropagatePhase::getQuiescentSteps(
+   Simulation* const /*simulation*/
+  ) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+
+  void PropagatePhase::skip(
+   Simulation* const simulation, const uint64_t& steps
+  ) {
+    if(!this->started) {
+      this->start(simulation);
+    }
+    const uint64_t stepCount = simulation->getStepCount();
+    const uint64_t endStepCount = stepCount+steps;
+    simulation->parallelFor(
+     this->entities.size(),
+     [&](std::size_t i) {
+      //// An entity with a period is only advanced at its period boundaries;
+      //// a lookahead jumps over all but the last boundary at once
+      const uint64_t period = this->periods.at(i);
+      if(period>1 && this->kinds.at(i)!=Kind::OTHER) {
+        if(endStepCount>=this->nextSteps.at(i)) {
+          this->advanceEntity(
+           simulation,i,((endStepCount-this->nextSteps.at(i))/period)*period
+          );
+        }
+        return;
+      }
+      const uint64_t entitySteps =
+       ((stepCount+steps)/period-stepCount/period)*period;
+      if(entitySteps>0) {
+        simulation->propagate(this->entities.at(i),entitySteps);
+      }
+     }
+    );
+    this->stepCount = endStepCount;
+  }
+
+  uint32_t PropagatePhase::getID() const {
+    return this->id;
+  }
+
+  Log* PropagatePhase::getLog() const {
+    return this->log;
+  }
+
+  void PropagatePhase::start(Simulation* const simulation) {
+    const uint64_t stepCount = simulation->getStepCount();
+    for(std::size_t i=0; i<this->entities.size(); i++) {
+      const uint64_t period = this->periods.at(i);
+      if(period==1 || this->kinds.at(i)==Kind::OTHER) {
+        continue;
+      }
+      //// The first update brings the entity to the next period boundary
+      this->prevSteps.at(i) = stepCount;
+      this->nextSteps.at(i) = (stepCount/period+1)*period;
+      this->prevECIPosns.at(i) = this->getEntityECIPosn(i);
+      if(this->kinds.at(i)==Kind::SATELLITE) {
+        Satellite& lookahead =
+         this->satelliteLookaheads.at(this->lookaheadIndices.at(i));
+        lookahead = *static_cast<Satellite*>(this->entities.at(i));
+        simulation->propagate(&lookahead,this->nextSteps.at(i)-stepCount);
+      } else {
+        GroundStation& lookahead =
+         this->groundStationLookaheads.at(this->lookaheadIndices.at(i));
+        lookahead = *static_cast<GroundStation*>(this->entities.at(i));
+        simulation->propagate(&lookahead,this->nextSteps.at(i)-stepCount);
+      }
+      this->nextECIPosns.at(i) = this->getLookaheadECIPosn(i);
+    }
+    this->stepCount = stepCount;
+    this->started = true;
+  }
+
+  void PropagatePhase::advanceEntity(
+   Simulation* const simulation, const std::size_t& index,
+   const uint64_t& steps
+  ) {
+    const uint64_t period = this->periods.at(index);
+    const std::size_t lookaheadIndex = this->lookaheadIndices.at(index);
+    if(this->kinds.at(index)==Kind::SATELLITE) {
+      Satellite& lookahead = this->satelliteLookaheads.at(lookaheadIndex);
+      if(steps>0) {
+        simulation->propagate(&lookahead,steps);
+      }
+      *static_cast<Satellite*>(this->entities.at(index)) = lookahead;
+      simulation->propagate(&lookahead,period);
+    } else {
+      GroundStation& lookahead =
+       this->groundStationLookaheads.at(lookaheadIndex);
+      if(steps>0) {
+        simulation->propagate(&lookahead,steps);
+      }
+      *static_cast<GroundStation*>(this->entities.at(index)) = lookahead;
+      simulation->propagate(&lookahead,period);
+    }
+    this->prevSteps.at(index) = this->nextSteps.at(index)+steps;
+    this->nextSteps.at(index) = this->prevSteps.at(index)+period;
+    this->prevECIPosns.at(index) = this->getEntityECIPosn(index);
+    this->nextECIPosns.at(index) = this->getLookaheadECIPosn(index);
+  }
+
+  std::array<double,3> PropagatePhase::getEntityECIPosn(
+   const std::size_t& index
+  ) const {
+    if(this->kinds.at(index)==Kind::SATELLITE) {
+      return static_cast<Satellite*>(this->entities.at(index))->getECIPosn();
+    } else if(this->kinds.at(index)==Kind::GROUND_STATION) {
+      return
+       static_cast<GroundStation*>(this->entities.at(index))->getECIPosn();
+    }
+    return {0.0,0.0,0.0};
+  }
+
+  std::array<double,3> PropagatePhase::getLookaheadECIPosn(
+   const std::size_t& index
+  ) const {
+    if(this->kinds.at(index)==Kind::SATELLITE) {
+      return this->satelliteLookaheads.at(
+       this->lookaheadIndices.at(index)
+      ).getECIPosn();
+    }
+    return this->groundStationLookaheads.at(
+     this->lookaheadIndices.at(index)
+    ).getECIPosn();
+  }
+}
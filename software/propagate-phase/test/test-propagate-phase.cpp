@@ -0,0 +1,182 @@
+// test-propagate-phase.cpp
+// PropagatePhase class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>          // max
+#include <array>              // array
+#include <cstdint>            // uint64_t
+#include <cstdlib>            // exit, EXIT_SUCCESS
+#include <string>             // to_string
+#include <vector>             // vector
+
+// satsim
+#include <DateTime.hpp>       // DateTime
+#include <GroundStation.hpp>  // GroundStation
+#include <Log.hpp>            // Log
+#include <LogLevel.hpp>       // LogLevel
+#include <PropagatePhase.hpp> // PropagatePhase
+#include <Satellite.hpp>      // Satellite
+#include <Simulation.hpp>     // Simulation
+#include <utilities.hpp>      // magnitude
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  // Steps of 45 seconds; the entity starts one hour after the clock
+  cote::Simulation simulation(
+   cote::DateTime(2022,12,31,23,58,0,0),0,0,45,0,4,0,&log
+  );
+  cote::DateTime entity(2023,1,1,0,58,0,0);
+  // A slow entity updated every 2 steps, i.e. every 90 seconds
+  cote::DateTime slowEntity(2023,1,1,0,58,0,0);
+  cote::PropagatePhase propagatePhase(0,&log);
+  propagatePhase.addEntity(&entity);
+  propagatePhase.addEntity(&slowEntity,2);
+  simulation.addPhase(&propagatePhase);
+  while(simulation.getStepCount()<simulation.getNumSteps()) {
+    simulation.step();
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+     "clock", simulation.getDateTime()->toString()
+    );
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+     "entity", entity.toString()
+    );
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+     "slow-entity", slowEntity.toString()
+    );
+  }
+  // Adaptive mode skips all of the steps at once
+  cote::Simulation adaptive(
+   cote::DateTime(2022,12,31,23,58,0,0),0,0,45,0,5,1,&log
+  );
+  cote::DateTime adaptiveEntity(2023,1,1,0,58,0,0);
+  cote::DateTime adaptiveSlowEntity(2023,1,1,0,58,0,0);
+  cote::PropagatePhase adaptivePhase(1,&log);
+  adaptivePhase.addEntity(&adaptiveEntity);
+  adaptivePhase.addEntity(&adaptiveSlowEntity,2);
+  adaptive.addPhase(&adaptivePhase);
+  adaptive.runAdaptive();
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(adaptive.getStepCount()),
+   "adaptive-clock", adaptive.getDateTime()->toString()
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(adaptive.getStepCount()),
+   "adaptive-entity", adaptiveEntity.toString()
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(adaptive.getStepCount()),
+   "adaptive-slow-entity", adaptiveSlowEntity.toString()
+  );
+  // A satellite and a ground station updated every 60 one-second steps are
+  // interpolated in between; their positions stay much closer to those of the
+  // same entities updated every step than the held positions do, and match
+  // them at every update
+  cote::Simulation orbit(
+   cote::DateTime(1980,10,1,23,41,24,113759999),0,0,1,0,600,2,&log
+  );
+  cote::Satellite satellite(
+   "../../satellite/data/test.tle",orbit.getDateTime(),&log
+  );
+  cote::Satellite slowSatellite(satellite);
+  cote::GroundStation groundStation(
+   40.4433,-79.9436,0.282,orbit.getDateTime(),0,&log
+  );
+  cote::GroundStation slowGroundStation(groundStation);
+  cote::PropagatePhase orbitPhase(2,&log);
+  orbitPhase.addEntity(&satellite);
+  orbitPhase.addEntity(&slowSatellite,60);
+  orbitPhase.addEntity(&groundStation);
+  orbitPhase.addEntity(&slowGroundStation,60);
+  orbit.addPhase(&orbitPhase);
+  double maxSatErrorKm = 0.0;
+  double maxGndErrorKm = 0.0;
+  double maxUpdateErrorKm = 0.0;
+  double maxHeldErrorKm = 0.0;
+  while(orbit.getStepCount()<orbit.getNumSteps()) {
+    orbit.step();
+    const std::array<double,3> satPosn = orbitPhase.getECIPosn(0);
+    const std::array<double,3> slowSatPosn = orbitPhase.getECIPosn(1);
+    const std::array<double,3> gndPosn = orbitPhase.getECIPosn(2);
+    const std::array<double,3> slowGndPosn = orbitPhase.getECIPosn(3);
+    const double satErrorKm = cote::util::magnitude({
+     slowSatPosn.at(0)-satPosn.at(0), slowSatPosn.at(1)-satPosn.at(1),
+     slowSatPosn.at(2)-satPosn.at(2)
+    });
+    const double gndErrorKm = cote::util::magnitude({
+     slowGndPosn.at(0)-gndPosn.at(0), slowGndPosn.at(1)-gndPosn.at(1),
+     slowGndPosn.at(2)-gndPosn.at(2)
+    });
+    const std::array<double,3> heldPosn = slowSatellite.getECIPosn();
+    maxHeldErrorKm = std::max(
+     maxHeldErrorKm,
+     cote::util::magnitude({
+      heldPosn.at(0)-satPosn.at(0), heldPosn.at(1)-satPosn.at(1),
+      heldPosn.at(2)-satPosn.at(2)
+     })
+    );
+    maxSatErrorKm = std::max(maxSatErrorKm,satErrorKm);
+    maxGndErrorKm = std::max(maxGndErrorKm,gndErrorKm);
+    if(orbit.getStepCount()%60==0) {
+      maxUpdateErrorKm = std::max(
+       maxUpdateErrorKm,std::max(satErrorKm,gndErrorKm)
+      );
+    }
+  }
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(orbit.getStepCount()),
+   "interpolated-satellite-max-error-km", std::to_string(maxSatErrorKm)
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(orbit.getStepCount()),
+   "interpolated-ground-station-max-error-km", std::to_string(maxGndErrorKm)
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(orbit.getStepCount()),
+   "held-satellite-max-error-km", std::to_string(maxHeldErrorKm)
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(orbit.getStepCount()),
+   "update-max-error-km", std::to_string(maxUpdateErrorKm)
+  );
+  // Skipping lands between updates and interpolates as stepping does
+  cote::Simulation skipping(
+   cote::DateTime(1980,10,1,23,41,24,113759999),0,0,1,0,600,3,&log
+  );
+  cote::Satellite skippingSatellite(
+   "../../satellite/data/test.tle",skipping.getDateTime(),&log
+  );
+  cote::PropagatePhase skippingPhase(3,&log);
+  skippingPhase.addEntity(&skippingSatellite,60);
+  skippingPhase.skip(&skipping,250);
+  const std::array<double,3> skippedPosn = skippingPhase.getECIPosn(0);
+  cote::Simulation stepping(
+   cote::DateTime(1980,10,1,23,41,24,113759999),0,0,1,0,250,4,&log
+  );
+  cote::Satellite steppingSatellite(
+   "../../satellite/data/test.tle",stepping.getDateTime(),&log
+  );
+  cote::PropagatePhase steppingPhase(4,&log);
+  steppingPhase.addEntity(&steppingSatellite,60);
+  stepping.addPhase(&steppingPhase);
+  stepping.run();
+  const std::array<double,3> steppedPosn = steppingPhase.getECIPosn(0);
+  log.meas(
+   cote::LogLevel::INFO, "250", "skipped-minus-stepped-km",
+   std::to_string(cote::util::magnitude({
+    skippedPosn.at(0)-steppedPosn.at(0), skippedPosn.at(1)-steppedPosn.at(1),
+    skippedPosn.at(2)-steppedPosn.at(2)
+   }))
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
@@ -10,6 +10,7 @@
 #define COTE_SATELLITE_HPP
 
 // Standard library
+#include <array>        // array
 #include <string>       // string
 
 // cote library
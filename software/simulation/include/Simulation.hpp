@@ -0,0 +1,174 @@
+// Simulation.hpp
+// Simulation class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_SIMULATION_HPP
+#define COTE_SIMULATION_HPP
+
+// Standard library
+#include <array>               // array
+#include <cstddef>             // size_t
+#include <cstdint>             // uint8_t, uint32_t, uint64_t
+#include <functional>          // function
+#include <string>              // string
+#include <vector>              // vector
+
+// cote library
+#include <DateTime.hpp>        // DateTime
+#include <EventQueue.hpp>      // EventQueue
+#include <IEventHandler.hpp>   // IEventHandler
+#include <IPhase.hpp>          // IPhase
+#include <IQuiescentPhase.hpp> // IQuiescentPhase
+#include <ISim.hpp>            // ISim
+#include <Log.hpp>             // Log
+#include <ThreadPool.hpp>      // ThreadPool
+
+namespace cote {
+  class Simulation {
+  public:
+    // Reads the start date and time, the time step and the step count from the
+    // date-time.dat, time-step.dat and num-steps.dat files in the directory; a
+    // missing file is logged and leaves a zero time step or step count
+    //// An optional thread-count.dat file sets the thread count; without it
+    //// the simulation runs serially
+    Simulation(
+     const std::string& configurationDirectory, const uint32_t& id=0,
+     Log* const log=NULL
+    );
+    Simulation(
+     const DateTime& dateTime, const uint8_t& hourStep,
+     const uint8_t& minuteStep, const uint8_t& secondStep,
+     const uint32_t& nanosecondStep, const uint64_t& numSteps,
+     const uint32_t& id=0, Log* const log=NULL
+    );
+    Simulation(const Simulation& simulation);
+    Simulation(Simulation&& simulation);
+    virtual ~Simulation();
+    virtual Simulation& operator=(const Simulation& simulation);
+    virtual Simulation& operator=(Simulation&& simulation);
+    virtual Simulation* clone() const;
+    // The simulation clock, to be given to the components of the simulation
+    DateTime* getDateTime();
+    uint8_t getHourStep() const;
+    uint8_t getMinuteStep() const;
+    uint8_t getSecondStep() const;
+    uint32_t getNanosecondStep() const;
+    double getStepSizeS() const;
+    uint64_t getNumSteps() const;
+    uint64_t getStepCount() const;
+    // Step context, computed once at the start of each step so that phases do
+    // not recompute it; describes the clock before any phase advances it
+    //// With a context period greater than one step, the Sun position is only
+    //// computed every context period and linearly interpolated in between;
+    //// PropagatePhase interpolates entity positions in the same way
+    double getJulianDay() const;
+    uint32_t getSecSinceMidnight() const;
+    uint32_t getNanosecond() const;
+    std::array<double,3> getSunECIPosnKm() const;
+    void setContextPeriod(const uint64_t& contextPeriod);
+    uint64_t getContextPeriod() const;
+    // Phases are run in the order added; they are not owned and must outlive
+    // the simulation
+    //// A phase with a period of N steps runs on the steps whose count is a
+    //// multiple of N, so e.g. an orbit phase can run every 1 s while a power
+    //// phase runs every 10 ms; a period of zero is treated as one
+    std::size_t addPhase(IPhase* const phase, const uint64_t& period=1);
+    std::size_t addPhase(
+     IQuiescentPhase* const phase, const uint64_t& period=1
+    );
+    std::size_t getPhaseCount() const;
+    IPhase* getPhase(const std::size_t& index) const;
+    uint64_t getPhasePeriod(const std::size_t& index) const;
+    // The period in steps of the phase being run, i.e. the number of steps
+    // that it should account for; one outside of step
+    uint64_t getPeriod() const;
+    // Runs each phase that is due once and increments the step count
+    void step();
+    // Steps until the step count reaches the number of steps
+    void run();
+    // Adaptive mode: like run, but whenever every phase is quiescent the
+    // simulation skips the quiescent steps at once and then returns to the
+    // base time step; the step count still counts base time steps, so any
+    // logging happens at the same step indices as with run
+    //// A phase that is not an IQuiescentPhase is never quiescent
+    void runAdaptive();
+    uint64_t getSkippedStepCount() const;
+    // While the phases are asked for their quiescent steps, the fewest steps
+    // allowed by the phases asked so far and the steps left; a phase need not
+    // look further ahead. Zero outside of runAdaptive
+    uint64_t getQuiescentStepLimit() const;
+    // Discrete-event mode: instead of running the phases every step, the clock
+    // jumps to the step of each scheduled event in turn and the handler of the
+    // event is called; handlers are not owned and must outlive the simulation
+    //// An event scheduled for a step that has already been reached is due at
+    //// the current step
+    void scheduleEvent(
+     const uint64_t& step, IEventHandler* const handler,
+     const std::size_t& entity=0, const uint32_t& type=0
+    );
+    std::size_t getPendingEventCount() const;
+    uint64_t getHandledEventCount() const;
+    // Handles events until none remain before the number of steps, then
+    // advances the clock and the step count to the number of steps
+    void runEvents();
+    // Advances an entity, e.g. a satellite in an event handler, by a number of
+    // time steps
+    void propagate(ISim* const entity, const uint64_t& steps) const;
+    // Parallel loops for phases, e.g. over satellites; see ThreadPool
+    void setThreadCount(const uint32_t& threadCount);
+    uint32_t getThreadCount() const;
+    void parallelFor(
+     const std::size_t& count, const std::function<void(std::size_t)>& task
+    );
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    static DateTime readDateTime(const std::string& configurationDirectory);
+    static std::string findFile(
+     const std::string& configurationDirectory, const std::string& suffix
+    );
+    static std::array<double,3> calcSunEciPosnKm(const DateTime& dateTime);
+    void updateStepSizeS();
+    void updateContext();
+    void sampleSun();
+    void advanceTo(const uint64_t& step);
+    void runPhases();
+    uint64_t getQuiescentSteps();
+    DateTime dateTime;       // simulation clock
+    uint8_t hourStep;        // time step
+    uint8_t minuteStep;      // time step
+    uint8_t secondStep;      // time step
+    uint32_t nanosecondStep; // time step
+    double stepSizeS;        // time step in seconds
+    uint64_t numSteps;       // steps to run
+    uint64_t stepCount;      // steps completed
+    // Step context
+    double julianDay;
+    uint32_t secSinceMidnight;
+    uint32_t nanosecond;
+    std::array<double,3> sunECIPosnKm;
+    // Multi-rate context
+    uint64_t contextPeriod;              // steps between Sun computations
+    uint64_t sunSampleStep;              // step of sunSampleStartKm
+    std::array<double,3> sunSampleStartKm;
+    std::array<double,3> sunSampleEndKm; // contextPeriod steps later
+    std::vector<IPhase*> phases;   // not owned, should not be deleted
+    std::vector<uint64_t> periods; // one per phase
+    uint64_t period;               // period of the phase being run
+    // One per phase; NULL for a phase that is not an IQuiescentPhase
+    std::vector<IQuiescentPhase*> quiescentPhases;
+    uint64_t skippedStepCount;     // steps skipped by runAdaptive
+    uint64_t quiescentStepLimit;   // see getQuiescentStepLimit
+    EventQueue events;             // discrete-event mode schedule
+    uint64_t handledEventCount;    // events handled by runEvents
+    ThreadPool threadPool;         // parallel loops of the phases
+    uint32_t id;                   // identification number
+    Log* log;                      // singleton, should not be deleted
+  };
+}
+
+#endif
@@ -0,0 +1,560 @@
+// Simulation.cpp
+// Simulation class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>           // max, min
+#include <array>               // array
+#include <cstddef>             // size_t
+#include <cstdint>             // int16_t, uint8_t, uint32_t, uint64_t
+#include <filesystem>          // directory_iterator, path
+#include <fstream>             // ifstream
+#include <functional>          // function
+#include <string>              // getline, stoi, stoul, stoull, string
+#include <system_error>        // error_code
+#include <utility>             // move
+#include <vector>              // vector
+
+// cote
+#include <constants.hpp>       // HOUR_PER_DAY, MIN_PER_HOUR, SEC_PER_MIN, ...
+#include <DateTime.hpp>        // DateTime
+#include <EventQueue.hpp>      // EventQueue
+#include <IEventHandler.hpp>   // IEventHandler
+#include <IPhase.hpp>          // IPhase
+#include <IQuiescentPhase.hpp> // IQuiescentPhase
+#include <ISim.hpp>            // ISim
+#include <Log.hpp>             // Log
+#include <LogLevel.hpp>        // LogLevel
+#include <Simulation.hpp>      // Simulation
+#include <ThreadPool.hpp>      // ThreadPool
+#include <utilities.hpp>       // calcJulianDayFromYMD, interpolateLinear, ...
+
+namespace cote {
+  Simulation::Simulation(
+   const std::string& configurationDirectory, const uint32_t& id,
+   Log* const log
+  ) : dateTime(Simulation::readDateTime(configurationDirectory)), hourStep(0),
+   minuteStep(0), secondStep(0), nanosecondStep(0), numSteps(0),
+   stepCount(0), contextPeriod(1), sunSampleStep(0), period(1),
+   skippedStepCount(0), quiescentStepLimit(0), events(id,log),
+   handledEventCount(0), threadPool(1,id,log), id(id), log(log) {
+    const std::string dateTimeFile =
+     Simulation::findFile(configurationDirectory,"date-time.dat");
+    const std::string timeStepFile =
+     Simulation::findFile(configurationDirectory,"time-step.dat");
+    const std::string numStepsFile =
+     Simulation::findFile(configurationDirectory,"num-steps.dat");
+    const std::string threadCountFile =
+     Simulation::findFile(configurationDirectory,"thread-count.dat");
+    if(timeStepFile!="") {
+      std::ifstream timeStepHandle(timeStepFile);
+      std::string line = "";
+      std::getline(timeStepHandle,line); // Read header
+      std::getline(timeStepHandle,line); // Read values
+      timeStepHandle.close();
+      this->hourStep = static_cast<uint8_t>(std::stoi(line.substr(0,2)));
+      this->minuteStep = static_cast<uint8_t>(std::stoi(line.substr(3,2)));
+      this->secondStep = static_cast<uint8_t>(std::stoi(line.substr(6,2)));
+      this->nanosecondStep =
+       static_cast<uint32_t>(std::stoul(line.substr(9,9)));
+    }
+    if(numStepsFile!="") {
+      std::ifstream numStepsHandle(numStepsFile);
+      std::string line = "";
+      std::getline(numStepsHandle,line); // Read header
+      std::getline(numStepsHandle,line); // Read values
+      numStepsHandle.close();
+      this->numSteps = static_cast<uint64_t>(std::stoull(line.substr(0,19)));
+    }
+    if(threadCountFile!="") {
+      std::ifstream threadCountHandle(threadCountFile);
+      std::string line = "";
+      std::getline(threadCountHandle,line); // Read header
+      std::getline(threadCountHandle,line); // Read values
+      threadCountHandle.close();
+      this->setThreadCount(static_cast<uint32_t>(std::stoul(line)));
+    }
+    if(this->log!=NULL) {
+      const std::vector<std::string> files = {
+       dateTimeFile, timeStepFile, numStepsFile
+      };
+      const std::vector<std::string> names = {
+       "date-time.dat", "time-step.dat", "num-steps.dat"
+      };
+      for(std::size_t i=0; i<files.size(); i++) {
+        if(files.at(i)=="") {
+          this->log->meas(
+           LogLevel::ERROR, std::to_string(this->id),
+           "simulation-missing-file", names.at(i)
+          );
+        }
+      }
+    }
+    this->updateStepSizeS();
+    this->updateContext();
+  }
+
+  Simulation::Simulation(
+   const DateTime& dateTime, const uint8_t& hourStep,
+   const uint8_t& minuteStep, const uint8_t& secondStep,
+   const uint32_t& nanosecondStep, const uint64_t& numSteps,
+   const uint32_t& id, Log* const log
+  ) : dateTime(dateTime), hourStep(hourStep), minuteStep(minuteStep),
+   secondStep(secondStep), nanosecondStep(nanosecondStep),
+   numSteps(numSteps), stepCount(0), contextPeriod(1), sunSampleStep(0),
+   period(1), skippedStepCount(0), quiescentStepLimit(0), events(id,log),
+   handledEventCount(0), threadPool(1,id,log), id(id), log(log) {
+    this->updateStepSizeS();
+    this->updateContext();
+  }
+
+  Simulation::Simulation(const Simulation& simulation) :
+   dateTime(simulation.dateTime), hourStep(simulation.getHourStep()),
+   minuteStep(simulation.getMinuteStep()),
+   secondStep(simulation.getSecondStep()),
+   nanosecondStep(simulation.getNanosecondStep()),
+   stepSizeS(simulation.getStepSizeS()), numSteps(simulation.getNumSteps()),
+   stepCount(simulation.getStepCount()), julianDay(simulation.getJulianDay()),
+   secSinceMidnight(simulation.getSecSinceMidnight()),
+   nanosecond(simulation.getNanosecond()),
+   sunECIPosnKm(simulation.getSunECIPosnKm()),
+   contextPeriod(simulation.getContextPeriod()),
+   sunSampleStep(simulation.sunSampleStep),
+   sunSampleStartKm(simulation.sunSampleStartKm),
+   sunSampleEndKm(simulation.sunSampleEndKm), phases(simulation.phases),
+   periods(simulation.periods), period(simulation.getPeriod()),
+   quiescentPhases(simulation.quiescentPhases),
+   skippedStepCount(simulation.getSkippedStepCount()),
+   quiescentStepLimit(simulation.getQuiescentStepLimit()),
+   events(simulation.events),
+   handledEventCount(simulation.getHandledEventCount()),
+   threadPool(simulation.threadPool),
+   id(simulation.getID()), log(simulation.getLog()) {}
+
+  Simulation::Simulation(Simulation&& simulation) :
+   dateTime(std::move(simulation.dateTime)), hourStep(simulation.hourStep),
+   minuteStep(simulation.minuteStep), secondStep(simulation.secondStep),
+   nanosecondStep(simulation.nanosecondStep),
+   stepSizeS(simulation.stepSizeS), numSteps(simulation.numSteps),
+   stepCount(simulation.stepCount), julianDay(simulation.julianDay),
+   secSinceMidnight(simulation.secSinceMidnight),
+   nanosecond(simulation.nanosecond), sunECIPosnKm(simulation.sunECIPosnKm),
+   contextPeriod(simulation.contextPeriod),
+   sunSampleStep(simulation.sunSampleStep),
+   sunSampleStartKm(simulation.sunSampleStartKm),
+   sunSampleEndKm(simulation.sunSampleEndKm),
+   phases(std::move(simulation.phases)),
+   periods(std::move(simulation.periods)), period(simulation.period),
+   quiescentPhases(std::move(simulation.quiescentPhases)),
+   skippedStepCount(simulation.skippedStepCount),
+   quiescentStepLimit(simulation.quiescentStepLimit),
+   events(std::move(simulation.events)),
+   handledEventCount(simulation.handledEventCount),
+   threadPool(std::move(simulation.threadPool)), id(simulation.id),
+   log(simulation.log) {
+    simulation.log = NULL;
+  }
+
+  Simulation::~Simulation() {
+    this->log = NULL;
+  }
+
+  Simulation& Simulation::operator=(const Simulation& simulation) {
+    Simulation temp(simulation);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  Simulation& Simulation::operator=(Simulation&& simulation) {
+    this->dateTime           = std::move(simulation.dateTime);
+    this->hourStep           = simulation.hourStep;
+    this->minuteStep         = simulation.minuteStep;
+    this->secondStep         = simulation.secondStep;
+    this->nanosecondStep     = simulation.nanosecondStep;
+    this->stepSizeS          = simulation.stepSizeS;
+    this->numSteps           = simulation.numSteps;
+    this->stepCount          = simulation.stepCount;
+    this->julianDay          = simulation.julianDay;
+    this->secSinceMidnight   = simulation.secSinceMidnight;
+    this->nanosecond         = simulation.nanosecond;
+    this->sunECIPosnKm       = simulation.sunECIPosnKm;
+    this->contextPeriod      = simulation.contextPeriod;
+    this->sunSampleStep      = simulation.sunSampleStep;
+    this->sunSampleStartKm   = simulation.sunSampleStartKm;
+    this->sunSampleEndKm     = simulation.sunSampleEndKm;
+    this->phases             = std::move(simulation.phases);
+    this->periods            = std::move(simulation.periods);
+    this->period             = simulation.period;
+    this->quiescentPhases    = std::move(simulation.quiescentPhases);
+    this->skippedStepCount   = simulation.skippedStepCount;
+    this->quiescentStepLimit = simulation.quiescentStepLimit;
+    this->events             = std::move(simulation.events);
+    this->handledEventCount  = simulation.handledEventCount;
+    this->threadPool         = std::move(simulation.threadPool);
+    this->id                 = simulation.id;
+    this->log                = simulation.log;
+    simulation.log           = NULL;
+    return *this;
+  }
+
+  Simulation* Simulation::clone() const {
+    return new Simulation(*this);
+  }
+
+  DateTime* Simulation::getDateTime() {
+    return &(this->dateTime);
+  }
+
+  uint8_t Simulation::getHourStep() const {
+    return this->hourStep;
+  }
+
+  uint8_t Simulation::getMinuteStep() const {
+    return this->minuteStep;
+  }
+
+  uint8_t Simulation::getSecondStep() const {
+    return this->secondStep;
+  }
+
+  uint32_t Simulation::getNanosecondStep() const {
+    return this->nanosecondStep;
+  }
+
+  double Simulation::getStepSizeS() const {
+    return this->stepSizeS;
+  }
+
+  uint64_t Simulation::getNumSteps() const {
+    return this->numSteps;
+  }
+
+  uint64_t Simulation::getStepCount() const {
+    return this->stepCount;
+  }
+
+  double Simulation::getJulianDay() const {
+    return this->julianDay;
+  }
+
+  uint32_t Simulation::getSecSinceMidnight() const {
+    return this->secSinceMidnight;
+  }
+
+  uint32_t Simulation::getNanosecond() const {
+    return this->nanosecond;
+  }
+
+  std::array<double,3> Simulation::getSunECIPosnKm() const {
+    return this->sunECIPosnKm;
+  }
+
+  void Simulation::setContextPeriod(const uint64_t& contextPeriod) {
+    this->contextPeriod = std::max(contextPeriod,static_cast<uint64_t>(1));
+    this->sampleSun();
+    this->updateContext();
+  }
+
+  uint64_t Simulation::getContextPeriod() const {
+    return this->contextPeriod;
+  }
+
+  std::size_t Simulation::addPhase(
+   IPhase* const phase, const uint64_t& period
+  ) {
+    this->phases.push_back(phase);
+    this->periods.push_back(std::max(period,static_cast<uint64_t>(1)));
+    this->quiescentPhases.push_back(NULL);
+    return this->phases.size()-1;
+  }
+
+  std::size_t Simulation::addPhase(
+   IQuiescentPhase* const phase, const uint64_t& period
+  ) {
+    const std::size_t index =
+     this->addPhase(static_cast<IPhase*>(phase),period);
+    this->quiescentPhases.at(index) = phase;
+    return index;
+  }
+
+  std::size_t Simulation::getPhaseCount() const {
+    return this->phases.size();
+  }
+
+  IPhase* Simulation::getPhase(const std::size_t& index) const {
+    return this->phases.at(index);
+  }
+
+  uint64_t Simulation::getPhasePeriod(const std::size_t& index) const {
+    return this->periods.at(index);
+  }
+
+  uint64_t Simulation::getPeriod() const {
+    return this->period;
+  }
+
+  void Simulation::step() {
+    this->updateContext();
+    this->runPhases();
+  }
+
+  void Simulation::run() {
+    while(this->stepCount<this->numSteps) {
+      this->step();
+    }
+  }
+
+  void Simulation::runAdaptive() {
+    while(this->stepCount<this->numSteps) {
+      this->updateContext();
+      const uint64_t steps = this->getQuiescentSteps();
+      if(steps<=1) {
+        this->runPhases();
+      } else {
+        for(std::size_t i=0; i<this->quiescentPhases.size(); i++) {
+          this->period = this->periods.at(i);
+          this->quiescentPhases.at(i)->skip(this,steps);
+        }
+        this->period = 1;
+        this->advanceTo(this->stepCount+steps);
+        this->skippedStepCount += steps;
+      }
+    }
+  }
+
+  uint64_t Simulation::getSkippedStepCount() const {
+    return this->skippedStepCount;
+  }
+
+  uint64_t Simulation::getQuiescentStepLimit() const {
+    return this->quiescentStepLimit;
+  }
+
+  void Simulation::scheduleEvent(
+   const uint64_t& step, IEventHandler* const handler,
+   const std::size_t& entity, const uint32_t& type
+  ) {
+    this->events.push(std::max(step,this->stepCount),handler,entity,type);
+  }
+
+  std::size_t Simulation::getPendingEventCount() const {
+    return this->events.getSize();
+  }
+
+  uint64_t Simulation::getHandledEventCount() const {
+    return this->handledEventCount;
+  }
+
+  void Simulation::runEvents() {
+    while(
+     !this->events.isEmpty() &&
+     this->events.getNextEvent().step<this->numSteps
+    ) {
+      const EventQueue::Event event = this->events.pop();
+      if(event.step>this->stepCount) {
+        this->advanceTo(event.step);
+        this->updateContext();
+      }
+      event.handler->handleEvent(this,event.entity,event.type);
+      this->handledEventCount += 1;
+    }
+    if(this->stepCount<this->numSteps) {
+      this->advanceTo(this->numSteps);
+      this->updateContext();
+    }
+  }
+
+  void Simulation::propagate(ISim* const entity, const uint64_t& steps) const {
+    const uint64_t NS_PER_MIN =
+     static_cast<uint64_t>(cnst::SEC_PER_MIN)*
+     static_cast<uint64_t>(cnst::NS_PER_SEC);
+    const uint64_t NS_PER_HOUR =
+     static_cast<uint64_t>(cnst::MIN_PER_HOUR)*NS_PER_MIN;
+    const uint64_t stepNs =
+     static_cast<uint64_t>(this->hourStep)*NS_PER_HOUR+
+     static_cast<uint64_t>(this->minuteStep)*NS_PER_MIN+
+     static_cast<uint64_t>(this->secondStep)*
+     static_cast<uint64_t>(cnst::NS_PER_SEC)+
+     static_cast<uint64_t>(this->nanosecondStep);
+    //// Updates accept less than one day at a time
+    uint64_t remainingNs = steps*stepNs;
+    while(remainingNs>0) {
+      const uint64_t updateNs = std::min(
+       remainingNs,static_cast<uint64_t>(cnst::HOUR_PER_DAY)*NS_PER_HOUR-1
+      );
+      entity->update(
+       static_cast<uint8_t>(updateNs/NS_PER_HOUR),
+       static_cast<uint8_t>((updateNs%NS_PER_HOUR)/NS_PER_MIN),
+       static_cast<uint8_t>(
+        (updateNs%NS_PER_MIN)/static_cast<uint64_t>(cnst::NS_PER_SEC)
+       ),
+       static_cast<uint32_t>(
+        updateNs%static_cast<uint64_t>(cnst::NS_PER_SEC)
+       )
+      );
+      remainingNs -= updateNs;
+    }
+  }
+
+  void Simulation::setThreadCount(const uint32_t& threadCount) {
+    this->threadPool = ThreadPool(threadCount,this->id,this->log);
+  }
+
+  uint32_t Simulation::getThreadCount() const {
+    return this->threadPool.getThreadCount();
+  }
+
+  void Simulation::parallelFor(
+   const std::size_t& count, const std::function<void(std::size_t)>& task
+  ) {
+    this->threadPool.parallelFor(count,task);
+  }
+
+  uint32_t Simulation::getID() const {
+    return this->id;
+  }
+
+  Log* Simulation::getLog() const {
+    return this->log;
+  }
+
+  DateTime Simulation::readDateTime(
+   const std::string& configurationDirectory
+  ) {
+    const std::string dateTimeFile =
+     Simulation::findFile(configurationDirectory,"date-time.dat");
+    if(dateTimeFile=="") {
+      return DateTime(2000,1,1,0,0,0,0);
+    }
+    std::ifstream dateTimeHandle(dateTimeFile);
+    std::string line = "";
+    std::getline(dateTimeHandle,line); // Read header
+    std::getline(dateTimeHandle,line); // Read values
+    dateTimeHandle.close();
+    const int16_t year = static_cast<int16_t>(std::stoi(line.substr(0,4)));
+    const uint8_t month = static_cast<uint8_t>(std::stoi(line.substr(5,2)));
+    const uint8_t day = static_cast<uint8_t>(std::stoi(line.substr(8,2)));
+    const uint8_t hour = static_cast<uint8_t>(std::stoi(line.substr(11,2)));
+    const uint8_t minute = static_cast<uint8_t>(std::stoi(line.substr(14,2)));
+    const uint8_t second = static_cast<uint8_t>(std::stoi(line.substr(17,2)));
+    const uint32_t ns = static_cast<uint32_t>(std::stoul(line.substr(20,9)));
+    return DateTime(year,month,day,hour,minute,second,ns);
+  }
+
+  std::string Simulation::findFile(
+   const std::string& configurationDirectory, const std::string& suffix
+  ) {
+    std::error_code errorCode;
+    std::filesystem::directory_iterator it(configurationDirectory,errorCode);
+    while(!errorCode && it!=std::filesystem::end(it)) {
+      const std::string pathStr = it->path().string();
+      if(
+       pathStr.size()>=suffix.size() &&
+       pathStr.substr(pathStr.size()-suffix.size())==suffix
+      ) {
+        return pathStr;
+      }
+      it.increment(errorCode);
+    }
+    return "";
+  }
+
+  std::array<double,3> Simulation::calcSunEciPosnKm(const DateTime& dateTime) {
+    return util::calcSunEciPosnKm(
+     util::calcJulianDayFromYMD(
+      dateTime.getYear(), dateTime.getMonth(), dateTime.getDay()
+     ),
+     util::calcSecSinceMidnight(
+      dateTime.getHour(), dateTime.getMinute(), dateTime.getSecond()
+     ),
+     dateTime.getNanosecond()
+    );
+  }
+
+  void Simulation::updateStepSizeS() {
+    this->stepSizeS =
+     (
+      static_cast<double>(this->hourStep)*
+      static_cast<double>(cnst::MIN_PER_HOUR)+
+      static_cast<double>(this->minuteStep)
+     )*static_cast<double>(cnst::SEC_PER_MIN)+
+     static_cast<double>(this->secondStep)+
+     static_cast<double>(this->nanosecondStep)/
+     static_cast<double>(cnst::NS_PER_SEC);
+  }
+
+  void Simulation::advanceTo(const uint64_t& step) {
+    this->propagate(&(this->dateTime),step-this->stepCount);
+    this->stepCount = step;
+  }
+
+  void Simulation::runPhases() {
+    for(std::size_t i=0; i<this->phases.size(); i++) {
+      if(this->stepCount%this->periods.at(i)==0) {
+        this->period = this->periods.at(i);
+        this->phases.at(i)->step(this);
+      }
+    }
+    this->period = 1;
+    this->stepCount += 1;
+  }
+
+  uint64_t Simulation::getQuiescentSteps() {
+    uint64_t steps = this->numSteps-this->stepCount;
+    for(std::size_t i=0; i<this->quiescentPhases.size() && steps>1; i++) {
+      if(this->quiescentPhases.at(i)==NULL) {
+        steps = 0;
+      } else {
+        this->period = this->periods.at(i);
+        this->quiescentStepLimit = steps;
+        steps = std::min(
+         steps,this->quiescentPhases.at(i)->getQuiescentSteps(this)
+        );
+      }
+    }
+    this->period = 1;
+    this->quiescentStepLimit = 0;
+    return steps;
+  }
+
+  void Simulation::updateContext() {
+    this->julianDay = util::calcJulianDayFromYMD(
+     this->dateTime.getYear(), this->dateTime.getMonth(),
+     this->dateTime.getDay()
+    );
+    this->secSinceMidnight = util::calcSecSinceMidnight(
+     this->dateTime.getHour(), this->dateTime.getMinute(),
+     this->dateTime.getSecond()
+    );
+    this->nanosecond = this->dateTime.getNanosecond();
+    if(this->contextPeriod==1) {
+      this->sunECIPosnKm = util::calcSunEciPosnKm(
+       this->julianDay, this->secSinceMidnight, this->nanosecond
+      );
+    } else {
+      if(
+       this->stepCount<this->sunSampleStep ||
+       this->stepCount>=this->sunSampleStep+this->contextPeriod
+      ) {
+        this->sampleSun();
+      }
+      this->sunECIPosnKm = util::interpolateLinear(
+       this->sunSampleStartKm, this->sunSampleEndKm,
+       static_cast<double>(this->stepCount-this->sunSampleStep)/
+       static_cast<double>(this->contextPeriod)
+      );
+    }
+  }
+
+  void Simulation::sampleSun() {
+    DateTime sampleDateTime(this->dateTime);
+    this->sunSampleStartKm = Simulation::calcSunEciPosnKm(sampleDateTime);
+    this->propagate(&sampleDateTime,this->contextPeriod);
+    this->sunSampleEndKm = Simulation::calcSunEciPosnKm(sampleDateTime);
+    this->sunSampleStep = this->stepCount;
+  }
+}
@@ -0,0 +1,231 @@
+// test-simulation.cpp
+// Simulation class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>             // size_t
+#include <cstdint>             // uint32_t, uint64_t
+#include <cstdlib>             // exit, EXIT_SUCCESS
+#include <string>              // string, to_string
+#include <vector>              // vector
+
+// satsim
+#include <DateTime.hpp>        // DateTime
+#include <IEventHandler.hpp>   // IEventHandler
+#include <IPhase.hpp>          // IPhase
+#include <IQuiescentPhase.hpp> // IQuiescentPhase
+#include <Log.hpp>             // Log
+#include <LogLevel.hpp>        // LogLevel
+#include <Simulation.hpp>      // Simulation
+
+// Logs the step context and then advances the clock
+class ClockPhase : public cote::IPhase {
+public:
+  void step(cote::Simulation* const simulation) override {
+    const std::string step = std::to_string(simulation->getStepCount());
+    cote::Log* log = simulation->getLog();
+    log->meas(
+     cote::LogLevel::INFO, step, "date-time",
+     simulation->getDateTime()->toString()
+    );
+    log->meas(
+     cote::LogLevel::INFO, step, "sec-since-midnight",
+     std::to_string(simulation->getSecSinceMidnight())
+    );
+    log->meas(
+     cote::LogLevel::INFO, step, "sun-x-km",
+     std::to_string(simulation->getSunECIPosnKm().at(0))
+    );
+    simulation->getDateTime()->update(
+     simulation->getHourStep(), simulation->getMinuteStep(),
+     simulation->getSecondStep(), simulation->getNanosecondStep()
+    );
+  }
+};
+
+// Records the order in which phases run
+class OrderPhase : public cote::IPhase {
+public:
+  OrderPhase(const std::string& name) : name(name) {}
+  void step(cote::Simulation* const simulation) override {
+    simulation->getLog()->meas(
+     cote::LogLevel::INFO, std::to_string(simulation->getStepCount()),
+     "phase", this->name
+    );
+  }
+private:
+  std::string name;
+};
+
+// Logs the date and time every 25 steps and is quiescent in between; counts
+// the steps that it accounts for and keeps the last quiescent step limit
+class TickPhase : public cote::IQuiescentPhase {
+public:
+  TickPhase() : count(0), limit(0) {}
+  void step(cote::Simulation* const simulation) override {
+    if(simulation->getStepCount()%25==0) {
+      simulation->getLog()->meas(
+       cote::LogLevel::INFO, std::to_string(simulation->getStepCount()),
+       "tick-date-time", simulation->getDateTime()->toString()
+      );
+    }
+    simulation->getDateTime()->update(
+     simulation->getHourStep(), simulation->getMinuteStep(),
+     simulation->getSecondStep(), simulation->getNanosecondStep()
+    );
+    this->count += 1;
+  }
+  uint64_t getQuiescentSteps(cote::Simulation* const simulation) override {
+    this->limit = simulation->getQuiescentStepLimit();
+    const uint64_t stepsPastTick = simulation->getStepCount()%25;
+    return stepsPastTick==0 ? 0 : 25-stepsPastTick;
+  }
+  void skip(
+   cote::Simulation* const /*simulation*/, const uint64_t& steps
+  ) override {
+    this->count += steps;
+  }
+  uint64_t getCount() const {
+    return this->count;
+  }
+  uint64_t getLimit() const {
+    return this->limit;
+  }
+private:
+  uint64_t count;
+  uint64_t limit;
+};
+
+// Logs each event and schedules the next one for the same entity; the type is
+// used as the number of steps between events
+class TickHandler : public cote::IEventHandler {
+public:
+  void handleEvent(
+   cote::Simulation* const simulation, const std::size_t& entity,
+   const uint32_t& type
+  ) override {
+    const std::string step = std::to_string(simulation->getStepCount());
+    cote::Log* log = simulation->getLog();
+    log->meas(
+     cote::LogLevel::INFO, step, "event-entity", std::to_string(entity)
+    );
+    log->meas(
+     cote::LogLevel::INFO, step, "event-date-time",
+     simulation->getDateTime()->toString()
+    );
+    simulation->scheduleEvent(
+     simulation->getStepCount()+type,this,entity,type
+    );
+  }
+};
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {
+   cote::LogLevel::INFO, cote::LogLevel::ERROR
+  };
+  cote::Log log(levels,"../test");
+  // One step of 1 minute and 30 seconds, 10 steps
+  cote::Simulation simulation(
+   cote::DateTime(2022,1,1,0,0,0,0),0,1,30,0,10,0,&log
+  );
+  ClockPhase clockPhase;
+  OrderPhase power("power");
+  OrderPhase payload("payload");
+  simulation.addPhase(&power);
+  simulation.addPhase(&payload);
+  simulation.addPhase(&clockPhase);
+  log.meas(
+   cote::LogLevel::INFO, "0", "step-size-s",
+   std::to_string(simulation.getStepSizeS())
+  );
+  simulation.run();
+  log.meas(
+   cote::LogLevel::INFO, "10", "step-count",
+   std::to_string(simulation.getStepCount())
+  );
+  // A missing configuration directory is logged and runs no steps
+  cote::Simulation missing("../nonexistent-configuration",1,&log);
+  missing.addPhase(&clockPhase);
+  missing.run();
+  log.meas(
+   cote::LogLevel::INFO, "0", "missing-num-steps",
+   std::to_string(missing.getNumSteps())
+  );
+  // Multi-rate: power every step, orbit every 4 steps and a Sun position
+  // that is only computed every 5 steps
+  cote::Simulation multiRate(
+   cote::DateTime(2022,1,1,0,0,0,0),0,1,30,0,10,3,&log
+  );
+  OrderPhase fast("fast");
+  OrderPhase slow("slow");
+  multiRate.addPhase(&fast);
+  multiRate.addPhase(&slow,4);
+  multiRate.addPhase(&clockPhase);
+  multiRate.setContextPeriod(5);
+  multiRate.run();
+  log.meas(
+   cote::LogLevel::INFO, "0", "slow-period",
+   std::to_string(multiRate.getPhasePeriod(1))
+  );
+  // Adaptive mode: logs at the same steps as stepping, skipping in between
+  cote::Simulation adaptive(
+   cote::DateTime(2022,1,1,0,0,0,0),0,0,1,0,100,4,&log
+  );
+  TickPhase tickPhase;
+  adaptive.addPhase(&tickPhase);
+  adaptive.runAdaptive();
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(adaptive.getStepCount()),
+   "adaptive-skipped", std::to_string(adaptive.getSkippedStepCount())
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(adaptive.getStepCount()),
+   "adaptive-count", std::to_string(tickPhase.getCount())
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(adaptive.getStepCount()),
+   "adaptive-date-time", adaptive.getDateTime()->toString()
+  );
+  //// The last check was at step 76, with 24 steps left
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(adaptive.getStepCount()),
+   "adaptive-limit", std::to_string(tickPhase.getLimit())
+  );
+  // Parallel loops give the same results as serial loops
+  adaptive.setThreadCount(4);
+  std::vector<uint64_t> squares(100,0);
+  adaptive.parallelFor(
+   squares.size(), [&](std::size_t i) {squares.at(i) = i*i;}
+  );
+  uint64_t squareSum = 0;
+  for(std::size_t i=0; i<squares.size(); i++) {
+    squareSum += squares.at(i);
+  }
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(adaptive.getThreadCount()),
+   "parallel-square-sum", std::to_string(squareSum)
+  );
+  // Discrete-event mode: 10^8 steps of 1 millisecond, but only 7 events
+  cote::Simulation events(
+   cote::DateTime(2022,1,1,0,0,0,0),0,0,0,1000000,100000000,2,&log
+  );
+  TickHandler tickHandler;
+  events.scheduleEvent(0,&tickHandler,0,40000000);
+  events.scheduleEvent(0,&tickHandler,1,30000000);
+  events.runEvents();
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(events.getStepCount()),
+   "events-handled", std::to_string(events.getHandledEventCount())
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(events.getStepCount()),
+   "events-date-time", events.getDateTime()->toString()
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
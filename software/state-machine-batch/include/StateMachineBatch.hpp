@@ -0,0 +1,104 @@
+// StateMachineBatch.hpp
+// StateMachineBatch class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_STATE_MACHINE_BATCH_HPP
+#define COTE_STATE_MACHINE_BATCH_HPP
+
+// Standard library
+#include <cstddef>                    // size_t
+#include <cstdint>                    // uint8_t, uint32_t
+#include <memory>                     // shared_ptr
+#include <string>                     // string
+#include <vector>                     // vector
+
+// cote
+#include <Log.hpp>                    // Log
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+
+namespace cote {
+  class StateMachineBatch {
+  public:
+    typedef StateMachineDefinition::VarHandle VarHandle;
+    typedef StateMachineDefinition::StateId StateId;
+    // Every instance follows the same definition, e.g. the camera of each
+    // satellite; instances are addressed by the dense index returned from
+    // addInstance
+    StateMachineBatch(
+     std::shared_ptr<const StateMachineDefinition> definition,
+     const uint32_t& id=0, Log* const log=NULL
+    );
+    StateMachineBatch(const StateMachineBatch& stateMachineBatch);
+    StateMachineBatch(StateMachineBatch&& stateMachineBatch);
+    virtual ~StateMachineBatch();
+    virtual StateMachineBatch& operator=(
+     const StateMachineBatch& stateMachineBatch
+    );
+    virtual StateMachineBatch& operator=(StateMachineBatch&& stateMachineBatch);
+    virtual StateMachineBatch* clone() const;
+    std::shared_ptr<const StateMachineDefinition> getDefinition() const;
+    // Adds an instance with the initial variable values and initial state of
+    // the definition and returns the index of the instance
+    std::size_t addInstance();
+    std::size_t getInstanceCount() const;
+    double getVariableValue(
+     const std::size_t& index, const VarHandle& variable
+    ) const;
+    void setVariableValue(
+     const std::size_t& index, const VarHandle& variable, const double& value
+    );
+    // The values of the variable indexed by instance, e.g. to set the node
+    // voltage of every satellite at once
+    const std::vector<double>& getVariableValues(const VarHandle& variable)
+     const;
+    void setVariableValues(
+     const VarHandle& variable, const std::vector<double>& values
+    );
+    StateId getCurrentStateId(const std::size_t& index) const;
+    std::string getCurrentState(const std::size_t& index) const;
+    // Applies exit and enter actions as StateMachine::setCurrentState does;
+    // the state must be named by the definition
+    void setCurrentState(const std::size_t& index, const StateId& state);
+    // Advances every instance as StateMachine::updateState would and returns
+    // the number of instances that took a transition
+    std::size_t updateState();
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    typedef StateMachineDefinition::Opcode Opcode;
+    typedef StateMachineDefinition::Comparison Comparison;
+    typedef StateMachineDefinition::Action Action;
+    typedef StateMachineDefinition::Condition Condition;
+    typedef StateMachineDefinition::Transition Transition;
+    // Applies the actions to the instances whose mask entry is 1
+    void applyActions(
+     const std::vector<Action>& actions, const std::vector<uint8_t>& mask
+    );
+    // Applies the actions to a single instance
+    void applyActions(
+     const std::vector<Action>& actions, const std::size_t& index
+    );
+    // definition: shared with every state machine of the same configuration
+    std::shared_ptr<const StateMachineDefinition> definition;
+    // Instance state; element i of each inner vector belongs to instance i
+    //   variableValues: indexed by VarHandle, then by instance
+    //   currentStates: the StateId of the current state of each instance
+    std::vector<std::vector<double>> variableValues;
+    std::vector<StateId> currentStates;
+    // Scratch masks used by updateState, one entry per instance
+    //   pending: 1 if the instance has not yet taken a transition
+    //   candidate: 1 if the instance is in the state being evaluated
+    //   fired: 1 if the instance takes the transition being evaluated
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> candidate;
+    std::vector<uint8_t> fired;
+    uint32_t id; // identification number
+    Log* log;    // singleton, should not be deleted
+  };
+}
+
+#endif
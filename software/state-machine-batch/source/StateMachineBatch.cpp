@@ -0,0 +1,307 @@
+// StateMachineBatch.cpp
+// StateMachineBatch class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+//
+// The variables and current states of all instances are stored as one
+// contiguous array per quantity. updateState walks the states and
+// transitions of the shared definition once and, for each transition,
+// evaluates its conditions for every instance with simple branch-free loops
+// that build a mask; actions are applied as masked selects. Compilers can
+// vectorize these loops, so the cost of stepping scales with the number of
+// instances like a data-parallel kernel rather than one call per object.
+
+// Standard library
+#include <cstddef>                    // size_t
+#include <cstdint>                    // uint8_t, uint32_t
+#include <memory>                     // shared_ptr
+#include <string>                     // string
+#include <utility>                    // move
+#include <vector>                     // vector
+
+// cote
+#include <Log.hpp>                    // Log
+#include <StateMachineBatch.hpp>      // StateMachineBatch
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+
+namespace cote {
+  StateMachineBatch::StateMachineBatch(
+   std::shared_ptr<const StateMachineDefinition> definition,
+   const uint32_t& id, Log* const log
+  ) : definition(definition),
+   variableValues(definition->getVariableCount()), id(id), log(log) {}
+
+  StateMachineBatch::StateMachineBatch(
+   const StateMachineBatch& stateMachineBatch
+  ) : definition(stateMachineBatch.getDefinition()),
+   variableValues(stateMachineBatch.variableValues),
+   currentStates(stateMachineBatch.currentStates),
+   pending(stateMachineBatch.pending), candidate(stateMachineBatch.candidate),
+   fired(stateMachineBatch.fired), id(stateMachineBatch.getID()),
+   log(stateMachineBatch.getLog()) {}
+
+  StateMachineBatch::StateMachineBatch(StateMachineBatch&& stateMachineBatch) :
+   definition(std::move(stateMachineBatch.definition)),
+   variableValues(std::move(stateMachineBatch.variableValues)),
+   currentStates(std::move(stateMachineBatch.currentStates)),
+   pending(std::move(stateMachineBatch.pending)),
+   candidate(std::move(stateMachineBatch.candidate)),
+   fired(std::move(stateMachineBatch.fired)), id(stateMachineBatch.id),
+   log(stateMachineBatch.log) {
+    stateMachineBatch.log = NULL;
+  }
+
+  StateMachineBatch::~StateMachineBatch() {
+    this->log = NULL;
+  }
+
+  StateMachineBatch& StateMachineBatch::operator=(
+   const StateMachineBatch& stateMachineBatch
+  ) {
+    StateMachineBatch temp(stateMachineBatch);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  StateMachineBatch& StateMachineBatch::operator=(
+   StateMachineBatch&& stateMachineBatch
+  ) {
+    this->definition     = std::move(stateMachineBatch.definition);
+    this->variableValues = std::move(stateMachineBatch.variableValues);
+    this->currentStates  = std::move(stateMachineBatch.currentStates);
+    this->pending        = std::move(stateMachineBatch.pending);
+    this->candidate      = std::move(stateMachineBatch.candidate);
+    this->fired          = std::move(stateMachineBatch.fired);
+    this->id             = stateMachineBatch.id;
+    this->log            = stateMachineBatch.log;
+    stateMachineBatch.log = NULL;
+    return *this;
+  }
+
+  StateMachineBatch* StateMachineBatch::clone() const {
+    return new StateMachineBatch(*this);
+  }
+
+  std::shared_ptr<const StateMachineDefinition>
+   StateMachineBatch::getDefinition() const {
+    return this->definition;
+  }
+
+  std::size_t StateMachineBatch::addInstance() {
+    const std::vector<double>& initialVariableValues =
+     this->definition->getInitialVariableValues();
+    for(VarHandle i=0; i<this->variableValues.size(); i++) {
+      this->variableValues.at(i).push_back(initialVariableValues.at(i));
+    }
+    this->currentStates.push_back(this->definition->getInitialState());
+    this->pending.push_back(0);
+    this->candidate.push_back(0);
+    this->fired.push_back(0);
+    return this->currentStates.size()-1;
+  }
+
+  std::size_t StateMachineBatch::getInstanceCount() const {
+    return this->currentStates.size();
+  }
+
+  double StateMachineBatch::getVariableValue(
+   const std::size_t& index, const VarHandle& variable
+  ) const {
+    return this->variableValues.at(variable).at(index);
+  }
+
+  void StateMachineBatch::setVariableValue(
+   const std::size_t& index, const VarHandle& variable, const double& value
+  ) {
+    this->variableValues.at(variable).at(index) = value;
+  }
+
+  const std::vector<double>& StateMachineBatch::getVariableValues(
+   const VarHandle& variable
+  ) const {
+    return this->variableValues.at(variable);
+  }
+
+  void StateMachineBatch::setVariableValues(
+   const VarHandle& variable, const std::vector<double>& values
+  ) {
+    std::vector<double>& column = this->variableValues.at(variable);
+    for(std::size_t n=0; n<column.size(); n++) {
+      column.at(n) = values.at(n);
+    }
+  }
+
+  StateMachineBatch::StateId StateMachineBatch::getCurrentStateId(
+   const std::size_t& index
+  ) const {
+    return this->currentStates.at(index);
+  }
+
+  std::string StateMachineBatch::getCurrentState(const std::size_t& index)
+   const {
+    return this->definition->getStateName(this->currentStates.at(index));
+  }
+
+  void StateMachineBatch::setCurrentState(
+   const std::size_t& index, const StateId& state
+  ) {
+    const std::vector<Action>& enterActions =
+     this->definition->getEnterActions(state);
+    const StateId previousState = this->currentStates.at(index);
+    this->currentStates.at(index) = state;
+    this->applyActions(this->definition->getExitActions(previousState),index);
+    this->applyActions(enterActions,index);
+  }
+
+  std::size_t StateMachineBatch::updateState() {
+    const std::size_t count = this->currentStates.size();
+    uint8_t* const pend = this->pending.data();
+    uint8_t* const cand = this->candidate.data();
+    uint8_t* const f = this->fired.data();
+    for(std::size_t n=0; n<count; n++) {
+      pend[n] = 1;
+    }
+    std::size_t transitionCount = 0;
+    for(StateId s=0; s<this->definition->getStateCount(); s++) {
+      const std::vector<Transition>& transitions =
+       this->definition->getTransitions(s);
+      if(transitions.empty()) {
+        continue;
+      }
+      // Instances that entered this state during this call are not pending
+      const StateId* const state = this->currentStates.data();
+      std::size_t occupiedCount = 0;
+      for(std::size_t n=0; n<count; n++) {
+        cand[n] = (state[n]==s) & pend[n];
+        occupiedCount += cand[n];
+      }
+      // Transitions are checked in order; the first one met is taken
+      for(
+       std::size_t t=0; occupiedCount>0 && t<transitions.size(); t++
+      ) {
+        const Transition& transition = transitions.at(t);
+        if(!transition.satisfiable) {
+          continue;
+        }
+        for(std::size_t n=0; n<count; n++) {
+          f[n] = cand[n];
+        }
+        for(std::size_t c=0; c<transition.conditions.size(); c++) {
+          const Condition& condition = transition.conditions.at(c);
+          const double* const v =
+           this->variableValues.at(condition.variable).data();
+          const double value = condition.value;
+          if(condition.comparison==Comparison::EQ) {
+            for(std::size_t n=0; n<count; n++) {
+              f[n] &= (v[n]==value);
+            }
+          } else if(condition.comparison==Comparison::NE) {
+            for(std::size_t n=0; n<count; n++) {
+              f[n] &= (v[n]!=value);
+            }
+          } else if(condition.comparison==Comparison::LE) {
+            for(std::size_t n=0; n<count; n++) {
+              f[n] &= (v[n]<=value);
+            }
+          } else if(condition.comparison==Comparison::GE) {
+            for(std::size_t n=0; n<count; n++) {
+              f[n] &= (v[n]>=value);
+            }
+          } else if(condition.comparison==Comparison::LT) {
+            for(std::size_t n=0; n<count; n++) {
+              f[n] &= (v[n]<value);
+            }
+          } else if(condition.comparison==Comparison::GT) {
+            for(std::size_t n=0; n<count; n++) {
+              f[n] &= (v[n]>value);
+            }
+          }
+        }
+        std::size_t firedCount = 0;
+        for(std::size_t n=0; n<count; n++) {
+          cand[n] &= (f[n]^1);
+          pend[n] &= (f[n]^1);
+          firedCount += f[n];
+        }
+        if(firedCount==0) {
+          continue;
+        }
+        this->applyActions(this->definition->getExitActions(s),this->fired);
+        this->applyActions(transition.actions,this->fired);
+        this->applyActions(
+         this->definition->getEnterActions(transition.dstState),this->fired
+        );
+        StateId* const nextState = this->currentStates.data();
+        const StateId dstState = transition.dstState;
+        for(std::size_t n=0; n<count; n++) {
+          nextState[n] = f[n] ? dstState : nextState[n];
+        }
+        occupiedCount -= firedCount;
+        transitionCount += firedCount;
+      }
+    }
+    return transitionCount;
+  }
+
+  uint32_t StateMachineBatch::getID() const {
+    return this->id;
+  }
+
+  Log* StateMachineBatch::getLog() const {
+    return this->log;
+  }
+
+  void StateMachineBatch::applyActions(
+   const std::vector<Action>& actions, const std::vector<uint8_t>& mask
+  ) {
+    const std::size_t count = this->currentStates.size();
+    const uint8_t* const m = mask.data();
+    for(std::size_t i=0; i<actions.size(); i++) {
+      const Action& action = actions.at(i);
+      // An undeclared variable throws here, as it does in StateMachine
+      double* const v = this->variableValues.at(action.variable).data();
+      const double value = action.value;
+      // Selects rather than arithmetic on the mask keep results bit-identical
+      // to StateMachine, e.g. for -0.0 and NaN
+      if(action.opcode==Opcode::ASSIGN) {
+        for(std::size_t n=0; n<count; n++) {
+          v[n] = m[n] ? value : v[n];
+        }
+      } else if(action.opcode==Opcode::ADD) {
+        for(std::size_t n=0; n<count; n++) {
+          v[n] = m[n] ? v[n]+value : v[n];
+        }
+      } else if(action.opcode==Opcode::SUBTRACT) {
+        for(std::size_t n=0; n<count; n++) {
+          v[n] = m[n] ? v[n]-value : v[n];
+        }
+      } else if(action.opcode==Opcode::MULTIPLY) {
+        for(std::size_t n=0; n<count; n++) {
+          v[n] = m[n] ? v[n]*value : v[n];
+        }
+      }
+    }
+  }
+
+  void StateMachineBatch::applyActions(
+   const std::vector<Action>& actions, const std::size_t& index
+  ) {
+    for(std::size_t i=0; i<actions.size(); i++) {
+      const Action& action = actions.at(i);
+      double& variableValue =
+       this->variableValues.at(action.variable).at(index);
+      if(action.opcode==Opcode::ASSIGN) {
+        variableValue = action.value;
+      } else if(action.opcode==Opcode::ADD) {
+        variableValue += action.value;
+      } else if(action.opcode==Opcode::SUBTRACT) {
+        variableValue -= action.value;
+      } else if(action.opcode==Opcode::MULTIPLY) {
+        variableValue *= action.value;
+      }
+    }
+  }
+}
@@ -0,0 +1,96 @@
+// test-state-machine-batch.cpp
+// StateMachineBatch class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>                    // size_t
+#include <cstdlib>                    // exit, EXIT_SUCCESS
+#include <memory>                     // shared_ptr
+#include <string>                     // string, to_string
+#include <vector>                     // vector
+
+// satsim
+#include <Log.hpp>                    // Log
+#include <LogLevel.hpp>               // LogLevel
+#include <StateMachine.hpp>           // StateMachine
+#include <StateMachineBatch.hpp>      // StateMachineBatch
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  std::shared_ptr<const cote::StateMachineDefinition> definition =
+   cote::StateMachineDefinition::load(
+    "../../state-machine/configuration/computer-state-machine.dat"
+   );
+  const cote::StateMachineBatch::VarHandle NODE_VOLTAGE =
+   definition->getVariableHandle("node-voltage");
+  const cote::StateMachineBatch::VarHandle CLAIMED_TASK_COUNT =
+   definition->getVariableHandle("claimed-task-count");
+  const cote::StateMachineBatch::VarHandle POWER_W =
+   definition->getVariableHandle("power-w");
+  // Step a batch and one StateMachine per instance with the same inputs
+  const std::size_t instanceCount = 64;
+  cote::StateMachineBatch batch(definition,0,&log);
+  std::vector<cote::StateMachine> stateMachines;
+  for(std::size_t i=0; i<instanceCount; i++) {
+    batch.addInstance();
+    stateMachines.push_back(cote::StateMachine(definition,i,&log));
+  }
+  std::vector<double> nodeVoltage(instanceCount,0.0);
+  std::size_t mismatchCount = 0;
+  for(std::size_t step=0; step<200; step++) {
+    // Each instance sweeps the voltage thresholds with a different phase
+    for(std::size_t i=0; i<instanceCount; i++) {
+      nodeVoltage.at(i) = 4.5+0.05*static_cast<double>((step+3*i)%60);
+      stateMachines.at(i).setVariableValue(NODE_VOLTAGE,nodeVoltage.at(i));
+      const double claimedTaskCount = ((step/10+i)%3==0) ? 1.0 : 0.0;
+      stateMachines.at(i).setVariableValue(
+       CLAIMED_TASK_COUNT,claimedTaskCount
+      );
+      batch.setVariableValue(i,CLAIMED_TASK_COUNT,claimedTaskCount);
+      stateMachines.at(i).updateState();
+    }
+    batch.setVariableValues(NODE_VOLTAGE,nodeVoltage);
+    const std::size_t transitionCount = batch.updateState();
+    for(std::size_t i=0; i<instanceCount; i++) {
+      for(
+       cote::StateMachineBatch::VarHandle v=0;
+       v<definition->getVariableCount(); v++
+      ) {
+        if(
+         batch.getVariableValue(i,v)!=stateMachines.at(i).getVariableValue(v)
+        ) {
+          mismatchCount++;
+        }
+      }
+      if(
+       batch.getCurrentStateId(i)!=stateMachines.at(i).getCurrentStateId()
+      ) {
+        mismatchCount++;
+      }
+    }
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(step), "transition-count",
+     std::to_string(transitionCount)
+    );
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(step), "instance-0-state",
+     batch.getCurrentState(0)
+    );
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(step), "instance-0-power-w",
+     std::to_string(batch.getVariableValue(0,POWER_W))
+    );
+  }
+  log.meas(
+   cote::LogLevel::INFO, "200", "mismatch-count", std::to_string(mismatchCount)
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
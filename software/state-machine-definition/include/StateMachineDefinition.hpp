@@ -0,0 +1,254 @@
+// StateMachineDefinition.hpp
+// StateMachineDefinition class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_STATE_MACHINE_DEFINITION_HPP
+#define COTE_STATE_MACHINE_DEFINITION_HPP
+
+// Standard library
+#include <cstddef>             // size_t
+#include <cstdint>             // uint8_t
+#include <functional>          // less
+#include <limits>              // numeric_limits
+#include <map>                 // map
+#include <memory>              // shared_ptr
+#include <string>              // string
+#include <string_view>         // string_view
+#include <tuple>               // tuple
+#include <utility>             // pair
+#include <vector>              // vector
+
+// cote library
+#include <StateTransition.hpp> // StateTransition
+
+namespace cote {
+  class StateMachineDefinition {
+  public:
+    // Handles into the compiled configuration
+    typedef std::size_t VarHandle;
+    typedef std::size_t StateId;
+    static constexpr VarHandle NO_VARIABLE =
+     std::numeric_limits<std::size_t>::max();
+    static constexpr StateId NO_STATE = std::numeric_limits<std::size_t>::max();
+    // Operators of compiled actions: =, +=, -=, and *=
+    enum class Opcode : uint8_t {ASSIGN, ADD, SUBTRACT, MULTIPLY};
+    // Operators of compiled conditions: ==, !=, <=, >=, <, and >
+    enum class Comparison : uint8_t {EQ, NE, LE, GE, LT, GT};
+    struct Action {
+      VarHandle variable; // NO_VARIABLE if undeclared
+      Opcode opcode;
+      double value;
+    };
+    struct Condition {
+      VarHandle variable;
+      Comparison comparison;
+      double value;
+    };
+    struct Transition {
+      StateId dstState;
+      bool satisfiable;                  // false if a variable is undeclared
+                                         // or a condition is malformed
+      std::vector<Condition> conditions;
+      std::vector<Action> actions;
+    };
+    // Parses and compiles the text of a state machine configuration file;
+    // configName, e.g. the file path, prefixes parse error messages
+    StateMachineDefinition(
+     const std::string& configText,
+     const std::string& configName="configuration"
+    );
+    StateMachineDefinition(const StateMachineDefinition& definition);
+    StateMachineDefinition(StateMachineDefinition&& definition);
+    virtual ~StateMachineDefinition();
+    virtual StateMachineDefinition& operator=(
+     const StateMachineDefinition& definition
+    );
+    virtual StateMachineDefinition& operator=(
+     StateMachineDefinition&& definition
+    );
+    virtual StateMachineDefinition* clone() const;
+    // Returns the definition of the configuration file, parsing it only if no
+    // live definition has the same content; definitions are immutable, so one
+    // is shared by every state machine built from identical files, and its
+    // parse errors name the first of those files to be loaded
+    static std::shared_ptr<const StateMachineDefinition> load(
+     const std::string& configFile
+    );
+    std::string getConfigText() const;
+    std::string getConfigName() const;
+    // Messages of the form name:line:column: description for each malformed
+    // line or item; malformed items are skipped and the rest is kept
+    std::vector<std::string> getParseErrors() const;
+    std::map<std::string,double> getConstantValues() const;
+    double getConstantValue(const std::string& constant) const;
+    // The configuration as string maps, built from the configuration text on
+    // the first call to any of these
+    std::map<
+     std::string,std::vector<std::tuple<std::string,std::string,double>>
+    > getEnterStateValues() const;
+    std::map<
+     std::string,std::vector<std::tuple<std::string,std::string,double>>
+    > getExitStateValues() const;
+    std::map<
+     std::string,std::map<
+      std::string,std::vector<std::tuple<std::string,std::string,double>>
+     >
+    > getTransitionValues() const;
+    std::map<std::string,std::vector<StateTransition>> getStateTransitions()
+     const;
+    // Variables
+    std::size_t getVariableCount() const;
+    //// Returns NO_VARIABLE if the configuration does not declare the variable
+    VarHandle getVariableHandle(const std::string& variable) const;
+    const std::string& getVariableName(const VarHandle& variable) const;
+    const std::vector<double>& getInitialVariableValues() const;
+    // States
+    std::size_t getStateCount() const;
+    //// Returns NO_STATE if the configuration does not name the state
+    StateId getStateId(const std::string& state) const;
+    const std::string& getStateName(const StateId& state) const;
+    StateId getInitialState() const;
+    const std::vector<Action>& getEnterActions(const StateId& state) const;
+    const std::vector<Action>& getExitActions(const StateId& state) const;
+    //// The transitions out of the state in the order in which they are checked
+    const std::vector<Transition>& getTransitions(const StateId& state) const;
+    // Guards
+    //// Indices into getTransitions(state) of the transitions whose conditions
+    //// read the variable
+    const std::vector<std::size_t>& getGuardIndex(
+     const StateId& state, const VarHandle& variable
+    ) const;
+    //// Sorted distinct values that conditions compare the variable against
+    const std::vector<double>& getGuardThresholds(const VarHandle& variable)
+     const;
+  private:
+    // A configuration as parsed, viewing the configuration text; items are
+    // kept in the order read, and the changes and conditions of a line are
+    // the [begin,end) ranges of changes and conditions
+    struct ParsedChange {
+      std::string_view variable;
+      std::string_view assignmentOperator;
+      double value;
+    };
+    struct ParsedCondition {
+      std::string_view variable;
+      std::string_view comparisonOperator;
+      double value;
+    };
+    struct ParsedStateChanges {
+      std::string_view state;
+      std::size_t changesBegin;
+      std::size_t changesEnd;
+    };
+    struct ParsedTransition {
+      std::string_view srcState;
+      std::string_view dstState;
+      std::size_t conditionsBegin;
+      std::size_t conditionsEnd;
+      bool wellFormed;
+      std::size_t changesBegin;
+      std::size_t changesEnd;
+    };
+    struct ParsedConfiguration {
+      std::vector<std::pair<std::string_view,double>> constants;
+      std::vector<std::pair<std::string_view,double>> variables;
+      std::vector<ParsedChange> changes;
+      std::vector<ParsedCondition> conditions;
+      std::vector<ParsedStateChanges> enterStates;
+      std::vector<ParsedStateChanges> exitStates;
+      std::vector<ParsedTransition> transitions;
+      std::string_view initialState;
+    };
+    // The string maps of the previous StateMachine configuration parser;
+    // StateMachine only uses the compiled tables, so these are built from the
+    // configuration text on first request
+    struct LegacyValues {
+      std::map<
+       std::string,std::vector<std::tuple<std::string,std::string,double>>
+      > enterStateValues;
+      std::map<
+       std::string,std::vector<std::tuple<std::string,std::string,double>>
+      > exitStateValues;
+      std::map<
+       std::string,
+       std::map<
+        std::string,std::vector<std::tuple<std::string,std::string,double>>
+       >
+      > transitionValues;
+      std::map<std::string,std::vector<StateTransition>> stateTransitions;
+    };
+    // Parses configText; parse errors are appended to parseErrors if not NULL
+    void parse(
+     ParsedConfiguration& parsed, std::vector<std::string>* const parseErrors
+    ) const;
+    void parseLine(
+     const std::string_view& line, const std::size_t& lineNumber,
+     ParsedConfiguration& parsed, std::vector<std::string>* const parseErrors
+    ) const;
+    void parseChanges(
+     const std::string_view& text, const std::size_t& lineNumber,
+     const std::size_t& column, ParsedConfiguration& parsed,
+     std::vector<std::string>* const parseErrors
+    ) const;
+    void addParseError(
+     const std::size_t& lineNumber, const std::size_t& column,
+     const std::string& message, std::vector<std::string>* const parseErrors
+    ) const;
+    StateId addState(const std::string_view& state);
+    void compileActions(
+     const ParsedConfiguration& parsed, const std::size_t& changesBegin,
+     const std::size_t& changesEnd, std::vector<Action>& actions
+    ) const;
+    std::shared_ptr<const LegacyValues> getLegacyValues() const;
+    // Configuration
+    //   configText: the text that was parsed, used to confirm cache hits
+    //   configName: the name used in parse error messages
+    //   parseErrors: the parse error messages in the order found
+    std::string configText;
+    std::string configName;
+    std::vector<std::string> parseErrors;
+    // constantValues map
+    //   Key: the string name of the constant
+    //   Value: the value of the constant represented as a double
+    std::map<std::string,double> constantValues;
+    // Variables
+    //   initialVariableValues holds the initial value of each variable in a
+    //   dense slot indexed by its VarHandle; variableNames holds the name of
+    //   each slot, and variableHandles maps each name back to its slot
+    std::vector<double> initialVariableValues;
+    std::vector<std::string> variableNames;
+    std::map<std::string,VarHandle,std::less<>> variableHandles;
+    // Legacy string maps, NULL until first requested; held through a shared
+    // pointer that is loaded and stored atomically, as the definition may be
+    // shared by state machines on several threads
+    mutable std::shared_ptr<const LegacyValues> legacyValues;
+    // Compiled states, indexed by StateId
+    //   stateNames: the string name of each state
+    //   stateIds: maps each name back to its StateId
+    //   enterActions, exitActions: the actions applied when the state is
+    //     entered or exited
+    //   transitions: the possible transitions out of the state in the order
+    //     in which they are checked
+    //   initialState: the state named by initial-state
+    std::vector<std::string> stateNames;
+    std::map<std::string,StateId,std::less<>> stateIds;
+    std::vector<std::vector<Action>> enterActions;
+    std::vector<std::vector<Action>> exitActions;
+    std::vector<std::vector<Transition>> transitions;
+    StateId initialState;
+    // Guard dependency index
+    //   guardIndex: for each StateId and VarHandle, the indices of the
+    //     transitions out of the state whose conditions read the variable
+    //   guardThresholds: for each VarHandle, the sorted distinct values that
+    //     conditions compare the variable against; a change of value that
+    //     does not reach one of them cannot change any condition
+    std::vector<std::vector<std::vector<std::size_t>>> guardIndex;
+    std::vector<std::vector<double>> guardThresholds;
+  };
+}
+
+#endif
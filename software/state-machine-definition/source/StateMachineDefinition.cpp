@@ -0,0 +1,793 @@
+// StateMachineDefinition.cpp
+// StateMachineDefinition class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>                  // sort, stable_sort, unique
+#include <cstddef>                    // size_t
+#include <fstream>                    // ifstream
+#include <functional>                 // hash, less
+#include <ios>                        // ios, streamoff
+#include <map>                        // map
+#include <memory>                     // atomic_load, atomic_store,
+                                      // make_shared, shared_ptr, weak_ptr
+#include <mutex>                      // lock_guard, mutex
+#include <string>                     // string, to_string
+#include <string_view>                // string_view, find, npos, substr
+#include <tuple>                      // get, make_tuple, tuple
+#include <utility>                    // make_pair, move, pair
+#include <vector>                     // vector
+
+// cote library
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+#include <StateTransition.hpp>        // StateTransition
+
+namespace cote {
+  StateMachineDefinition::StateMachineDefinition(
+   const std::string& configText, const std::string& configName
+  ) : configText(configText), configName(configName), initialState(NO_STATE) {
+    // Parse the configuration text in a single pass, viewing it in place
+    ParsedConfiguration parsed;
+    this->parse(parsed,&(this->parseErrors));
+    for(std::size_t i=0; i<parsed.constants.size(); i++) {
+      this->constantValues[std::string(parsed.constants.at(i).first)] =
+       parsed.constants.at(i).second;
+    }
+    for(std::size_t i=0; i<parsed.variables.size(); i++) {
+      const std::string_view name = parsed.variables.at(i).first;
+      std::map<std::string,VarHandle,std::less<>>::const_iterator it =
+       this->variableHandles.find(name);
+      if(it==this->variableHandles.end()) {
+        this->variableHandles.emplace(
+         std::string(name),this->initialVariableValues.size()
+        );
+        this->variableNames.push_back(std::string(name));
+        this->initialVariableValues.push_back(parsed.variables.at(i).second);
+      } else {
+        this->initialVariableValues.at(it->second) =
+         parsed.variables.at(i).second;
+      }
+    }
+    // Compile the configuration into dense tables for StateMachine
+    this->guardThresholds.resize(this->initialVariableValues.size());
+    //// States are assigned IDs in the order the previous string maps gave:
+    //// the initial state, then the states with enter changes, exit changes
+    //// and transitions, each by name; stable sorts keep the lines of one
+    //// state in the order read
+    this->initialState = this->addState(parsed.initialState);
+    std::vector<std::size_t> enterOrder(parsed.enterStates.size());
+    for(std::size_t i=0; i<enterOrder.size(); i++) {
+      enterOrder.at(i) = i;
+    }
+    std::stable_sort(
+     enterOrder.begin(),enterOrder.end(),
+     [&](const std::size_t& a, const std::size_t& b) {
+      return parsed.enterStates.at(a).state<parsed.enterStates.at(b).state;
+     }
+    );
+    for(std::size_t i=0; i<enterOrder.size(); i++) {
+      this->addState(parsed.enterStates.at(enterOrder.at(i)).state);
+    }
+    std::vector<std::size_t> exitOrder(parsed.exitStates.size());
+    for(std::size_t i=0; i<exitOrder.size(); i++) {
+      exitOrder.at(i) = i;
+    }
+    std::stable_sort(
+     exitOrder.begin(),exitOrder.end(),
+     [&](const std::size_t& a, const std::size_t& b) {
+      return parsed.exitStates.at(a).state<parsed.exitStates.at(b).state;
+     }
+    );
+    for(std::size_t i=0; i<exitOrder.size(); i++) {
+      this->addState(parsed.exitStates.at(exitOrder.at(i)).state);
+    }
+    std::vector<std::size_t> transitionOrder(parsed.transitions.size());
+    for(std::size_t i=0; i<transitionOrder.size(); i++) {
+      transitionOrder.at(i) = i;
+    }
+    std::stable_sort(
+     transitionOrder.begin(),transitionOrder.end(),
+     [&](const std::size_t& a, const std::size_t& b) {
+      return parsed.transitions.at(a).srcState<
+       parsed.transitions.at(b).srcState;
+     }
+    );
+    for(std::size_t i=0; i<transitionOrder.size(); i++) {
+      const ParsedTransition& parsedTransition =
+       parsed.transitions.at(transitionOrder.at(i));
+      this->addState(parsedTransition.srcState);
+      this->addState(parsedTransition.dstState);
+    }
+    // Compile the changes applied when each state is entered or exited
+    for(std::size_t i=0; i<enterOrder.size(); i++) {
+      const ParsedStateChanges& stateChanges =
+       parsed.enterStates.at(enterOrder.at(i));
+      this->compileActions(
+       parsed,stateChanges.changesBegin,stateChanges.changesEnd,
+       this->enterActions.at(this->stateIds.find(stateChanges.state)->second)
+      );
+    }
+    for(std::size_t i=0; i<exitOrder.size(); i++) {
+      const ParsedStateChanges& stateChanges =
+       parsed.exitStates.at(exitOrder.at(i));
+      this->compileActions(
+       parsed,stateChanges.changesBegin,stateChanges.changesEnd,
+       this->exitActions.at(this->stateIds.find(stateChanges.state)->second)
+      );
+    }
+    // The changes of every transition line with the same source and
+    // destination states are applied together, in the order read
+    std::vector<std::size_t> pairOrder(transitionOrder);
+    std::stable_sort(
+     pairOrder.begin(),pairOrder.end(),
+     [&](const std::size_t& a, const std::size_t& b) {
+      const ParsedTransition& ta = parsed.transitions.at(a);
+      const ParsedTransition& tb = parsed.transitions.at(b);
+      return (ta.srcState<tb.srcState) ||
+       (ta.srcState==tb.srcState && ta.dstState<tb.dstState);
+     }
+    );
+    std::vector<std::vector<Action>> transitionActions(
+     parsed.transitions.size()
+    );
+    for(std::size_t i=0; i<pairOrder.size();) {
+      const ParsedTransition& first = parsed.transitions.at(pairOrder.at(i));
+      std::size_t pairEnd = i;
+      std::vector<Action> actions;
+      while(
+       pairEnd<pairOrder.size() &&
+       parsed.transitions.at(pairOrder.at(pairEnd)).srcState==first.srcState &&
+       parsed.transitions.at(pairOrder.at(pairEnd)).dstState==first.dstState
+      ) {
+        const ParsedTransition& transition =
+         parsed.transitions.at(pairOrder.at(pairEnd));
+        this->compileActions(
+         parsed,transition.changesBegin,transition.changesEnd,actions
+        );
+        pairEnd++;
+      }
+      for(std::size_t j=i; j<pairEnd; j++) {
+        transitionActions.at(pairOrder.at(j)) = actions;
+      }
+      i = pairEnd;
+    }
+    // Compile the transitions out of each state
+    std::vector<ParsedCondition> conditions;
+    for(std::size_t i=0; i<transitionOrder.size(); i++) {
+      const ParsedTransition& parsedTransition =
+       parsed.transitions.at(transitionOrder.at(i));
+      const StateId srcState =
+       this->stateIds.find(parsedTransition.srcState)->second;
+      Transition transition;
+      transition.dstState =
+       this->stateIds.find(parsedTransition.dstState)->second;
+      transition.satisfiable = parsedTransition.wellFormed;
+      //// Conditions are checked grouped by variable name, as the previous
+      //// string map of conditions held them
+      conditions.assign(
+       parsed.conditions.begin()+parsedTransition.conditionsBegin,
+       parsed.conditions.begin()+parsedTransition.conditionsEnd
+      );
+      std::stable_sort(
+       conditions.begin(),conditions.end(),
+       [](const ParsedCondition& a, const ParsedCondition& b) {
+        return a.variable<b.variable;
+       }
+      );
+      for(std::size_t j=0; j<conditions.size(); j++) {
+        const std::map<std::string,VarHandle,std::less<>>::const_iterator it =
+         this->variableHandles.find(conditions.at(j).variable);
+        if(it==this->variableHandles.end()) {
+          // StateTransition::checkConditions fails on unknown variables
+          transition.satisfiable = false;
+          continue;
+        }
+        const std::string_view& comparisonOperator =
+         conditions.at(j).comparisonOperator;
+        Condition condition;
+        condition.variable = it->second;
+        condition.value = conditions.at(j).value;
+        if(comparisonOperator=="==") {
+          condition.comparison = Comparison::EQ;
+        } else if(comparisonOperator=="!=") {
+          condition.comparison = Comparison::NE;
+        } else if(comparisonOperator=="<=") {
+          condition.comparison = Comparison::LE;
+        } else if(comparisonOperator==">=") {
+          condition.comparison = Comparison::GE;
+        } else if(comparisonOperator=="<") {
+          condition.comparison = Comparison::LT;
+        } else if(comparisonOperator==">") {
+          condition.comparison = Comparison::GT;
+        } else {
+          continue;
+        }
+        transition.conditions.push_back(condition);
+      }
+      transition.actions =
+       std::move(transitionActions.at(transitionOrder.at(i)));
+      // Index the transition under each variable that its conditions read
+      const std::size_t transitionIndex = this->transitions.at(srcState).size();
+      for(std::size_t j=0; j<transition.conditions.size(); j++) {
+        const VarHandle variable = transition.conditions.at(j).variable;
+        std::vector<std::size_t>& dependentTransitions =
+         this->guardIndex.at(srcState).at(variable);
+        if(
+         dependentTransitions.empty() ||
+         dependentTransitions.back()!=transitionIndex
+        ) {
+          dependentTransitions.push_back(transitionIndex);
+        }
+        this->guardThresholds.at(variable).push_back(
+         transition.conditions.at(j).value
+        );
+      }
+      this->transitions.at(srcState).push_back(std::move(transition));
+    }
+    for(VarHandle i=0; i<this->guardThresholds.size(); i++) {
+      std::vector<double>& thresholds = this->guardThresholds.at(i);
+      std::sort(thresholds.begin(),thresholds.end());
+      thresholds.erase(
+       std::unique(thresholds.begin(),thresholds.end()),thresholds.end()
+      );
+    }
+  }
+
+  StateMachineDefinition::StateMachineDefinition(
+   const StateMachineDefinition& definition
+  ) : configText(definition.configText), configName(definition.configName),
+   parseErrors(definition.parseErrors),
+   constantValues(definition.constantValues),
+   initialVariableValues(definition.initialVariableValues),
+   variableNames(definition.variableNames),
+   variableHandles(definition.variableHandles),
+   legacyValues(std::atomic_load(&(definition.legacyValues))),
+   stateNames(definition.stateNames), stateIds(definition.stateIds),
+   enterActions(definition.enterActions),
+   exitActions(definition.exitActions), transitions(definition.transitions),
+   initialState(definition.initialState), guardIndex(definition.guardIndex),
+   guardThresholds(definition.guardThresholds) {}
+
+  StateMachineDefinition::StateMachineDefinition(
+   StateMachineDefinition&& definition
+  ) : configText(std::move(definition.configText)),
+   configName(std::move(definition.configName)),
+   parseErrors(std::move(definition.parseErrors)),
+   constantValues(std::move(definition.constantValues)),
+   initialVariableValues(std::move(definition.initialVariableValues)),
+   variableNames(std::move(definition.variableNames)),
+   variableHandles(std::move(definition.variableHandles)),
+   legacyValues(std::move(definition.legacyValues)),
+   stateNames(std::move(definition.stateNames)),
+   stateIds(std::move(definition.stateIds)),
+   enterActions(std::move(definition.enterActions)),
+   exitActions(std::move(definition.exitActions)),
+   transitions(std::move(definition.transitions)),
+   initialState(definition.initialState),
+   guardIndex(std::move(definition.guardIndex)),
+   guardThresholds(std::move(definition.guardThresholds)) {}
+
+  StateMachineDefinition::~StateMachineDefinition() {}
+
+  StateMachineDefinition& StateMachineDefinition::operator=(
+   const StateMachineDefinition& definition
+  ) {
+    StateMachineDefinition temp(definition);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  StateMachineDefinition& StateMachineDefinition::operator=(
+   StateMachineDefinition&& definition
+  ) {
+    this->configText            = std::move(definition.configText);
+    this->configName            = std::move(definition.configName);
+    this->parseErrors           = std::move(definition.parseErrors);
+    this->constantValues        = std::move(definition.constantValues);
+    this->initialVariableValues = std::move(definition.initialVariableValues);
+    this->variableNames         = std::move(definition.variableNames);
+    this->variableHandles       = std::move(definition.variableHandles);
+    this->legacyValues          = std::move(definition.legacyValues);
+    this->stateNames            = std::move(definition.stateNames);
+    this->stateIds              = std::move(definition.stateIds);
+    this->enterActions          = std::move(definition.enterActions);
+    this->exitActions           = std::move(definition.exitActions);
+    this->transitions           = std::move(definition.transitions);
+    this->initialState          = definition.initialState;
+    this->guardIndex            = std::move(definition.guardIndex);
+    this->guardThresholds       = std::move(definition.guardThresholds);
+    return *this;
+  }
+
+  StateMachineDefinition* StateMachineDefinition::clone() const {
+    return new StateMachineDefinition(*this);
+  }
+
+  std::shared_ptr<const StateMachineDefinition> StateMachineDefinition::load(
+   const std::string& configFile
+  ) {
+    // Read the file with one call rather than one character at a time
+    std::ifstream configHandle(configFile,std::ios::binary|std::ios::ate);
+    std::string configText = "";
+    const std::streamoff configSize = configHandle.tellg();
+    if(configSize>0) {
+      configText.resize(static_cast<std::size_t>(configSize));
+      configHandle.seekg(0,std::ios::beg);
+      configHandle.read(&configText[0],configSize);
+    }
+    configHandle.close();
+    // Live definitions keyed by the hash of their text; the cache holds weak
+    // references, so a definition is freed with its last state machine
+    static std::mutex cacheMutex;
+    static std::map<
+     std::size_t,std::vector<std::weak_ptr<const StateMachineDefinition>>
+    > cache;
+    const std::size_t key = std::hash<std::string>()(configText);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::vector<std::weak_ptr<const StateMachineDefinition>>& bucket =
+     cache[key];
+    std::shared_ptr<const StateMachineDefinition> definition;
+    for(std::size_t i=0; i<bucket.size();) {
+      std::shared_ptr<const StateMachineDefinition> candidate =
+       bucket.at(i).lock();
+      if(!candidate) {
+        bucket.erase(bucket.begin()+i);
+      } else {
+        if(candidate->configText==configText) {
+          definition = candidate;
+        }
+        i++;
+      }
+    }
+    if(!definition) {
+      definition =
+       std::make_shared<const StateMachineDefinition>(configText,configFile);
+      bucket.push_back(definition);
+    }
+    return definition;
+  }
+
+  std::string StateMachineDefinition::getConfigText() const {
+    return this->configText;
+  }
+
+  std::string StateMachineDefinition::getConfigName() const {
+    return this->configName;
+  }
+
+  std::vector<std::string> StateMachineDefinition::getParseErrors() const {
+    return this->parseErrors;
+  }
+
+  std::map<std::string,double> StateMachineDefinition::getConstantValues()
+   const {
+    return this->constantValues;
+  }
+
+  double StateMachineDefinition::getConstantValue(
+   const std::string& constant
+  ) const {
+    return this->constantValues.at(constant);
+  }
+
+  std::map<
+   std::string,std::vector<std::tuple<std::string,std::string,double>>
+  > StateMachineDefinition::getEnterStateValues() const {
+    return this->getLegacyValues()->enterStateValues;
+  }
+
+  std::map<
+   std::string,std::vector<std::tuple<std::string,std::string,double>>
+  > StateMachineDefinition::getExitStateValues() const {
+    return this->getLegacyValues()->exitStateValues;
+  }
+
+  std::map<
+   std::string,std::map<
+    std::string,std::vector<std::tuple<std::string,std::string,double>>
+   >
+  > StateMachineDefinition::getTransitionValues() const {
+    return this->getLegacyValues()->transitionValues;
+  }
+
+  std::map<std::string,std::vector<StateTransition>>
+   StateMachineDefinition::getStateTransitions() const {
+    return this->getLegacyValues()->stateTransitions;
+  }
+
+  std::size_t StateMachineDefinition::getVariableCount() const {
+    return this->initialVariableValues.size();
+  }
+
+  StateMachineDefinition::VarHandle StateMachineDefinition::getVariableHandle(
+   const std::string& variable
+  ) const {
+    std::map<std::string,VarHandle,std::less<>>::const_iterator it =
+     this->variableHandles.find(variable);
+    return (it==this->variableHandles.end()) ? NO_VARIABLE : it->second;
+  }
+
+  const std::string& StateMachineDefinition::getVariableName(
+   const VarHandle& variable
+  ) const {
+    return this->variableNames.at(variable);
+  }
+
+  const std::vector<double>& StateMachineDefinition::getInitialVariableValues()
+   const {
+    return this->initialVariableValues;
+  }
+
+  std::size_t StateMachineDefinition::getStateCount() const {
+    return this->stateNames.size();
+  }
+
+  StateMachineDefinition::StateId StateMachineDefinition::getStateId(
+   const std::string& state
+  ) const {
+    std::map<std::string,StateId,std::less<>>::const_iterator it =
+     this->stateIds.find(state);
+    return (it==this->stateIds.end()) ? NO_STATE : it->second;
+  }
+
+  const std::string& StateMachineDefinition::getStateName(
+   const StateId& state
+  ) const {
+    return this->stateNames.at(state);
+  }
+
+  StateMachineDefinition::StateId StateMachineDefinition::getInitialState()
+   const {
+    return this->initialState;
+  }
+
+  const std::vector<StateMachineDefinition::Action>&
+   StateMachineDefinition::getEnterActions(const StateId& state) const {
+    return this->enterActions.at(state);
+  }
+
+  const std::vector<StateMachineDefinition::Action>&
+   StateMachineDefinition::getExitActions(const StateId& state) const {
+    return this->exitActions.at(state);
+  }
+
+  const std::vector<StateMachineDefinition::Transition>&
+   StateMachineDefinition::getTransitions(const StateId& state) const {
+    return this->transitions.at(state);
+  }
+
+  const std::vector<std::size_t>& StateMachineDefinition::getGuardIndex(
+   const StateId& state, const VarHandle& variable
+  ) const {
+    return this->guardIndex.at(state).at(variable);
+  }
+
+  const std::vector<double>& StateMachineDefinition::getGuardThresholds(
+   const VarHandle& variable
+  ) const {
+    return this->guardThresholds.at(variable);
+  }
+
+  void StateMachineDefinition::parse(
+   ParsedConfiguration& parsed, std::vector<std::string>* const parseErrors
+  ) const {
+    // Parse configuration text in a single pass, one line at a time
+    const std::string_view text(this->configText);
+    std::size_t lineNumber = 0;
+    std::size_t lineStart = 0;
+    while(lineStart<text.size()) {
+      std::size_t lineEnd = text.find('\n',lineStart);
+      if(lineEnd==std::string_view::npos) {
+        lineEnd = text.size();
+      }
+      lineNumber++;
+      this->parseLine(
+       text.substr(lineStart,lineEnd-lineStart),lineNumber,parsed,parseErrors
+      );
+      lineStart = lineEnd+std::string_view("\n").size();
+    }
+  }
+
+  void StateMachineDefinition::parseLine(
+   const std::string_view& line, const std::size_t& lineNumber,
+   ParsedConfiguration& parsed, std::vector<std::string>* const parseErrors
+  ) const {
+    const std::size_t labelEnd = line.find(':');
+    const std::string_view label = line.substr(0,labelEnd);
+    if(labelEnd==std::string_view::npos) {
+      if(
+       label=="constant" || label=="variable" || label=="enter-state" ||
+       label=="exit-state" || label=="transition" || label=="initial-state"
+      ) {
+        this->addParseError(
+         lineNumber,line.size()+1,"expected ':'",parseErrors
+        );
+      }
+      return;
+    }
+    // Columns are 1-based byte offsets into the line
+    const std::string_view body = line.substr(labelEnd+1);
+    const std::size_t bodyColumn = labelEnd+2;
+    if(label=="constant" || label=="variable") {
+      const std::size_t nameEnd = body.find(':');
+      if(nameEnd==std::string_view::npos) {
+        this->addParseError(
+         lineNumber,bodyColumn+body.size(),"expected ':' after the name",
+         parseErrors
+        );
+        return;
+      }
+      double value = 0.0;
+      if(!StateTransition::parseValue(body.substr(nameEnd+1),value)) {
+        this->addParseError(
+         lineNumber,bodyColumn+nameEnd+1,"expected a number",parseErrors
+        );
+        return;
+      }
+      ((label=="constant") ? parsed.constants : parsed.variables).push_back(
+       std::make_pair(body.substr(0,nameEnd),value)
+      );
+    } else if(label=="enter-state" || label=="exit-state") {
+      const std::size_t nameEnd = body.find(':');
+      if(nameEnd==std::string_view::npos) {
+        this->addParseError(
+         lineNumber,bodyColumn+body.size(),"expected ':' after the state",
+         parseErrors
+        );
+        return;
+      }
+      ParsedStateChanges stateChanges;
+      stateChanges.state = body.substr(0,nameEnd);
+      stateChanges.changesBegin = parsed.changes.size();
+      this->parseChanges(
+       body.substr(nameEnd+1),lineNumber,bodyColumn+nameEnd+1,parsed,
+       parseErrors
+      );
+      stateChanges.changesEnd = parsed.changes.size();
+      // As before, a state with no changes has no entry
+      if(stateChanges.changesEnd>stateChanges.changesBegin) {
+        ((label=="enter-state") ? parsed.enterStates : parsed.exitStates)
+         .push_back(stateChanges);
+      }
+    } else if(label=="transition") {
+      const std::size_t arrowIndex = body.find("->");
+      if(arrowIndex==std::string_view::npos) {
+        this->addParseError(lineNumber,bodyColumn,"expected '->'",parseErrors);
+        return;
+      }
+      const std::size_t dstEnd = body.find(':',arrowIndex);
+      if(dstEnd==std::string_view::npos) {
+        this->addParseError(
+         lineNumber,bodyColumn+body.size(),
+         "expected ':' after the destination state",parseErrors
+        );
+        return;
+      }
+      ParsedTransition transition;
+      transition.srcState = body.substr(0,arrowIndex);
+      transition.dstState = body.substr(arrowIndex+2,dstEnd-arrowIndex-2);
+      transition.wellFormed = true;
+      // Conditions end at the next ':' and changes follow it
+      const std::size_t conditionsEnd = body.find(':',dstEnd+1);
+      const std::string_view conditionsText =
+       body.substr(dstEnd+1,conditionsEnd-dstEnd-1);
+      transition.conditionsBegin = parsed.conditions.size();
+      std::size_t i = 0;
+      while(i<conditionsText.size()) {
+        std::size_t delimiterIndex = conditionsText.find(',',i);
+        ParsedCondition condition;
+        if(
+         StateTransition::parseCondition(
+          conditionsText.substr(i,delimiterIndex-i),condition.variable,
+          condition.comparisonOperator,condition.value
+         )
+        ) {
+          parsed.conditions.push_back(condition);
+        } else {
+          // Dropping the condition would weaken the guard, so the transition
+          // is kept but never fires
+          this->addParseError(
+           lineNumber,bodyColumn+dstEnd+1+i,
+           "malformed condition; the transition never fires",parseErrors
+          );
+          transition.wellFormed = false;
+        }
+        i = (
+         delimiterIndex==std::string_view::npos ?
+         delimiterIndex : delimiterIndex+std::string_view(",").size()
+        );
+      }
+      transition.conditionsEnd = parsed.conditions.size();
+      transition.changesBegin = parsed.changes.size();
+      if(conditionsEnd!=std::string_view::npos) {
+        this->parseChanges(
+         body.substr(conditionsEnd+1),lineNumber,bodyColumn+conditionsEnd+1,
+         parsed,parseErrors
+        );
+      }
+      transition.changesEnd = parsed.changes.size();
+      parsed.transitions.push_back(transition);
+    } else if(label=="initial-state") {
+      parsed.initialState = body;
+    }
+  }
+
+  void StateMachineDefinition::parseChanges(
+   const std::string_view& text, const std::size_t& lineNumber,
+   const std::size_t& column, ParsedConfiguration& parsed,
+   std::vector<std::string>* const parseErrors
+  ) const {
+    // Compound operators are matched first so that += is not read as =
+    const std::string_view assignmentOperators[] = {"+=", "-=", "*=", "="};
+    std::size_t i = 0;
+    while(i<text.size()) {
+      const std::size_t delimiterIndex = text.find(',',i);
+      const std::string_view change = text.substr(i,delimiterIndex-i);
+      bool parsedChange = false;
+      for(std::size_t j=0; j<4; j++) {
+        const std::size_t operatorIndex = change.find(assignmentOperators[j]);
+        if(operatorIndex!=std::string_view::npos) {
+          ParsedChange parsedValue;
+          if(
+           StateTransition::parseValue(
+            change.substr(operatorIndex+assignmentOperators[j].size()),
+            parsedValue.value
+           )
+          ) {
+            parsedValue.variable = change.substr(0,operatorIndex);
+            parsedValue.assignmentOperator = assignmentOperators[j];
+            parsed.changes.push_back(parsedValue);
+            parsedChange = true;
+          }
+          break;
+        }
+      }
+      if(!parsedChange) {
+        this->addParseError(lineNumber,column+i,"malformed change",parseErrors);
+      }
+      i = (
+       delimiterIndex==std::string_view::npos ?
+       delimiterIndex : delimiterIndex+std::string_view(",").size()
+      );
+    }
+  }
+
+  void StateMachineDefinition::addParseError(
+   const std::size_t& lineNumber, const std::size_t& column,
+   const std::string& message, std::vector<std::string>* const parseErrors
+  ) const {
+    if(parseErrors!=NULL) {
+      parseErrors->push_back(
+       this->configName+":"+std::to_string(lineNumber)+":"+
+       std::to_string(column)+": "+message
+      );
+    }
+  }
+
+  StateMachineDefinition::StateId StateMachineDefinition::addState(
+   const std::string_view& state
+  ) {
+    //// The lower bound doubles as the insertion hint for a new state
+    std::map<std::string,StateId,std::less<>>::const_iterator it =
+     this->stateIds.lower_bound(state);
+    if(it!=this->stateIds.end() && it->first==state) {
+      return it->second;
+    }
+    const StateId stateId = this->stateNames.size();
+    this->stateNames.push_back(std::string(state));
+    this->stateIds.emplace_hint(it,std::string(state),stateId);
+    this->enterActions.push_back(std::vector<Action>());
+    this->exitActions.push_back(std::vector<Action>());
+    this->transitions.push_back(std::vector<Transition>());
+    this->guardIndex.push_back(
+     std::vector<std::vector<std::size_t>>(this->initialVariableValues.size())
+    );
+    return stateId;
+  }
+
+  void StateMachineDefinition::compileActions(
+   const ParsedConfiguration& parsed, const std::size_t& changesBegin,
+   const std::size_t& changesEnd, std::vector<Action>& actions
+  ) const {
+    for(std::size_t i=changesBegin; i<changesEnd; i++) {
+      const ParsedChange& change = parsed.changes.at(i);
+      const std::map<std::string,VarHandle,std::less<>>::const_iterator it =
+       this->variableHandles.find(change.variable);
+      Action action;
+      action.variable = (it==this->variableHandles.end()) ?
+       NO_VARIABLE : it->second;
+      action.value = change.value;
+      if(change.assignmentOperator=="=") {
+        action.opcode = Opcode::ASSIGN;
+      } else if(change.assignmentOperator=="+=") {
+        action.opcode = Opcode::ADD;
+      } else if(change.assignmentOperator=="-=") {
+        action.opcode = Opcode::SUBTRACT;
+      } else if(change.assignmentOperator=="*=") {
+        action.opcode = Opcode::MULTIPLY;
+      } else {
+        continue;
+      }
+      actions.push_back(action);
+    }
+  }
+
+  std::shared_ptr<const StateMachineDefinition::LegacyValues>
+   StateMachineDefinition::getLegacyValues() const {
+    std::shared_ptr<const LegacyValues> legacy =
+     std::atomic_load(&(this->legacyValues));
+    if(legacy) {
+      return legacy;
+    }
+    //// Threads that race here build equal maps, and one set is kept
+    ParsedConfiguration parsed;
+    this->parse(parsed,NULL);
+    std::shared_ptr<LegacyValues> values = std::make_shared<LegacyValues>();
+    for(std::size_t i=0; i<parsed.enterStates.size(); i++) {
+      const ParsedStateChanges& stateChanges = parsed.enterStates.at(i);
+      std::vector<std::tuple<std::string,std::string,double>>& stateValues =
+       values->enterStateValues[std::string(stateChanges.state)];
+      for(
+       std::size_t j=stateChanges.changesBegin; j<stateChanges.changesEnd; j++
+      ) {
+        const ParsedChange& change = parsed.changes.at(j);
+        stateValues.push_back(std::make_tuple(
+         std::string(change.variable),std::string(change.assignmentOperator),
+         change.value
+        ));
+      }
+    }
+    for(std::size_t i=0; i<parsed.exitStates.size(); i++) {
+      const ParsedStateChanges& stateChanges = parsed.exitStates.at(i);
+      std::vector<std::tuple<std::string,std::string,double>>& stateValues =
+       values->exitStateValues[std::string(stateChanges.state)];
+      for(
+       std::size_t j=stateChanges.changesBegin; j<stateChanges.changesEnd; j++
+      ) {
+        const ParsedChange& change = parsed.changes.at(j);
+        stateValues.push_back(std::make_tuple(
+         std::string(change.variable),std::string(change.assignmentOperator),
+         change.value
+        ));
+      }
+    }
+    for(std::size_t i=0; i<parsed.transitions.size(); i++) {
+      const ParsedTransition& transition = parsed.transitions.at(i);
+      const std::string srcStateString(transition.srcState);
+      const std::string dstStateString(transition.dstState);
+      std::map<std::string,std::vector<std::pair<std::string,double>>>
+       conditions;
+      for(
+       std::size_t j=transition.conditionsBegin; j<transition.conditionsEnd;
+       j++
+      ) {
+        const ParsedCondition& condition = parsed.conditions.at(j);
+        conditions[std::string(condition.variable)].push_back(std::make_pair(
+         std::string(condition.comparisonOperator),condition.value
+        ));
+      }
+      values->stateTransitions[srcStateString].push_back(
+       StateTransition(
+        srcStateString,dstStateString,std::move(conditions),
+        transition.wellFormed
+       )
+      );
+      std::vector<std::tuple<std::string,std::string,double>>& changes =
+       values->transitionValues[srcStateString][dstStateString];
+      for(std::size_t j=transition.changesBegin; j<transition.changesEnd; j++) {
+        const ParsedChange& change = parsed.changes.at(j);
+        changes.push_back(std::make_tuple(
+         std::string(change.variable),std::string(change.assignmentOperator),
+         change.value
+        ));
+      }
+    }
+    legacy = values;
+    std::atomic_store(&(this->legacyValues),legacy);
+    return legacy;
+  }
+}
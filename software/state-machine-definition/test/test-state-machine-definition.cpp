@@ -0,0 +1,110 @@
+// test-state-machine-definition.cpp
+// StateMachineDefinition class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>                    // size_t
+#include <cstdlib>                    // exit, EXIT_SUCCESS
+#include <memory>                     // make_shared, shared_ptr
+#include <string>                     // string, to_string
+#include <vector>                     // vector
+
+// satsim
+#include <Log.hpp>                    // Log
+#include <LogLevel.hpp>               // LogLevel
+#include <StateMachine.hpp>           // StateMachine
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {
+   cote::LogLevel::INFO, cote::LogLevel::ERROR
+  };
+  cote::Log log(levels,"../test");
+  const std::string configFile =
+   "../../state-machine/configuration/computer-state-machine.dat";
+  // Loading the same file twice yields one shared definition
+  std::shared_ptr<const cote::StateMachineDefinition> definition =
+   cote::StateMachineDefinition::load(configFile);
+  log.meas(
+   cote::LogLevel::INFO, "0", "shared-on-load",
+   std::to_string(cote::StateMachineDefinition::load(configFile)==definition)
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "state-count",
+   std::to_string(definition->getStateCount())
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "variable-count",
+   std::to_string(definition->getVariableCount())
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "initial-state",
+   definition->getStateName(definition->getInitialState())
+  );
+  // State machines built from the file share the definition but not values
+  cote::StateMachine stateMachine0(configFile,0,&log);
+  cote::StateMachine stateMachine1(definition,1,&log);
+  log.meas(
+   cote::LogLevel::INFO, "0", "shared-by-state-machines",
+   std::to_string(
+    stateMachine0.getDefinition()==definition &&
+    stateMachine1.getDefinition()==definition
+   )
+  );
+  stateMachine0.setVariableValue("node-voltage",7.0);
+  stateMachine1.setVariableValue("node-voltage",1.0);
+  for(std::size_t i=0; i<2; i++) {
+    stateMachine0.updateState();
+    stateMachine1.updateState();
+  }
+  log.meas(
+   cote::LogLevel::INFO, "0", "state-machine-0-state",
+   stateMachine0.getCurrentState()
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "state-machine-1-state",
+   stateMachine1.getCurrentState()
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "definition-use-count",
+   std::to_string(definition.use_count())
+  );
+  // Malformed items are skipped and reported with their line and column
+  std::shared_ptr<const cote::StateMachineDefinition> malformed =
+   std::make_shared<const cote::StateMachineDefinition>(
+    "variable:power-w:1.5\n"
+    "variable:node-voltage:high\n"
+    "enter-state:ON:power-w=2.0,power-w+=\n"
+    "transition:OFF->ON:node-voltage>=,power-w<3.0\n"
+    "transition:ON-OFF:power-w<1.0\n"
+    "initial-state:OFF\n",
+    "malformed-state-machine.dat"
+   );
+  log.meas(
+   cote::LogLevel::INFO, "0", "parse-error-count",
+   std::to_string(malformed->getParseErrors().size())
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "malformed-variable-count",
+   std::to_string(malformed->getVariableCount())
+  );
+  // The OFF->ON transition has a malformed guard, so it never fires even
+  // though its well-formed condition holds; the machine stays OFF
+  cote::StateMachine stateMachine2(malformed,2,&log);
+  stateMachine2.updateState();
+  log.meas(
+   cote::LogLevel::INFO, "0", "state-machine-2-state",
+   stateMachine2.getCurrentState()
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "malformed-guard-never-fires",
+   std::to_string(stateMachine2.getCurrentState()=="OFF" ? 1 : 0)
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
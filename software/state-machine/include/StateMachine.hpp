@@ -10,30 +10,55 @@
 #define COTE_STATE_MACHINE_HPP
 
 // Standard library
-#include <cstdint>             // uint32_t
-#include <map>                 // map
-#include <string>              // string
-#include <tuple>               // tuple
-#include <vector>              // vector
+#include <cstddef>                    // size_t
+#include <cstdint>                    // int64_t, uint8_t, uint32_t
+#include <map>                        // map
+#include <memory>                     // shared_ptr
+#include <string>                     // string
+#include <tuple>                      // tuple
+#include <vector>                     // vector
 
 // cote library
-#include <Log.hpp>             // Log
-#include <StateTransition.hpp> // StateTransition
+#include <IStateMachine.hpp>          // IStateMachine
+#include <IVariableListener.hpp>      // IVariableListener
+#include <Log.hpp>                    // Log
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+#include <StateTransition.hpp>        // StateTransition
 
 namespace cote {
-  class StateMachine {
+  class StateMachine : public IStateMachine {
   public:
+    // Handles into the compiled configuration; a handle obtained from one
+    // state machine is valid for every state machine with the same definition
+    typedef StateMachineDefinition::VarHandle VarHandle;
+    typedef StateMachineDefinition::StateId StateId;
+    static constexpr VarHandle NO_VARIABLE =
+     StateMachineDefinition::NO_VARIABLE;
+    static constexpr StateId NO_STATE = StateMachineDefinition::NO_STATE;
+    // A run of time spent in one state, from start up to but not including end
+    struct StateInterval {
+      int64_t start;
+      int64_t end;
+      StateId state;
+    };
+    // Loads the configuration file through StateMachineDefinition::load, so
+    // state machines built from identical files share one definition
     StateMachine(
      const std::string& configFile, const uint32_t& id=0, Log* const log=NULL
     );
+    StateMachine(
+     std::shared_ptr<const StateMachineDefinition> definition,
+     const uint32_t& id=0, Log* const log=NULL
+    );
     StateMachine(const StateMachine& stateMachine);
     StateMachine(StateMachine&& stateMachine);
     virtual ~StateMachine();
     virtual StateMachine& operator=(const StateMachine& stateMachine);
     virtual StateMachine& operator=(StateMachine&& stateMachine);
     virtual StateMachine* clone() const;
-    std::map<std::string,double> getConstantValues() const;
-    std::map<std::string,double> getVariableValues() const;
+    std::shared_ptr<const StateMachineDefinition> getDefinition() const;
+    std::map<std::string,double> getConstantValues() const override;
+    std::map<std::string,double> getVariableValues() const override;
     std::map<
      std::string,std::vector<std::tuple<std::string,std::string,double>>
     > getEnterStateValues() const;
@@ -47,64 +72,111 @@ namespace cote {
     > getTransitionValues() const;
     std::map<std::string,std::vector<StateTransition>> getStateTransitions()
      const;
-    std::string getCurrentState() const;
-    uint32_t getID() const;
-    Log* getLog() const;
-    double getConstantValue(const std::string& constant) const;
-    double getVariableValue(const std::string& variable) const;
-    void setVariableValue(const std::string& variable, const double& value);
-    void setCurrentState(const std::string& state);
-    void updateState();
+    std::string getCurrentState() const override;
+    uint32_t getID() const override;
+    Log* getLog() const override;
+    double getConstantValue(const std::string& constant) const override;
+    double getVariableValue(const std::string& variable) const override;
+    void setVariableValue(
+     const std::string& variable, const double& value
+    ) override;
+    // Returns the values that the variable is compared against by the
+    // transitions out of the current state, e.g. voltage thresholds
+    std::vector<double> getConditionValues(const std::string& variable) const;
+    // Registers a listener that is notified whenever the value of the variable
+    // changes, including changes made by enter, exit, and transition actions.
+    // Listeners are not owned and are not copied or moved with the machine.
+    void addVariableListener(
+     const std::string& variable, IVariableListener* const listener
+    );
+    void removeVariableListener(
+     const std::string& variable, IVariableListener* const listener
+    );
+    void setCurrentState(const std::string& state) override;
+    void updateState() override;
+    // Handle-based accessors; look handles up once and use these in loops
+    //// Returns NO_VARIABLE if the configuration does not declare the variable
+    VarHandle getVariableHandle(const std::string& variable) const;
+    std::string getVariableName(const VarHandle& variable) const;
+    double getVariableValue(const VarHandle& variable) const;
+    void setVariableValue(const VarHandle& variable, const double& value);
+    std::vector<double> getConditionValues(const VarHandle& variable) const;
+    //// Returns NO_STATE if the configuration does not name the state
+    StateId getStateId(const std::string& state) const;
+    std::string getStateName(const StateId& state) const;
+    StateId getCurrentStateId() const;
+    void setCurrentState(const StateId& state);
+    // State-interval recording; time is in caller-defined ticks, e.g. steps
+    //// Sets the time stamped on subsequent state changes; time should not
+    //// decrease
+    void setTime(const int64_t& time);
+    int64_t getTime() const;
+    //// Returns the total time spent in the state, including the open
+    //// interval of the current state up to the current time
+    int64_t getTimeInState(const StateId& state) const;
+    std::map<std::string,int64_t> getTimeInStates() const;
+    //// When enabled, each interval is appended once time advances past the
+    //// end of it; state changes undone at the same time are not recorded
+    void setRecordStateIntervals(const bool& record);
+    const std::vector<StateInterval>& getStateIntervals() const;
+    void clearStateIntervals();
+    //// Ends the open interval of the current state at the current time, e.g.
+    //// at the end of a run, and starts a new one
+    void closeStateInterval();
   private:
-    // constantValues map
-    //   Key: the string name of the constant
-    //   Value: the value of the constant represented as a double
-    std::map<std::string,double> constantValues;
-    // variableValues map
-    //   Key: the string name of the variable
-    //   Value: the value of the variable represented as a double
-    std::map<std::string,double> variableValues;
-    // enterStateValues map
-    //   Key: the string name of the state that is being entered
-    //   Value: a vector of (string,string,double) tuples, where the first entry
-    //          is the string variable name, the second entry is the string
-    //          operator, and the third entry is the double value used with the
-    //          operator
-    std::map<
-     std::string,std::vector<std::tuple<std::string,std::string,double>>
-    > enterStateValues;
-    // exitStateValues map
-    //   Key: the string name of the state that is being exited
-    //   Value: a vector of (string,string,double) tuples, where the first entry
-    //          is the string variable name, the second entry is the string
-    //          operator, and the third entry is the double value used with the
-    //          operator
-    std::map<
-     std::string,std::vector<std::tuple<std::string,std::string,double>>
-    > exitStateValues;
-    // transitionValues map
-    //   Key: the string name of the state that is being exited (srcState)
-    //   Value: a map with the following structure:
-    //     Key: the string name of the state that is being entered (dstState)
-    //     Value: a vector of (string,string,double) tuples, where the first
-    //            entry is the string variable name, the second entry is the
-    //            string operator, and the third entry is the double value used
-    //            with the operator
-    std::map<
-     std::string,
-     std::map<
-      std::string,std::vector<std::tuple<std::string,std::string,double>>
-     >
-    > transitionValues;
-    // stateTransitions map
-    //   Key: the string name of the state
-    //   Value: a vector of StateTransition objects representing the possible
-    //          transitions to new states from the key state
-    std::map<std::string,std::vector<StateTransition>> stateTransitions;
+    typedef StateMachineDefinition::Opcode Opcode;
+    typedef StateMachineDefinition::Comparison Comparison;
+    typedef StateMachineDefinition::Action Action;
+    typedef StateMachineDefinition::Condition Condition;
+    typedef StateMachineDefinition::Transition Transition;
+    bool checkConditions(const Transition& transition) const;
+    bool crossesThreshold(
+     const VarHandle& variable, const double& value0, const double& value1
+    ) const;
+    void applyActions(const std::vector<Action>& actions);
+    // definition: the parsed and compiled configuration, shared with every
+    //   state machine built from the same configuration text
+    std::shared_ptr<const StateMachineDefinition> definition;
+    // variableValues: the value of each variable indexed by its VarHandle
+    std::vector<double> variableValues;
+    // extraStateNames: states that setCurrentState named but the
+    //   configuration does not; they have IDs from the definition's state
+    //   count upward and have no actions or transitions
+    std::vector<std::string> extraStateNames;
+    // Dirty tracking, which lets updateState skip transitions whose
+    // conditions cannot have changed
+    //   variableDirty, dirtyVariables: the variables that changed across a
+    //     guard threshold since the last call to updateState
+    //   evaluateAll: set when the current state changed since the last call
+    //     to updateState, in which case every transition is checked
+    //   candidateTransitions: scratch flags used by updateState
+    std::vector<uint8_t> variableDirty;
+    std::vector<VarHandle> dirtyVariables;
+    bool evaluateAll;
+    std::vector<uint8_t> candidateTransitions;
+    // variableListeners vector
+    //   Index: the VarHandle of the variable
+    //   Value: a vector of listeners to notify when the variable changes; the
+    //          listeners are not owned and should not be deleted
+    std::vector<std::vector<IVariableListener*>> variableListeners;
+    // State-interval recording
+    //   time: the time stamped on state changes
+    //   intervalState, stateStartTime: the state of the open interval and the
+    //     time at which it was entered; differs from currentState between a
+    //     state change and the next advance of time
+    //   stateTimes: the closed time spent in each state indexed by StateId
+    //   recordStateIntervals, stateIntervals: the intervals recorded since
+    //     the last call to clearStateIntervals, if enabled
+    int64_t time;
+    StateId intervalState;
+    int64_t stateStartTime;
+    std::vector<int64_t> stateTimes;
+    bool recordStateIntervals;
+    std::vector<StateInterval> stateIntervals;
     // currentState, id, and log
-    std::string currentState; // a string that represents the current state
-    uint32_t id;              // identification number
-    Log* log;                 // singleton, should not be deleted
+    StateId currentState; // the ID of the current state
+    uint32_t id;          // identification number
+    Log* log;             // singleton, should not be deleted
   };
 }
 
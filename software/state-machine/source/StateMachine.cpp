@@ -7,238 +7,63 @@
 // See the top-level LICENSE file for the license.
 
 // Standard library
-#include <algorithm>           // min
-#include <cstddef>             // size_t
-#include <cstdint>             // uint32_t
-#include <fstream>             // ifstream
-#include <map>                 // map
-#include <string>              // string, getline, find, substr, npos, stod
-#include <utility>             // move
-#include <vector>              // vector
+#include <algorithm>                  // find, lower_bound, max, min
+#include <cstddef>                    // size_t
+#include <cstdint>                    // int64_t, uint8_t, uint32_t
+#include <map>                        // map
+#include <memory>                     // shared_ptr
+#include <string>                     // string
+#include <utility>                    // move
+#include <vector>                     // vector
 
 // cote library
-#include <Log.hpp>             // Log
-#include <StateMachine.hpp>    // StateMachine
-#include <StateTransition.hpp> // StateTransition
+#include <IVariableListener.hpp>      // IVariableListener
+#include <Log.hpp>                    // Log
+#include <StateMachine.hpp>           // StateMachine
+#include <StateMachineDefinition.hpp> // StateMachineDefinition
+#include <StateTransition.hpp>        // StateTransition
 
 namespace cote {
   StateMachine::StateMachine(
    const std::string& configFile, const uint32_t& id, Log* const log
-  ) : currentState(""), id(id), log(log) {
-    // Parse configuration file
-    std::ifstream configHandle(configFile);
-    std::string line = "";
-    while(std::getline(configHandle,line)) {
-      std::size_t labelEndIndex = line.find(":",0);
-      std::string label = line.substr(0,labelEndIndex);
-      line =
-       line.substr(labelEndIndex+std::string(":").size(),std::string::npos);
-      if(label=="constant") {
-        std::size_t delimiterIndex = line.find(":",0);
-        std::string constantName = line.substr(0,delimiterIndex);
-        double constantValue = std::stod(
-         line.substr(delimiterIndex+std::string(":").size(),std::string::npos)
-        );
-        this->constantValues[constantName] = constantValue;
-      } else if(label=="variable") {
-        std::size_t delimiterIndex = line.find(":",0);
-        std::string variableName = line.substr(0,delimiterIndex);
-        double variableValue = std::stod(
-         line.substr(delimiterIndex+std::string(":").size(),std::string::npos)
-        );
-        this->variableValues[variableName] = variableValue;
-      } else if(label=="enter-state") {
-        std::size_t delimiterIndex = line.find(":",0);
-        std::string stateName = line.substr(0,delimiterIndex);
-        line =
-         line.substr(delimiterIndex+std::string(":").size(),std::string::npos);
-        std::size_t lineIndex = 0;
-        while(lineIndex<line.size()) {
-          delimiterIndex = line.find(",",lineIndex);
-          std::string enterChange =
-           line.substr(lineIndex,delimiterIndex-lineIndex);
-          std::size_t operatorIndex = 0;
-          std::string variableName = "";
-          std::string assignmentOperator = "";
-          double variableValue = 0.0;
-          if(enterChange.find("+=",0)!=std::string::npos) {
-            operatorIndex = enterChange.find("+=",0);
-            assignmentOperator = "+=";
-          } else if(enterChange.find("-=",0)!=std::string::npos) {
-            operatorIndex = enterChange.find("-=",0);
-            assignmentOperator = "-=";
-          } else if(enterChange.find("*=",0)!=std::string::npos) {
-            operatorIndex = enterChange.find("*=",0);
-            assignmentOperator = "*=";
-          } else if(enterChange.find("=",0)!=std::string::npos) {
-            operatorIndex = enterChange.find("=",0);
-            assignmentOperator = "=";
-          }
-          variableName = enterChange.substr(0,operatorIndex);
-          variableValue = std::stod(enterChange.substr(
-           operatorIndex+assignmentOperator.size(),std::string::npos
-          ));
-          if(this->enterStateValues.count(stateName)==0) {
-            this->enterStateValues[stateName] =
-             std::vector<std::tuple<std::string,std::string,double>>();
-          }
-          this->enterStateValues.at(stateName).push_back(
-           std::make_tuple(variableName,assignmentOperator,variableValue)
-          );
-          lineIndex = (
-           delimiterIndex==std::string::npos ?
-           delimiterIndex : delimiterIndex+std::string(",").size()
-          );
-        }
-      } else if(label=="exit-state") {
-        std::size_t delimiterIndex = line.find(":",0);
-        std::string stateName = line.substr(0,delimiterIndex);
-        line =
-         line.substr(delimiterIndex+std::string(":").size(),std::string::npos);
-        std::size_t lineIndex = 0;
-        while(lineIndex<line.size()) {
-          delimiterIndex = line.find(",",lineIndex);
-          std::string exitChange =
-           line.substr(lineIndex,delimiterIndex-lineIndex);
-          std::size_t operatorIndex = 0;
-          std::string variableName = "";
-          std::string assignmentOperator = "";
-          double variableValue = 0.0;
-          if(exitChange.find("+=",0)!=std::string::npos) {
-            operatorIndex = exitChange.find("+=",0);
-            assignmentOperator = "+=";
-          } else if(exitChange.find("-=",0)!=std::string::npos) {
-            operatorIndex = exitChange.find("-=",0);
-            assignmentOperator = "-=";
-          } else if(exitChange.find("*=",0)!=std::string::npos) {
-            operatorIndex = exitChange.find("*=",0);
-            assignmentOperator = "*=";
-          } else if(exitChange.find("=",0)!=std::string::npos) {
-            operatorIndex = exitChange.find("=",0);
-            assignmentOperator = "=";
-          }
-          variableName = exitChange.substr(0,operatorIndex);
-          variableValue = std::stod(exitChange.substr(
-           operatorIndex+assignmentOperator.size(),std::string::npos
-          ));
-          if(this->exitStateValues.count(stateName)==0) {
-            this->exitStateValues[stateName] =
-             std::vector<std::tuple<std::string,std::string,double>>();
-          }
-          this->exitStateValues.at(stateName).push_back(
-           std::make_tuple(variableName,assignmentOperator,variableValue)
-          );
-          lineIndex = (
-           delimiterIndex==std::string::npos ?
-           delimiterIndex : delimiterIndex+std::string(",").size()
-          );
-        }
-      } else if(label=="transition") {
-        // Find the delimiter between the transition conditions and the
-        // transition changes
-        std::size_t transitionChangeIndex = line.find(":",0);
-        transitionChangeIndex = (
-         transitionChangeIndex==std::string::npos ?
-         transitionChangeIndex : transitionChangeIndex+std::string(":").size()
-        );
-        transitionChangeIndex = line.find(":",transitionChangeIndex);
-        // Record the transition conditions, source state, and destination state
-        std::string transitionConditions =
-         "transition:"+line.substr(0,transitionChangeIndex);
-        std::size_t srcStartIndex =
-         transitionConditions.find(":",0)+std::string(":").size();
-        std::size_t srcEndIndex = transitionConditions.find("->",0);
-        std::size_t dstStartIndex = srcEndIndex+std::string("->").size();
-        std::size_t dstEndIndex = transitionConditions.find(":",dstStartIndex);
-        std::string srcStateString =
-         transitionConditions.substr(srcStartIndex,srcEndIndex-srcStartIndex);
-        std::string dstStateString =
-         transitionConditions.substr(dstStartIndex,dstEndIndex-dstStartIndex);
-        if(this->stateTransitions.count(srcStateString)==0) {
-          this->stateTransitions[srcStateString] =
-           std::vector<StateTransition>();
-        }
-        this->stateTransitions.at(srcStateString).push_back(
-         cote::StateTransition(transitionConditions)
-        );
-        // Record the transition changes
-        transitionChangeIndex = (
-         transitionChangeIndex==std::string::npos ?
-         transitionChangeIndex : transitionChangeIndex+std::string(":").size()
-        );
-        std::string transitionChanges = line.substr(
-         std::min(transitionChangeIndex,line.size()),std::string::npos
-        );
-        if(this->transitionValues.count(srcStateString)==0) {
-          this->transitionValues[srcStateString] = std::map<
-           std::string,std::vector<std::tuple<std::string,std::string,double>>
-          >();
-        }
-        if(this->transitionValues.at(srcStateString).count(dstStateString)==0) {
-          this->transitionValues.at(srcStateString)[dstStateString] =
-           std::vector<std::tuple<std::string,std::string,double>>();
-        }
-        transitionChangeIndex = 0;
-        while(transitionChangeIndex<transitionChanges.size()) {
-          std::size_t delimterIndex =
-           transitionChanges.find(",",transitionChangeIndex);
-          std::string transitionChange = transitionChanges.substr(
-           transitionChangeIndex, delimterIndex
-          );
-          std::size_t operatorIndex = 0;
-          std::string variableName = "";
-          std::string assignmentOperator = "";
-          double variableValue = 0.0;
-          if(transitionChange.find("+=",0)!=std::string::npos) {
-            operatorIndex = transitionChange.find("+=",0);
-            assignmentOperator = "+=";
-          } else if(transitionChange.find("-=",0)!=std::string::npos) {
-            operatorIndex = transitionChange.find("-=",0);
-            assignmentOperator = "-=";
-          } else if(transitionChange.find("*=",0)!=std::string::npos) {
-            operatorIndex = transitionChange.find("*=",0);
-            assignmentOperator = "*=";
-          } else if(transitionChange.find("=",0)!=std::string::npos) {
-            operatorIndex = transitionChange.find("=",0);
-            assignmentOperator = "=";
-          }
-          variableName = transitionChange.substr(0,operatorIndex);
-          variableValue = std::stod(transitionChange.substr(
-           operatorIndex+assignmentOperator.size(),std::string::npos
-          ));
-          this->transitionValues.at(srcStateString).at(dstStateString).push_back
-          (
-           std::make_tuple(variableName,assignmentOperator,variableValue)
-          );
-          transitionChangeIndex = (
-           delimterIndex==std::string::npos ?
-           delimterIndex : delimterIndex+std::string(",").size()
-          );
-        }
-      } else if(label=="initial-state") {
-        this->currentState = line;
-      }
-    }
-    configHandle.close();
-  }
+  ) : StateMachine(StateMachineDefinition::load(configFile),id,log) {}
+
+  StateMachine::StateMachine(
+   std::shared_ptr<const StateMachineDefinition> definition,
+   const uint32_t& id, Log* const log
+  ) : definition(definition),
+   variableValues(definition->getInitialVariableValues()),
+   variableDirty(definition->getVariableCount(),0), evaluateAll(true),
+   variableListeners(definition->getVariableCount()), time(0),
+   intervalState(definition->getInitialState()), stateStartTime(0),
+   stateTimes(definition->getStateCount(),0), recordStateIntervals(false),
+   currentState(definition->getInitialState()), id(id), log(log) {}
 
   StateMachine::StateMachine(const StateMachine& stateMachine) :
-   constantValues(stateMachine.getConstantValues()),
-   variableValues(stateMachine.getVariableValues()),
-   enterStateValues(stateMachine.getEnterStateValues()),
-   exitStateValues(stateMachine.getExitStateValues()),
-   transitionValues(stateMachine.getTransitionValues()),
-   stateTransitions(stateMachine.getStateTransitions()),
-   currentState(stateMachine.getCurrentState()), id(stateMachine.getID()),
+   definition(stateMachine.getDefinition()),
+   variableValues(stateMachine.variableValues),
+   extraStateNames(stateMachine.extraStateNames),
+   variableDirty(stateMachine.variableValues.size(),0), evaluateAll(true),
+   variableListeners(stateMachine.variableValues.size()),
+   time(stateMachine.time), intervalState(stateMachine.intervalState),
+   stateStartTime(stateMachine.stateStartTime),
+   stateTimes(stateMachine.stateTimes),
+   recordStateIntervals(stateMachine.recordStateIntervals),
+   stateIntervals(stateMachine.stateIntervals),
+   currentState(stateMachine.getCurrentStateId()), id(stateMachine.getID()),
    log(stateMachine.getLog()) {}
 
   StateMachine::StateMachine(StateMachine&& stateMachine) :
-   constantValues(stateMachine.constantValues),
+   definition(stateMachine.definition),
    variableValues(stateMachine.variableValues),
-   enterStateValues(stateMachine.enterStateValues),
-   exitStateValues(stateMachine.exitStateValues),
-   transitionValues(stateMachine.transitionValues),
-   stateTransitions(stateMachine.stateTransitions),
+   extraStateNames(stateMachine.extraStateNames),
+   variableDirty(stateMachine.variableValues.size(),0), evaluateAll(true),
+   variableListeners(stateMachine.variableValues.size()),
+   time(stateMachine.time), intervalState(stateMachine.intervalState),
+   stateStartTime(stateMachine.stateStartTime),
+   stateTimes(std::move(stateMachine.stateTimes)),
+   recordStateIntervals(stateMachine.recordStateIntervals),
+   stateIntervals(std::move(stateMachine.stateIntervals)),
    currentState(stateMachine.currentState), id(stateMachine.id),
    log(stateMachine.log) {
     stateMachine.log = NULL;
@@ -255,16 +80,35 @@ namespace cote {
   }
 
   StateMachine& StateMachine::operator=(StateMachine&& stateMachine) {
-    this->constantValues   = stateMachine.constantValues;
-    this->variableValues   = stateMachine.variableValues;
-    this->enterStateValues = stateMachine.enterStateValues;
-    this->exitStateValues  = stateMachine.exitStateValues;
-    this->transitionValues = stateMachine.transitionValues;
-    this->stateTransitions = stateMachine.stateTransitions;
-    this->currentState     = stateMachine.currentState;
-    this->id               = stateMachine.id;
-    this->log              = stateMachine.log;
-    stateMachine.log       = NULL;
+    // Listeners stay with this state machine; carry them over by name
+    std::vector<std::vector<IVariableListener*>> variableListeners(
+     stateMachine.variableValues.size()
+    );
+    for(VarHandle i=0; i<this->variableListeners.size(); i++) {
+      const VarHandle variable = stateMachine.definition->getVariableHandle(
+       this->definition->getVariableName(i)
+      );
+      if(variable!=NO_VARIABLE) {
+        variableListeners.at(variable) = this->variableListeners.at(i);
+      }
+    }
+    this->definition           = stateMachine.definition;
+    this->variableValues       = stateMachine.variableValues;
+    this->extraStateNames      = stateMachine.extraStateNames;
+    this->variableDirty.assign(stateMachine.variableValues.size(),0);
+    this->dirtyVariables.clear();
+    this->evaluateAll          = true;
+    this->variableListeners    = variableListeners;
+    this->time                 = stateMachine.time;
+    this->intervalState        = stateMachine.intervalState;
+    this->stateStartTime       = stateMachine.stateStartTime;
+    this->stateTimes           = std::move(stateMachine.stateTimes);
+    this->recordStateIntervals = stateMachine.recordStateIntervals;
+    this->stateIntervals       = std::move(stateMachine.stateIntervals);
+    this->currentState         = stateMachine.currentState;
+    this->id                   = stateMachine.id;
+    this->log                  = stateMachine.log;
+    stateMachine.log           = NULL;
     return *this;
   }
 
@@ -272,24 +116,34 @@ namespace cote {
     return new StateMachine(*this);
   }
 
+  std::shared_ptr<const StateMachineDefinition> StateMachine::getDefinition()
+   const {
+    return this->definition;
+  }
+
   std::map<std::string,double> StateMachine::getConstantValues() const {
-    return this->constantValues;
+    return this->definition->getConstantValues();
   }
 
   std::map<std::string,double> StateMachine::getVariableValues() const {
-    return this->variableValues;
+    std::map<std::string,double> variableValues;
+    for(VarHandle i=0; i<this->variableValues.size(); i++) {
+      variableValues[this->definition->getVariableName(i)] =
+       this->variableValues.at(i);
+    }
+    return variableValues;
   }
 
   std::map<
    std::string,std::vector<std::tuple<std::string,std::string,double>>
   > StateMachine::getEnterStateValues() const {
-    return this->enterStateValues;
+    return this->definition->getEnterStateValues();
   }
 
   std::map<
    std::string,std::vector<std::tuple<std::string,std::string,double>>
   > StateMachine::getExitStateValues() const {
-    return this->exitStateValues;
+    return this->definition->getExitStateValues();
   }
 
   std::map<
@@ -297,16 +151,16 @@ namespace cote {
     std::string,std::vector<std::tuple<std::string,std::string,double>>
    >
   > StateMachine::getTransitionValues() const {
-    return this->transitionValues;
+    return this->definition->getTransitionValues();
   }
 
   std::map<std::string,std::vector<StateTransition>>
    StateMachine::getStateTransitions() const {
-    return this->stateTransitions;
+    return this->definition->getStateTransitions();
   }
 
   std::string StateMachine::getCurrentState() const {
-    return this->currentState;
+    return this->getStateName(this->currentState);
   }
 
   uint32_t StateMachine::getID() const {
@@ -318,167 +172,343 @@ namespace cote {
   }
 
   double StateMachine::getConstantValue(const std::string& constant) const {
-    return this->constantValues.at(constant);
+    return this->definition->getConstantValue(constant);
   }
 
   double StateMachine::getVariableValue(const std::string& variable) const {
-    return this->variableValues.at(variable);
+    return this->variableValues.at(
+     this->definition->getVariableHandle(variable)
+    );
   }
 
   void StateMachine::setVariableValue(
    const std::string& variable, const double& value
   ) {
-    this->variableValues.at(variable) = value;
+    this->setVariableValue(
+     this->definition->getVariableHandle(variable),value
+    );
+  }
+
+  std::vector<double> StateMachine::getConditionValues(
+   const std::string& variable
+  ) const {
+    return this->getConditionValues(
+     this->definition->getVariableHandle(variable)
+    );
+  }
+
+  void StateMachine::addVariableListener(
+   const std::string& variable, IVariableListener* const listener
+  ) {
+    this->variableListeners.at(
+     this->definition->getVariableHandle(variable)
+    ).push_back(listener);
+  }
+
+  void StateMachine::removeVariableListener(
+   const std::string& variable, IVariableListener* const listener
+  ) {
+    const VarHandle handle = this->definition->getVariableHandle(variable);
+    if(handle!=NO_VARIABLE) {
+      std::vector<IVariableListener*>& listeners =
+       this->variableListeners.at(handle);
+      std::vector<IVariableListener*>::iterator it =
+       std::find(listeners.begin(),listeners.end(),listener);
+      if(it!=listeners.end()) {
+        listeners.erase(it);
+      }
+    }
+  }
+
+  void StateMachine::setCurrentState(const std::string& state) {
+    StateId stateId = this->getStateId(state);
+    if(stateId==NO_STATE) {
+      stateId =
+       this->definition->getStateCount()+this->extraStateNames.size();
+      this->extraStateNames.push_back(state);
+    }
+    this->setCurrentState(stateId);
   }
 
   void StateMachine::updateState() {
-    if(this->stateTransitions.count(this->currentState)!=0) {
-      std::vector<StateTransition> possibleTransitions =
-       this->stateTransitions.at(this->currentState);
+    const StateId previousState = this->currentState;
+    if(previousState>=this->definition->getStateCount()) {
+      // States named only by setCurrentState have no transitions
+      for(std::size_t i=0; i<this->dirtyVariables.size(); i++) {
+        this->variableDirty.at(this->dirtyVariables.at(i)) = 0;
+      }
+      this->dirtyVariables.clear();
+      this->evaluateAll = false;
+      return;
+    }
+    const std::vector<Transition>& possibleTransitions =
+     this->definition->getTransitions(previousState);
+    std::size_t transitionIndex = possibleTransitions.size();
+    if(this->evaluateAll) {
       for(std::size_t i=0; i<possibleTransitions.size(); i++) {
-        if(possibleTransitions.at(i).checkConditions(this->variableValues)) {
-          std::string previousState = this->currentState;
-          this->currentState = possibleTransitions.at(i).getDstState();
-          // Apply exit changes
-          if(this->exitStateValues.count(previousState)!=0) {
-            for(
-             std::size_t j=0; j<this->exitStateValues.at(previousState).size();
-             j++
-            ) {
-              std::tuple<std::string,std::string,double> exitChange =
-               this->exitStateValues.at(previousState).at(j);
-              std::string variableName = std::get<0>(exitChange);
-              std::string assignmentOperator = std::get<1>(exitChange);
-              double changeValue = std::get<2>(exitChange);
-              double variableValue = this->getVariableValue(variableName);
-              if(assignmentOperator=="+=") {
-                this->setVariableValue(variableName, variableValue+changeValue);
-              } else if(assignmentOperator=="-=") {
-                this->setVariableValue(variableName, variableValue-changeValue);
-              } else if(assignmentOperator=="*=") {
-                this->setVariableValue(variableName, variableValue*changeValue);
-              } else if(assignmentOperator=="=") {
-                this->setVariableValue(variableName, changeValue);
-              }
-            }
-          }
-          // Apply transition changes
-          if(this->transitionValues.count(previousState)!=0) {
-            if(this->transitionValues.at(previousState).count(
-             this->currentState
-            )!=0) {
-              for(
-               std::size_t j=0;
-               j<this->transitionValues.at(previousState).at(
-                this->currentState
-               ).size();
-               j++
-              ) {
-                std::tuple<std::string,std::string,double> transitionChange =
-                 this->transitionValues.at(previousState).at(
-                  this->currentState
-                 ).at(j);
-                std::string variableName = std::get<0>(transitionChange);
-                std::string assignmentOperator = std::get<1>(transitionChange);
-                double changeValue = std::get<2>(transitionChange);
-                double variableValue = this->getVariableValue(variableName);
-                if(assignmentOperator=="+=") {
-                  this->setVariableValue(
-                   variableName, variableValue+changeValue
-                  );
-                } else if(assignmentOperator=="-=") {
-                  this->setVariableValue(
-                   variableName, variableValue-changeValue
-                  );
-                } else if(assignmentOperator=="*=") {
-                  this->setVariableValue(
-                   variableName, variableValue*changeValue
-                  );
-                } else if(assignmentOperator=="=") {
-                  this->setVariableValue(variableName, changeValue);
-                }
-              }
-            }
-          }
-          // Apply enter changes
-          if(this->enterStateValues.count(this->currentState)!=0) {
-            for(
-             std::size_t j=0;
-             j<this->enterStateValues.at(this->currentState).size();
-             j++
-            ) {
-              std::tuple<std::string,std::string,double> enterChange =
-               this->enterStateValues.at(this->currentState).at(j);
-              std::string variableName = std::get<0>(enterChange);
-              std::string assignmentOperator = std::get<1>(enterChange);
-              double changeValue = std::get<2>(enterChange);
-              double variableValue = this->getVariableValue(variableName);
-              if(assignmentOperator=="+=") {
-                this->setVariableValue(variableName, variableValue+changeValue);
-              } else if(assignmentOperator=="-=") {
-                this->setVariableValue(variableName, variableValue-changeValue);
-              } else if(assignmentOperator=="*=") {
-                this->setVariableValue(variableName, variableValue*changeValue);
-              } else if(assignmentOperator=="=") {
-                this->setVariableValue(variableName, changeValue);
-              }
-            }
-          }
+        if(this->checkConditions(possibleTransitions.at(i))) {
+          transitionIndex = i;
           break;
         }
       }
+    } else if(!this->dirtyVariables.empty()) {
+      if(this->candidateTransitions.size()<possibleTransitions.size()) {
+        this->candidateTransitions.resize(possibleTransitions.size(),0);
+      }
+      for(std::size_t i=0; i<this->dirtyVariables.size(); i++) {
+        const std::vector<std::size_t>& dependentTransitions =
+         this->definition->getGuardIndex(
+          previousState,this->dirtyVariables.at(i)
+         );
+        for(std::size_t j=0; j<dependentTransitions.size(); j++) {
+          this->candidateTransitions.at(dependentTransitions.at(j)) = 1;
+        }
+      }
+      for(std::size_t i=0; i<possibleTransitions.size(); i++) {
+        if(this->candidateTransitions.at(i)!=0) {
+          this->candidateTransitions.at(i) = 0;
+          if(
+           transitionIndex==possibleTransitions.size() &&
+           this->checkConditions(possibleTransitions.at(i))
+          ) {
+            transitionIndex = i;
+          }
+        }
+      }
+    }
+    for(std::size_t i=0; i<this->dirtyVariables.size(); i++) {
+      this->variableDirty.at(this->dirtyVariables.at(i)) = 0;
+    }
+    this->dirtyVariables.clear();
+    this->evaluateAll = false;
+    if(transitionIndex<possibleTransitions.size()) {
+      const Transition& transition = possibleTransitions.at(transitionIndex);
+      this->currentState = transition.dstState;
+      this->evaluateAll = true;
+      this->applyActions(this->definition->getExitActions(previousState));
+      this->applyActions(transition.actions);
+      this->applyActions(
+       this->definition->getEnterActions(transition.dstState)
+      );
     }
   }
 
-  void StateMachine::setCurrentState(const std::string& state) {
-    std::string previousState = this->currentState;
-    this->currentState = state;
-    // Apply exit changes
-    if(this->exitStateValues.count(previousState)!=0) {
-      for(
-       std::size_t j=0; j<this->exitStateValues.at(previousState).size();
-       j++
+  StateMachine::VarHandle StateMachine::getVariableHandle(
+   const std::string& variable
+  ) const {
+    return this->definition->getVariableHandle(variable);
+  }
+
+  std::string StateMachine::getVariableName(const VarHandle& variable) const {
+    return this->definition->getVariableName(variable);
+  }
+
+  double StateMachine::getVariableValue(const VarHandle& variable) const {
+    return this->variableValues.at(variable);
+  }
+
+  void StateMachine::setVariableValue(
+   const VarHandle& variable, const double& value
+  ) {
+    double& variableValue = this->variableValues.at(variable);
+    if(variableValue!=value) {
+      const double previousValue = variableValue;
+      variableValue = value;
+      if(
+       this->variableDirty.at(variable)==0 &&
+       this->crossesThreshold(variable,previousValue,value)
       ) {
-        std::tuple<std::string,std::string,double> exitChange =
-         this->exitStateValues.at(previousState).at(j);
-        std::string variableName = std::get<0>(exitChange);
-        std::string assignmentOperator = std::get<1>(exitChange);
-        double changeValue = std::get<2>(exitChange);
-        double variableValue = this->getVariableValue(variableName);
-        if(assignmentOperator=="+=") {
-          this->setVariableValue(variableName, variableValue+changeValue);
-        } else if(assignmentOperator=="-=") {
-          this->setVariableValue(variableName, variableValue-changeValue);
-        } else if(assignmentOperator=="*=") {
-          this->setVariableValue(variableName, variableValue*changeValue);
-        } else if(assignmentOperator=="=") {
-          this->setVariableValue(variableName, changeValue);
-        }
+        this->variableDirty.at(variable) = 1;
+        this->dirtyVariables.push_back(variable);
       }
-    }
-    // Apply enter changes
-    if(this->enterStateValues.count(this->currentState)!=0) {
+      // Listeners may add or remove listeners, so index on every iteration
       for(
-       std::size_t j=0;
-       j<this->enterStateValues.at(this->currentState).size();
-       j++
+       std::size_t i=0; i<this->variableListeners.at(variable).size(); i++
       ) {
-        std::tuple<std::string,std::string,double> enterChange =
-         this->enterStateValues.at(this->currentState).at(j);
-        std::string variableName = std::get<0>(enterChange);
-        std::string assignmentOperator = std::get<1>(enterChange);
-        double changeValue = std::get<2>(enterChange);
-        double variableValue = this->getVariableValue(variableName);
-        if(assignmentOperator=="+=") {
-          this->setVariableValue(variableName, variableValue+changeValue);
-        } else if(assignmentOperator=="-=") {
-          this->setVariableValue(variableName, variableValue-changeValue);
-        } else if(assignmentOperator=="*=") {
-          this->setVariableValue(variableName, variableValue*changeValue);
-        } else if(assignmentOperator=="=") {
-          this->setVariableValue(variableName, changeValue);
+        this->variableListeners.at(variable).at(i)->onVariableChange(
+         this,this->definition->getVariableName(variable),previousValue,value
+        );
+      }
+    }
+  }
+
+  std::vector<double> StateMachine::getConditionValues(
+   const VarHandle& variable
+  ) const {
+    std::vector<double> conditionValues;
+    if(this->currentState>=this->definition->getStateCount()) {
+      return conditionValues;
+    }
+    const std::vector<Transition>& possibleTransitions =
+     this->definition->getTransitions(this->currentState);
+    for(std::size_t i=0; i<possibleTransitions.size(); i++) {
+      const std::vector<Condition>& conditions =
+       possibleTransitions.at(i).conditions;
+      for(std::size_t j=0; j<conditions.size(); j++) {
+        if(conditions.at(j).variable==variable) {
+          conditionValues.push_back(conditions.at(j).value);
         }
       }
     }
+    return conditionValues;
+  }
+
+  StateMachine::StateId StateMachine::getStateId(
+   const std::string& state
+  ) const {
+    const StateId stateId = this->definition->getStateId(state);
+    if(stateId!=NO_STATE) {
+      return stateId;
+    }
+    std::vector<std::string>::const_iterator it = std::find(
+     this->extraStateNames.begin(),this->extraStateNames.end(),state
+    );
+    return (it==this->extraStateNames.end()) ? NO_STATE :
+     this->definition->getStateCount()+(it-this->extraStateNames.begin());
+  }
+
+  std::string StateMachine::getStateName(const StateId& state) const {
+    const std::size_t stateCount = this->definition->getStateCount();
+    return (state<stateCount) ? this->definition->getStateName(state) :
+     this->extraStateNames.at(state-stateCount);
+  }
+
+  StateMachine::StateId StateMachine::getCurrentStateId() const {
+    return this->currentState;
+  }
+
+  void StateMachine::setCurrentState(const StateId& state) {
+    const std::size_t stateCount = this->definition->getStateCount();
+    if(state>=stateCount) {
+      this->extraStateNames.at(state-stateCount); // rejects unknown IDs
+    }
+    const StateId previousState = this->currentState;
+    this->currentState = state;
+    this->evaluateAll = true;
+    if(previousState<stateCount) {
+      this->applyActions(this->definition->getExitActions(previousState));
+    }
+    if(state<stateCount) {
+      this->applyActions(this->definition->getEnterActions(state));
+    }
+  }
+
+  void StateMachine::setTime(const int64_t& time) {
+    // The state held when time advances is the state of the next interval
+    if(time!=this->time && this->currentState!=this->intervalState) {
+      this->closeStateInterval();
+    }
+    this->time = time;
+  }
+
+  int64_t StateMachine::getTime() const {
+    return this->time;
+  }
+
+  int64_t StateMachine::getTimeInState(const StateId& state) const {
+    int64_t timeInState =
+     (state<this->stateTimes.size()) ? this->stateTimes.at(state) : 0;
+    if(state==this->intervalState) {
+      timeInState += this->time-this->stateStartTime;
+    }
+    return timeInState;
+  }
+
+  std::map<std::string,int64_t> StateMachine::getTimeInStates() const {
+    std::map<std::string,int64_t> timeInStates;
+    const std::size_t stateCount =
+     this->definition->getStateCount()+this->extraStateNames.size();
+    for(StateId i=0; i<stateCount; i++) {
+      timeInStates[this->getStateName(i)] = this->getTimeInState(i);
+    }
+    return timeInStates;
+  }
+
+  void StateMachine::setRecordStateIntervals(const bool& record) {
+    this->recordStateIntervals = record;
+  }
+
+  const std::vector<StateMachine::StateInterval>&
+   StateMachine::getStateIntervals() const {
+    return this->stateIntervals;
+  }
+
+  void StateMachine::clearStateIntervals() {
+    this->stateIntervals.clear();
+  }
+
+  void StateMachine::closeStateInterval() {
+    if(this->time>this->stateStartTime) {
+      if(this->intervalState>=this->stateTimes.size()) {
+        this->stateTimes.resize(this->intervalState+1,0);
+      }
+      this->stateTimes.at(this->intervalState) +=
+       this->time-this->stateStartTime;
+      if(this->recordStateIntervals) {
+        this->stateIntervals.push_back(
+         {this->stateStartTime,this->time,this->intervalState}
+        );
+      }
+    }
+    this->intervalState = this->currentState;
+    this->stateStartTime = this->time;
+  }
+
+  bool StateMachine::checkConditions(const Transition& transition) const {
+    bool conditionsMet = transition.satisfiable;
+    for(
+     std::size_t i=0; conditionsMet && i<transition.conditions.size(); i++
+    ) {
+      const Condition& condition = transition.conditions.at(i);
+      const double variableValue = this->variableValues.at(condition.variable);
+      if(condition.comparison==Comparison::EQ) {
+        conditionsMet = (variableValue==condition.value);
+      } else if(condition.comparison==Comparison::NE) {
+        conditionsMet = (variableValue!=condition.value);
+      } else if(condition.comparison==Comparison::LE) {
+        conditionsMet = (variableValue<=condition.value);
+      } else if(condition.comparison==Comparison::GE) {
+        conditionsMet = (variableValue>=condition.value);
+      } else if(condition.comparison==Comparison::LT) {
+        conditionsMet = (variableValue<condition.value);
+      } else if(condition.comparison==Comparison::GT) {
+        conditionsMet = (variableValue>condition.value);
+      }
+    }
+    return conditionsMet;
+  }
+
+  bool StateMachine::crossesThreshold(
+   const VarHandle& variable, const double& value0, const double& value1
+  ) const {
+    const std::vector<double>& thresholds = 
+     this->definition->getGuardThresholds(variable);
+    if(thresholds.empty()) {
+      return false;
+    }
+    if(value0!=value0 || value1!=value1) { // NaN compares false with all
+      return true;
+    }
+    std::vector<double>::const_iterator it = std::lower_bound(
+     thresholds.begin(),thresholds.end(),std::min(value0,value1)
+    );
+    return it!=thresholds.end() && *it<=std::max(value0,value1);
+  }
+
+  void StateMachine::applyActions(const std::vector<Action>& actions) {
+    for(std::size_t i=0; i<actions.size(); i++) {
+      const Action& action = actions.at(i);
+      // An undeclared variable throws here, as the string lookup used to
+      const double variableValue = this->variableValues.at(action.variable);
+      if(action.opcode==Opcode::ASSIGN) {
+        this->setVariableValue(action.variable, action.value);
+      } else if(action.opcode==Opcode::ADD) {
+        this->setVariableValue(action.variable, variableValue+action.value);
+      } else if(action.opcode==Opcode::SUBTRACT) {
+        this->setVariableValue(action.variable, variableValue-action.value);
+      } else if(action.opcode==Opcode::MULTIPLY) {
+        this->setVariableValue(action.variable, variableValue*action.value);
+      }
+    }
   }
 }
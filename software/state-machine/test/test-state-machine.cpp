@@ -8,8 +8,11 @@
 
 // Standard library
 #include <cstddef>          // size_t
+#include <cstdint>          // int64_t
 #include <cstdlib>          // exit, EXIT_SUCCESS
-#include <string>           // to_string
+#include <map>              // map
+#include <string>           // string, to_string
+#include <vector>           // vector
 
 // satsim
 #include <Log.hpp>          // Log
@@ -307,6 +310,81 @@ int main(int argc, char** argv) {
       );
     }
   }
+  // Drive a copy through the same transitions with the handle-based API
+  cote::StateMachine handleStateMachine(computerStateMachine);
+  const cote::StateMachine::VarHandle NODE_VOLTAGE =
+   handleStateMachine.getVariableHandle("node-voltage");
+  const cote::StateMachine::VarHandle POWER_W =
+   handleStateMachine.getVariableHandle("power-w");
+  const cote::StateMachine::StateId IDLE =
+   handleStateMachine.getStateId("IDLE");
+  handleStateMachine.setCurrentState(handleStateMachine.getStateId("OFF"));
+  for(std::size_t j=0; j<25; j++) {
+    time += 0.1;
+    nodeVoltage += 0.1;
+    handleStateMachine.setVariableValue(NODE_VOLTAGE,nodeVoltage);
+    handleStateMachine.updateState();
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(time), "handle-computer-state",
+     handleStateMachine.getStateName(handleStateMachine.getCurrentStateId())
+    );
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(time), "handle-power-w",
+     std::to_string(handleStateMachine.getVariableValue(POWER_W))
+    );
+    if(handleStateMachine.getCurrentStateId()==IDLE) {
+      log.evnt(cote::LogLevel::INFO, std::to_string(time), "handle-idle");
+    }
+  }
+  // Record state intervals over integer steps
+  cote::StateMachine intervalStateMachine(computerStateMachine);
+  const cote::StateMachine::VarHandle INTERVAL_NODE_VOLTAGE =
+   intervalStateMachine.getVariableHandle("node-voltage");
+  intervalStateMachine.setRecordStateIntervals(true);
+  intervalStateMachine.setCurrentState("OFF");
+  int64_t step = 0;
+  nodeVoltage = 5.0;
+  for(std::size_t j=0; j<60; j++) {
+    step += 1;
+    nodeVoltage += (j<20) ? 0.1 : ((j<40) ? 0.0 : -0.1);
+    intervalStateMachine.setTime(step);
+    intervalStateMachine.setVariableValue(INTERVAL_NODE_VOLTAGE,nodeVoltage);
+    if(j==25 || j==35) {
+      intervalStateMachine.setVariableValue(
+       "claimed-task-count",(j==25) ? 1.0 : 0.0
+      );
+    }
+    intervalStateMachine.updateState();
+  }
+  intervalStateMachine.closeStateInterval();
+  const std::vector<cote::StateMachine::StateInterval>& intervals =
+   intervalStateMachine.getStateIntervals();
+  int64_t intervalSum = 0;
+  for(std::size_t i=0; i<intervals.size(); i++) {
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(intervals.at(i).start),
+     "interval-state",
+     intervalStateMachine.getStateName(intervals.at(i).state)
+    );
+    intervalSum += intervals.at(i).end-intervals.at(i).start;
+  }
+  const std::map<std::string,int64_t> timeInStates =
+   intervalStateMachine.getTimeInStates();
+  int64_t timeInStatesSum = 0;
+  for(
+   std::map<std::string,int64_t>::const_iterator it = timeInStates.begin();
+   it!=timeInStates.end(); it++
+  ) {
+    log.meas(
+     cote::LogLevel::INFO, it->first, "time-in-state",
+     std::to_string(it->second)
+    );
+    timeInStatesSum += it->second;
+  }
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(step), "interval-sums-match",
+   std::to_string(intervalSum==step && timeInStatesSum==step)
+  );
   // Write out logs
   log.writeAll();
   std::exit(EXIT_SUCCESS);
@@ -10,10 +10,11 @@
 #define COTE_STATE_TRANSITION_HPP
 
 // Standard library
-#include <map>     // map
-#include <string>  // string
-#include <utility> // pair
-#include <vector>  // vector
+#include <map>         // map
+#include <string>      // string
+#include <string_view> // string_view
+#include <utility>     // pair
+#include <vector>      // vector
 
 // cote
 // None
@@ -21,19 +22,46 @@
 namespace cote {
   class StateTransition {
   public:
+    // Parses a description such as transition:SRC->DST:cond,cond; a
+    // transition with a malformed condition is kept but never fires
     StateTransition(const std::string& description);
+    // Takes the conditions by value so that a parser can move them in;
+    // wellFormed is false if a condition failed to parse
+    StateTransition(
+     const std::string& srcState, const std::string& dstState,
+     std::map<std::string,std::vector<std::pair<std::string,double>>>
+      conditions,
+     const bool& wellFormed=true
+    );
     StateTransition(const StateTransition& stateTransition);
-    StateTransition(StateTransition&& stateTransition);
+    // noexcept so that growing a vector of transitions moves rather than copies
+    StateTransition(StateTransition&& stateTransition) noexcept;
     virtual ~StateTransition();
     virtual StateTransition& operator=(const StateTransition& stateTransition);
     virtual StateTransition& operator=(StateTransition&& stateTransition);
     virtual StateTransition* clone() const;
-    std::string getSrcState() const;
-    std::string getDstState() const;
-    std::map<std::string,std::vector<std::pair<std::string,double>>>
+    const std::string& getSrcState() const;
+    const std::string& getDstState() const;
+    const std::map<std::string,std::vector<std::pair<std::string,double>>>&
      getConditions() const;
+    // Whether every condition parsed; checkConditions fails otherwise
+    bool isWellFormed() const;
     bool checkConditions(const std::map<std::string,double>& conditionValues)
      const;
+    // Configuration tokens, parsed without copying the text; each returns
+    // false if the text is malformed
+    //// Parses a number, allowing surrounding whitespace and a leading +
+    static bool parseValue(const std::string_view& text, double& value);
+    //// Parses a condition such as node-voltage>=5.5
+    static bool parseCondition(
+     const std::string_view& text, std::string& condition,
+     std::string& comparisonOperator, double& value
+    );
+    //// As above, with the condition and operator viewing the text
+    static bool parseCondition(
+     const std::string_view& text, std::string_view& condition,
+     std::string_view& comparisonOperator, double& value
+    );
   private:
     std::string srcState;
     std::string dstState;
@@ -44,6 +72,7 @@ namespace cote {
     //          which is the value used with the comparison operator in order to
     //          determine whether the transition condition has been met
     std::map<std::string,std::vector<std::pair<std::string,double>>> conditions;
+    bool wellFormed;
   };
 }
 
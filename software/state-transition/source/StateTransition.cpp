@@ -7,9 +7,13 @@
 // See the top-level LICENSE file for the license.
 
 // Standard library
+#include <cctype>              // isspace
+#include <charconv>            // from_chars, from_chars_result
 #include <cstddef>             // size_t
 #include <map>                 // map
-#include <string>              // string, find, npos, substr, stod
+#include <string>              // string
+#include <string_view>         // string_view, find, npos, substr
+#include <system_error>        // errc
 #include <utility>             // move, pair, make_pair
 #include <vector>              // vector
 
@@ -17,84 +21,78 @@
 #include <StateTransition.hpp> // StateTransition
 
 namespace cote {
-  StateTransition::StateTransition(const std::string& description) {
+  StateTransition::StateTransition(const std::string& description) :
+   wellFormed(true) {
+    const std::string_view text(description);
     // skip past the "transition" label
-    std::size_t delimiterIndex = description.find(":",0);
+    std::size_t delimiterIndex = text.find(':');
     std::size_t i = (
-     delimiterIndex==std::string::npos ?
-     delimiterIndex : delimiterIndex+std::string(":").size()
+     delimiterIndex==std::string_view::npos ?
+     delimiterIndex : delimiterIndex+std::string_view(":").size()
     );
     // parse and set the source state name
-    delimiterIndex = description.find("->",i);
-    if(delimiterIndex==std::string::npos) {
+    delimiterIndex = text.find("->",i);
+    if(delimiterIndex==std::string_view::npos) {
       this->srcState = "";
       i = delimiterIndex;
     } else {
-      this->srcState = description.substr(i,delimiterIndex-i);
-      i = delimiterIndex+std::string("->").size();
+      this->srcState = std::string(text.substr(i,delimiterIndex-i));
+      i = delimiterIndex+std::string_view("->").size();
     }
     // parse and set the destination state name
-    delimiterIndex = description.find(":",i);
-    if(delimiterIndex==std::string::npos) {
+    delimiterIndex = text.find(':',i);
+    if(delimiterIndex==std::string_view::npos) {
       this->dstState = "";
       i = delimiterIndex;
     } else {
-      this->dstState = description.substr(i,delimiterIndex-i);
-      i = delimiterIndex+std::string(":").size();
+      this->dstState = std::string(text.substr(i,delimiterIndex-i));
+      i = delimiterIndex+std::string_view(":").size();
     }
     // parse and set the transition conditions
-    while(i<description.size()) {
-      delimiterIndex = description.find(",",i);
-      std::string transitionCondition = description.substr(i,delimiterIndex-i);
-      std::size_t j = 0;
+    while(i<text.size()) {
+      delimiterIndex = text.find(',',i);
       std::string condition = "";
       std::string comparisonOperator = "";
       double value = 0.0;
-      if(transitionCondition.find("==",0)!=std::string::npos) {
-        j = transitionCondition.find("==",0);
-        comparisonOperator = "==";
-      } else if(transitionCondition.find("!=",0)!=std::string::npos) {
-        j = transitionCondition.find("!=",0);
-        comparisonOperator = "!=";
-      } else if(transitionCondition.find("<=",0)!=std::string::npos) {
-        j = transitionCondition.find("<=",0);
-        comparisonOperator = "<=";
-      } else if(transitionCondition.find(">=",0)!=std::string::npos) {
-        j = transitionCondition.find(">=",0);
-        comparisonOperator = ">=";
-      } else if(transitionCondition.find("<",0)!=std::string::npos) {
-        j = transitionCondition.find("<",0);
-        comparisonOperator = "<";
-      } else if(transitionCondition.find(">",0)!=std::string::npos) {
-        j = transitionCondition.find(">",0);
-        comparisonOperator = ">";
-      }
-      condition = transitionCondition.substr(0,j);
-      value = std::stod(transitionCondition.substr(
-       j+comparisonOperator.size(),std::string::npos
-      ));
-      if(this->conditions.count(condition)==0) {
-        this->conditions[condition] =
-         std::vector<std::pair<std::string,double>>();
+      if(
+       StateTransition::parseCondition(
+        text.substr(i,delimiterIndex-i),condition,comparisonOperator,value
+       )
+      ) {
+        this->conditions[condition].push_back(
+         std::make_pair(comparisonOperator,value)
+        );
+      } else {
+        // Dropping the condition would weaken the guard
+        this->wellFormed = false;
       }
-      this->conditions.at(condition).push_back(
-       std::make_pair(comparisonOperator,value)
-      );
       i = (
-       delimiterIndex==std::string::npos ?
-       delimiterIndex : delimiterIndex+std::string(",").size()
+       delimiterIndex==std::string_view::npos ?
+       delimiterIndex : delimiterIndex+std::string_view(",").size()
       );
     }
   }
 
+  StateTransition::StateTransition(
+   const std::string& srcState, const std::string& dstState,
+   std::map<std::string,std::vector<std::pair<std::string,double>>>
+    conditions,
+   const bool& wellFormed
+  ) : srcState(srcState), dstState(dstState),
+   conditions(std::move(conditions)), wellFormed(wellFormed) {}
+
   StateTransition::StateTransition(const StateTransition& stateTransition) :
    srcState(stateTransition.getSrcState()),
    dstState(stateTransition.getDstState()),
-   conditions(stateTransition.getConditions()) {}
+   conditions(stateTransition.getConditions()),
+   wellFormed(stateTransition.isWellFormed()) {}
 
-  StateTransition::StateTransition(StateTransition&& stateTransition) :
-   srcState(stateTransition.srcState), dstState(stateTransition.dstState),
-   conditions(stateTransition.conditions) {}
+  StateTransition::StateTransition(
+   StateTransition&& stateTransition
+  ) noexcept : srcState(std::move(stateTransition.srcState)),
+   dstState(std::move(stateTransition.dstState)),
+   conditions(std::move(stateTransition.conditions)),
+   wellFormed(stateTransition.wellFormed) {}
 
   StateTransition::~StateTransition() {}
 
@@ -109,9 +107,10 @@ namespace cote {
   StateTransition& StateTransition::operator=(
    StateTransition&& stateTransition
   ) {
-    this->srcState   = stateTransition.srcState;
-    this->dstState   = stateTransition.dstState;
-    this->conditions = stateTransition.conditions;
+    this->srcState   = std::move(stateTransition.srcState);
+    this->dstState   = std::move(stateTransition.dstState);
+    this->conditions = std::move(stateTransition.conditions);
+    this->wellFormed = stateTransition.wellFormed;
     return *this;
   }
 
@@ -119,23 +118,27 @@ namespace cote {
     return new StateTransition(*this);
   }
 
-  std::string StateTransition::getSrcState() const {
+  const std::string& StateTransition::getSrcState() const {
     return this->srcState;
   }
 
-  std::string StateTransition::getDstState() const {
+  const std::string& StateTransition::getDstState() const {
     return this->dstState;
   }
 
-  std::map<std::string,std::vector<std::pair<std::string,double>>>
+  const std::map<std::string,std::vector<std::pair<std::string,double>>>&
    StateTransition::getConditions() const {
     return this->conditions;
   }
 
+  bool StateTransition::isWellFormed() const {
+    return this->wellFormed;
+  }
+
   bool StateTransition::checkConditions(
    const std::map<std::string,double>& conditionValues
   ) const {
-    bool conditionsMet = true;
+    bool conditionsMet = this->wellFormed;
     for(
      std::map<
       std::string,std::vector<std::pair<std::string,double>>
@@ -178,4 +181,71 @@ namespace cote {
     }
     return conditionsMet;
   }
+
+  bool StateTransition::parseValue(
+   const std::string_view& text, double& value
+  ) {
+    std::size_t begin = 0;
+    std::size_t end = text.size();
+    while(
+     begin<end && std::isspace(static_cast<unsigned char>(text.at(begin)))
+    ) {
+      begin++;
+    }
+    while(
+     end>begin && std::isspace(static_cast<unsigned char>(text.at(end-1)))
+    ) {
+      end--;
+    }
+    if(end-begin>1 && text.at(begin)=='+' && text.at(begin+1)!='-') {
+      begin++;
+    }
+    const char* const first = text.data()+begin;
+    const char* const last = text.data()+end;
+    double parsedValue = 0.0;
+    const std::from_chars_result result =
+     std::from_chars(first,last,parsedValue);
+    if(first==last || result.ec!=std::errc() || result.ptr!=last) {
+      return false;
+    }
+    value = parsedValue;
+    return true;
+  }
+
+  bool StateTransition::parseCondition(
+   const std::string_view& text, std::string& condition,
+   std::string& comparisonOperator, double& value
+  ) {
+    std::string_view conditionView;
+    std::string_view comparisonOperatorView;
+    const bool parsed = StateTransition::parseCondition(
+     text,conditionView,comparisonOperatorView,value
+    );
+    if(!comparisonOperatorView.empty()) {
+      condition = std::string(conditionView);
+      comparisonOperator = std::string(comparisonOperatorView);
+    }
+    return parsed;
+  }
+
+  bool StateTransition::parseCondition(
+   const std::string_view& text, std::string_view& condition,
+   std::string_view& comparisonOperator, double& value
+  ) {
+    // Two-character operators are matched first so that <= is not read as <
+    const std::string_view comparisonOperators[] = {
+     "==", "!=", "<=", ">=", "<", ">"
+    };
+    for(std::size_t i=0; i<6; i++) {
+      const std::size_t operatorIndex = text.find(comparisonOperators[i]);
+      if(operatorIndex!=std::string_view::npos) {
+        condition = text.substr(0,operatorIndex);
+        comparisonOperator = comparisonOperators[i];
+        return StateTransition::parseValue(
+         text.substr(operatorIndex+comparisonOperators[i].size()),value
+        );
+      }
+    }
+    return false;
+  }
 }
@@ -0,0 +1,82 @@
+// ThreadPool.hpp
+// ThreadPool class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_THREAD_POOL_HPP
+#define COTE_THREAD_POOL_HPP
+
+// Standard library
+#include <atomic>             // atomic
+#include <condition_variable> // condition_variable
+#include <cstddef>            // size_t
+#include <cstdint>            // uint32_t, uint64_t
+#include <deque>              // deque
+#include <functional>         // function
+#include <mutex>              // mutex
+#include <thread>             // thread
+#include <utility>            // pair
+#include <vector>             // vector
+
+// cote
+#include <Log.hpp>            // Log
+
+namespace cote {
+  class ThreadPool {
+  public:
+    // Runs parallel loops on the calling thread and threadCount-1 workers; a
+    // thread count of zero or one runs them serially on the calling thread
+    ThreadPool(
+     const uint32_t& threadCount=1, const uint32_t& id=0, Log* const log=NULL
+    );
+    // Copies and moves start their own workers; workers are never shared
+    ThreadPool(const ThreadPool& threadPool);
+    ThreadPool(ThreadPool&& threadPool);
+    virtual ~ThreadPool();
+    virtual ThreadPool& operator=(const ThreadPool& threadPool);
+    virtual ThreadPool& operator=(ThreadPool&& threadPool);
+    virtual ThreadPool* clone() const;
+    uint32_t getThreadCount() const;
+    // Calls task once for each index in [0,count) and returns when every call
+    // has returned; each thread starts on its own contiguous share of the
+    // indices and steals blocks from the other threads once it runs out
+    //// Calls for different indices may run concurrently, so a task should
+    //// only write to data for its own index; reductions over the indices are
+    //// bit-identical to a serial run when done afterwards in index order
+    void parallelFor(
+     const std::size_t& count, const std::function<void(std::size_t)>& task
+    );
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    struct Queue {
+      std::mutex mutex;
+      std::deque<std::pair<std::size_t,std::size_t>> blocks; // [begin,end)
+    };
+    void start();
+    void stop();
+    void work(const std::size_t& thread);
+    void runBlocks(const std::size_t& thread);
+    bool popBlock(
+     const std::size_t& thread, std::pair<std::size_t,std::size_t>& block
+    );
+    uint32_t threadCount;
+    std::vector<std::thread> workers; // threadCount-1 workers
+    std::vector<Queue> queues;        // one per thread, including the caller
+    // The running parallel loop; not owned, should not be deleted
+    const std::function<void(std::size_t)>* task;
+    std::atomic<std::size_t> remaining; // indices not yet run
+    std::mutex mutex;                   // guards the members below
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    uint64_t generation; // parallel loops started
+    bool stopping;       // workers should exit
+    uint32_t id;         // identification number
+    Log* log;            // singleton, should not be deleted
+  };
+}
+
+#endif
@@ -0,0 +1,204 @@
+// ThreadPool.cpp
+// ThreadPool class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>          // max, min
+#include <condition_variable> // condition_variable
+#include <cstddef>            // size_t
+#include <cstdint>            // uint32_t, uint64_t
+#include <functional>         // function
+#include <mutex>              // lock_guard, mutex, unique_lock
+#include <thread>             // thread
+#include <utility>            // pair
+#include <vector>             // vector
+
+// cote
+#include <Log.hpp>            // Log
+#include <ThreadPool.hpp>     // ThreadPool
+
+namespace cote {
+  ThreadPool::ThreadPool(
+   const uint32_t& threadCount, const uint32_t& id, Log* const log
+  ) : threadCount(std::max(threadCount,static_cast<uint32_t>(1))),
+   queues(this->threadCount), task(NULL), remaining(0), generation(0),
+   stopping(false), id(id), log(log) {
+    this->start();
+  }
+
+  ThreadPool::ThreadPool(const ThreadPool& threadPool) :
+   threadCount(threadPool.getThreadCount()), queues(this->threadCount),
+   task(NULL), remaining(0), generation(0), stopping(false),
+   id(threadPool.getID()), log(threadPool.getLog()) {
+    this->start();
+  }
+
+  ThreadPool::ThreadPool(ThreadPool&& threadPool) :
+   threadCount(threadPool.threadCount), queues(this->threadCount), task(NULL),
+   remaining(0), generation(0), stopping(false), id(threadPool.id),
+   log(threadPool.log) {
+    threadPool.log = NULL;
+    this->start();
+  }
+
+  ThreadPool::~ThreadPool() {
+    this->stop();
+    this->log = NULL;
+  }
+
+  ThreadPool& ThreadPool::operator=(const ThreadPool& threadPool) {
+    ThreadPool temp(threadPool);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  ThreadPool& ThreadPool::operator=(ThreadPool&& threadPool) {
+    this->stop();
+    this->threadCount    = threadPool.threadCount;
+    this->queues         = std::vector<Queue>(this->threadCount);
+    this->task           = NULL;
+    this->remaining      = 0;
+    this->generation     = 0;
+    this->stopping       = false;
+    this->id             = threadPool.id;
+    this->log            = threadPool.log;
+    threadPool.log       = NULL;
+    this->start();
+    return *this;
+  }
+
+  ThreadPool* ThreadPool::clone() const {
+    return new ThreadPool(*this);
+  }
+
+  uint32_t ThreadPool::getThreadCount() const {
+    return this->threadCount;
+  }
+
+  void ThreadPool::parallelFor(
+   const std::size_t& count, const std::function<void(std::size_t)>& task
+  ) {
+    if(this->threadCount==1 || count<=1) {
+      for(std::size_t i=0; i<count; i++) {
+        task(i);
+      }
+      return;
+    }
+    // Deal each thread a contiguous share, cut into blocks that can be stolen
+    const std::size_t threads = static_cast<std::size_t>(this->threadCount);
+    const std::size_t blockSize = std::max(
+     static_cast<std::size_t>(1),count/(threads*8)
+    );
+    this->task = &task;
+    this->remaining = count;
+    for(std::size_t t=0; t<threads; t++) {
+      const std::size_t shareEnd = (count*(t+1))/threads;
+      std::lock_guard<std::mutex> lock(this->queues.at(t).mutex);
+      for(std::size_t i=(count*t)/threads; i<shareEnd; i+=blockSize) {
+        this->queues.at(t).blocks.push_back(
+         std::pair<std::size_t,std::size_t>(i,std::min(i+blockSize,shareEnd))
+        );
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->generation += 1;
+    }
+    this->workAvailable.notify_all();
+    // The calling thread works too, then waits for any blocks still running
+    this->runBlocks(0);
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->workDone.wait(lock,[this]{return this->remaining==0;});
+    this->task = NULL;
+  }
+
+  uint32_t ThreadPool::getID() const {
+    return this->id;
+  }
+
+  Log* ThreadPool::getLog() const {
+    return this->log;
+  }
+
+  void ThreadPool::start() {
+    for(std::size_t t=1; t<static_cast<std::size_t>(this->threadCount); t++) {
+      this->workers.push_back(std::thread(&ThreadPool::work,this,t));
+    }
+  }
+
+  void ThreadPool::stop() {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stopping = true;
+    }
+    this->workAvailable.notify_all();
+    for(std::size_t i=0; i<this->workers.size(); i++) {
+      this->workers.at(i).join();
+    }
+    this->workers.clear();
+  }
+
+  void ThreadPool::work(const std::size_t& thread) {
+    uint64_t seenGeneration = 0;
+    while(true) {
+      {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->workAvailable.wait(
+         lock,
+         [this,seenGeneration]{
+          return this->stopping || this->generation!=seenGeneration;
+         }
+        );
+        if(this->stopping) {
+          return;
+        }
+        seenGeneration = this->generation;
+      }
+      this->runBlocks(thread);
+    }
+  }
+
+  void ThreadPool::runBlocks(const std::size_t& thread) {
+    std::pair<std::size_t,std::size_t> block;
+    while(this->popBlock(thread,block)) {
+      for(std::size_t i=block.first; i<block.second; i++) {
+        (*(this->task))(i);
+      }
+      const std::size_t blockCount = block.second-block.first;
+      if(this->remaining.fetch_sub(blockCount)==blockCount) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->workDone.notify_all();
+      }
+    }
+  }
+
+  bool ThreadPool::popBlock(
+   const std::size_t& thread, std::pair<std::size_t,std::size_t>& block
+  ) {
+    // Take the next block of this thread's own share first
+    {
+      Queue& queue = this->queues.at(thread);
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if(!queue.blocks.empty()) {
+        block = queue.blocks.front();
+        queue.blocks.pop_front();
+        return true;
+      }
+    }
+    // Then steal the last block of another thread's share
+    for(std::size_t i=1; i<this->queues.size(); i++) {
+      Queue& queue = this->queues.at((thread+i)%this->queues.size());
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if(!queue.blocks.empty()) {
+        block = queue.blocks.back();
+        queue.blocks.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+}
@@ -0,0 +1,68 @@
+// test-thread-pool.cpp
+// ThreadPool class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cmath>          // sin
+#include <cstddef>        // size_t
+#include <cstdlib>        // exit, EXIT_SUCCESS
+#include <string>         // to_string
+#include <vector>         // vector
+
+// satsim
+#include <Log.hpp>        // Log
+#include <LogLevel.hpp>   // LogLevel
+#include <ThreadPool.hpp> // ThreadPool
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  // Uneven work per index, summed in index order after each parallel loop
+  const std::size_t count = 1000;
+  std::vector<double> serial(count,0.0);
+  std::vector<double> parallel(count,0.0);
+  auto work = [](const std::size_t& i) {
+    double value = 0.0;
+    for(std::size_t j=0; j<(i%17)*100; j++) {
+      value += std::sin(static_cast<double>(i+j));
+    }
+    return value;
+  };
+  cote::ThreadPool serialPool(1,0,&log);
+  cote::ThreadPool pool(8,1,&log);
+  for(std::size_t loop=0; loop<3; loop++) {
+    serialPool.parallelFor(count,[&](std::size_t i) {serial.at(i) += work(i);});
+    pool.parallelFor(count,[&](std::size_t i) {parallel.at(i) += work(i);});
+  }
+  double serialSum = 0.0;
+  double parallelSum = 0.0;
+  for(std::size_t i=0; i<count; i++) {
+    serialSum += serial.at(i);
+    parallelSum += parallel.at(i);
+  }
+  log.meas(
+   cote::LogLevel::INFO, "0", "thread-count",
+   std::to_string(pool.getThreadCount())
+  );
+  log.meas(
+   cote::LogLevel::INFO, "0", "identical",
+   std::to_string(serialSum==parallelSum)
+  );
+  // A copy starts its own workers
+  cote::ThreadPool copy(pool);
+  std::vector<std::size_t> indices(5,0);
+  copy.parallelFor(5,[&](std::size_t i) {indices.at(i) = i*i;});
+  for(std::size_t i=0; i<indices.size(); i++) {
+    log.meas(
+     cote::LogLevel::INFO, std::to_string(i), "copy-index",
+     std::to_string(indices.at(i))
+    );
+  }
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
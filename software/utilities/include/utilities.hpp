@@ -8,7 +8,7 @@
 
 // Standard library
 #include <array>           // array
-#include <cstdint>         // int16_t, uint8_t, uint32_t
+#include <cstdint>         // int16_t, uint8_t, uint32_t, uint64_t
 #include <tuple>           // tuple
 
 // cote library
@@ -288,6 +288,19 @@ namespace cote { namespace util {
    const std::array<double,3>& end, const std::array<double,3>& start
   );
 
+  // Linearly interpolate between two Cartesian 3D vectors
+  // Parameters:
+  //  start: The vector at fraction 0.0
+  //  end: The vector at fraction 1.0
+  //  fraction: The position between start and end
+  // Returns:
+  //  start plus fraction times the separation vector from start to end
+  // Reference: Standard calculation
+  std::array<double,3> interpolateLinear(
+   const std::array<double,3>& start, const std::array<double,3>& end,
+   const double& fraction
+  );
+
   // Calculate the ECI position vector of the sun in kilometers
   // Parameters:
   //  julianDay: Julian days up to midnight of the UT1 Gregorian day of interest
@@ -349,6 +362,68 @@ namespace cote { namespace util {
    const std::array<double,3>& satEciKm, const std::array<double,3>& sunEciKm
   );
 
+  // Calculate the number of steps over which a quantity stays below a limit
+  // Parameters:
+  //  margin: how far the quantity is below the limit
+  //  ratePerStep: an upper bound on how far the quantity approaches the limit
+  //   each step
+  // Returns:
+  //  The number of steps, starting with the current one, over which the
+  //  quantity stays below the limit, keeping one step in hand; zero if margin
+  //  is not positive and the largest uint64_t if the limit is out of reach
+  // Reference: None
+  uint64_t calcStepsBelow(const double& margin, const double& ratePerStep);
+
+  // Calculate an upper bound on the speed of a satellite in orbit
+  // Parameters:
+  //  radiusKm: the distance (km) from the satellite to the center of the Earth
+  // Returns:
+  //  The escape speed in km/s, which every bound orbit is slower than
+  // Reference: Vis-viva equation
+  double calcMaxSpeedKmPerS(const double& radiusKm);
+
+  // Calculate the number of steps over which a satellite in full sunlight or
+  //  in the umbra certainly stays out of the penumbra. Seen from the
+  //  satellite, the penumbra begins where the angle between the Earth and the
+  //  Sun reaches the sum (from sunlight) or the difference (from umbra) of
+  //  their angular radii; the direction to the Earth turns at most v/r, the
+  //  angular radius of the Earth changes at most A*v/(r*sqrt(r^2-A^2)), and
+  //  the direction to the Sun turns by well under 1e-6 rad/s. The bound is
+  //  doubled to absorb the error of the propagator.
+  // Parameters:
+  //  satEciKm: the ECI position of the satellite in kilometers
+  //  sunEciKm: the ECI position of the Sun in kilometers
+  //  sunOcclusionFactor: the return value from calcSunOcclusionFactor()
+  //  stepSizeS: the duration of a step in seconds
+  // Returns:
+  //  The number of steps as returned by calcStepsBelow(); zero in penumbra
+  // Reference: Geometry
+  uint64_t calcStepsOutsidePenumbra(
+   const std::array<double,3>& satEciKm, const std::array<double,3>& sunEciKm,
+   const double& sunOcclusionFactor, const double& stepSizeS
+  );
+
+  // Calculate the number of steps over which the look angle elevation from a
+  //  ground station to a satellite certainly stays on the same side of a
+  //  threshold, e.g. the lowest elevation at which they can link. The line of
+  //  sight turns at most as fast as the relative speed over the range, plus
+  //  the rotation of the local horizon. The bound is doubled to absorb the
+  //  error of the propagator.
+  // Parameters:
+  //  elevationDeg: the return value from calcElevationDeg()
+  //  thresholdDeg: the threshold elevation in degrees
+  //  alt: height above the ellipsoid of ground station in kilometers
+  //  eciPosnSat: satellite ECI position in kilometers
+  //  stepSizeS: the duration of a step in seconds
+  // Returns:
+  //  The number of steps as returned by calcStepsBelow(); zero at the
+  //  threshold
+  // Reference: Geometry
+  uint64_t calcStepsToElevation(
+   const double& elevationDeg, const double& thresholdDeg, const double& alt,
+   const std::array<double,3>& eciPosnSat, const double& stepSizeS
+  );
+
   // Calculate the number of tiles per ground track frame in order to maximize
   //  object detection inference accuracy
   // Parameters:
@@ -11,6 +11,7 @@
 #include <cmath>           // fmod
 #include <cstdint>         // int16_t, uint8_t, int32_t
 #include <fstream>         // ifstream
+#include <limits>          // numeric_limits
 #include <tuple>           // tuple
 
 // cote library
@@ -694,6 +695,18 @@ namespace cote { namespace util {
     return separationVector;
   }
 
+  std::array<double,3> interpolateLinear(
+   const std::array<double,3>& start, const std::array<double,3>& end,
+   const double& fraction
+  ) {
+    std::array<double,3> interpolated = {
+     start.at(0)+fraction*(end.at(0)-start.at(0)),
+     start.at(1)+fraction*(end.at(1)-start.at(1)),
+     start.at(2)+fraction*(end.at(2)-start.at(2))
+    };
+    return interpolated;
+  }
+
   std::array<double,3> calcSunEciPosnKm(
    const double& julianDay, const uint32_t& second, const uint32_t& nanosecond
   ) {
@@ -782,6 +795,71 @@ namespace cote { namespace util {
     }
   }
 
+  uint64_t calcStepsBelow(const double& margin, const double& ratePerStep) {
+    if(!(margin>0.0)) {
+      return 0;
+    }
+    const double steps = margin/ratePerStep;
+    if(steps>=1.0e18) {
+      return std::numeric_limits<uint64_t>::max();
+    }
+    return (steps>=1.0) ? static_cast<uint64_t>(steps)-1 : 0;
+  }
+
+  double calcMaxSpeedKmPerS(const double& radiusKm) {
+    return std::sqrt(2.0*cnst::WGS_84_GM/radiusKm);
+  }
+
+  uint64_t calcStepsOutsidePenumbra(
+   const std::array<double,3>& satEciKm, const std::array<double,3>& sunEciKm,
+   const double& sunOcclusionFactor, const double& stepSizeS
+  ) {
+    if(sunOcclusionFactor!=0.0 && sunOcclusionFactor!=1.0) {
+      return 0;
+    }
+    const std::array<double,3> earthEciKm = {0.0,0.0,0.0};
+    const std::array<double,3> satToEarth =
+     calcSeparationVector(earthEciKm,satEciKm);
+    const std::array<double,3> satToSun =
+     calcSeparationVector(sunEciKm,satEciKm);
+    const double radiusKm = magnitude(satToEarth);
+    if(!(radiusKm>cnst::WGS_84_A)) {
+      return 0;
+    }
+    const double angRadiusEarth = calcAngularRadius(cnst::WGS_84_A,radiusKm);
+    const double angRadiusSun =
+     calcAngularRadius(cnst::SUN_RADIUS_KM,magnitude(satToSun));
+    const double angBetweenEarthSun = calcAngleBetween(satToEarth,satToSun);
+    const double marginRad = (sunOcclusionFactor==0.0) ?
+     angBetweenEarthSun-(angRadiusEarth+angRadiusSun) :
+     (angRadiusEarth-angRadiusSun)-angBetweenEarthSun;
+    const double speedKmPerS = calcMaxSpeedKmPerS(radiusKm);
+    const double radPerS =
+     speedKmPerS/radiusKm+
+     cnst::WGS_84_A*speedKmPerS/(
+      radiusKm*std::sqrt(radiusKm*radiusKm-cnst::WGS_84_A*cnst::WGS_84_A)
+     )+1.0e-6;
+    return calcStepsBelow(marginRad,2.0*radPerS*stepSizeS);
+  }
+
+  uint64_t calcStepsToElevation(
+   const double& elevationDeg, const double& thresholdDeg, const double& alt,
+   const std::array<double,3>& eciPosnSat, const double& stepSizeS
+  ) {
+    // The ground station is at most this far from the center of the Earth
+    const double gndRadiusKm = cnst::WGS_84_A+std::fabs(alt);
+    const double radiusKm = magnitude(eciPosnSat);
+    if(!(radiusKm>gndRadiusKm)) {
+      return 0;
+    }
+    const double marginRad =
+     std::fabs(thresholdDeg-elevationDeg)*cnst::RAD_PER_DEG;
+    const double radPerS =
+     (calcMaxSpeedKmPerS(radiusKm)+cnst::WGS_84_WE*gndRadiusKm)/
+     (radiusKm-gndRadiusKm)+cnst::WGS_84_WE;
+    return calcStepsBelow(marginRad,2.0*radPerS*stepSizeS);
+  }
+
   uint64_t calcTileCountForMaxAcc(
    const std::array<double,3>& satEciPosn, const double& focalLengthM,
    const double& pixelSizeM, const double& featureSizeM,
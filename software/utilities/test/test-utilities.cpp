@@ -113,5 +113,11 @@ int main(int argc, char** argv) {
             << std::endl
             << " Correct result: 397.505"
             << std::endl;
+  // Test the steps below a limit, keeping one step in hand
+  std::cout << "calcStepsBelow(10.0,3.0): "
+            << cote::util::calcStepsBelow(10.0,3.0)
+            << std::endl
+            << " Correct result: 2"
+            << std::endl;
   std::exit(EXIT_SUCCESS);
 }
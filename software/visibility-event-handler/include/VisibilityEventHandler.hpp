@@ -0,0 +1,108 @@
+// VisibilityEventHandler.hpp
+// VisibilityEventHandler class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_VISIBILITY_EVENT_HANDLER_HPP
+#define COTE_VISIBILITY_EVENT_HANDLER_HPP
+
+// Standard library
+#include <cstddef>           // size_t
+#include <cstdint>           // uint32_t, uint64_t
+#include <string>            // string
+#include <vector>            // vector
+
+// cote library
+#include <GroundStation.hpp> // GroundStation
+#include <IEventHandler.hpp> // IEventHandler
+#include <Log.hpp>           // Log
+#include <Satellite.hpp>     // Satellite
+#include <Simulation.hpp>    // Simulation
+
+namespace cote {
+  class VisibilityEventHandler : public IEventHandler {
+  public:
+    // Logs each acquisition (AOS) and loss (LOS) of signal between every
+    // ground station and every satellite in a discrete-event simulation; a
+    // satellite is in view at or above the minimum elevation. A satellite is
+    // only propagated to the steps at which it is checked, and the next check
+    // of a ground station and satellite pair is scheduled for the earliest
+    // step at which the elevation could cross the minimum
+    //// AOS is logged at the first step in view and LOS at the first step out
+    //// of view
+    VisibilityEventHandler(
+     const double& minElevationDeg=10.0, const uint32_t& id=0,
+     Log* const log=NULL
+    );
+    VisibilityEventHandler(
+     const VisibilityEventHandler& visibilityEventHandler
+    );
+    VisibilityEventHandler(VisibilityEventHandler&& visibilityEventHandler);
+    virtual ~VisibilityEventHandler();
+    virtual VisibilityEventHandler& operator=(
+     const VisibilityEventHandler& visibilityEventHandler
+    );
+    virtual VisibilityEventHandler& operator=(
+     VisibilityEventHandler&& visibilityEventHandler
+    );
+    virtual VisibilityEventHandler* clone() const;
+    // Satellites and ground stations are not owned and must outlive the
+    // handler; each satellite must be at the simulation clock when the
+    // handler is started
+    std::size_t addSatellite(Satellite* const satellite);
+    std::size_t getSatelliteCount() const;
+    Satellite* getSatellite(const std::size_t& index) const;
+    std::size_t addGroundStation(GroundStation* const groundStation);
+    std::size_t getGroundStationCount() const;
+    GroundStation* getGroundStation(const std::size_t& index) const;
+    double getMinElevationDeg() const;
+    // Checks every ground station and satellite pair at the current step,
+    // which schedules its next check; AOS and LOS are logged as the
+    // simulation runs events
+    void start(Simulation* const simulation);
+    // Whether the satellite was in view of the ground station at the most
+    // recent check of the pair
+    bool isVisible(
+     const std::size_t& groundStationIndex, const std::size_t& satelliteIndex
+    ) const;
+    // The number of acquisitions of signal logged for the pair
+    uint64_t getAosCount(
+     const std::size_t& groundStationIndex, const std::size_t& satelliteIndex
+    ) const;
+    void handleEvent(
+     Simulation* const simulation, const std::size_t& entity,
+     const uint32_t& type
+    ) override;
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    // Pairs are indexed by groundStationIndex*satelliteCount+satelliteIndex
+    std::size_t getPairIndex(
+     const std::size_t& groundStationIndex, const std::size_t& satelliteIndex
+    ) const;
+    // Propagates the satellite of the pair to the current step, logs any AOS
+    // or LOS and schedules the next check
+    void check(Simulation* const simulation, const std::size_t& pair);
+    double calcElevationDeg(
+     Simulation* const simulation, const std::size_t& pair
+    ) const;
+    void scheduleCheck(
+     Simulation* const simulation, const std::size_t& pair,
+     const double& elevationDeg
+    );
+    std::vector<Satellite*> satellites;         // not owned, do not delete
+    std::vector<uint64_t> stepCounts;           // step each satellite is at
+    std::vector<GroundStation*> groundStations; // not owned, do not delete
+    std::vector<std::string> names;             // one log name per pair
+    std::vector<bool> visibles;                 // one per pair
+    std::vector<uint64_t> aosCounts;            // one per pair
+    double minElevationDeg;                     // lowest elevation in view
+    uint32_t id;                                // identification number
+    Log* log;                                   // singleton, should not be deleted
+  };
+}
+
+#endif
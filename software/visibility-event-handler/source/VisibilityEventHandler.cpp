@@ -0,0 +1,264 @@
+// VisibilityEventHandler.cpp
+// VisibilityEventHandler class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>                  // max, min
+#include <cstddef>                    // size_t
+#include <cstdint>                    // uint32_t, uint64_t
+#include <iomanip>                    // setw, setfill
+#include <sstream>                    // ostringstream
+#include <string>                     // string
+#include <utility>                    // move
+#include <vector>                     // vector
+
+// cote
+#include <GroundStation.hpp>          // GroundStation
+#include <Log.hpp>                    // Log
+#include <LogLevel.hpp>               // LogLevel
+#include <Satellite.hpp>              // Satellite
+#include <Simulation.hpp>             // Simulation
+#include <utilities.hpp>              // calcElevationDeg,
+                                      // calcStepsToElevation
+#include <VisibilityEventHandler.hpp> // VisibilityEventHandler
+
+namespace cote {
+  VisibilityEventHandler::VisibilityEventHandler(
+   const double& minElevationDeg, const uint32_t& id, Log* const log
+  ) : minElevationDeg(minElevationDeg), id(id), log(log) {}
+
+  VisibilityEventHandler::VisibilityEventHandler(
+   const VisibilityEventHandler& visibilityEventHandler
+  ) : satellites(visibilityEventHandler.satellites),
+   stepCounts(visibilityEventHandler.stepCounts),
+   groundStations(visibilityEventHandler.groundStations),
+   names(visibilityEventHandler.names),
+   visibles(visibilityEventHandler.visibles),
+   aosCounts(visibilityEventHandler.aosCounts),
+   minElevationDeg(visibilityEventHandler.getMinElevationDeg()),
+   id(visibilityEventHandler.getID()), log(visibilityEventHandler.getLog()) {}
+
+  VisibilityEventHandler::VisibilityEventHandler(
+   VisibilityEventHandler&& visibilityEventHandler
+  ) : satellites(std::move(visibilityEventHandler.satellites)),
+   stepCounts(std::move(visibilityEventHandler.stepCounts)),
+   groundStations(std::move(visibilityEventHandler.groundStations)),
+   names(std::move(visibilityEventHandler.names)),
+   visibles(std::move(visibilityEventHandler.visibles)),
+   aosCounts(std::move(visibilityEventHandler.aosCounts)),
+   minElevationDeg(visibilityEventHandler.minElevationDeg),
+   id(visibilityEventHandler.id), log(visibilityEventHandler.log) {
+    visibilityEventHandler.log = NULL;
+  }
+
+  VisibilityEventHandler::~VisibilityEventHandler() {
+    this->log = NULL;
+  }
+
+  VisibilityEventHandler& VisibilityEventHandler::operator=(
+   const VisibilityEventHandler& visibilityEventHandler
+  ) {
+    VisibilityEventHandler temp(visibilityEventHandler);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  VisibilityEventHandler& VisibilityEventHandler::operator=(
+   VisibilityEventHandler&& visibilityEventHandler
+  ) {
+    this->satellites      = std::move(visibilityEventHandler.satellites);
+    this->stepCounts      = std::move(visibilityEventHandler.stepCounts);
+    this->groundStations  = std::move(visibilityEventHandler.groundStations);
+    this->names           = std::move(visibilityEventHandler.names);
+    this->visibles        = std::move(visibilityEventHandler.visibles);
+    this->aosCounts       = std::move(visibilityEventHandler.aosCounts);
+    this->minElevationDeg = visibilityEventHandler.minElevationDeg;
+    this->id              = visibilityEventHandler.id;
+    this->log             = visibilityEventHandler.log;
+    visibilityEventHandler.log = NULL;
+    return *this;
+  }
+
+  VisibilityEventHandler* VisibilityEventHandler::clone() const {
+    return new VisibilityEventHandler(*this);
+  }
+
+  std::size_t VisibilityEventHandler::addSatellite(
+   Satellite* const satellite
+  ) {
+    this->satellites.push_back(satellite);
+    this->stepCounts.push_back(0);
+    return this->satellites.size()-1;
+  }
+
+  std::size_t VisibilityEventHandler::getSatelliteCount() const {
+    return this->satellites.size();
+  }
+
+  Satellite* VisibilityEventHandler::getSatellite(
+   const std::size_t& index
+  ) const {
+    return this->satellites.at(index);
+  }
+
+  std::size_t VisibilityEventHandler::addGroundStation(
+   GroundStation* const groundStation
+  ) {
+    this->groundStations.push_back(groundStation);
+    return this->groundStations.size()-1;
+  }
+
+  std::size_t VisibilityEventHandler::getGroundStationCount() const {
+    return this->groundStations.size();
+  }
+
+  GroundStation* VisibilityEventHandler::getGroundStation(
+   const std::size_t& index
+  ) const {
+    return this->groundStations.at(index);
+  }
+
+  double VisibilityEventHandler::getMinElevationDeg() const {
+    return this->minElevationDeg;
+  }
+
+  void VisibilityEventHandler::start(Simulation* const simulation) {
+    for(std::size_t i=0; i<this->satellites.size(); i++) {
+      this->stepCounts.at(i) = simulation->getStepCount();
+    }
+    const std::size_t pairCount =
+     this->groundStations.size()*this->satellites.size();
+    this->names.clear();
+    this->visibles.assign(pairCount,false);
+    this->aosCounts.assign(pairCount,0);
+    for(std::size_t i=0; i<this->groundStations.size(); i++) {
+      for(std::size_t j=0; j<this->satellites.size(); j++) {
+        std::ostringstream name;
+        name << "gnd-" << std::setw(10) << std::setfill('0')
+             << this->groundStations.at(i)->getID()
+             << "-sat-" << std::setw(10) << std::setfill('0')
+             << this->satellites.at(j)->getID() << "-visibility";
+        this->names.push_back(name.str());
+      }
+    }
+    for(std::size_t i=0; i<pairCount; i++) {
+      //// A satellite that starts in view has not been acquired during the run
+      const double elevationDeg = this->calcElevationDeg(simulation,i);
+      this->visibles.at(i) = (elevationDeg>=this->minElevationDeg);
+      this->scheduleCheck(simulation,i,elevationDeg);
+    }
+  }
+
+  bool VisibilityEventHandler::isVisible(
+   const std::size_t& groundStationIndex, const std::size_t& satelliteIndex
+  ) const {
+    return this->visibles.at(
+     this->getPairIndex(groundStationIndex,satelliteIndex)
+    );
+  }
+
+  uint64_t VisibilityEventHandler::getAosCount(
+   const std::size_t& groundStationIndex, const std::size_t& satelliteIndex
+  ) const {
+    return this->aosCounts.at(
+     this->getPairIndex(groundStationIndex,satelliteIndex)
+    );
+  }
+
+  void VisibilityEventHandler::handleEvent(
+   Simulation* const simulation, const std::size_t& entity,
+   const uint32_t& /*type*/
+  ) {
+    this->check(simulation,entity);
+  }
+
+  uint32_t VisibilityEventHandler::getID() const {
+    return this->id;
+  }
+
+  Log* VisibilityEventHandler::getLog() const {
+    return this->log;
+  }
+
+  std::size_t VisibilityEventHandler::getPairIndex(
+   const std::size_t& groundStationIndex, const std::size_t& satelliteIndex
+  ) const {
+    return groundStationIndex*this->satellites.size()+satelliteIndex;
+  }
+
+  void VisibilityEventHandler::check(
+   Simulation* const simulation, const std::size_t& pair
+  ) {
+    const std::size_t satelliteIndex = pair%this->satellites.size();
+    const uint64_t stepCount = simulation->getStepCount();
+    if(stepCount>this->stepCounts.at(satelliteIndex)) {
+      simulation->propagate(
+       this->satellites.at(satelliteIndex),
+       stepCount-this->stepCounts.at(satelliteIndex)
+      );
+      this->stepCounts.at(satelliteIndex) = stepCount;
+    }
+    const double elevationDeg = this->calcElevationDeg(simulation,pair);
+    const bool prevVisible = this->visibles.at(pair);
+    const bool visible = (elevationDeg>=this->minElevationDeg);
+    this->visibles.at(pair) = visible;
+    if(!prevVisible && visible) {
+      this->aosCounts.at(pair) += 1;
+      if(this->log!=NULL) {
+        COTE_MEAS(
+         *(this->log), LogLevel::INFO, simulation->getDateTime()->toString(),
+         this->names.at(pair), std::string("aos")
+        );
+      }
+    } else if(prevVisible && !visible) {
+      if(this->log!=NULL) {
+        COTE_MEAS(
+         *(this->log), LogLevel::INFO, simulation->getDateTime()->toString(),
+         this->names.at(pair), std::string("los")
+        );
+      }
+    }
+    this->scheduleCheck(simulation,pair,elevationDeg);
+  }
+
+  double VisibilityEventHandler::calcElevationDeg(
+   Simulation* const simulation, const std::size_t& pair
+  ) const {
+    const GroundStation* const groundStation =
+     this->groundStations.at(pair/this->satellites.size());
+    return util::calcElevationDeg(
+     simulation->getJulianDay(), simulation->getSecSinceMidnight(),
+     simulation->getNanosecond(), groundStation->getLatitude(),
+     groundStation->getLongitude(), groundStation->getHAE(),
+     this->satellites.at(pair%this->satellites.size())->getECIPosn()
+    );
+  }
+
+  void VisibilityEventHandler::scheduleCheck(
+   Simulation* const simulation, const std::size_t& pair,
+   const double& elevationDeg
+  ) {
+    //// The elevation stays on its side of the minimum for the steady steps
+    //// starting with the current one; checks are never scheduled past the
+    //// end of the run
+    const uint64_t stepCount = simulation->getStepCount();
+    const uint64_t remainingSteps = (simulation->getNumSteps()>stepCount) ?
+     simulation->getNumSteps()-stepCount : 0;
+    const uint64_t steadySteps = util::calcStepsToElevation(
+     elevationDeg, this->minElevationDeg,
+     this->groundStations.at(pair/this->satellites.size())->getHAE(),
+     this->satellites.at(pair%this->satellites.size())->getECIPosn(),
+     simulation->getStepSizeS()
+    );
+    simulation->scheduleEvent(
+     stepCount+std::max(
+      std::min(steadySteps,remainingSteps),static_cast<uint64_t>(1)
+     ),
+     this,pair
+    );
+  }
+}
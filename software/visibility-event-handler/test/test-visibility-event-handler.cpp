@@ -0,0 +1,96 @@
+// test-visibility-event-handler.cpp
+// VisibilityEventHandler class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstdint>                    // uint64_t
+#include <cstdlib>                    // exit, EXIT_SUCCESS
+#include <string>                     // string, to_string
+#include <vector>                     // vector
+
+// cote library
+#include <DateTime.hpp>               // DateTime
+#include <GroundStation.hpp>          // GroundStation
+#include <Log.hpp>                    // Log
+#include <LogLevel.hpp>               // LogLevel
+#include <Satellite.hpp>              // Satellite
+#include <Simulation.hpp>             // Simulation
+#include <utilities.hpp>              // calcJulianDayFromYMD,
+                                      // calcSecSinceMidnight,
+                                      // calcElevationDeg
+#include <VisibilityEventHandler.hpp> // VisibilityEventHandler
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  // One day of one second steps, about fifteen orbits
+  const cote::DateTime start(1980,10,1,23,41,24,113759999);
+  const uint64_t NUM_STEPS = 86400;
+  const double MIN_ELEVATION_DEG = 10.0;
+  cote::Simulation simulation(start,0,0,1,0,NUM_STEPS,0,&log);
+  cote::Satellite satellite(
+   "../../satellite/data/test.tle",simulation.getDateTime(),&log
+  );
+  cote::GroundStation groundStation(
+   40.4427,-79.9430,0.300,simulation.getDateTime(),1,&log
+  );
+  cote::VisibilityEventHandler visibilityEventHandler(
+   MIN_ELEVATION_DEG,0,&log
+  );
+  visibilityEventHandler.addSatellite(&satellite);
+  visibilityEventHandler.addGroundStation(&groundStation);
+  visibilityEventHandler.start(&simulation);
+  simulation.runEvents();
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+   "aos-count", std::to_string(visibilityEventHandler.getAosCount(0,0))
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+   "handled-event-count",
+   std::to_string(simulation.getHandledEventCount())
+  );
+  // The same satellite stepped every step logs the same AOS and LOS
+  cote::DateTime dateTime(start);
+  cote::Satellite steppedSatellite("../../satellite/data/test.tle",&dateTime);
+  bool prevVisible = false;
+  uint64_t steppedAosCount = 0;
+  for(uint64_t step=0; step<NUM_STEPS; step++) {
+    const double elevationDeg = cote::util::calcElevationDeg(
+     cote::util::calcJulianDayFromYMD(
+      dateTime.getYear(), dateTime.getMonth(), dateTime.getDay()
+     ),
+     cote::util::calcSecSinceMidnight(
+      dateTime.getHour(), dateTime.getMinute(), dateTime.getSecond()
+     ),
+     dateTime.getNanosecond(), groundStation.getLatitude(),
+     groundStation.getLongitude(), groundStation.getHAE(),
+     steppedSatellite.getECIPosn()
+    );
+    const bool visible = (elevationDeg>=MIN_ELEVATION_DEG);
+    if(step>0 && !prevVisible && visible) {
+      steppedAosCount += 1;
+      log.meas(
+       cote::LogLevel::INFO, dateTime.toString(), "stepped-visibility", "aos"
+      );
+    } else if(step>0 && prevVisible && !visible) {
+      log.meas(
+       cote::LogLevel::INFO, dateTime.toString(), "stepped-visibility", "los"
+      );
+    }
+    prevVisible = visible;
+    dateTime.update(0,0,1,0);
+    steppedSatellite.update(0,0,1,0);
+  }
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(NUM_STEPS), "stepped-aos-count",
+   std::to_string(steppedAosCount)
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}
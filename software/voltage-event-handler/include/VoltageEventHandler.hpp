@@ -0,0 +1,96 @@
+// VoltageEventHandler.hpp
+// VoltageEventHandler class header file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+#ifndef COTE_VOLTAGE_EVENT_HANDLER_HPP
+#define COTE_VOLTAGE_EVENT_HANDLER_HPP
+
+// Standard library
+#include <cstddef>            // size_t
+#include <cstdint>            // uint32_t, uint64_t
+#include <string>             // string
+#include <vector>             // vector
+
+// cote library
+#include <IEventHandler.hpp>  // IEventHandler
+#include <Log.hpp>            // Log
+#include <PowerSubsystem.hpp> // PowerSubsystem
+#include <Simulation.hpp>     // Simulation
+
+namespace cote {
+  class VoltageEventHandler : public IEventHandler {
+  public:
+    // Logs each power subsystem's node voltage crossing its thresholds, e.g.
+    // the voltages that state machine transitions compare against, in a
+    // discrete-event simulation. A power subsystem is only advanced to the
+    // steps at which it is checked, and the next check is scheduled for the
+    // step at which PowerSubsystem::calcTimeToNextEvent predicts the next
+    // threshold crossing, clipping change, or brownout
+    //// The node is below a threshold when its voltage is less than it, as in
+    //// a node-voltage<threshold guard; a crossing is logged at the first step
+    //// on the other side
+    VoltageEventHandler(const uint32_t& id=0, Log* const log=NULL);
+    VoltageEventHandler(const VoltageEventHandler& voltageEventHandler);
+    VoltageEventHandler(VoltageEventHandler&& voltageEventHandler);
+    virtual ~VoltageEventHandler();
+    virtual VoltageEventHandler& operator=(
+     const VoltageEventHandler& voltageEventHandler
+    );
+    virtual VoltageEventHandler& operator=(
+     VoltageEventHandler&& voltageEventHandler
+    );
+    virtual VoltageEventHandler* clone() const;
+    // Power subsystems are not owned and must outlive the handler; each must
+    // be at the simulation clock when the handler is started
+    std::size_t addPowerSubsystem(
+     PowerSubsystem* const powerSubsystem,
+     const std::vector<double>& thresholds
+    );
+    std::size_t getPowerSubsystemCount() const;
+    PowerSubsystem* getPowerSubsystem(const std::size_t& index) const;
+    const std::vector<double>& getThresholds(const std::size_t& index) const;
+    // Checks every power subsystem at the current step, which schedules its
+    // next check; the crossings are logged as the simulation runs events
+    void start(Simulation* const simulation);
+    // The prediction assumes that the loads and the solar current do not
+    // change; call update immediately before changing either. It advances the
+    // power subsystem to the current step, logs any crossing, and replaces
+    // the scheduled check with one at the current step, which is handled
+    // after the change
+    void update(Simulation* const simulation, const std::size_t& index);
+    // The node voltage at the most recent check of the power subsystem
+    double getNodeVoltage(const std::size_t& index) const;
+    // The number of threshold crossings logged for the power subsystem
+    uint64_t getCrossingCount(const std::size_t& index) const;
+    void handleEvent(
+     Simulation* const simulation, const std::size_t& entity,
+     const uint32_t& type
+    ) override;
+    uint32_t getID() const;
+    Log* getLog() const;
+  private:
+    // Advances the power subsystem to the current step and logs any crossing
+    void advance(Simulation* const simulation, const std::size_t& index);
+    // Advances the power subsystem, logs any brownout and schedules the next
+    // check
+    void check(Simulation* const simulation, const std::size_t& index);
+    void scheduleCheck(Simulation* const simulation, const std::size_t& index);
+    std::vector<PowerSubsystem*> powerSubsystems; // not owned, do not delete
+    std::vector<std::vector<double>> thresholds;  // one set per subsystem
+    std::vector<std::string> names;               // one log name per subsystem
+    std::vector<uint64_t> stepCounts;             // step each subsystem is at
+    std::vector<double> nodeVoltages;             // one per subsystem
+    std::vector<uint64_t> crossingCounts;         // one per subsystem
+    // generations: the event type of the scheduled check of each subsystem;
+    //   update increments it, so the check that it replaces is ignored
+    std::vector<uint32_t> generations;
+    uint32_t id;                                  // identification number
+    Log* log;                                     // singleton, should not be deleted
+  };
+}
+
+#endif
@@ -0,0 +1,239 @@
+// VoltageEventHandler.cpp
+// VoltageEventHandler class implementation file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <algorithm>               // max
+#include <cmath>                   // ceil
+#include <cstddef>                 // size_t
+#include <cstdint>                 // uint32_t, uint64_t
+#include <iomanip>                 // setw, setfill
+#include <sstream>                 // ostringstream
+#include <string>                  // string
+#include <utility>                 // move
+#include <vector>                  // vector
+
+// cote
+#include <Log.hpp>                 // Log
+#include <LogLevel.hpp>            // LogLevel
+#include <PowerSubsystem.hpp>      // PowerSubsystem
+#include <Simulation.hpp>          // Simulation
+#include <VoltageEventHandler.hpp> // VoltageEventHandler
+
+namespace cote {
+  VoltageEventHandler::VoltageEventHandler(
+   const uint32_t& id, Log* const log
+  ) : id(id), log(log) {}
+
+  VoltageEventHandler::VoltageEventHandler(
+   const VoltageEventHandler& voltageEventHandler
+  ) : powerSubsystems(voltageEventHandler.powerSubsystems),
+   thresholds(voltageEventHandler.thresholds),
+   names(voltageEventHandler.names),
+   stepCounts(voltageEventHandler.stepCounts),
+   nodeVoltages(voltageEventHandler.nodeVoltages),
+   crossingCounts(voltageEventHandler.crossingCounts),
+   generations(voltageEventHandler.generations),
+   id(voltageEventHandler.getID()), log(voltageEventHandler.getLog()) {}
+
+  VoltageEventHandler::VoltageEventHandler(
+   VoltageEventHandler&& voltageEventHandler
+  ) : powerSubsystems(std::move(voltageEventHandler.powerSubsystems)),
+   thresholds(std::move(voltageEventHandler.thresholds)),
+   names(std::move(voltageEventHandler.names)),
+   stepCounts(std::move(voltageEventHandler.stepCounts)),
+   nodeVoltages(std::move(voltageEventHandler.nodeVoltages)),
+   crossingCounts(std::move(voltageEventHandler.crossingCounts)),
+   generations(std::move(voltageEventHandler.generations)),
+   id(voltageEventHandler.id), log(voltageEventHandler.log) {
+    voltageEventHandler.log = NULL;
+  }
+
+  VoltageEventHandler::~VoltageEventHandler() {
+    this->log = NULL;
+  }
+
+  VoltageEventHandler& VoltageEventHandler::operator=(
+   const VoltageEventHandler& voltageEventHandler
+  ) {
+    VoltageEventHandler temp(voltageEventHandler);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  VoltageEventHandler& VoltageEventHandler::operator=(
+   VoltageEventHandler&& voltageEventHandler
+  ) {
+    this->powerSubsystems = std::move(voltageEventHandler.powerSubsystems);
+    this->thresholds      = std::move(voltageEventHandler.thresholds);
+    this->names           = std::move(voltageEventHandler.names);
+    this->stepCounts      = std::move(voltageEventHandler.stepCounts);
+    this->nodeVoltages    = std::move(voltageEventHandler.nodeVoltages);
+    this->crossingCounts  = std::move(voltageEventHandler.crossingCounts);
+    this->generations     = std::move(voltageEventHandler.generations);
+    this->id              = voltageEventHandler.id;
+    this->log             = voltageEventHandler.log;
+    voltageEventHandler.log = NULL;
+    return *this;
+  }
+
+  VoltageEventHandler* VoltageEventHandler::clone() const {
+    return new VoltageEventHandler(*this);
+  }
+
+  std::size_t VoltageEventHandler::addPowerSubsystem(
+   PowerSubsystem* const powerSubsystem, const std::vector<double>& thresholds
+  ) {
+    std::ostringstream name;
+    name << "pwr-" << std::setw(10) << std::setfill('0')
+         << powerSubsystem->getID() << "-node-voltage";
+    this->powerSubsystems.push_back(powerSubsystem);
+    this->thresholds.push_back(thresholds);
+    this->names.push_back(name.str());
+    this->stepCounts.push_back(0);
+    this->nodeVoltages.push_back(powerSubsystem->getNodeVoltage());
+    this->crossingCounts.push_back(0);
+    this->generations.push_back(0);
+    return this->powerSubsystems.size()-1;
+  }
+
+  std::size_t VoltageEventHandler::getPowerSubsystemCount() const {
+    return this->powerSubsystems.size();
+  }
+
+  PowerSubsystem* VoltageEventHandler::getPowerSubsystem(
+   const std::size_t& index
+  ) const {
+    return this->powerSubsystems.at(index);
+  }
+
+  const std::vector<double>& VoltageEventHandler::getThresholds(
+   const std::size_t& index
+  ) const {
+    return this->thresholds.at(index);
+  }
+
+  void VoltageEventHandler::start(Simulation* const simulation) {
+    for(std::size_t i=0; i<this->powerSubsystems.size(); i++) {
+      this->stepCounts.at(i) = simulation->getStepCount();
+      this->nodeVoltages.at(i) = this->powerSubsystems.at(i)->getNodeVoltage();
+      this->crossingCounts.at(i) = 0;
+      this->generations.at(i) += 1;
+      this->scheduleCheck(simulation,i);
+    }
+  }
+
+  void VoltageEventHandler::update(
+   Simulation* const simulation, const std::size_t& index
+  ) {
+    this->advance(simulation,index);
+    this->generations.at(index) += 1;
+    simulation->scheduleEvent(
+     simulation->getStepCount(),this,index,this->generations.at(index)
+    );
+  }
+
+  double VoltageEventHandler::getNodeVoltage(const std::size_t& index) const {
+    return this->nodeVoltages.at(index);
+  }
+
+  uint64_t VoltageEventHandler::getCrossingCount(
+   const std::size_t& index
+  ) const {
+    return this->crossingCounts.at(index);
+  }
+
+  void VoltageEventHandler::handleEvent(
+   Simulation* const simulation, const std::size_t& entity,
+   const uint32_t& type
+  ) {
+    if(type==this->generations.at(entity)) {
+      this->check(simulation,entity);
+    }
+  }
+
+  uint32_t VoltageEventHandler::getID() const {
+    return this->id;
+  }
+
+  Log* VoltageEventHandler::getLog() const {
+    return this->log;
+  }
+
+  void VoltageEventHandler::advance(
+   Simulation* const simulation, const std::size_t& index
+  ) {
+    PowerSubsystem* const powerSubsystem = this->powerSubsystems.at(index);
+    const uint64_t stepCount = simulation->getStepCount();
+    if(stepCount>this->stepCounts.at(index)) {
+      powerSubsystem->advance(
+       static_cast<double>(stepCount-this->stepCounts.at(index))*
+       simulation->getStepSizeS()
+      );
+      this->stepCounts.at(index) = stepCount;
+    }
+    const double prevNodeVoltage = this->nodeVoltages.at(index);
+    const double nodeVoltage = powerSubsystem->getNodeVoltage();
+    this->nodeVoltages.at(index) = nodeVoltage;
+    const std::vector<double>& thresholds = this->thresholds.at(index);
+    for(std::size_t i=0; i<thresholds.size(); i++) {
+      const bool prevBelow = (prevNodeVoltage<thresholds.at(i));
+      const bool below = (nodeVoltage<thresholds.at(i));
+      if(prevBelow!=below) {
+        this->crossingCounts.at(index) += 1;
+        if(this->log!=NULL) {
+          std::ostringstream crossing;
+          crossing << (below ? "below-" : "above-") << thresholds.at(i);
+          COTE_MEAS(
+           *(this->log), LogLevel::INFO, simulation->getDateTime()->toString(),
+           this->names.at(index), crossing.str()
+          );
+        }
+      }
+    }
+  }
+
+  void VoltageEventHandler::check(
+   Simulation* const simulation, const std::size_t& index
+  ) {
+    this->advance(simulation,index);
+    if(this->powerSubsystems.at(index)->isBrownout()) {
+      //// The node cannot supply the loads, so the voltage is not predicted;
+      //// the caller is expected to call update and shed load
+      if(this->log!=NULL) {
+        COTE_MEAS(
+         *(this->log), LogLevel::INFO, simulation->getDateTime()->toString(),
+         this->names.at(index), std::string("brownout")
+        );
+      }
+      return;
+    }
+    this->scheduleCheck(simulation,index);
+  }
+
+  void VoltageEventHandler::scheduleCheck(
+   Simulation* const simulation, const std::size_t& index
+  ) {
+    //// The next event is rounded up to a step, so that the node is on the
+    //// other side of a threshold when it is checked; if the event is not
+    //// reached, the check at the end of the run is never handled
+    const uint64_t stepCount = simulation->getStepCount();
+    const uint64_t remainingSteps = (simulation->getNumSteps()>stepCount) ?
+     simulation->getNumSteps()-stepCount : 0;
+    const double eventSteps = std::ceil(
+     this->powerSubsystems.at(index)->calcTimeToNextEvent(
+      this->thresholds.at(index)
+     )/simulation->getStepSizeS()
+    );
+    const uint64_t steps = (eventSteps<static_cast<double>(remainingSteps)) ?
+     static_cast<uint64_t>(eventSteps) : remainingSteps;
+    simulation->scheduleEvent(
+     stepCount+std::max(steps,static_cast<uint64_t>(1)),this,index,
+     this->generations.at(index)
+    );
+  }
+}
@@ -0,0 +1,151 @@
+// test-voltage-event-handler.cpp
+// VoltageEventHandler class test file
+//
+// Written by Bradley Denby
+// Other contributors: None
+//
+// See the top-level LICENSE file for the license.
+
+// Standard library
+#include <cstddef>                 // size_t
+#include <cstdint>                 // uint32_t, uint64_t
+#include <cstdlib>                 // exit, EXIT_SUCCESS
+#include <sstream>                 // ostringstream
+#include <string>                  // string, to_string
+#include <vector>                  // vector
+
+// cote library
+#include <Capacitor.hpp>           // Capacitor
+#include <DateTime.hpp>            // DateTime
+#include <IEventHandler.hpp>       // IEventHandler
+#include <Log.hpp>                 // Log
+#include <LogLevel.hpp>            // LogLevel
+#include <PowerSubsystem.hpp>      // PowerSubsystem
+#include <Simulation.hpp>          // Simulation
+#include <SolarArray.hpp>          // SolarArray
+#include <VoltageEventHandler.hpp> // VoltageEventHandler
+
+// Sets the load of a power subsystem at scheduled steps, updating the voltage
+// event handler first
+class LoadSwitch : public cote::IEventHandler {
+public:
+  LoadSwitch(
+   cote::PowerSubsystem* const powerSubsystem,
+   cote::VoltageEventHandler* const voltageEventHandler,
+   const std::vector<double>& loadPowerWs
+  ) : powerSubsystem(powerSubsystem),
+   voltageEventHandler(voltageEventHandler), loadPowerWs(loadPowerWs) {}
+  void handleEvent(
+   cote::Simulation* const simulation, const std::size_t& entity,
+   const uint32_t& /*type*/
+  ) override {
+    this->voltageEventHandler->update(simulation,0);
+    this->powerSubsystem->setLoadPowerW(this->loadPowerWs.at(entity));
+  }
+private:
+  cote::PowerSubsystem* powerSubsystem;
+  cote::VoltageEventHandler* voltageEventHandler;
+  std::vector<double> loadPowerWs;
+};
+
+// Logs the crossings of the thresholds between two node voltages
+void logCrossings(
+ cote::Log* const log, const cote::DateTime& dateTime,
+ const std::vector<double>& thresholds, const double& prevNodeVoltage,
+ const double& nodeVoltage
+) {
+  for(std::size_t i=0; i<thresholds.size(); i++) {
+    const bool prevBelow = (prevNodeVoltage<thresholds.at(i));
+    const bool below = (nodeVoltage<thresholds.at(i));
+    if(prevBelow!=below) {
+      std::ostringstream crossing;
+      crossing << (below ? "below-" : "above-") << thresholds.at(i);
+      log->meas(
+       cote::LogLevel::INFO, dateTime.toString(), "stepped-node-voltage",
+       crossing.str()
+      );
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<cote::LogLevel> levels = {cote::LogLevel::INFO};
+  cote::Log log(levels,"../test");
+  // One hour of one second steps: discharge under a heavy load, charge under
+  // a light load until the solar array is clipped, then discharge again
+  const cote::DateTime start(1980,10,1,23,41,24,113759999);
+  const uint64_t NUM_STEPS = 3600;
+  const std::vector<uint64_t> SWITCH_STEPS = {600,2400};
+  const std::vector<double> LOAD_POWER_WS = {4.0,0.5,4.0};
+  const std::vector<double> THRESHOLDS = {5.0,5.5,5.75,6.75};
+  cote::Simulation simulation(start,0,0,1,0,NUM_STEPS,0,&log);
+  cote::SolarArray solarArray(7.2,0.0064,0.292,1,&log);
+  solarArray.setIrradianceWpM2(1366.1);
+  cote::Capacitor capacitor(50.0,0.168,1,&log);
+  capacitor.setChargeCoulomb(340.0);
+  cote::PowerSubsystem powerSubsystem(&capacitor,&solarArray,1,&log);
+  powerSubsystem.setLoadPowerW(LOAD_POWER_WS.at(0));
+  // The stepped copy starts from the same charge
+  cote::Capacitor steppedCapacitor(capacitor);
+  cote::PowerSubsystem steppedPowerSubsystem(
+   &steppedCapacitor,&solarArray,2,&log
+  );
+  steppedPowerSubsystem.setLoadPowerW(LOAD_POWER_WS.at(0));
+  cote::VoltageEventHandler voltageEventHandler(0,&log);
+  voltageEventHandler.addPowerSubsystem(&powerSubsystem,THRESHOLDS);
+  LoadSwitch loadSwitch(
+   &powerSubsystem,&voltageEventHandler,
+   std::vector<double>(LOAD_POWER_WS.begin()+1,LOAD_POWER_WS.end())
+  );
+  for(std::size_t i=0; i<SWITCH_STEPS.size(); i++) {
+    simulation.scheduleEvent(SWITCH_STEPS.at(i),&loadSwitch,i);
+  }
+  voltageEventHandler.start(&simulation);
+  simulation.runEvents();
+  voltageEventHandler.update(&simulation,0);
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+   "crossing-count",
+   std::to_string(voltageEventHandler.getCrossingCount(0))
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+   "handled-event-count",
+   std::to_string(simulation.getHandledEventCount())
+  );
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(simulation.getStepCount()),
+   "node-voltage", std::to_string(voltageEventHandler.getNodeVoltage(0))
+  );
+  // The same power subsystem advanced every step logs the same crossings
+  cote::DateTime dateTime(start);
+  double prevNodeVoltage = steppedPowerSubsystem.getNodeVoltage();
+  std::size_t switchIndex = 0;
+  for(uint64_t step=1; step<=NUM_STEPS; step++) {
+    steppedPowerSubsystem.advance(1.0);
+    dateTime.update(0,0,1,0);
+    logCrossings(
+     &log, dateTime, THRESHOLDS, prevNodeVoltage,
+     steppedPowerSubsystem.getNodeVoltage()
+    );
+    prevNodeVoltage = steppedPowerSubsystem.getNodeVoltage();
+    if(
+     switchIndex<SWITCH_STEPS.size() && step==SWITCH_STEPS.at(switchIndex)
+    ) {
+      switchIndex++;
+      steppedPowerSubsystem.setLoadPowerW(LOAD_POWER_WS.at(switchIndex));
+      logCrossings(
+       &log, dateTime, THRESHOLDS, prevNodeVoltage,
+       steppedPowerSubsystem.getNodeVoltage()
+      );
+      prevNodeVoltage = steppedPowerSubsystem.getNodeVoltage();
+    }
+  }
+  log.meas(
+   cote::LogLevel::INFO, std::to_string(NUM_STEPS), "stepped-node-voltage",
+   std::to_string(prevNodeVoltage)
+  );
+  // Write out logs
+  log.writeAll();
+  std::exit(EXIT_SUCCESS);
+}